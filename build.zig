@@ -8,6 +8,9 @@ pub fn build(b: &Builder) {
     test_step.dependOn(tests.addPkgTests(b, test_filter,
         "test/behavior.zig", "behavior", "Run the behavior tests"));
 
+    test_step.dependOn(tests.addAnalysisThreadsTests(b, test_filter,
+        "test/behavior.zig", "behavior"));
+
     test_step.dependOn(tests.addPkgTests(b, test_filter,
         "std/index.zig", "std", "Run the standard library tests"));
 
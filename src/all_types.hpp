@@ -8,6 +8,7 @@
 #ifndef ZIG_ALL_TYPES_HPP
 #define ZIG_ALL_TYPES_HPP
 
+#include "arena.hpp"
 #include "list.hpp"
 #include "buffer.hpp"
 #include "zig_llvm.hpp"
@@ -29,10 +30,14 @@ struct LabelTableEntry;
 struct BuiltinFnEntry;
 struct TypeStructField;
 struct CodeGen;
+struct IrInstructionStats;
 struct ConstExprValue;
 struct IrInstruction;
 struct IrInstructionCast;
 struct IrBasicBlock;
+struct IrBytecode;
+struct OsMutex;
+struct ImportPrefetcher;
 struct ScopeDecls;
 
 struct IrGotoItem {
@@ -48,7 +53,8 @@ struct IrExecutable {
     size_t mem_slot_count;
     size_t next_debug_id;
     size_t *backward_branch_count;
-    size_t backward_branch_quota;
+    // shared by the whole comptime evaluation, @setEvalBranchQuota raises it
+    size_t *backward_branch_quota;
     bool invalid;
     ZigList<LabelTableEntry *> all_labels;
     ZigList<IrGotoItem> goto_list;
@@ -58,6 +64,17 @@ struct IrExecutable {
     AstNode *source_node;
     IrExecutable *parent_exec;
     Scope *begin_scope;
+    // set by ir_gen when the IR depends on the scope it was generated in by
+    // more than the variables it references, e.g. container declarations
+    bool captures_scope;
+    // analysis uses param_vars_new[i] wherever the IR refers to
+    // param_vars_old[i], see ir_eval_const_value
+    VariableTableEntry **param_vars_old;
+    VariableTableEntry **param_vars_new;
+    size_t param_var_count;
+    // when set, the IR of this executable is allocated from here instead of
+    // the IR arena, so that it can be freed on its own
+    Arena *arena;
 };
 
 enum OutType {
@@ -101,14 +118,29 @@ struct ConstStructValue {
 enum ConstArraySpecial {
     ConstArraySpecialNone,
     ConstArraySpecialUndef,
+    // A []u8 whose bytes are stored in s_buf rather than as one ConstExprValue
+    // per element. expand_undef_array converts it to ConstArraySpecialNone.
+    ConstArraySpecialBuf,
+    // An array of bools, floats or integers of at most 64 bits whose elements
+    // are stored in s_dense. See type_allows_dense_const_array.
+    ConstArraySpecialDense,
 };
 
 struct ConstArrayValue {
     ConstArraySpecial special;
+    ConstParent parent;
     struct {
         ConstExprValue *elements;
-        ConstParent parent;
     } s_none;
+    Buf *s_buf;
+    struct {
+        // integers in two's complement and bools as 0 or 1 go in words,
+        // floats go in floats; only one of the two is allocated
+        uint64_t *words;
+        double *floats;
+        // bit i is set when element i is not undefined
+        uint64_t *defined;
+    } s_dense;
 };
 
 enum ConstPtrSpecial {
@@ -811,11 +843,13 @@ struct AstNodeErrorType {
 struct AstNodeVarLiteral {
 };
 
+// AST nodes are only allocated as big as the header plus the member of data
+// that their type uses, see ast_node_data_size. They are never copied.
 struct AstNode {
     enum NodeType type;
-    size_t line;
-    size_t column;
     uint32_t create_index; // for determinism purposes
+    uint32_t line;
+    uint32_t column;
     ImportTableEntry *owner;
     union {
         AstNodeRoot root;
@@ -1150,8 +1184,14 @@ struct FnTableEntry {
     IrExecutable ir_executable;
     IrExecutable analyzed_executable;
     size_t prealloc_bbc;
+    size_t prealloc_backward_branch_quota;
     AstNode **param_source_nodes;
     Buf **param_names;
+    // the parameter variables are defined and ir_executable holds the
+    // pass-1 IR of the body, possibly generated by an analysis thread
+    bool body_ir_generated;
+    // with --free-ir, ir_executable lives here until ir_free_fn_pass1
+    Arena ir_arena;
 
     AstNode *fn_no_inline_set_node;
     AstNode *fn_static_eval_set_node;
@@ -1165,6 +1205,17 @@ struct FnTableEntry {
     Buf *section_name;
     AstNode *set_global_linkage_node;
     GlobalLinkageId linkage;
+
+    // pass-1 IR of the body, shared by comptime calls of this function, and
+    // the parameter variables of the call it was generated for
+    IrExecutable *comptime_ir;
+    ZigList<VariableTableEntry *> comptime_ir_params;
+    bool comptime_ir_in_use;
+    bool comptime_ir_uncacheable;
+    // register bytecode lowered from analyzed_executable that comptime calls
+    // of this function run instead, see ir_eval_fn_call_bytecode
+    IrBytecode *comptime_bytecode;
+    bool comptime_bytecode_unsupported;
 };
 
 uint32_t fn_table_entry_hash(FnTableEntry*);
@@ -1223,6 +1274,7 @@ enum BuiltinFnId {
     BuiltinFnIdOffsetOf,
     BuiltinFnIdInlineCall,
     BuiltinFnIdTypeId,
+    BuiltinFnIdSetEvalBranchQuota,
 };
 
 struct BuiltinFnEntry {
@@ -1316,15 +1368,41 @@ struct ZigLLVMFnKey {
 uint32_t zig_llvm_fn_key_hash(ZigLLVMFnKey);
 bool zig_llvm_fn_key_eql(ZigLLVMFnKey a, ZigLLVMFnKey b);
 
+// for tables keyed by the unique Buf that intern_buf returns
+uint32_t interned_buf_hash(Buf *buf);
+bool interned_buf_eql(Buf *a, Buf *b);
+
 struct TimeEvent {
     double time;
     const char *name;
+    // peak resident set size of the process so far, in bytes
+    size_t peak_rss;
+};
+
+// the comptime calls made from one call site, see --comptime-report
+struct ComptimeCallSite {
+    AstNode *source_node;
+    FnTableEntry *fn_entry;
+    size_t call_count;
+    size_t backward_branch_count;
+    double seconds;
+};
+
+uint32_t ast_node_ptr_hash(AstNode *node);
+bool ast_node_ptr_eql(AstNode *a, AstNode *b);
+
+// a file whose contents went into the object file, see cache.cpp
+struct CacheDep {
+    Buf *path;
+    uint64_t hash;
 };
 
 enum BuildMode {
     BuildModeDebug,
     BuildModeFastRelease,
     BuildModeSafeRelease,
+    // optimizes for size, with safety off
+    BuildModeSmallRelease,
 };
 
 struct LinkLib {
@@ -1352,9 +1430,11 @@ struct CodeGen {
 
 
     // reminder: hash tables must be initialized before use
+    HashMap<Buf *, Buf *, buf_hash, buf_eql_buf> intern_table;
     HashMap<Buf *, ImportTableEntry *, buf_hash, buf_eql_buf> import_table;
-    HashMap<Buf *, BuiltinFnEntry *, buf_hash, buf_eql_buf> builtin_fn_table;
-    HashMap<Buf *, TypeTableEntry *, buf_hash, buf_eql_buf> primitive_type_table;
+    // keyed by interned names, like the symbols in the AST
+    HashMap<Buf *, BuiltinFnEntry *, interned_buf_hash, interned_buf_eql> builtin_fn_table;
+    HashMap<Buf *, TypeTableEntry *, interned_buf_hash, interned_buf_eql> primitive_type_table;
     HashMap<TypeId, TypeTableEntry *, type_id_hash, type_id_eql> type_table;
     HashMap<FnTypeId *, TypeTableEntry *, fn_type_id_hash, fn_type_id_eql> fn_type_table;
     HashMap<Buf *, ErrorTableEntry *, buf_hash, buf_eql_buf> error_table;
@@ -1440,6 +1520,10 @@ struct CodeGen {
     LLVMTargetMachineRef target_machine;
     ZigLLVMDIFile *dummy_di_file;
     bool is_native_target;
+    // from --target-cpu and --target-features, and once the target machine
+    // is created, what it was created with
+    Buf *target_cpu;
+    Buf *target_features;
     PackageTableEntry *root_package;
     PackageTableEntry *std_package;
     PackageTableEntry *zigrt_package;
@@ -1522,11 +1606,76 @@ struct CodeGen {
     Buf *test_filter;
     Buf *test_name_prefix;
 
+    // number of threads that emit machine code, each into its own object
+    size_t codegen_threads;
+    // emit ThinLTO bitcode and leave codegen to the linker
+    bool thin_lto;
+    // profile-guided optimization: the raw profile that an instrumented
+    // executable writes when main returns, or the merged profile to use
+    Buf *profile_generate_path;
+    Buf *profile_use_path;
+    // number of threads that generate the pass-1 IR of function bodies.
+    // while they run, analysis_mutex guards the tables they share.
+    size_t analysis_threads;
+    OsMutex *analysis_mutex;
+    // reads and parses imports ahead of analysis, see start_import_prefetch.
+    // while its threads run, analysis_mutex also guards intern_table.
+    ImportPrefetcher *import_prefetcher;
+    bool parse_threads_running;
+
     ZigList<TimeEvent> timing_events;
+    // all of the source that went through tokenize, and how long it took
+    size_t tokenize_byte_count;
+    size_t tokenize_token_count;
+    double tokenize_seconds;
+    // comptime calls that generated pass-1 IR and that reused it
+    size_t comptime_ir_gen_count;
+    size_t comptime_ir_reuse_count;
+    // comptime calls that ran as bytecode and that fell back to analysis
+    size_t comptime_bytecode_run_count;
+    size_t comptime_bytecode_bail_count;
+    // nesting depth of analyze_const_value. function bodies are only
+    // analyzed ahead of their turn when this is zero.
+    size_t const_eval_depth;
+    // backward branches that a comptime evaluation may take unless it
+    // calls @setEvalBranchQuota
+    size_t comptime_quota;
+    bool comptime_report;
+    HashMap<AstNode *, ComptimeCallSite *, ast_node_ptr_hash, ast_node_ptr_eql> comptime_call_sites;
+
+    // AST nodes
+    Arena parse_arena;
+    // IR instructions and basic blocks, pass 1 and analyzed
+    Arena ir_arena;
+    // compile-time values created during analysis and comptime evaluation
+    Arena const_val_arena;
+    // type table entries, which live until the end of codegen
+    Arena type_arena;
+    // with --free-ir, the pass-1 IR of each function body is freed once the
+    // body has been analyzed, and the IR arena once all bodies are rendered
+    bool free_ir;
+    size_t pass1_ir_bytes_freed;
+    // pass-1 IR of comptime expressions, see ir_eval_const_value
+    size_t comptime_scratch_bytes_freed;
+    size_t comptime_scratch_bytes_kept;
+    size_t ir_bytes_freed;
+    IrInstructionStats *ir_stats;
 
     Buf *cache_dir;
     Buf *out_h_path;
 
+    // incremental build cache, see cache.cpp
+    uint64_t cache_key;
+    ZigList<CacheDep> cache_deps;
+    // set when the build reads an input that the cache cannot track
+    bool cache_disabled;
+    size_t cache_hit_count;
+    size_t cache_miss_count;
+    size_t cache_files_checked;
+    const char *cache_miss_reason;
+    // the builds of builtin.o and compiler_rt.o for linking this one
+    ZigList<CodeGen *> child_gens;
+
     ZigList<FnTableEntry *> inline_fns;
     ZigList<AstNode *> tld_ref_source_node_stack;
 };
@@ -1538,7 +1687,8 @@ enum VarLinkage {
 };
 
 struct VariableTableEntry {
-    Buf name;
+    // interned, see intern_buf
+    Buf *name;
     ConstExprValue *value;
     LLVMValueRef value_ref;
     bool src_is_const;
@@ -1602,7 +1752,8 @@ struct Scope {
 struct ScopeDecls {
     Scope base;
 
-    HashMap<Buf *, Tld *, buf_hash, buf_eql_buf> decl_table;
+    // keys are interned, see intern_buf
+    HashMap<Buf *, Tld *, interned_buf_hash, interned_buf_eql> decl_table;
     bool safety_off;
     AstNode *safety_set_node;
     bool fast_math_off;
@@ -1617,7 +1768,8 @@ struct ScopeDecls {
 struct ScopeBlock {
     Scope base;
 
-    HashMap<Buf *, LabelTableEntry *, buf_hash, buf_eql_buf> label_table; 
+    // keys are interned, see intern_buf
+    HashMap<Buf *, LabelTableEntry *, interned_buf_hash, interned_buf_eql> label_table;
     bool safety_off;
     AstNode *safety_set_node;
     bool fast_math_off;
@@ -1821,13 +1973,30 @@ enum IrInstructionId {
     IrInstructionIdFieldParentPtr,
     IrInstructionIdOffsetOf,
     IrInstructionIdTypeId,
+    IrInstructionIdSetEvalBranchQuota,
+};
+
+// the last IrInstructionId + 1
+static const size_t ir_instruction_id_count = IrInstructionIdSetEvalBranchQuota + 1;
+
+// How many instructions of each kind were created, and the bytes they took
+// together with their values. Reported with --enable-timing-info.
+struct IrInstructionStats {
+    size_t count[ir_instruction_id_count];
+    size_t bytes[ir_instruction_id_count];
 };
 
 struct IrInstruction {
     IrInstructionId id;
+    // true if this instruction was generated by zig and not from user code
+    bool is_gen;
     Scope *scope;
     AstNode *source_node;
-    ConstExprValue value;
+    // the result of the instruction. only the kinds of instruction that can
+    // have a compile-time known result get the whole value, and global_refs
+    // once it is known; for the others it ends after the runtime hints, see
+    // ir_value_size
+    ConstExprValue *value;
     size_t debug_id;
     LLVMValueRef llvm_value;
     // if ref_count is zero and the instruction has no side effects,
@@ -1835,8 +2004,6 @@ struct IrInstruction {
     size_t ref_count;
     IrInstruction *other;
     IrBasicBlock *owner_bb;
-    // true if this instruction was generated by zig and not from user code
-    bool is_gen;
 };
 
 struct IrInstructionCondBr {
@@ -2589,6 +2756,12 @@ struct IrInstructionTypeId {
     IrInstruction *type_value;
 };
 
+struct IrInstructionSetEvalBranchQuota {
+    IrInstruction base;
+
+    IrInstruction *new_quota;
+};
+
 static const size_t slice_ptr_index = 0;
 static const size_t slice_len_index = 1;
 
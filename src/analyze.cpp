@@ -15,7 +15,24 @@
 #include "parser.hpp"
 #include "zig_llvm.hpp"
 
-static const size_t default_backward_branch_quota = 1000;
+thread_local AnalysisWorker *analysis_worker = nullptr;
+
+// Held while looking up or adding to a table that the analysis threads or
+// the parse threads share. Without them there is nothing to guard against.
+struct AnalysisLock {
+    OsMutex *mutex;
+
+    AnalysisLock(CodeGen *g) :
+        mutex((analysis_worker != nullptr || g->parse_threads_running) ? g->analysis_mutex : nullptr)
+    {
+        if (mutex != nullptr)
+            os_mutex_lock(mutex);
+    }
+    ~AnalysisLock() {
+        if (mutex != nullptr)
+            os_mutex_unlock(mutex);
+    }
+};
 
 static void resolve_enum_type(CodeGen *g, TypeTableEntry *enum_type);
 static void resolve_struct_type(CodeGen *g, TypeTableEntry *struct_type);
@@ -32,7 +49,12 @@ ErrorMsg *add_node_error(CodeGen *g, AstNode *node, Buf *msg) {
     ErrorMsg *err = err_msg_create_with_line(node->owner->path, node->line, node->column,
             node->owner->source_code, node->owner->line_offsets, msg);
 
-    g->errors.append(err);
+    if (analysis_worker != nullptr) {
+        analysis_worker->errors.append(err);
+        analysis_worker->error_nodes.append(node);
+    } else {
+        g->errors.append(err);
+    }
     return err;
 }
 
@@ -48,8 +70,8 @@ ErrorMsg *add_error_note(CodeGen *g, ErrorMsg *parent_msg, AstNode *node, Buf *m
     return err;
 }
 
-TypeTableEntry *new_type_table_entry(TypeTableEntryId id) {
-    TypeTableEntry *entry = allocate<TypeTableEntry>(1);
+TypeTableEntry *new_type_table_entry(CodeGen *g, TypeTableEntryId id) {
+    TypeTableEntry *entry = arena_allocate<TypeTableEntry>(&g->type_arena, 1);
     entry->id = id;
     return entry;
 }
@@ -155,8 +177,8 @@ ImportTableEntry *get_scope_import(Scope *scope) {
     zig_unreachable();
 }
 
-static TypeTableEntry *new_container_type_entry(TypeTableEntryId id, AstNode *source_node, Scope *parent_scope) {
-    TypeTableEntry *entry = new_type_table_entry(id);
+static TypeTableEntry *new_container_type_entry(CodeGen *g, TypeTableEntryId id, AstNode *source_node, Scope *parent_scope) {
+    TypeTableEntry *entry = new_type_table_entry(g, id);
     *get_container_scope_ptr(entry) = create_decls_scope(source_node, parent_scope, entry, get_scope_import(parent_scope));
     return entry;
 }
@@ -323,6 +345,7 @@ TypeTableEntry *get_pointer_to_type_extra(CodeGen *g, TypeTableEntry *child_type
         bool is_volatile, uint32_t bit_offset, uint32_t unaligned_bit_count)
 {
     assert(child_type->id != TypeTableEntryIdInvalid);
+    AnalysisLock lock(g);
 
     TypeId type_id = {};
     TypeTableEntry **parent_pointer = nullptr;
@@ -346,7 +369,7 @@ TypeTableEntry *get_pointer_to_type_extra(CodeGen *g, TypeTableEntry *child_type
 
     type_ensure_zero_bits_known(g, child_type);
 
-    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdPointer);
+    TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdPointer);
     entry->is_copyable = true;
 
     const char *const_str = is_const ? "const " : "";
@@ -400,7 +423,7 @@ TypeTableEntry *get_maybe_type(CodeGen *g, TypeTableEntry *child_type) {
     } else {
         ensure_complete_type(g, child_type);
 
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdMaybe);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdMaybe);
         assert(child_type->type_ref);
         assert(child_type->di_type);
         entry->is_copyable = type_is_copyable(g, child_type);
@@ -482,7 +505,7 @@ TypeTableEntry *get_error_type(CodeGen *g, TypeTableEntry *child_type) {
     if (child_type->error_parent)
         return child_type->error_parent;
 
-    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdErrorUnion);
+    TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdErrorUnion);
     entry->is_copyable = true;
     assert(child_type->type_ref);
     assert(child_type->di_type);
@@ -556,6 +579,8 @@ TypeTableEntry *get_error_type(CodeGen *g, TypeTableEntry *child_type) {
 }
 
 TypeTableEntry *get_array_type(CodeGen *g, TypeTableEntry *child_type, uint64_t array_size) {
+    AnalysisLock lock(g);
+
     TypeId type_id = {};
     type_id.id = TypeTableEntryIdArray;
     type_id.data.array.child_type = child_type;
@@ -568,7 +593,7 @@ TypeTableEntry *get_array_type(CodeGen *g, TypeTableEntry *child_type, uint64_t
 
     ensure_complete_type(g, child_type);
 
-    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdArray);
+    TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdArray);
     entry->zero_bits = (array_size == 0) || child_type->zero_bits;
     entry->is_copyable = false;
 
@@ -628,7 +653,7 @@ TypeTableEntry *get_slice_type(CodeGen *g, TypeTableEntry *child_type, bool is_c
         return *parent_pointer;
     } else if (is_const) {
         TypeTableEntry *var_peer = get_slice_type(g, child_type, false);
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdStruct);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdStruct);
         entry->is_copyable = true;
 
         buf_resize(&entry->name, 0);
@@ -644,7 +669,7 @@ TypeTableEntry *get_slice_type(CodeGen *g, TypeTableEntry *child_type, bool is_c
         *parent_pointer = entry;
         return entry;
     } else {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdStruct);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdStruct);
         entry->is_copyable = true;
 
         // If the child type is []const T then we need to make sure the type ref
@@ -765,7 +790,7 @@ TypeTableEntry *get_slice_type(CodeGen *g, TypeTableEntry *child_type, bool is_c
 }
 
 TypeTableEntry *get_opaque_type(CodeGen *g, Scope *scope, AstNode *source_node, const char *name) {
-    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdOpaque);
+    TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdOpaque);
 
     buf_init_from_str(&entry->name, name);
 
@@ -787,10 +812,11 @@ TypeTableEntry *get_opaque_type(CodeGen *g, Scope *scope, AstNode *source_node,
 TypeTableEntry *get_bound_fn_type(CodeGen *g, FnTableEntry *fn_entry) {
     TypeTableEntry *fn_type = fn_entry->type_entry;
     assert(fn_type->id == TypeTableEntryIdFn);
+    AnalysisLock lock(g);
     if (fn_type->data.fn.bound_fn_parent)
         return fn_type->data.fn.bound_fn_parent;
 
-    TypeTableEntry *bound_fn_type = new_type_table_entry(TypeTableEntryIdBoundFn);
+    TypeTableEntry *bound_fn_type = new_type_table_entry(g, TypeTableEntryIdBoundFn);
     bound_fn_type->is_copyable = false;
     bound_fn_type->data.bound_fn.fn_type = fn_type;
     bound_fn_type->zero_bits = true;
@@ -818,13 +844,14 @@ static const char *calling_convention_name(CallingConvention cc) {
 }
 
 TypeTableEntry *get_fn_type(CodeGen *g, FnTypeId *fn_type_id) {
+    AnalysisLock lock(g);
     auto table_entry = g->fn_type_table.maybe_get(fn_type_id);
     if (table_entry) {
         return table_entry->value;
     }
     ensure_complete_type(g, fn_type_id->return_type);
 
-    TypeTableEntry *fn_type = new_type_table_entry(TypeTableEntryIdFn);
+    TypeTableEntry *fn_type = new_type_table_entry(g, TypeTableEntryIdFn);
     fn_type->is_copyable = true;
     fn_type->data.fn.fn_type_id = *fn_type_id;
 
@@ -956,7 +983,7 @@ TypeTableEntry *get_partial_container_type(CodeGen *g, Scope *scope, ContainerKi
         AstNode *decl_node, const char *name, ContainerLayout layout)
 {
     TypeTableEntryId type_id = container_to_type(kind);
-    TypeTableEntry *entry = new_container_type_entry(type_id, decl_node, scope);
+    TypeTableEntry *entry = new_container_type_entry(g, type_id, decl_node, scope);
 
     switch (kind) {
         case ContainerKindStruct:
@@ -988,22 +1015,26 @@ TypeTableEntry *get_partial_container_type(CodeGen *g, Scope *scope, ContainerKi
 
 static IrInstruction *analyze_const_value(CodeGen *g, Scope *scope, AstNode *node, TypeTableEntry *type_entry, Buf *type_name) {
     size_t backward_branch_count = 0;
-    return ir_eval_const_value(g, scope, node, type_entry,
-            &backward_branch_count, default_backward_branch_quota,
+    size_t backward_branch_quota = g->comptime_quota;
+    g->const_eval_depth += 1;
+    IrInstruction *result = ir_eval_const_value(g, scope, node, type_entry,
+            &backward_branch_count, &backward_branch_quota,
             nullptr, nullptr, node, type_name, nullptr);
+    g->const_eval_depth -= 1;
+    return result;
 }
 
 TypeTableEntry *analyze_type_expr(CodeGen *g, Scope *scope, AstNode *node) {
     IrInstruction *result = analyze_const_value(g, scope, node, g->builtin_types.entry_type, nullptr);
-    if (result->value.type->id == TypeTableEntryIdInvalid)
+    if (result->value->type->id == TypeTableEntryIdInvalid)
         return g->builtin_types.entry_invalid;
 
-    assert(result->value.special != ConstValSpecialRuntime);
-    return result->value.data.x_type;
+    assert(result->value->special != ConstValSpecialRuntime);
+    return result->value->data.x_type;
 }
 
 TypeTableEntry *get_generic_fn_type(CodeGen *g, FnTypeId *fn_type_id) {
-    TypeTableEntry *fn_type = new_type_table_entry(TypeTableEntryIdFn);
+    TypeTableEntry *fn_type = new_type_table_entry(g, TypeTableEntryIdFn);
     fn_type->is_copyable = false;
     buf_init_from_str(&fn_type->name, "fn(");
     size_t i = 0;
@@ -1203,7 +1234,7 @@ bool type_is_invalid(TypeTableEntry *type_entry) {
 
 
 TypeTableEntry *create_enum_tag_type(CodeGen *g, TypeTableEntry *enum_type, TypeTableEntry *int_type) {
-    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdEnumTag);
+    TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdEnumTag);
 
     buf_resize(&entry->name, 0);
     buf_appendf(&entry->name, "@enumTagType(%s)", buf_ptr(&enum_type->name));
@@ -1224,6 +1255,8 @@ static void resolve_enum_type(CodeGen *g, TypeTableEntry *enum_type) {
 
     if (enum_type->data.enumeration.complete)
         return;
+    // see resolve_struct_zero_bits
+    assert(analysis_worker == nullptr);
 
     resolve_enum_zero_bits(g, enum_type);
     if (enum_type->data.enumeration.is_invalid)
@@ -1443,7 +1476,7 @@ static bool type_allowed_in_packed_struct(TypeTableEntry *type_entry) {
 TypeTableEntry *get_struct_type(CodeGen *g, const char *type_name, const char *field_names[],
         TypeTableEntry *field_types[], size_t field_count)
 {
-    TypeTableEntry *struct_type = new_type_table_entry(TypeTableEntryIdStruct);
+    TypeTableEntry *struct_type = new_type_table_entry(g, TypeTableEntryIdStruct);
 
     buf_init_from_str(&struct_type->name, type_name);
 
@@ -1512,6 +1545,8 @@ static void resolve_struct_type(CodeGen *g, TypeTableEntry *struct_type) {
 
     if (struct_type->data.structure.complete)
         return;
+    // see resolve_struct_zero_bits
+    assert(analysis_worker == nullptr);
 
     resolve_struct_zero_bits(g, struct_type);
     if (struct_type->data.structure.is_invalid)
@@ -1722,6 +1757,8 @@ static void resolve_enum_zero_bits(CodeGen *g, TypeTableEntry *enum_type) {
 
     if (enum_type->data.enumeration.zero_bits_known)
         return;
+    // see resolve_struct_zero_bits
+    assert(analysis_worker == nullptr);
 
     if (enum_type->data.enumeration.zero_bits_loop_flag) {
         enum_type->data.enumeration.zero_bits_known = true;
@@ -1774,6 +1811,11 @@ static void resolve_struct_zero_bits(CodeGen *g, TypeTableEntry *struct_type) {
 
     if (struct_type->data.structure.zero_bits_known)
         return;
+    // Resolving a container reports errors and changes type state that every
+    // thread reads, in an order that must not depend on thread timing. The
+    // type getters, which analysis threads call, only reach this for
+    // containers, and fn_body_ir_is_independent keeps those threads off them.
+    assert(analysis_worker == nullptr);
 
     if (struct_type->data.structure.zero_bits_loop_flag) {
         struct_type->data.structure.zero_bits_known = true;
@@ -1854,7 +1896,7 @@ FnTableEntry *create_fn_raw(FnInline inline_value, GlobalLinkageId linkage) {
     FnTableEntry *fn_entry = allocate<FnTableEntry>(1);
 
     fn_entry->analyzed_executable.backward_branch_count = &fn_entry->prealloc_bbc;
-    fn_entry->analyzed_executable.backward_branch_quota = default_backward_branch_quota;
+    fn_entry->analyzed_executable.backward_branch_quota = &fn_entry->prealloc_backward_branch_quota;
     fn_entry->analyzed_executable.fn_entry = fn_entry;
     fn_entry->ir_executable.fn_entry = fn_entry;
     fn_entry->fn_inline = inline_value;
@@ -2064,7 +2106,7 @@ static void preview_test_decl(CodeGen *g, AstNode *node, ScopeDecls *decls_scope
     }
 
     TldFn *tld_fn = allocate<TldFn>(1);
-    init_tld(&tld_fn->base, TldIdFn, test_name, VisibModPrivate, node, &decls_scope->base);
+    init_tld(g, &tld_fn->base, TldIdFn, test_name, VisibModPrivate, node, &decls_scope->base);
     g->resolve_queue.append(&tld_fn->base);
 }
 
@@ -2095,16 +2137,16 @@ static void preview_comptime_decl(CodeGen *g, AstNode *node, ScopeDecls *decls_s
     assert(node->type == NodeTypeCompTime);
 
     TldCompTime *tld_comptime = allocate<TldCompTime>(1);
-    init_tld(&tld_comptime->base, TldIdCompTime, nullptr, VisibModPrivate, node, &decls_scope->base);
+    init_tld(g, &tld_comptime->base, TldIdCompTime, nullptr, VisibModPrivate, node, &decls_scope->base);
     g->resolve_queue.append(&tld_comptime->base);
 }
 
 
-void init_tld(Tld *tld, TldId id, Buf *name, VisibMod visib_mod, AstNode *source_node,
+void init_tld(CodeGen *g, Tld *tld, TldId id, Buf *name, VisibMod visib_mod, AstNode *source_node,
     Scope *parent_scope)
 {
     tld->id = id;
-    tld->name = name;
+    tld->name = name ? intern_buf(g, name) : nullptr;
     tld->visib_mod = visib_mod;
     tld->source_node = source_node;
     tld->import = source_node ? source_node->owner : nullptr;
@@ -2112,7 +2154,7 @@ void init_tld(Tld *tld, TldId id, Buf *name, VisibMod visib_mod, AstNode *source
 }
 
 void update_compile_var(CodeGen *g, Buf *name, ConstExprValue *value) {
-    Tld *tld = g->compile_var_import->decls_scope->decl_table.get(name);
+    Tld *tld = g->compile_var_import->decls_scope->decl_table.get(intern_buf(g, name));
     resolve_top_level_decl(g, tld, false, tld->source_node);
     assert(tld->id == TldIdVar);
     TldVar *tld_var = (TldVar *)tld;
@@ -2135,7 +2177,7 @@ void scan_decls(CodeGen *g, ScopeDecls *decls_scope, AstNode *node) {
                 Buf *name = node->data.variable_declaration.symbol;
                 VisibMod visib_mod = node->data.variable_declaration.visib_mod;
                 TldVar *tld_var = allocate<TldVar>(1);
-                init_tld(&tld_var->base, TldIdVar, name, visib_mod, node, &decls_scope->base);
+                init_tld(g, &tld_var->base, TldIdVar, name, visib_mod, node, &decls_scope->base);
                 tld_var->extern_lib_name = node->data.variable_declaration.lib_name;
                 add_top_level_decl(g, decls_scope, &tld_var->base);
                 break;
@@ -2151,7 +2193,7 @@ void scan_decls(CodeGen *g, ScopeDecls *decls_scope, AstNode *node) {
 
                 VisibMod visib_mod = node->data.fn_proto.visib_mod;
                 TldFn *tld_fn = allocate<TldFn>(1);
-                init_tld(&tld_fn->base, TldIdFn, fn_name, visib_mod, node, &decls_scope->base);
+                init_tld(g, &tld_fn->base, TldIdFn, fn_name, visib_mod, node, &decls_scope->base);
                 tld_fn->extern_lib_name = node->data.fn_proto.lib_name;
                 add_top_level_decl(g, decls_scope, &tld_fn->base);
 
@@ -2301,7 +2343,8 @@ VariableTableEntry *add_variable(CodeGen *g, AstNode *source_node, Scope *parent
 
     assert(name);
 
-    buf_init_from_buf(&variable_entry->name, name);
+    name = intern_buf(g, name);
+    variable_entry->name = name;
 
     if (value->type->id != TypeTableEntryIdInvalid) {
         VariableTableEntry *existing_var = find_variable(g, parent_scope, name);
@@ -2392,7 +2435,7 @@ static void resolve_decl_var(CodeGen *g, TldVar *tld_var) {
     } else if (var_decl->expr) {
         init_value = analyze_const_value(g, tld_var->base.parent_scope, var_decl->expr, explicit_type, var_decl->symbol);
         assert(init_value);
-        implicit_type = init_value->value.type;
+        implicit_type = init_value->value->type;
 
         if (implicit_type->id == TypeTableEntryIdUnreachable) {
             add_node_error(g, source_node, buf_sprintf("variable initialization is unreachable"));
@@ -2410,7 +2453,7 @@ static void resolve_decl_var(CodeGen *g, TldVar *tld_var) {
             add_node_error(g, source_node, buf_sprintf("variable of type 'type' must be constant"));
             implicit_type = g->builtin_types.entry_invalid;
         }
-        assert(implicit_type->id == TypeTableEntryIdInvalid || init_value->value.special != ConstValSpecialRuntime);
+        assert(implicit_type->id == TypeTableEntryIdInvalid || init_value->value->special != ConstValSpecialRuntime);
     } else if (linkage != VarLinkageExternal) {
         add_node_error(g, source_node, buf_sprintf("variables must be initialized"));
         implicit_type = g->builtin_types.entry_invalid;
@@ -2419,7 +2462,7 @@ static void resolve_decl_var(CodeGen *g, TldVar *tld_var) {
     TypeTableEntry *type = explicit_type ? explicit_type : implicit_type;
     assert(type != nullptr); // should have been caught by the parser
 
-    ConstExprValue *init_val = init_value ? &init_value->value : create_const_runtime(type);
+    ConstExprValue *init_val = init_value ? init_value->value : create_const_runtime(g, type);
 
     tld_var->var = add_variable(g, source_node, tld_var->base.parent_scope, var_decl->symbol,
             is_const, init_val, &tld_var->base);
@@ -2572,6 +2615,8 @@ bool types_match_const_cast_only(TypeTableEntry *expected_type, TypeTableEntry *
 }
 
 Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
+    assert(buf_is_interned(g, name));
+
     // we must resolve all the use decls
     ImportTableEntry *import = get_scope_import(scope);
     for (size_t i = 0; i < import->use_decls.length; i += 1) {
@@ -2595,10 +2640,12 @@ Tld *find_decl(CodeGen *g, Scope *scope, Buf *name) {
 }
 
 VariableTableEntry *find_variable(CodeGen *g, Scope *scope, Buf *name) {
+    assert(buf_is_interned(g, name));
+
     while (scope) {
         if (scope->id == ScopeIdVarDecl) {
             ScopeVarDecl *var_scope = (ScopeVarDecl *)scope;
-            if (buf_eql_buf(name, &var_scope->var->name))
+            if (var_scope->var->name == name)
                 return var_scope->var;
         } else if (scope->id == ScopeIdDecls) {
             ScopeDecls *decls_scope = (ScopeDecls *)scope;
@@ -2804,9 +2851,13 @@ void define_local_param_variables(CodeGen *g, FnTableEntry *fn_table_entry, Vari
         }
 
         VariableTableEntry *var = add_variable(g, param_decl_node, fn_table_entry->child_scope,
-                param_name, true, create_const_runtime(param_type), nullptr);
+                param_name, true, create_const_runtime(g, param_type), nullptr);
         var->src_arg_index = i;
         fn_table_entry->child_scope = var->child_scope;
+        // declaring it again for a comptime call would report it again, and
+        // the bytecode evaluator may have to hand such a call back
+        if (var->value->type->id == TypeTableEntryIdInvalid)
+            fn_table_entry->comptime_bytecode_unsupported = true;
         var->shadowable = var->shadowable || is_var_args;
 
         if (type_has_bits(param_type)) {
@@ -2846,18 +2897,15 @@ void analyze_fn_ir(CodeGen *g, FnTableEntry *fn_table_entry, AstNode *return_typ
         fprintf(stderr, "}\n");
     }
 
+    ir_free_fn_pass1(g, fn_table_entry);
     fn_table_entry->anal_state = FnAnalStateComplete;
 }
 
-static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
-    assert(fn_table_entry->anal_state != FnAnalStateProbing);
-    if (fn_table_entry->anal_state != FnAnalStateReady)
-        return;
-
-    fn_table_entry->anal_state = FnAnalStateProbing;
-
-    AstNode *return_type_node = (fn_table_entry->proto_node != nullptr) ?
-        fn_table_entry->proto_node->data.fn_proto.return_type : fn_table_entry->fndef_scope->base.source_node;
+// Pass 1 of analyze_fn_body. This only reads what the top level
+// declarations resolved to, so gen_fn_bodies_ir can run it on other threads.
+static void gen_fn_body_ir(CodeGen *g, FnTableEntry *fn_table_entry) {
+    assert(!fn_table_entry->body_ir_generated);
+    fn_table_entry->body_ir_generated = true;
 
     assert(fn_table_entry->fndef_scope);
     if (!fn_table_entry->child_scope)
@@ -2869,6 +2917,21 @@ static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
     assert(!fn_type->data.fn.is_generic);
 
     ir_gen_fn(g, fn_table_entry);
+}
+
+void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
+    assert(fn_table_entry->anal_state != FnAnalStateProbing);
+    if (fn_table_entry->anal_state != FnAnalStateReady)
+        return;
+
+    fn_table_entry->anal_state = FnAnalStateProbing;
+    fn_table_entry->prealloc_backward_branch_quota = g->comptime_quota;
+
+    AstNode *return_type_node = (fn_table_entry->proto_node != nullptr) ?
+        fn_table_entry->proto_node->data.fn_proto.return_type : fn_table_entry->fndef_scope->base.source_node;
+
+    if (!fn_table_entry->body_ir_generated)
+        gen_fn_body_ir(g, fn_table_entry);
     if (fn_table_entry->ir_executable.invalid) {
         fn_table_entry->anal_state = FnAnalStateInvalid;
         return;
@@ -2886,14 +2949,14 @@ static void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry) {
 
 static void add_symbols_from_import(CodeGen *g, AstNode *src_use_node, AstNode *dst_use_node) {
     IrInstruction *use_target_value = src_use_node->data.use.value;
-    if (use_target_value->value.type->id == TypeTableEntryIdInvalid) {
+    if (use_target_value->value->type->id == TypeTableEntryIdInvalid) {
         dst_use_node->owner->any_imports_failed = true;
         return;
     }
 
     dst_use_node->data.use.resolution = TldResolutionOk;
 
-    ConstExprValue *const_val = &use_target_value->value;
+    ConstExprValue *const_val = use_target_value->value;
     assert(const_val->special != ConstValSpecialRuntime);
 
     ImportTableEntry *target_import = const_val->data.x_import;
@@ -2954,12 +3017,72 @@ void preview_use_decl(CodeGen *g, AstNode *node) {
     IrInstruction *result = analyze_const_value(g, &node->owner->decls_scope->base,
         node->data.use.expr, g->builtin_types.entry_namespace, nullptr);
 
-    if (result->value.type->id == TypeTableEntryIdInvalid)
+    if (result->value->type->id == TypeTableEntryIdInvalid)
         node->owner->any_imports_failed = true;
 
     node->data.use.value = result;
 }
 
+static void prefetch_imports_of(CodeGen *g, ImportTableEntry *import);
+
+// The part of add_source_file that comes after parsing.
+static ImportTableEntry *add_parsed_source_file(CodeGen *g, ImportTableEntry *import_entry) {
+    Buf *abs_full_path = import_entry->path;
+
+    if (g->parse_threads_running)
+        prefetch_imports_of(g, import_entry);
+
+    Buf *src_dirname = buf_alloc();
+    Buf *src_basename = buf_alloc();
+    os_path_split(abs_full_path, src_dirname, src_basename);
+
+    import_entry->di_file = ZigLLVMCreateFile(g->dbuilder, buf_ptr(src_basename), buf_ptr(src_dirname));
+    g->import_table.put(abs_full_path, import_entry);
+    g->import_queue.append(import_entry);
+
+    import_entry->decls_scope = create_decls_scope(import_entry->root, nullptr, nullptr, import_entry);
+
+
+    assert(import_entry->root->type == NodeTypeRoot);
+    for (size_t decl_i = 0; decl_i < import_entry->root->data.root.top_level_decls.length; decl_i += 1) {
+        AstNode *top_level_decl = import_entry->root->data.root.top_level_decls.at(decl_i);
+
+        if (top_level_decl->type == NodeTypeFnDef) {
+            AstNode *proto_node = top_level_decl->data.fn_def.fn_proto;
+            assert(proto_node->type == NodeTypeFnProto);
+            Buf *proto_name = proto_node->data.fn_proto.name;
+
+            bool is_pub = (proto_node->data.fn_proto.visib_mod == VisibModPub);
+
+            if (is_pub) {
+                if (buf_eql_str(proto_name, "main")) {
+                    g->have_pub_main = true;
+                } else if (buf_eql_str(proto_name, "panic")) {
+                    g->have_pub_panic = true;
+                }
+            } else if (proto_node->data.fn_proto.visib_mod == VisibModExport && buf_eql_str(proto_name, "main") &&
+                    g->libc_link_lib != nullptr)
+            {
+                g->have_c_main = true;
+            }
+
+        }
+    }
+
+    return import_entry;
+}
+
+static void tokenize_source(CodeGen *g, Buf *source_code, Tokenization *tokenization) {
+    double start_time = os_get_time();
+    tokenize(source_code, tokenization);
+    double seconds = os_get_time() - start_time;
+
+    AnalysisLock lock(g);
+    g->tokenize_byte_count += buf_len(source_code);
+    g->tokenize_token_count += tokenization->tokens->length;
+    g->tokenize_seconds += seconds;
+}
+
 ImportTableEntry *add_source_file(CodeGen *g, PackageTableEntry *package, Buf *abs_full_path, Buf *source_code) {
     if (g->verbose) {
         fprintf(stderr, "\nOriginal Source (%s):\n", buf_ptr(abs_full_path));
@@ -2971,7 +3094,7 @@ ImportTableEntry *add_source_file(CodeGen *g, PackageTableEntry *package, Buf *a
     }
 
     Tokenization tokenization = {0};
-    tokenize(source_code, &tokenization);
+    tokenize_source(g, source_code, &tokenization);
 
     if (tokenization.err) {
         ErrorMsg *err = err_msg_create_with_line(abs_full_path, tokenization.err_line, tokenization.err_column,
@@ -2995,50 +3118,287 @@ ImportTableEntry *add_source_file(CodeGen *g, PackageTableEntry *package, Buf *a
     import_entry->path = abs_full_path;
 
     import_entry->root = ast_parse(source_code, tokenization.tokens, import_entry, g->err_color,
-            &g->next_node_index);
+            &g->next_node_index, &g->parse_arena, g);
     assert(import_entry->root);
     if (g->verbose) {
         ast_print(stderr, import_entry->root, 0);
     }
 
-    Buf *src_dirname = buf_alloc();
-    Buf *src_basename = buf_alloc();
-    os_path_split(abs_full_path, src_dirname, src_basename);
+    return add_parsed_source_file(g, import_entry);
+}
 
-    import_entry->di_file = ZigLLVMCreateFile(g->dbuilder, buf_ptr(src_basename), buf_ptr(src_dirname));
-    g->import_table.put(abs_full_path, import_entry);
-    g->import_queue.append(import_entry);
+enum ImportPrefetchState {
+    ImportPrefetchStateQueued,
+    ImportPrefetchStateRunning,
+    ImportPrefetchStateDone,
+};
 
-    import_entry->decls_scope = create_decls_scope(import_entry->root, nullptr, nullptr, import_entry);
+struct ImportPrefetch {
+    // the path that @import joins, before it is made absolute
+    Buf *full_path;
+    PackageTableEntry *package;
+    ImportPrefetchState state;
+    // set once Done, if the file could be read, tokenized and parsed
+    ImportTableEntry *import_entry;
+    ZigList<AstNode *> nodes;
+};
 
+struct ImportPrefetchThread {
+    CodeGen *codegen;
+    OsThread *thread;
+    Arena node_arena;
+};
 
-    assert(import_entry->root->type == NodeTypeRoot);
-    for (size_t decl_i = 0; decl_i < import_entry->root->data.root.top_level_decls.length; decl_i += 1) {
-        AstNode *top_level_decl = import_entry->root->data.root.top_level_decls.at(decl_i);
+struct ImportPrefetcher {
+    // guards everything below and the state of the jobs
+    OsMutex *mutex;
+    OsCond *cond;
+    HashMap<Buf *, ImportPrefetch *, buf_hash, buf_eql_buf> table;
+    ZigList<ImportPrefetch *> queue;
+    size_t queue_index;
+    ImportPrefetchThread *threads;
+    size_t thread_count;
+    bool stop;
+};
 
-        if (top_level_decl->type == NodeTypeFnDef) {
-            AstNode *proto_node = top_level_decl->data.fn_def.fn_proto;
-            assert(proto_node->type == NodeTypeFnProto);
-            Buf *proto_name = proto_node->data.fn_proto.name;
+// The string of @import("...") if node is one.
+static Buf *get_import_target(AstNode *node) {
+    if (node == nullptr || node->type != NodeTypeFnCallExpr || !node->data.fn_call_expr.is_builtin)
+        return nullptr;
+    AstNode *fn_ref_node = node->data.fn_call_expr.fn_ref_expr;
+    if (fn_ref_node->type != NodeTypeSymbol || !buf_eql_str(fn_ref_node->data.symbol_expr.symbol, "import"))
+        return nullptr;
+    if (node->data.fn_call_expr.params.length != 1)
+        return nullptr;
+    AstNode *arg_node = node->data.fn_call_expr.params.at(0);
+    if (arg_node->type != NodeTypeStringLiteral || arg_node->data.string_literal.c)
+        return nullptr;
+    return arg_node->data.string_literal.buf;
+}
 
-            bool is_pub = (proto_node->data.fn_proto.visib_mod == VisibModPub);
+// Resolves the import like ir_analyze_instruction_import does and queues it.
+static void prefetch_import(CodeGen *g, ImportTableEntry *importer, Buf *import_target_str) {
+    ImportPrefetcher *prefetcher = g->import_prefetcher;
 
-            if (is_pub) {
-                if (buf_eql_str(proto_name, "main")) {
-                    g->have_pub_main = true;
-                } else if (buf_eql_str(proto_name, "panic")) {
-                    g->have_pub_panic = true;
-                }
-            } else if (proto_node->data.fn_proto.visib_mod == VisibModExport && buf_eql_str(proto_name, "main") &&
-                    g->libc_link_lib != nullptr)
-            {
-                g->have_c_main = true;
-            }
+    PackageTableEntry *target_package;
+    Buf *import_target_path;
+    Buf *search_dir;
+    auto package_entry = importer->package->package_table.maybe_get(import_target_str);
+    if (package_entry) {
+        target_package = package_entry->value;
+        import_target_path = &target_package->root_src_path;
+        search_dir = &target_package->root_src_dir;
+    } else {
+        target_package = importer->package;
+        import_target_path = import_target_str;
+        search_dir = buf_alloc();
+        os_path_dirname(importer->path, search_dir);
+    }
+
+    Buf *full_path = buf_alloc();
+    os_path_join(search_dir, import_target_path, full_path);
+
+    os_mutex_lock(prefetcher->mutex);
+    if (prefetcher->table.maybe_get(full_path) == nullptr) {
+        ImportPrefetch *job = allocate<ImportPrefetch>(1);
+        job->full_path = full_path;
+        job->package = target_package;
+        prefetcher->table.put(full_path, job);
+        prefetcher->queue.append(job);
+        os_cond_broadcast(prefetcher->cond);
+    }
+    os_mutex_unlock(prefetcher->mutex);
+}
+
+// Only top level declarations are looked at; that is where nearly all
+// imports are, and anything missed is simply parsed when it is reached.
+static void prefetch_imports_of(CodeGen *g, ImportTableEntry *import) {
+    AstNode *root = import->root;
+    for (size_t i = 0; i < root->data.root.top_level_decls.length; i += 1) {
+        AstNode *decl_node = root->data.root.top_level_decls.at(i);
+        Buf *import_target_str = nullptr;
+        if (decl_node->type == NodeTypeVariableDeclaration) {
+            import_target_str = get_import_target(decl_node->data.variable_declaration.expr);
+        } else if (decl_node->type == NodeTypeUse) {
+            import_target_str = get_import_target(decl_node->data.use.expr);
+        }
+        if (import_target_str != nullptr)
+            prefetch_import(g, import, import_target_str);
+    }
+}
+
+// Any failure leaves import_entry null, and then the import is read and
+// parsed on the main thread after all, which reports the error.
+static void parse_prefetched_import(CodeGen *g, ImportPrefetch *job, Arena *node_arena) {
+    Buf *abs_full_path = buf_alloc();
+    if (os_path_real(job->full_path, abs_full_path))
+        return;
+    Buf *source_code = buf_alloc();
+    if (os_map_file_path(abs_full_path, source_code))
+        return;
+
+    Tokenization tokenization = {0};
+    tokenize_source(g, source_code, &tokenization);
+    if (tokenization.err) {
+        os_unmap_file(source_code);
+        return;
+    }
+
+    ImportTableEntry *import_entry = allocate<ImportTableEntry>(1);
+    import_entry->package = job->package;
+    import_entry->source_code = source_code;
+    import_entry->line_offsets = tokenization.line_offsets;
+    import_entry->path = abs_full_path;
+    import_entry->root = ast_parse_detached(source_code, tokenization.tokens, import_entry,
+            node_arena, &job->nodes, g);
+    if (import_entry->root == nullptr) {
+        os_unmap_file(source_code);
+        return;
+    }
+
+    job->import_entry = import_entry;
+    prefetch_imports_of(g, import_entry);
+}
+
+static void import_prefetch_thread(void *context) {
+    ImportPrefetchThread *thread = reinterpret_cast<ImportPrefetchThread *>(context);
+    CodeGen *g = thread->codegen;
+    ImportPrefetcher *prefetcher = g->import_prefetcher;
 
+    os_mutex_lock(prefetcher->mutex);
+    while (!prefetcher->stop) {
+        if (prefetcher->queue_index == prefetcher->queue.length) {
+            os_cond_wait(prefetcher->cond, prefetcher->mutex);
+            continue;
         }
+        ImportPrefetch *job = prefetcher->queue.at(prefetcher->queue_index);
+        prefetcher->queue_index += 1;
+        if (job->state != ImportPrefetchStateQueued)
+            continue;
+
+        job->state = ImportPrefetchStateRunning;
+        os_mutex_unlock(prefetcher->mutex);
+        parse_prefetched_import(g, job, &thread->node_arena);
+        os_mutex_lock(prefetcher->mutex);
+        job->state = ImportPrefetchStateDone;
+        os_cond_broadcast(prefetcher->cond);
     }
+    os_mutex_unlock(prefetcher->mutex);
+}
 
-    return import_entry;
+// Starts threads that read and parse the files that the imports known so far
+// import, and in turn the files that those import. This overlaps file I/O
+// and parsing with semantic analysis. With --verbose the sources, tokens and
+// ASTs are printed as they are added, so nothing is parsed ahead then.
+static void start_import_prefetch(CodeGen *g) {
+    if (g->analysis_threads <= 1 || g->verbose)
+        return;
+
+    if (g->analysis_mutex == nullptr)
+        g->analysis_mutex = os_mutex_create();
+    if (g->import_prefetcher == nullptr) {
+        ImportPrefetcher *prefetcher = allocate<ImportPrefetcher>(1);
+        prefetcher->mutex = os_mutex_create();
+        prefetcher->cond = os_cond_create();
+        prefetcher->table.init(16);
+        g->import_prefetcher = prefetcher;
+    }
+    ImportPrefetcher *prefetcher = g->import_prefetcher;
+
+    g->parse_threads_running = true;
+    for (size_t i = 0; i < g->import_queue.length; i += 1) {
+        prefetch_imports_of(g, g->import_queue.at(i));
+    }
+
+    prefetcher->stop = false;
+    prefetcher->thread_count = g->analysis_threads - 1;
+    prefetcher->threads = allocate<ImportPrefetchThread>(prefetcher->thread_count);
+    for (size_t i = 0; i < prefetcher->thread_count; i += 1) {
+        ImportPrefetchThread *thread = &prefetcher->threads[i];
+        thread->codegen = g;
+        arena_init(&thread->node_arena, g->parse_arena.name);
+        thread->thread = os_thread_create(import_prefetch_thread, thread);
+    }
+}
+
+// Jobs that are still queued stay queued for the next start_import_prefetch,
+// and finished ones can still be taken.
+static void stop_import_prefetch(CodeGen *g) {
+    if (!g->parse_threads_running)
+        return;
+
+    ImportPrefetcher *prefetcher = g->import_prefetcher;
+    os_mutex_lock(prefetcher->mutex);
+    prefetcher->stop = true;
+    os_cond_broadcast(prefetcher->cond);
+    os_mutex_unlock(prefetcher->mutex);
+
+    for (size_t i = 0; i < prefetcher->thread_count; i += 1) {
+        ImportPrefetchThread *thread = &prefetcher->threads[i];
+        os_thread_join(thread->thread);
+        arena_adopt(&g->parse_arena, &thread->node_arena);
+    }
+    free(prefetcher->threads);
+    prefetcher->threads = nullptr;
+    prefetcher->thread_count = 0;
+    g->parse_threads_running = false;
+}
+
+// Returns the import at full_path, as @import joins it, if it was parsed
+// ahead of time, waiting for the thread that parses it if need be. Returns
+// nullptr if the caller has to read and parse it itself.
+ImportTableEntry *take_prefetched_import(CodeGen *g, Buf *full_path) {
+    ImportPrefetcher *prefetcher = g->import_prefetcher;
+    if (prefetcher == nullptr)
+        return nullptr;
+
+    os_mutex_lock(prefetcher->mutex);
+    auto entry = prefetcher->table.maybe_get(full_path);
+    ImportPrefetch *job = (entry != nullptr) ? entry->value : nullptr;
+    ImportTableEntry *import_entry = nullptr;
+    if (job != nullptr) {
+        // rather than wait for a thread to get to it, the caller parses it
+        if (job->state == ImportPrefetchStateQueued)
+            job->state = ImportPrefetchStateDone;
+        while (job->state != ImportPrefetchStateDone)
+            os_cond_wait(prefetcher->cond, prefetcher->mutex);
+        import_entry = job->import_entry;
+        job->import_entry = nullptr;
+    }
+    os_mutex_unlock(prefetcher->mutex);
+
+    if (import_entry == nullptr)
+        return nullptr;
+
+    // number the nodes as if the file had been parsed just now
+    for (size_t i = 0; i < job->nodes.length; i += 1) {
+        job->nodes.at(i)->create_index += g->next_node_index;
+    }
+    g->next_node_index += (uint32_t)job->nodes.length;
+    job->nodes.deinit();
+
+    return add_parsed_source_file(g, import_entry);
+}
+
+// Unmaps the sources of the imports that were parsed ahead but never taken.
+// Analysis must be over, so that nothing takes them after all.
+void free_prefetched_imports(CodeGen *g) {
+    ImportPrefetcher *prefetcher = g->import_prefetcher;
+    if (prefetcher == nullptr)
+        return;
+    assert(!g->parse_threads_running);
+
+    auto it = prefetcher->table.entry_iterator();
+    for (;;) {
+        auto *entry = it.next();
+        if (!entry)
+            break;
+        ImportPrefetch *job = entry->value;
+        if (job->import_entry != nullptr) {
+            os_unmap_file(job->import_entry->source_code);
+            job->import_entry = nullptr;
+        }
+    }
 }
 
 void scan_import(CodeGen *g, ImportTableEntry *import) {
@@ -3048,7 +3408,131 @@ void scan_import(CodeGen *g, ImportTableEntry *import) {
     }
 }
 
+static void find_container_decl(AstNode **node_ptr, void *context) {
+    bool *found = reinterpret_cast<bool *>(context);
+    if (*found)
+        return;
+    if ((*node_ptr)->type == NodeTypeContainerDecl) {
+        *found = true;
+        return;
+    }
+    ast_visit_node_children(*node_ptr, find_container_decl, context);
+}
+
+// Whether pass 1 of fn_entry may run on an analysis thread. Generic instances
+// share their body's AST nodes, which IR generation writes to. Container
+// declarations add to the resolve queue and create named LLVM types, whose
+// names must not depend on thread timing.
+static bool fn_body_ir_is_independent(FnTableEntry *fn_entry) {
+    if (fn_entry->anal_state != FnAnalStateReady || fn_entry->body_ir_generated ||
+        fn_entry->body_node == nullptr || fn_entry->param_source_nodes != nullptr)
+    {
+        return false;
+    }
+    bool found = false;
+    find_container_decl(&fn_entry->body_node, &found);
+    return !found;
+}
+
+struct GenFnBodiesIr {
+    CodeGen *codegen;
+    ZigList<FnTableEntry *> fns;
+    size_t next_fn_index;
+    AnalysisWorker *workers;
+};
+
+static void gen_fn_bodies_ir_thread(void *context, size_t thread_index) {
+    GenFnBodiesIr *job = reinterpret_cast<GenFnBodiesIr *>(context);
+    CodeGen *g = job->codegen;
+    analysis_worker = &job->workers[thread_index];
+    for (;;) {
+        os_mutex_lock(g->analysis_mutex);
+        size_t fn_index = job->next_fn_index;
+        job->next_fn_index += 1;
+        os_mutex_unlock(g->analysis_mutex);
+
+        if (fn_index >= job->fns.length)
+            break;
+        gen_fn_body_ir(g, job->fns.at(fn_index));
+    }
+    analysis_worker = nullptr;
+}
+
+struct WorkerError {
+    ErrorMsg *msg;
+    AstNode *node;
+    size_t index;
+};
+
+static int compare_worker_errors(const void *a, const void *b) {
+    const WorkerError *error_a = reinterpret_cast<const WorkerError *>(a);
+    const WorkerError *error_b = reinterpret_cast<const WorkerError *>(b);
+    if (error_a->node->create_index != error_b->node->create_index)
+        return (error_a->node->create_index < error_b->node->create_index) ? -1 : 1;
+    // the errors of one node come from one function body and thus from one
+    // thread, which found them in a deterministic order
+    if (error_a->index != error_b->index)
+        return (error_a->index < error_b->index) ? -1 : 1;
+    return 0;
+}
+
+// Generates the pass-1 IR of the function bodies that are waiting for
+// analysis on g->analysis_threads threads. Pass 2 stays serial; it
+// instantiates generics and evaluates comptime code, which touches far more
+// shared state. Errors are reported in AST order regardless of which thread
+// found them.
+static void gen_fn_bodies_ir(CodeGen *g) {
+    GenFnBodiesIr job = {};
+    job.codegen = g;
+    for (size_t i = g->fn_defs_index; i < g->fn_defs.length; i += 1) {
+        FnTableEntry *fn_entry = g->fn_defs.at(i);
+        if (fn_body_ir_is_independent(fn_entry))
+            job.fns.append(fn_entry);
+    }
+    if (job.fns.length < 2) {
+        job.fns.deinit();
+        return;
+    }
+
+    size_t thread_count = (job.fns.length < g->analysis_threads) ? job.fns.length : g->analysis_threads;
+    job.workers = allocate<AnalysisWorker>(thread_count);
+    for (size_t i = 0; i < thread_count; i += 1) {
+        arena_init(&job.workers[i].ir_arena, g->ir_arena.name);
+        arena_init(&job.workers[i].const_val_arena, g->const_val_arena.name);
+    }
+    if (g->analysis_mutex == nullptr)
+        g->analysis_mutex = os_mutex_create();
+
+    os_run_threads(thread_count, gen_fn_bodies_ir_thread, &job);
+
+    ZigList<WorkerError> errors = {};
+    for (size_t i = 0; i < thread_count; i += 1) {
+        AnalysisWorker *worker = &job.workers[i];
+        arena_adopt(&g->ir_arena, &worker->ir_arena);
+        arena_adopt(&g->const_val_arena, &worker->const_val_arena);
+        for (size_t id = 0; id < ir_instruction_id_count; id += 1) {
+            g->ir_stats->count[id] += worker->ir_stats.count[id];
+            g->ir_stats->bytes[id] += worker->ir_stats.bytes[id];
+        }
+        for (size_t err_i = 0; err_i < worker->errors.length; err_i += 1) {
+            errors.append({worker->errors.at(err_i), worker->error_nodes.at(err_i), err_i});
+        }
+        worker->errors.deinit();
+        worker->error_nodes.deinit();
+    }
+    qsort(errors.items, errors.length, sizeof(WorkerError), compare_worker_errors);
+    for (size_t i = 0; i < errors.length; i += 1) {
+        g->errors.append(errors.at(i).msg);
+    }
+
+    errors.deinit();
+    free(job.workers);
+    job.fns.deinit();
+}
+
 void semantic_analyze(CodeGen *g) {
+    start_import_prefetch(g);
+
     for (; g->import_queue_index < g->import_queue.length; g->import_queue_index += 1) {
         ImportTableEntry *import = g->import_queue.at(g->import_queue_index);
         scan_import(g, import);
@@ -3073,11 +3557,16 @@ void semantic_analyze(CodeGen *g) {
             resolve_top_level_decl(g, tld, pointer_only, nullptr);
         }
 
+        if (g->analysis_threads > 1)
+            gen_fn_bodies_ir(g);
+
         for (; g->fn_defs_index < g->fn_defs.length; g->fn_defs_index += 1) {
             FnTableEntry *fn_entry = g->fn_defs.at(g->fn_defs_index);
             analyze_fn_body(g, fn_entry);
         }
     }
+
+    stop_import_prefetch(g);
 }
 
 TypeTableEntry **get_int_type_ptr(CodeGen *g, bool is_signed, uint32_t size_in_bits) {
@@ -3106,6 +3595,7 @@ TypeTableEntry *get_int_type(CodeGen *g, bool is_signed, uint32_t size_in_bits)
     type_id.data.integer.is_signed = is_signed;
     type_id.data.integer.bit_count = size_in_bits;
 
+    AnalysisLock lock(g);
     {
         auto entry = g->type_table.maybe_get(type_id);
         if (entry)
@@ -3199,6 +3689,14 @@ bool fn_table_entry_eql(FnTableEntry *a, FnTableEntry *b) {
     return ptr_eq(a, b);
 }
 
+uint32_t ast_node_ptr_hash(AstNode *node) {
+    return ptr_hash(node);
+}
+
+bool ast_node_ptr_eql(AstNode *a, AstNode *b) {
+    return ptr_eq(a, b);
+}
+
 uint32_t fn_type_id_hash(FnTypeId *id) {
     uint32_t result = 0;
     result += ((uint32_t)(id->cc)) * (uint32_t)3349388391;
@@ -3233,6 +3731,66 @@ bool fn_type_id_eql(FnTypeId *a, FnTypeId *b) {
     return true;
 }
 
+static uint32_t hash_u64(uint64_t x) {
+    return ((uint32_t)x ^ (uint32_t)(x >> 32)) * (uint32_t)2654435761;
+}
+
+static uint32_t hash_bignum(BigNum *bignum) {
+    if (bignum->kind == BigNumKindFloat) {
+        // +0.0 and -0.0 compare equal
+        double x = (bignum->data.x_float == 0.0) ? 0.0 : bignum->data.x_float;
+        uint64_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        return hash_u64(bits) ^ (uint32_t)2447151372;
+    }
+    return hash_u64(bignum_to_twos_complement(bignum));
+}
+
+// Returns element index of an array value. For the compact array
+// representations the element is materialized into tmp.
+static ConstExprValue *const_array_elem(ConstExprValue *array_val, size_t index, ConstExprValue *tmp) {
+    TypeTableEntry *elem_type = array_val->type->data.array.child_type;
+    switch (array_val->data.x_array.special) {
+        case ConstArraySpecialNone:
+            return &array_val->data.x_array.s_none.elements[index];
+        case ConstArraySpecialUndef:
+            tmp->special = ConstValSpecialUndef;
+            tmp->type = elem_type;
+            return tmp;
+        case ConstArraySpecialBuf:
+            tmp->special = ConstValSpecialStatic;
+            tmp->type = elem_type;
+            bignum_init_unsigned(&tmp->data.x_bignum, (uint8_t)buf_ptr(array_val->data.x_array.s_buf)[index]);
+            return tmp;
+        case ConstArraySpecialDense:
+            dense_const_array_get(array_val, index, tmp);
+            return tmp;
+    }
+    zig_unreachable();
+}
+
+static uint32_t hash_const_val(ConstExprValue *const_val);
+
+// const_values_equal treats two pointed-to values which share global_refs
+// as the same value.
+static bool same_global_identity(ConstExprValue *a, ConstExprValue *b) {
+    return a == b || (a->global_refs != nullptr && a->global_refs == b->global_refs);
+}
+
+static uint32_t hash_global_identity(ConstExprValue *const_val) {
+    return const_val->global_refs ? hash_ptr(const_val->global_refs) : hash_ptr(const_val);
+}
+
+// Values that are not static only show up as parts of aggregates.
+static uint32_t hash_const_val_part(ConstExprValue *const_val) {
+    if (const_val->special != ConstValSpecialStatic)
+        return (uint32_t)1898302745;
+    return hash_const_val(const_val);
+}
+
+// Aggregates are hashed by value. Pointers are hashed by the identity of
+// what they point to, the same way const_values_equal compares them, so
+// hashing never follows a pointer and cannot loop on cyclic data.
 static uint32_t hash_const_val(ConstExprValue *const_val) {
     assert(const_val->special == ConstValSpecialStatic);
     switch (const_val->type->id) {
@@ -3247,10 +3805,9 @@ static uint32_t hash_const_val(ConstExprValue *const_val) {
         case TypeTableEntryIdInt:
         case TypeTableEntryIdNumLitInt:
         case TypeTableEntryIdEnumTag:
-            return ((uint32_t)(bignum_to_twos_complement(&const_val->data.x_bignum) % UINT32_MAX)) * (uint32_t)1331471175;
         case TypeTableEntryIdFloat:
         case TypeTableEntryIdNumLitFloat:
-            return (uint32_t)(const_val->data.x_bignum.data.x_float * (uint32_t)UINT32_MAX);
+            return hash_bignum(&const_val->data.x_bignum);
         case TypeTableEntryIdArgTuple:
             return (uint32_t)const_val->data.x_arg_tuple.start_index * (uint32_t)281907309 +
                 (uint32_t)const_val->data.x_arg_tuple.end_index * (uint32_t)2290442768;
@@ -3277,13 +3834,13 @@ static uint32_t hash_const_val(ConstExprValue *const_val) {
                         return hash_val;
                     case ConstPtrSpecialBaseArray:
                         hash_val += (uint32_t)1764906839;
-                        hash_val += hash_ptr(const_val->data.x_ptr.data.base_array.array_val);
+                        hash_val += hash_global_identity(const_val->data.x_ptr.data.base_array.array_val);
                         hash_val += hash_size(const_val->data.x_ptr.data.base_array.elem_index);
                         hash_val += const_val->data.x_ptr.data.base_array.is_cstr ? 1297263887 : 200363492;
                         return hash_val;
                     case ConstPtrSpecialBaseStruct:
                         hash_val += (uint32_t)3518317043;
-                        hash_val += hash_ptr(const_val->data.x_ptr.data.base_struct.struct_val);
+                        hash_val += hash_global_identity(const_val->data.x_ptr.data.base_struct.struct_val);
                         hash_val += hash_size(const_val->data.x_ptr.data.base_struct.field_index);
                         return hash_val;
                     case ConstPtrSpecialHardCodedAddr:
@@ -3301,11 +3858,26 @@ static uint32_t hash_const_val(ConstExprValue *const_val) {
         case TypeTableEntryIdNullLit:
             return 844854567;
         case TypeTableEntryIdArray:
-            // TODO better hashing algorithm
-            return 1166190605;
+            {
+                // an undefined array hashes like the array of undefined
+                // elements that const_values_equal finds equal to it
+                uint32_t hash_val = 1166190605;
+                uint64_t len = const_val->type->data.array.len;
+                for (uint64_t i = 0; i < len; i += 1) {
+                    ConstExprValue tmp = {};
+                    ConstExprValue *elem_val = const_array_elem(const_val, i, &tmp);
+                    hash_val = hash_val * (uint32_t)31 + hash_const_val_part(elem_val);
+                }
+                return hash_val;
+            }
         case TypeTableEntryIdStruct:
-            // TODO better hashing algorithm
-            return 1532530855;
+            {
+                uint32_t hash_val = 1532530855;
+                for (size_t i = 0; i < const_val->type->data.structure.src_field_count; i += 1) {
+                    hash_val = hash_val * (uint32_t)31 + hash_const_val_part(&const_val->data.x_struct.fields[i]);
+                }
+                return hash_val;
+            }
         case TypeTableEntryIdUnion:
             // TODO better hashing algorithm
             return 2709806591;
@@ -3316,14 +3888,20 @@ static uint32_t hash_const_val(ConstExprValue *const_val) {
                 return 4016830364;
             }
         case TypeTableEntryIdErrorUnion:
-            // TODO better hashing algorithm
-            return 3415065496;
+            if (const_val->data.x_err_union.err != nullptr) {
+                return hash_ptr(const_val->data.x_err_union.err) ^ (uint32_t)3415065496;
+            } else {
+                return hash_const_val_part(const_val->data.x_err_union.payload) * (uint32_t)2630160122;
+            }
         case TypeTableEntryIdPureError:
-            // TODO better hashing algorithm
-            return 2630160122;
+            return hash_ptr(const_val->data.x_pure_err) ^ (uint32_t)2630160122;
         case TypeTableEntryIdEnum:
-            // TODO better hashing algorithm
-            return 31643936;
+            {
+                uint32_t hash_val = hash_u64(const_val->data.x_enum.tag) ^ (uint32_t)31643936;
+                if (const_val->data.x_enum.payload != nullptr)
+                    hash_val = hash_val * (uint32_t)31 + hash_const_val_part(const_val->data.x_enum.payload);
+                return hash_val;
+            }
         case TypeTableEntryIdFn:
             return 4133894920 ^ hash_ptr(const_val->data.x_fn.fn_entry);
         case TypeTableEntryIdNamespace:
@@ -3467,18 +4045,12 @@ bool type_requires_comptime(TypeTableEntry *type_entry) {
 void init_const_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *str) {
     const_val->special = ConstValSpecialStatic;
     const_val->type = get_array_type(g, g->builtin_types.entry_u8, buf_len(str));
-    const_val->data.x_array.s_none.elements = create_const_vals(buf_len(str));
-
-    for (size_t i = 0; i < buf_len(str); i += 1) {
-        ConstExprValue *this_char = &const_val->data.x_array.s_none.elements[i];
-        this_char->special = ConstValSpecialStatic;
-        this_char->type = g->builtin_types.entry_u8;
-        bignum_init_unsigned(&this_char->data.x_bignum, (uint8_t)buf_ptr(str)[i]);
-    }
+    const_val->data.x_array.special = ConstArraySpecialBuf;
+    const_val->data.x_array.s_buf = str;
 }
 
 ConstExprValue *create_const_str_lit(CodeGen *g, Buf *str) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_str_lit(g, const_val, str);
     return const_val;
 }
@@ -3486,20 +4058,12 @@ ConstExprValue *create_const_str_lit(CodeGen *g, Buf *str) {
 void init_const_c_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *str) {
     // first we build the underlying array
     size_t len_with_null = buf_len(str) + 1;
-    ConstExprValue *array_val = create_const_vals(1);
+    ConstExprValue *array_val = create_const_vals(g, 1);
     array_val->special = ConstValSpecialStatic;
     array_val->type = get_array_type(g, g->builtin_types.entry_u8, len_with_null);
-    array_val->data.x_array.s_none.elements = create_const_vals(len_with_null);
-    for (size_t i = 0; i < buf_len(str); i += 1) {
-        ConstExprValue *this_char = &array_val->data.x_array.s_none.elements[i];
-        this_char->special = ConstValSpecialStatic;
-        this_char->type = g->builtin_types.entry_u8;
-        bignum_init_unsigned(&this_char->data.x_bignum, (uint8_t)buf_ptr(str)[i]);
-    }
-    ConstExprValue *null_char = &array_val->data.x_array.s_none.elements[len_with_null - 1];
-    null_char->special = ConstValSpecialStatic;
-    null_char->type = g->builtin_types.entry_u8;
-    bignum_init_unsigned(&null_char->data.x_bignum, 0);
+    array_val->data.x_array.special = ConstArraySpecialBuf;
+    array_val->data.x_array.s_buf = buf_create_from_buf(str);
+    buf_append_char(array_val->data.x_array.s_buf, 0);
 
     // then make the pointer point to it
     const_val->special = ConstValSpecialStatic;
@@ -3510,7 +4074,7 @@ void init_const_c_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *str) {
     const_val->data.x_ptr.data.base_array.is_cstr = true;
 }
 ConstExprValue *create_const_c_str_lit(CodeGen *g, Buf *str) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_c_str_lit(g, const_val, str);
     return const_val;
 }
@@ -3522,8 +4086,8 @@ void init_const_unsigned_negative(ConstExprValue *const_val, TypeTableEntry *typ
     const_val->data.x_bignum.is_negative = negative;
 }
 
-ConstExprValue *create_const_unsigned_negative(TypeTableEntry *type, uint64_t x, bool negative) {
-    ConstExprValue *const_val = create_const_vals(1);
+ConstExprValue *create_const_unsigned_negative(CodeGen *g, TypeTableEntry *type, uint64_t x, bool negative) {
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_unsigned_negative(const_val, type, x, negative);
     return const_val;
 }
@@ -3533,7 +4097,7 @@ void init_const_usize(CodeGen *g, ConstExprValue *const_val, uint64_t x) {
 }
 
 ConstExprValue *create_const_usize(CodeGen *g, uint64_t x) {
-    return create_const_unsigned_negative(g->builtin_types.entry_usize, x, false);
+    return create_const_unsigned_negative(g, g->builtin_types.entry_usize, x, false);
 }
 
 void init_const_signed(ConstExprValue *const_val, TypeTableEntry *type, int64_t x) {
@@ -3542,8 +4106,8 @@ void init_const_signed(ConstExprValue *const_val, TypeTableEntry *type, int64_t
     bignum_init_signed(&const_val->data.x_bignum, x);
 }
 
-ConstExprValue *create_const_signed(TypeTableEntry *type, int64_t x) {
-    ConstExprValue *const_val = create_const_vals(1);
+ConstExprValue *create_const_signed(CodeGen *g, TypeTableEntry *type, int64_t x) {
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_signed(const_val, type, x);
     return const_val;
 }
@@ -3554,8 +4118,8 @@ void init_const_float(ConstExprValue *const_val, TypeTableEntry *type, double va
     bignum_init_float(&const_val->data.x_bignum, value);
 }
 
-ConstExprValue *create_const_float(TypeTableEntry *type, double value) {
-    ConstExprValue *const_val = create_const_vals(1);
+ConstExprValue *create_const_float(CodeGen *g, TypeTableEntry *type, double value) {
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_float(const_val, type, value);
     return const_val;
 }
@@ -3566,8 +4130,8 @@ void init_const_enum_tag(ConstExprValue *const_val, TypeTableEntry *type, uint64
     const_val->data.x_enum.tag = tag;
 }
 
-ConstExprValue *create_const_enum_tag(TypeTableEntry *type, uint64_t tag) {
-    ConstExprValue *const_val = create_const_vals(1);
+ConstExprValue *create_const_enum_tag(CodeGen *g, TypeTableEntry *type, uint64_t tag) {
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_enum_tag(const_val, type, tag);
     return const_val;
 }
@@ -3579,7 +4143,7 @@ void init_const_bool(CodeGen *g, ConstExprValue *const_val, bool value) {
 }
 
 ConstExprValue *create_const_bool(CodeGen *g, bool value) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_bool(g, const_val, value);
     return const_val;
 }
@@ -3589,8 +4153,8 @@ void init_const_runtime(ConstExprValue *const_val, TypeTableEntry *type) {
     const_val->type = type;
 }
 
-ConstExprValue *create_const_runtime(TypeTableEntry *type) {
-    ConstExprValue *const_val = create_const_vals(1);
+ConstExprValue *create_const_runtime(CodeGen *g, TypeTableEntry *type) {
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_runtime(const_val, type);
     return const_val;
 }
@@ -3602,7 +4166,7 @@ void init_const_type(CodeGen *g, ConstExprValue *const_val, TypeTableEntry *type
 }
 
 ConstExprValue *create_const_type(CodeGen *g, TypeTableEntry *type_value) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_type(g, const_val, type_value);
     return const_val;
 }
@@ -3614,14 +4178,14 @@ void init_const_slice(CodeGen *g, ConstExprValue *const_val, ConstExprValue *arr
 
     const_val->special = ConstValSpecialStatic;
     const_val->type = get_slice_type(g, array_val->type->data.array.child_type, is_const);
-    const_val->data.x_struct.fields = create_const_vals(2);
+    const_val->data.x_struct.fields = create_const_vals(g, 2);
 
     init_const_ptr_array(g, &const_val->data.x_struct.fields[slice_ptr_index], array_val, start, is_const);
     init_const_usize(g, &const_val->data.x_struct.fields[slice_len_index], len);
 }
 
 ConstExprValue *create_const_slice(CodeGen *g, ConstExprValue *array_val, size_t start, size_t len, bool is_const) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_slice(g, const_val, array_val, start, len, is_const);
     return const_val;
 }
@@ -3640,7 +4204,7 @@ void init_const_ptr_array(CodeGen *g, ConstExprValue *const_val, ConstExprValue
 }
 
 ConstExprValue *create_const_ptr_array(CodeGen *g, ConstExprValue *array_val, size_t elem_index, bool is_const) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_ptr_array(g, const_val, array_val, elem_index, is_const);
     return const_val;
 }
@@ -3653,7 +4217,7 @@ void init_const_ptr_ref(CodeGen *g, ConstExprValue *const_val, ConstExprValue *p
 }
 
 ConstExprValue *create_const_ptr_ref(CodeGen *g, ConstExprValue *pointee_val, bool is_const) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_ptr_ref(g, const_val, pointee_val, is_const);
     return const_val;
 }
@@ -3670,7 +4234,7 @@ void init_const_ptr_hard_coded_addr(CodeGen *g, ConstExprValue *const_val, TypeT
 ConstExprValue *create_const_ptr_hard_coded_addr(CodeGen *g, TypeTableEntry *pointee_type,
         size_t addr, bool is_const)
 {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_ptr_hard_coded_addr(g, const_val, pointee_type, addr, is_const);
     return const_val;
 }
@@ -3683,7 +4247,7 @@ void init_const_arg_tuple(CodeGen *g, ConstExprValue *const_val, size_t arg_inde
 }
 
 ConstExprValue *create_const_arg_tuple(CodeGen *g, size_t arg_index_start, size_t arg_index_end) {
-    ConstExprValue *const_val = create_const_vals(1);
+    ConstExprValue *const_val = create_const_vals(g, 1);
     init_const_arg_tuple(g, const_val, arg_index_start, arg_index_end);
     return const_val;
 }
@@ -3699,7 +4263,7 @@ void init_const_undefined(CodeGen *g, ConstExprValue *const_val) {
 
         const_val->special = ConstValSpecialStatic;
         size_t field_count = wanted_type->data.structure.src_field_count;
-        const_val->data.x_struct.fields = create_const_vals(field_count);
+        const_val->data.x_struct.fields = create_const_vals(g, field_count);
         for (size_t i = 0; i < field_count; i += 1) {
             ConstExprValue *field_val = &const_val->data.x_struct.fields[i];
             field_val->type = wanted_type->data.structure.fields[i].type_entry;
@@ -3717,9 +4281,10 @@ void init_const_undefined(CodeGen *g, ConstExprValue *const_val) {
     }
 }
 
-ConstExprValue *create_const_vals(size_t count) {
-    ConstGlobalRefs *global_refs = allocate<ConstGlobalRefs>(count);
-    ConstExprValue *vals = allocate<ConstExprValue>(count);
+ConstExprValue *create_const_vals(CodeGen *g, size_t count) {
+    Arena *arena = get_const_val_arena(g);
+    ConstGlobalRefs *global_refs = arena_allocate<ConstGlobalRefs>(arena, count);
+    ConstExprValue *vals = arena_allocate<ConstExprValue>(arena, count);
     for (size_t i = 0; i < count; i += 1) {
         vals[i].global_refs = &global_refs[i];
     }
@@ -3753,8 +4318,15 @@ bool ir_get_var_is_comptime(VariableTableEntry *var) {
     if (!var->is_comptime)
         return false;
     if (var->is_comptime->other)
-        return var->is_comptime->other->value.data.x_bool;
-    return var->is_comptime->value.data.x_bool;
+        return var->is_comptime->other->value->data.x_bool;
+    return var->is_comptime->value->data.x_bool;
+}
+
+// Like const_values_equal, for parts of aggregates which may be undefined.
+static bool const_values_equal_part(ConstExprValue *a, ConstExprValue *b) {
+    if (a->special != ConstValSpecialStatic || b->special != ConstValSpecialStatic)
+        return a->special == b->special;
+    return const_values_equal(a, b);
 }
 
 bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
@@ -3771,7 +4343,7 @@ bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
                 if (enum1->tag == enum2->tag) {
                     TypeEnumField *enum_field = &a->type->data.enumeration.fields[enum1->tag];
                     if (type_has_bits(enum_field->type_entry)) {
-                        zig_panic("TODO const expr analyze enum special value for equality");
+                        return const_values_equal_part(enum1->payload, enum2->payload);
                     } else {
                         return true;
                     }
@@ -3807,9 +4379,8 @@ bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
                         return false;
                     return true;
                 case ConstPtrSpecialBaseArray:
-                    if (a->data.x_ptr.data.base_array.array_val != b->data.x_ptr.data.base_array.array_val &&
-                        a->data.x_ptr.data.base_array.array_val->global_refs !=
-                        b->data.x_ptr.data.base_array.array_val->global_refs)
+                    if (!same_global_identity(a->data.x_ptr.data.base_array.array_val,
+                                b->data.x_ptr.data.base_array.array_val))
                     {
                         return false;
                     }
@@ -3819,9 +4390,8 @@ bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
                         return false;
                     return true;
                 case ConstPtrSpecialBaseStruct:
-                    if (a->data.x_ptr.data.base_struct.struct_val != b->data.x_ptr.data.base_struct.struct_val &&
-                        a->data.x_ptr.data.base_struct.struct_val->global_refs !=
-                        b->data.x_ptr.data.base_struct.struct_val->global_refs)
+                    if (!same_global_identity(a->data.x_ptr.data.base_struct.struct_val,
+                                b->data.x_ptr.data.base_struct.struct_val))
                     {
                         return false;
                     }
@@ -3837,21 +4407,40 @@ bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
             }
             zig_unreachable();
         case TypeTableEntryIdArray:
-            zig_panic("TODO");
+            {
+                if (a->data.x_array.special == ConstArraySpecialUndef &&
+                    b->data.x_array.special == ConstArraySpecialUndef)
+                {
+                    return true;
+                }
+                if (a->data.x_array.special == ConstArraySpecialBuf &&
+                    b->data.x_array.special == ConstArraySpecialBuf)
+                {
+                    return buf_eql_buf(a->data.x_array.s_buf, b->data.x_array.s_buf);
+                }
+                uint64_t len = a->type->data.array.len;
+                assert(len == b->type->data.array.len);
+                for (uint64_t i = 0; i < len; i += 1) {
+                    ConstExprValue tmp_a = {};
+                    ConstExprValue tmp_b = {};
+                    if (!const_values_equal_part(const_array_elem(a, i, &tmp_a), const_array_elem(b, i, &tmp_b)))
+                        return false;
+                }
+                return true;
+            }
         case TypeTableEntryIdStruct:
             for (size_t i = 0; i < a->type->data.structure.src_field_count; i += 1) {
                 ConstExprValue *field_a = &a->data.x_struct.fields[i];
                 ConstExprValue *field_b = &b->data.x_struct.fields[i];
-                if (!const_values_equal(field_a, field_b))
+                if (!const_values_equal_part(field_a, field_b))
                     return false;
             }
             return true;
         case TypeTableEntryIdUnion:
             zig_panic("TODO");
         case TypeTableEntryIdUndefLit:
-            zig_panic("TODO");
         case TypeTableEntryIdNullLit:
-            zig_panic("TODO");
+            return true;
         case TypeTableEntryIdMaybe:
             if (a->data.x_maybe == nullptr || b->data.x_maybe == nullptr) {
                 return (a->data.x_maybe == nullptr && b->data.x_maybe == nullptr);
@@ -3859,7 +4448,9 @@ bool const_values_equal(ConstExprValue *a, ConstExprValue *b) {
                 return const_values_equal(a->data.x_maybe, b->data.x_maybe);
             }
         case TypeTableEntryIdErrorUnion:
-            zig_panic("TODO");
+            if (a->data.x_err_union.err != nullptr || b->data.x_err_union.err != nullptr)
+                return a->data.x_err_union.err == b->data.x_err_union.err;
+            return const_values_equal_part(a->data.x_err_union.payload, b->data.x_err_union.payload);
         case TypeTableEntryIdNamespace:
             return a->data.x_import == b->data.x_import;
         case TypeTableEntryIdBlock:
@@ -4039,7 +4630,7 @@ void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val) {
         case TypeTableEntryIdBlock:
             {
                 AstNode *node = const_val->data.x_block->source_node;
-                buf_appendf(buf, "(scope:%" ZIG_PRI_usize ":%" ZIG_PRI_usize ")", node->line + 1, node->column + 1);
+                buf_appendf(buf, "(scope:%" ZIG_PRI_usize ":%" ZIG_PRI_usize ")", (size_t)node->line + 1, (size_t)node->column + 1);
                 return;
             }
         case TypeTableEntryIdArray:
@@ -4059,10 +4650,17 @@ void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val) {
                 {
                     buf_append_char(buf, '"');
                     for (uint64_t i = 0; i < len; i += 1) {
-                        ConstExprValue *child_value = &const_val->data.x_array.s_none.elements[i];
-                        uint64_t big_c = child_value->data.x_bignum.data.x_uint;
-                        assert(big_c <= UINT8_MAX);
-                        uint8_t c = (uint8_t)big_c;
+                        uint8_t c;
+                        if (const_val->data.x_array.special == ConstArraySpecialBuf) {
+                            c = (uint8_t)buf_ptr(const_val->data.x_array.s_buf)[i];
+                        } else if (const_val->data.x_array.special == ConstArraySpecialDense) {
+                            c = (uint8_t)const_val->data.x_array.s_dense.words[i];
+                        } else {
+                            ConstExprValue *child_value = &const_val->data.x_array.s_none.elements[i];
+                            uint64_t big_c = child_value->data.x_bignum.data.x_uint;
+                            assert(big_c <= UINT8_MAX);
+                            c = (uint8_t)big_c;
+                        }
                         if (c == '"') {
                             buf_append_str(buf, "\\\"");
                         } else {
@@ -4077,8 +4675,14 @@ void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val) {
                 for (uint64_t i = 0; i < len; i += 1) {
                     if (i != 0)
                         buf_appendf(buf, ",");
-                    ConstExprValue *child_value = &const_val->data.x_array.s_none.elements[i];
-                    render_const_value(g, buf, child_value);
+                    if (const_val->data.x_array.special == ConstArraySpecialDense) {
+                        ConstExprValue child_value = {};
+                        dense_const_array_get(const_val, i, &child_value);
+                        render_const_value(g, buf, &child_value);
+                    } else {
+                        ConstExprValue *child_value = &const_val->data.x_array.s_none.elements[i];
+                        render_const_value(g, buf, child_value);
+                    }
                 }
                 buf_appendf(buf, "}");
                 return;
@@ -4160,7 +4764,7 @@ void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val) {
 }
 
 TypeTableEntry *make_int_type(CodeGen *g, bool is_signed, uint32_t size_in_bits) {
-    TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdInt);
+    TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdInt);
     entry->is_copyable = true;
     entry->type_ref = LLVMIntType(size_in_bits);
 
@@ -4315,12 +4919,40 @@ bool zig_llvm_fn_key_eql(ZigLLVMFnKey a, ZigLLVMFnKey b) {
     zig_unreachable();
 }
 
+uint32_t interned_buf_hash(Buf *buf) {
+    return ptr_hash(buf);
+}
+
+bool interned_buf_eql(Buf *a, Buf *b) {
+    return a == b;
+}
+
+// Returns the one Buf with the same contents as str that all identifiers
+// share, so that symbol tables can hash and compare names by pointer.
+// The result must not be modified.
+Buf *intern_buf(CodeGen *g, Buf *str) {
+    AnalysisLock lock(g);
+    bool existed;
+    auto entry = g->intern_table.get_or_insert(str, nullptr, &existed);
+    if (!existed) {
+        entry->key = buf_create_from_buf(str);
+        entry->value = entry->key;
+    }
+    return entry->value;
+}
+
+bool buf_is_interned(CodeGen *g, Buf *str) {
+    AnalysisLock lock(g);
+    auto entry = g->intern_table.maybe_get(str);
+    return entry != nullptr && entry->value == str;
+}
+
 void expand_undef_array(CodeGen *g, ConstExprValue *const_val) {
     assert(const_val->type->id == TypeTableEntryIdArray);
     if (const_val->data.x_array.special == ConstArraySpecialUndef) {
         const_val->data.x_array.special = ConstArraySpecialNone;
         size_t elem_count = const_val->type->data.array.len;
-        const_val->data.x_array.s_none.elements = create_const_vals(elem_count);
+        const_val->data.x_array.s_none.elements = create_const_vals(g, elem_count);
         for (size_t i = 0; i < elem_count; i += 1) {
             ConstExprValue *element_val = &const_val->data.x_array.s_none.elements[i];
             element_val->type = const_val->type->data.array.child_type;
@@ -4332,6 +4964,184 @@ void expand_undef_array(CodeGen *g, ConstExprValue *const_val) {
                 parent->data.p_array.elem_index = i;
             }
         }
+    } else if (const_val->data.x_array.special == ConstArraySpecialBuf) {
+        // u8 elements have no ConstParent, so only the values need filling in
+        Buf *buf = const_val->data.x_array.s_buf;
+        size_t elem_count = const_val->type->data.array.len;
+        assert(buf_len(buf) == elem_count);
+        const_val->data.x_array.special = ConstArraySpecialNone;
+        const_val->data.x_array.s_buf = nullptr;
+        const_val->data.x_array.s_none.elements = create_const_vals(g, elem_count);
+        for (size_t i = 0; i < elem_count; i += 1) {
+            ConstExprValue *this_char = &const_val->data.x_array.s_none.elements[i];
+            this_char->special = ConstValSpecialStatic;
+            this_char->type = g->builtin_types.entry_u8;
+            bignum_init_unsigned(&this_char->data.x_bignum, (uint8_t)buf_ptr(buf)[i]);
+        }
+    } else if (const_val->data.x_array.special == ConstArraySpecialDense) {
+        // elements of a dense array are scalars, which have no ConstParent
+        size_t elem_count = const_val->type->data.array.len;
+        ConstExprValue *elements = create_const_vals(g, elem_count);
+        for (size_t i = 0; i < elem_count; i += 1) {
+            dense_const_array_get(const_val, i, &elements[i]);
+        }
+        const_val->data.x_array.special = ConstArraySpecialNone;
+        const_val->data.x_array.s_dense.words = nullptr;
+        const_val->data.x_array.s_dense.floats = nullptr;
+        const_val->data.x_array.s_dense.defined = nullptr;
+        const_val->data.x_array.s_none.elements = elements;
+    }
+}
+
+bool type_allows_dense_const_array(TypeTableEntry *elem_type) {
+    switch (elem_type->id) {
+        case TypeTableEntryIdBool:
+        case TypeTableEntryIdFloat:
+            return true;
+        case TypeTableEntryIdInt:
+            return elem_type->data.integral.bit_count <= 64;
+        default:
+            return false;
+    }
+}
+
+static void alloc_dense_const_array(CodeGen *g, ConstExprValue *array_val) {
+    TypeTableEntry *elem_type = array_val->type->data.array.child_type;
+    size_t elem_count = array_val->type->data.array.len;
+    array_val->data.x_array.special = ConstArraySpecialDense;
+    Arena *arena = get_const_val_arena(g);
+    if (elem_type->id == TypeTableEntryIdFloat) {
+        array_val->data.x_array.s_dense.floats = arena_allocate<double>(arena, elem_count);
+    } else {
+        array_val->data.x_array.s_dense.words = arena_allocate<uint64_t>(arena, elem_count);
+    }
+    array_val->data.x_array.s_dense.defined = arena_allocate<uint64_t>(arena, (elem_count + 63) / 64);
+}
+
+// Switches an undefined, byte string or freshly built array of a suitable
+// element type over to dense storage. This must not be called on a
+// ConstArraySpecialNone array once pointers to its elements may exist.
+// Returns whether the array is dense.
+bool make_dense_const_array(CodeGen *g, ConstExprValue *array_val) {
+    assert(array_val->type->id == TypeTableEntryIdArray);
+    ConstArrayValue *array = &array_val->data.x_array;
+    if (array->special == ConstArraySpecialDense)
+        return true;
+    if (!type_allows_dense_const_array(array_val->type->data.array.child_type))
+        return false;
+
+    size_t elem_count = array_val->type->data.array.len;
+    switch (array->special) {
+        case ConstArraySpecialUndef:
+            alloc_dense_const_array(g, array_val);
+            return true;
+        case ConstArraySpecialBuf:
+            {
+                Buf *buf = array->s_buf;
+                assert(buf_len(buf) == elem_count);
+                alloc_dense_const_array(g, array_val);
+                for (size_t i = 0; i < elem_count; i += 1) {
+                    array->s_dense.words[i] = (uint8_t)buf_ptr(buf)[i];
+                    array->s_dense.defined[i / 64] |= ((uint64_t)1) << (i % 64);
+                }
+                array->s_buf = nullptr;
+                return true;
+            }
+        case ConstArraySpecialNone:
+            {
+                ConstExprValue *elements = array->s_none.elements;
+                for (size_t i = 0; i < elem_count; i += 1) {
+                    if (elements[i].special == ConstValSpecialRuntime)
+                        return false;
+                }
+                alloc_dense_const_array(g, array_val);
+                for (size_t i = 0; i < elem_count; i += 1) {
+                    dense_const_array_set(array_val, i, &elements[i]);
+                }
+                array->s_none.elements = nullptr;
+                return true;
+            }
+        case ConstArraySpecialDense:
+            zig_unreachable();
+    }
+    zig_unreachable();
+}
+
+void copy_dense_const_array(CodeGen *g, ConstExprValue *dest, ConstExprValue *src) {
+    assert(src->data.x_array.special == ConstArraySpecialDense);
+    size_t elem_count = src->type->data.array.len;
+    alloc_dense_const_array(g, dest);
+    if (src->data.x_array.s_dense.floats != nullptr) {
+        memcpy(dest->data.x_array.s_dense.floats, src->data.x_array.s_dense.floats, elem_count * sizeof(double));
+    } else {
+        memcpy(dest->data.x_array.s_dense.words, src->data.x_array.s_dense.words, elem_count * sizeof(uint64_t));
+    }
+    memcpy(dest->data.x_array.s_dense.defined, src->data.x_array.s_dense.defined,
+            ((elem_count + 63) / 64) * sizeof(uint64_t));
+}
+
+void dense_const_array_get(ConstExprValue *array_val, size_t index, ConstExprValue *out_val) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    assert(array->special == ConstArraySpecialDense);
+    assert(index < array_val->type->data.array.len);
+    TypeTableEntry *elem_type = array_val->type->data.array.child_type;
+
+    out_val->type = elem_type;
+    if (!(array->s_dense.defined[index / 64] & (((uint64_t)1) << (index % 64)))) {
+        out_val->special = ConstValSpecialUndef;
+        return;
+    }
+    out_val->special = ConstValSpecialStatic;
+    switch (elem_type->id) {
+        case TypeTableEntryIdBool:
+            out_val->data.x_bool = (array->s_dense.words[index] != 0);
+            return;
+        case TypeTableEntryIdFloat:
+            bignum_init_float(&out_val->data.x_bignum, array->s_dense.floats[index]);
+            return;
+        case TypeTableEntryIdInt:
+            if (elem_type->data.integral.is_signed) {
+                bignum_init_signed(&out_val->data.x_bignum, (int64_t)array->s_dense.words[index]);
+            } else {
+                bignum_init_unsigned(&out_val->data.x_bignum, array->s_dense.words[index]);
+            }
+            return;
+        default:
+            zig_unreachable();
+    }
+}
+
+void dense_const_array_set(ConstExprValue *array_val, size_t index, ConstExprValue *elem_val) {
+    ConstArrayValue *array = &array_val->data.x_array;
+    assert(array->special == ConstArraySpecialDense);
+    assert(index < array_val->type->data.array.len);
+    uint64_t defined_bit = ((uint64_t)1) << (index % 64);
+
+    if (elem_val->special == ConstValSpecialUndef) {
+        array->s_dense.defined[index / 64] &= ~defined_bit;
+        return;
+    }
+    assert(elem_val->special == ConstValSpecialStatic);
+    array->s_dense.defined[index / 64] |= defined_bit;
+
+    switch (array_val->type->data.array.child_type->id) {
+        case TypeTableEntryIdBool:
+            array->s_dense.words[index] = elem_val->data.x_bool ? 1 : 0;
+            return;
+        case TypeTableEntryIdFloat:
+            if (elem_val->data.x_bignum.kind == BigNumKindFloat) {
+                array->s_dense.floats[index] = elem_val->data.x_bignum.data.x_float;
+            } else {
+                BigNum float_val;
+                bignum_cast_to_float(&float_val, &elem_val->data.x_bignum);
+                array->s_dense.floats[index] = float_val.data.x_float;
+            }
+            return;
+        case TypeTableEntryIdInt:
+            array->s_dense.words[index] = bignum_to_twos_complement(&elem_val->data.x_bignum);
+            return;
+        default:
+            zig_unreachable();
     }
 }
 
@@ -4339,8 +5149,7 @@ ConstParent *get_const_val_parent(CodeGen *g, ConstExprValue *value) {
     assert(value->type);
     TypeTableEntry *type_entry = value->type;
     if (type_entry->id == TypeTableEntryIdArray) {
-        expand_undef_array(g, value);
-        return &value->data.x_array.s_none.parent;
+        return &value->data.x_array.parent;
     } else if (type_entry->id == TypeTableEntryIdStruct) {
         return &value->data.x_struct.parent;
     }
@@ -4367,7 +5176,7 @@ FnTableEntry *get_extern_panic_fn(CodeGen *g) {
     buf_init_from_str(&fn_entry->symbol_name, "__zig_panic");
 
     TldFn *tld_fn = allocate<TldFn>(1);
-    init_tld(&tld_fn->base, TldIdFn, &fn_entry->symbol_name, VisibModPrivate, nullptr, nullptr);
+    init_tld(g, &tld_fn->base, TldIdFn, &fn_entry->symbol_name, VisibModPrivate, nullptr, nullptr);
     tld_fn->fn_entry = fn_entry;
 
     g->external_prototypes.put_unique(tld_fn->base.name, &tld_fn->base);
@@ -13,7 +13,7 @@
 void semantic_analyze(CodeGen *g);
 ErrorMsg *add_node_error(CodeGen *g, AstNode *node, Buf *msg);
 ErrorMsg *add_error_note(CodeGen *g, ErrorMsg *parent_msg, AstNode *node, Buf *msg);
-TypeTableEntry *new_type_table_entry(TypeTableEntryId id);
+TypeTableEntry *new_type_table_entry(CodeGen *g, TypeTableEntryId id);
 TypeTableEntry *get_pointer_to_type(CodeGen *g, TypeTableEntry *child_type, bool is_const);
 TypeTableEntry *get_pointer_to_type_extra(CodeGen *g, TypeTableEntry *child_type, bool is_const,
         bool is_volatile, uint32_t bit_offset, uint32_t unaligned_bit_count);
@@ -44,6 +44,8 @@ bool type_has_bits(TypeTableEntry *type_entry);
 
 
 ImportTableEntry *add_source_file(CodeGen *g, PackageTableEntry *package, Buf *abs_full_path, Buf *source_code);
+ImportTableEntry *take_prefetched_import(CodeGen *g, Buf *full_path);
+void free_prefetched_imports(CodeGen *g);
 
 
 // TODO move these over, these used to be static
@@ -68,7 +70,7 @@ void preview_use_decl(CodeGen *g, AstNode *node);
 void resolve_use_decl(CodeGen *g, AstNode *node);
 FnTableEntry *scope_fn_entry(Scope *scope);
 ImportTableEntry *get_scope_import(Scope *scope);
-void init_tld(Tld *tld, TldId id, Buf *name, VisibMod visib_mod, AstNode *source_node, Scope *parent_scope);
+void init_tld(CodeGen *g, Tld *tld, TldId id, Buf *name, VisibMod visib_mod, AstNode *source_node, Scope *parent_scope);
 VariableTableEntry *add_variable(CodeGen *g, AstNode *source_node, Scope *parent_scope, Buf *name,
     bool is_const, ConstExprValue *init_value, Tld *src_tld);
 TypeTableEntry *analyze_type_expr(CodeGen *g, Scope *scope, AstNode *node);
@@ -91,6 +93,7 @@ uint64_t max_unsigned_val(TypeTableEntry *type_entry);
 void render_const_value(CodeGen *g, Buf *buf, ConstExprValue *const_val);
 void define_local_param_variables(CodeGen *g, FnTableEntry *fn_table_entry, VariableTableEntry **arg_vars);
 void analyze_fn_ir(CodeGen *g, FnTableEntry *fn_table_entry, AstNode *return_type_node);
+void analyze_fn_body(CodeGen *g, FnTableEntry *fn_table_entry);
 
 ScopeBlock *create_block_scope(AstNode *node, Scope *parent);
 ScopeDefer *create_defer_scope(AstNode *node, Scope *parent);
@@ -109,19 +112,19 @@ void init_const_c_str_lit(CodeGen *g, ConstExprValue *const_val, Buf *c_str);
 ConstExprValue *create_const_c_str_lit(CodeGen *g, Buf *c_str);
 
 void init_const_unsigned_negative(ConstExprValue *const_val, TypeTableEntry *type, uint64_t x, bool negative);
-ConstExprValue *create_const_unsigned_negative(TypeTableEntry *type, uint64_t x, bool negative);
+ConstExprValue *create_const_unsigned_negative(CodeGen *g, TypeTableEntry *type, uint64_t x, bool negative);
 
 void init_const_signed(ConstExprValue *const_val, TypeTableEntry *type, int64_t x);
-ConstExprValue *create_const_signed(TypeTableEntry *type, int64_t x);
+ConstExprValue *create_const_signed(CodeGen *g, TypeTableEntry *type, int64_t x);
 
 void init_const_usize(CodeGen *g, ConstExprValue *const_val, uint64_t x);
 ConstExprValue *create_const_usize(CodeGen *g, uint64_t x);
 
 void init_const_float(ConstExprValue *const_val, TypeTableEntry *type, double value);
-ConstExprValue *create_const_float(TypeTableEntry *type, double value);
+ConstExprValue *create_const_float(CodeGen *g, TypeTableEntry *type, double value);
 
 void init_const_enum_tag(ConstExprValue *const_val, TypeTableEntry *type, uint64_t tag);
-ConstExprValue *create_const_enum_tag(TypeTableEntry *type, uint64_t tag);
+ConstExprValue *create_const_enum_tag(CodeGen *g, TypeTableEntry *type, uint64_t tag);
 
 void init_const_bool(CodeGen *g, ConstExprValue *const_val, bool value);
 ConstExprValue *create_const_bool(CodeGen *g, bool value);
@@ -130,7 +133,7 @@ void init_const_type(CodeGen *g, ConstExprValue *const_val, TypeTableEntry *type
 ConstExprValue *create_const_type(CodeGen *g, TypeTableEntry *type_value);
 
 void init_const_runtime(ConstExprValue *const_val, TypeTableEntry *type);
-ConstExprValue *create_const_runtime(TypeTableEntry *type);
+ConstExprValue *create_const_runtime(CodeGen *g, TypeTableEntry *type);
 
 void init_const_ptr_ref(CodeGen *g, ConstExprValue *const_val, ConstExprValue *pointee_val, bool is_const);
 ConstExprValue *create_const_ptr_ref(CodeGen *g, ConstExprValue *pointee_val, bool is_const);
@@ -153,13 +156,20 @@ ConstExprValue *create_const_arg_tuple(CodeGen *g, size_t arg_index_start, size_
 
 void init_const_undefined(CodeGen *g, ConstExprValue *const_val);
 
-ConstExprValue *create_const_vals(size_t count);
+ConstExprValue *create_const_vals(CodeGen *g, size_t count);
 
 TypeTableEntry *make_int_type(CodeGen *g, bool is_signed, uint32_t size_in_bits);
 ConstParent *get_const_val_parent(CodeGen *g, ConstExprValue *value);
 FnTableEntry *get_extern_panic_fn(CodeGen *g);
 TypeTableEntry *create_enum_tag_type(CodeGen *g, TypeTableEntry *enum_type, TypeTableEntry *int_type);
 void expand_undef_array(CodeGen *g, ConstExprValue *const_val);
+Buf *intern_buf(CodeGen *g, Buf *str);
+bool buf_is_interned(CodeGen *g, Buf *str);
+bool type_allows_dense_const_array(TypeTableEntry *elem_type);
+bool make_dense_const_array(CodeGen *g, ConstExprValue *array_val);
+void copy_dense_const_array(CodeGen *g, ConstExprValue *dest, ConstExprValue *src);
+void dense_const_array_get(ConstExprValue *array_val, size_t index, ConstExprValue *out_val);
+void dense_const_array_set(ConstExprValue *array_val, size_t index, ConstExprValue *elem_val);
 void update_compile_var(CodeGen *g, Buf *name, ConstExprValue *value);
 
 const char *type_id_name(TypeTableEntryId id);
@@ -173,4 +183,30 @@ bool calling_convention_does_first_arg_return(CallingConvention cc);
 LinkLib *add_link_lib(CodeGen *codegen, Buf *lib);
 void add_link_lib_symbol(CodeGen *g, Buf *lib_name, Buf *symbol_name);
 
+// A thread that generates the pass-1 IR of function bodies allocates from
+// arenas of its own and collects its errors, so that they can be reported
+// in the same order no matter how the bodies were split across threads.
+struct AnalysisWorker {
+    Arena ir_arena;
+    Arena const_val_arena;
+    IrInstructionStats ir_stats;
+    ZigList<ErrorMsg *> errors;
+    ZigList<AstNode *> error_nodes;
+};
+
+// null except on the analysis threads while they run
+extern thread_local AnalysisWorker *analysis_worker;
+
+static inline Arena *get_ir_arena(CodeGen *g) {
+    return (analysis_worker != nullptr) ? &analysis_worker->ir_arena : &g->ir_arena;
+}
+
+static inline Arena *get_const_val_arena(CodeGen *g) {
+    return (analysis_worker != nullptr) ? &analysis_worker->const_val_arena : &g->const_val_arena;
+}
+
+static inline IrInstructionStats *get_ir_stats(CodeGen *g) {
+    return (analysis_worker != nullptr) ? &analysis_worker->ir_stats : g->ir_stats;
+}
+
 #endif
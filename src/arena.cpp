@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#include "arena.hpp"
+
+// The first chunk is small and the chunks double up to the full size, so
+// that the arenas of single function bodies stay cheap.
+static const size_t arena_first_chunk_size = 4 * 1024;
+static const size_t arena_chunk_size = 256 * 1024;
+
+void arena_init(Arena *arena, const char *name) {
+    *arena = {};
+    arena->name = name;
+}
+
+void arena_deinit(Arena *arena) {
+    ArenaChunk *chunk = arena->last_chunk;
+    while (chunk != nullptr) {
+        ArenaChunk *prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+    arena_init(arena, arena->name);
+}
+
+void *arena_alloc_slow(Arena *arena, size_t size, size_t align) {
+    // Allocations too big to share a chunk get a chunk of their own, which is
+    // linked in behind the current one so that the remaining space in the
+    // current chunk is not wasted.
+    size_t header_size = (sizeof(ArenaChunk) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    bool dedicated = (size > arena_chunk_size / 4);
+    size_t data_size;
+    if (dedicated) {
+        data_size = size + align;
+        if (data_size < size)
+            zig_panic("allocation failed");
+    } else {
+        data_size = arena_first_chunk_size;
+        for (size_t i = 0; i < arena->chunk_count && data_size < arena_chunk_size; i += 1)
+            data_size *= 2;
+        if (data_size < size + align)
+            data_size = arena_chunk_size;
+    }
+
+    ArenaChunk *chunk = reinterpret_cast<ArenaChunk *>(calloc(1, header_size + data_size));
+    if (!chunk)
+        zig_panic("allocation failed");
+    chunk->size = data_size;
+
+    uint8_t *data = reinterpret_cast<uint8_t *>(chunk) + header_size;
+    uintptr_t addr = ((uintptr_t)data + (align - 1)) & ~(uintptr_t)(align - 1);
+
+    if (dedicated && arena->last_chunk != nullptr) {
+        chunk->prev = arena->last_chunk->prev;
+        arena->last_chunk->prev = chunk;
+    } else {
+        chunk->prev = arena->last_chunk;
+        arena->last_chunk = chunk;
+        arena->cur = (uint8_t *)(addr + size);
+        arena->end = data + data_size;
+    }
+
+    arena->chunk_count += 1;
+    arena->bytes_reserved += data_size;
+    arena->alloc_count += 1;
+    arena->bytes_used += size;
+    return (void *)addr;
+}
+
+// Moves the memory of other into arena, so that it lives as long as arena
+// does. other is left empty. Allocation continues in arena's current chunk.
+void arena_adopt(Arena *arena, Arena *other) {
+    if (other->last_chunk == nullptr)
+        return;
+
+    ArenaChunk *first_chunk = other->last_chunk;
+    while (first_chunk->prev != nullptr)
+        first_chunk = first_chunk->prev;
+
+    if (arena->last_chunk == nullptr) {
+        arena->last_chunk = other->last_chunk;
+        arena->cur = other->cur;
+        arena->end = other->end;
+    } else {
+        first_chunk->prev = arena->last_chunk->prev;
+        arena->last_chunk->prev = other->last_chunk;
+    }
+
+    arena->alloc_count += other->alloc_count;
+    arena->bytes_used += other->bytes_used;
+    arena->bytes_reserved += other->bytes_reserved;
+    arena->chunk_count += other->chunk_count;
+    arena_init(other, other->name);
+}
+
+void arena_print_report(Arena *arena, FILE *f) {
+    fprintf(f, "%20s%12zu%12zu%12zu%12zu\n", arena->name, arena->alloc_count,
+            arena->bytes_used, arena->bytes_reserved, arena->chunk_count);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_ARENA_HPP
+#define ZIG_ARENA_HPP
+
+#include "util.hpp"
+
+#include <stddef.h>
+#include <stdio.h>
+
+// A bump allocator. Memory handed out by an arena is zero initialized, just
+// like allocate<T>, and is only released all at once by arena_deinit.
+struct ArenaChunk {
+    ArenaChunk *prev;
+    size_t size;
+};
+
+struct Arena {
+    const char *name;
+    uint8_t *cur;
+    uint8_t *end;
+    ArenaChunk *last_chunk;
+
+    // statistics, reported with --enable-timing-info
+    size_t alloc_count;
+    size_t bytes_used;
+    size_t bytes_reserved;
+    size_t chunk_count;
+};
+
+void arena_init(Arena *arena, const char *name);
+void arena_deinit(Arena *arena);
+void *arena_alloc_slow(Arena *arena, size_t size, size_t align);
+void arena_adopt(Arena *arena, Arena *other);
+void arena_print_report(Arena *arena, FILE *f);
+
+static inline void *arena_alloc_bytes(Arena *arena, size_t size, size_t align) {
+    assert(is_power_of_2(align));
+    uintptr_t addr = ((uintptr_t)arena->cur + (align - 1)) & ~(uintptr_t)(align - 1);
+    if (arena->cur == nullptr || addr > (uintptr_t)arena->end || size > (uintptr_t)arena->end - addr)
+        return arena_alloc_slow(arena, size, align);
+    arena->cur = (uint8_t *)(addr + size);
+    arena->alloc_count += 1;
+    arena->bytes_used += size;
+    return (void *)addr;
+}
+
+template<typename T>
+__attribute__((malloc)) static inline T *arena_allocate(Arena *arena, size_t count) {
+    if (count != 0 && SIZE_MAX / count < sizeof(T))
+        zig_panic("allocation failed");
+    return reinterpret_cast<T*>(arena_alloc_bytes(arena, count * sizeof(T), alignof(T)));
+}
+
+#endif
@@ -313,34 +313,28 @@ static bool is_printable(uint8_t c) {
     return false;
 }
 
-static void string_literal_escape(Buf *source, Buf *dest) {
+void string_literal_escape(Buf *source, Buf *dest) {
     buf_resize(dest, 0);
     for (size_t i = 0; i < buf_len(source); i += 1) {
         uint8_t c = *((uint8_t*)buf_ptr(source) + i);
-        if (is_printable(c)) {
-            buf_append_char(dest, c);
-        } else if (c == '\'') {
-            buf_append_str(dest, "\\'");
-        } else if (c == '"') {
+        // quotes and backslashes count as printable. zig only knows the
+        // \n, \r and \t control character escapes
+        if (c == '"') {
             buf_append_str(dest, "\\\"");
         } else if (c == '\\') {
             buf_append_str(dest, "\\\\");
-        } else if (c == '\a') {
-            buf_append_str(dest, "\\a");
-        } else if (c == '\b') {
-            buf_append_str(dest, "\\b");
-        } else if (c == '\f') {
-            buf_append_str(dest, "\\f");
+        } else if (is_printable(c)) {
+            buf_append_char(dest, c);
+        } else if (c == '\'') {
+            buf_append_str(dest, "\\'");
         } else if (c == '\n') {
             buf_append_str(dest, "\\n");
         } else if (c == '\r') {
             buf_append_str(dest, "\\r");
         } else if (c == '\t') {
             buf_append_str(dest, "\\t");
-        } else if (c == '\v') {
-            buf_append_str(dest, "\\v");
         } else {
-            buf_appendf(dest, "\\x%x", (int)c);
+            buf_appendf(dest, "\\x%02x", (int)c);
         }
     }
 }
@@ -19,6 +19,8 @@ void ast_render(CodeGen *codegen, FILE *f, AstNode *node, int indent_size);
 
 const char *container_string(ContainerKind kind);
 
+void string_literal_escape(Buf *source, Buf *dest);
+
 void ast_render_decls(CodeGen *codegen, FILE *f, int indent_size, ImportTableEntry *import);
 
 #endif
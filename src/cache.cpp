@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+// The object file that codegen emits into cache_dir is reused by later builds
+// when nothing that went into it has changed. Next to the object we write a
+// manifest with a key derived from the compiler binary, the compile options,
+// target, package mappings and the generated builtin.zig, followed by the
+// content hash of every file that the build read: each import, package root,
+// @embedFile target and --assembly file. A build whose key matches and whose
+// files all hash the same skips analysis and codegen entirely and links the
+// existing object.
+//
+// Analysis is not serialized, so when any file changed the whole module is
+// analyzed again.
+//
+// The manifest and the objects are written to temporary files and renamed
+// into place, so that a build never reads a half written one. Builds that
+// share a cache dir also hold the lock file in it from cache_restore until
+// the manifest is written, see build_o in link.cpp.
+
+#include "analyze.hpp"
+#include "cache.hpp"
+#include "codegen.hpp"
+#include "config.h"
+#include "error.hpp"
+#include "os.hpp"
+#include "target.hpp"
+
+#include <inttypes.h>
+
+static uint64_t hash_bytes(uint64_t h, const char *ptr, size_t len) {
+    // FNV-1a 64-bit hash
+    for (size_t i = 0; i < len; i += 1) {
+        h = h ^ ((uint8_t)ptr[i]);
+        h = h * 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t cache_hash_buf(Buf *buf) {
+    return hash_bytes(14695981039346656037ULL, buf_ptr(buf), buf_len(buf));
+}
+
+// ZIG_VERSION_STRING stays the same when the compiler is rebuilt, so the
+// compiler binary identifies the code that produced an object as well. If it
+// cannot be found, objects of a rebuilt compiler may be reused.
+Buf *cache_compiler_id(void) {
+    static Buf *compiler_id = nullptr;
+    if (compiler_id != nullptr)
+        return compiler_id;
+
+    compiler_id = buf_sprintf("zig %s", ZIG_VERSION_STRING);
+    Buf self_exe_path = BUF_INIT;
+    uint64_t size;
+    uint64_t mtime;
+    if (!os_self_exe_path(&self_exe_path) && !os_file_size_and_mtime(&self_exe_path, &size, &mtime)) {
+        buf_appendf(compiler_id, " %s %" PRIu64 " %" PRIu64, buf_ptr(&self_exe_path), size, mtime);
+    }
+    buf_deinit(&self_exe_path);
+    return compiler_id;
+}
+
+static size_t package_index(ZigList<PackageTableEntry *> *packages, PackageTableEntry *pkg) {
+    for (size_t i = 0; i < packages->length; i += 1) {
+        if (packages->at(i) == pkg)
+            return i;
+    }
+    packages->append(pkg);
+    return packages->length - 1;
+}
+
+// Every package that imports can reach, numbered in the order they are found,
+// along with the names that each package maps to the others. Packages refer
+// to each other in cycles, for example through @root.
+static void append_packages(CodeGen *g, Buf *key, ZigList<PackageTableEntry *> *packages) {
+    package_index(packages, g->root_package);
+    for (size_t i = 0; i < packages->length; i += 1) {
+        PackageTableEntry *pkg = packages->at(i);
+        if (key)
+            buf_appendf(key, "pkg %zu %s %s\n", i, buf_ptr(&pkg->root_src_dir), buf_ptr(&pkg->root_src_path));
+        auto it = pkg->package_table.entry_iterator();
+        for (;;) {
+            auto *entry = it.next();
+            if (!entry)
+                break;
+            size_t index = package_index(packages, entry->value);
+            if (key)
+                buf_appendf(key, "pkg %zu %s -> %zu\n", i, buf_ptr(entry->key), index);
+        }
+    }
+}
+
+static uint64_t compute_cache_key(CodeGen *g) {
+    Buf *key = buf_alloc();
+    buf_appendf(key, "%s\n", buf_ptr(cache_compiler_id()));
+    buf_appendf(key, "target %s\n", buf_ptr(&g->triple_str));
+    buf_appendf(key, "cpu %s %s\n", buf_ptr(g->target_cpu), buf_ptr(g->target_features));
+    buf_appendf(key, "mode %d\n", (int)g->build_mode);
+    buf_appendf(key, "comptime_quota %zu\n", g->comptime_quota);
+    buf_appendf(key, "objects %zu %d\n", codegen_object_count(g), g->thin_lto);
+    buf_appendf(key, "out %d %s\n", (int)g->out_type, buf_ptr(g->root_out_name));
+    buf_appendf(key, "flags %d %d %d %d %d\n", g->strip_debug_symbols, g->is_static, g->is_test_build,
+            g->omit_zigrt, g->want_h_file);
+    buf_appendf(key, "std %s\n", buf_ptr(g->zig_std_dir));
+    ZigList<PackageTableEntry *> packages = {};
+    append_packages(g, key, &packages);
+    packages.deinit();
+    for (size_t i = 0; i < g->assembly_files.length; i += 1) {
+        buf_appendf(key, "asm %s\n", buf_ptr(g->assembly_files.at(i)));
+    }
+    if (g->want_h_file)
+        buf_appendf(key, "out_h %s\n", g->out_h_path ? buf_ptr(g->out_h_path) : "");
+    // the contents of the profile are a dependency
+    if (g->profile_use_path)
+        buf_appendf(key, "profile_use %s\n", buf_ptr(g->profile_use_path));
+    if (g->test_filter)
+        buf_appendf(key, "test_filter %s\n", buf_ptr(g->test_filter));
+    if (g->test_name_prefix)
+        buf_appendf(key, "test_name_prefix %s\n", buf_ptr(g->test_name_prefix));
+    if (g->compile_var_import)
+        buf_append_buf(key, g->compile_var_import->source_code);
+    return cache_hash_buf(key);
+}
+
+static Buf *cache_manifest_path(CodeGen *g) {
+    Buf *basename = buf_sprintf("%s.manifest", buf_ptr(g->root_out_name));
+    Buf *result = buf_alloc();
+    os_path_join(g->cache_dir, basename, result);
+    return result;
+}
+
+// the path of one of the codegen_object_count objects that make up the output
+Buf *cache_object_path(CodeGen *g, size_t index) {
+    Buf *o_basename = buf_create_from_buf(g->root_out_name);
+    if (codegen_object_count(g) > 1)
+        buf_appendf(o_basename, ".%zu", index);
+    buf_append_str(o_basename, target_o_file_ext(&g->zig_target));
+    Buf *result = buf_alloc();
+    os_path_join(g->cache_dir, o_basename, result);
+    return result;
+}
+
+void cache_add_dep(CodeGen *g, Buf *path, Buf *contents) {
+    g->cache_deps.append({path, cache_hash_buf(contents)});
+}
+
+static bool cache_miss(CodeGen *g, const char *reason) {
+    g->cache_miss_count += 1;
+    g->cache_miss_reason = reason;
+
+    // the object file is about to be overwritten; if this build fails the
+    // old manifest must not vouch for whatever is left behind
+    Buf *manifest_path = cache_manifest_path(g);
+    bool exists;
+    if (!os_file_exists(manifest_path, &exists) && exists)
+        os_delete_file(manifest_path);
+    return false;
+}
+
+static bool read_line(Buf *contents, size_t *index, Buf *out_line) {
+    size_t start = *index;
+    if (start >= buf_len(contents))
+        return false;
+    size_t end = start;
+    while (end < buf_len(contents) && buf_ptr(contents)[end] != '\n')
+        end += 1;
+    buf_init_from_mem(out_line, buf_ptr(contents) + start, end - start);
+    *index = end + 1;
+    return true;
+}
+
+static bool line_starts_with(Buf *line, const char *prefix) {
+    size_t len = strlen(prefix);
+    return buf_len(line) >= len && memcmp(buf_ptr(line), prefix, len) == 0;
+}
+
+// Returns true when the object file from a previous build was added to
+// link_objects and the build can skip straight to linking.
+bool cache_restore(CodeGen *g) {
+    g->cache_key = compute_cache_key(g);
+
+    // the user asked to see the output of every stage
+    if (g->verbose)
+        return false;
+
+    codegen_add_time_event(g, "Check Cache");
+
+    Buf *manifest = buf_alloc();
+    if (os_fetch_file_path(cache_manifest_path(g), manifest))
+        return cache_miss(g, "no manifest");
+
+    size_t index = 0;
+    Buf *line = buf_alloc();
+    if (!read_line(manifest, &index, line) || !buf_eql_buf(line, buf_sprintf("key %016" PRIx64, g->cache_key)))
+        return cache_miss(g, "compile options changed");
+
+    size_t object_count = codegen_object_count(g);
+    for (size_t i = 0; i < object_count; i += 1) {
+        bool object_exists;
+        if (os_file_exists(cache_object_path(g, i), &object_exists) || !object_exists)
+            return cache_miss(g, "object file missing");
+    }
+
+    ZigList<Buf *> lib_lines = {};
+    Buf *contents = buf_alloc();
+    while (read_line(manifest, &index, line)) {
+        if (line_starts_with(line, "dep ")) {
+            // dep <hash> <path>
+            if (buf_len(line) < 4 + 16 + 1)
+                return cache_miss(g, "corrupt manifest");
+            Buf *path = buf_create_from_mem(buf_ptr(line) + 4 + 16 + 1, buf_len(line) - (4 + 16 + 1));
+            uint64_t hash = strtoull(buf_ptr(line) + 4, nullptr, 16);
+            g->cache_files_checked += 1;
+            if (os_fetch_file_path(path, contents) || cache_hash_buf(contents) != hash)
+                return cache_miss(g, "source changed");
+        } else if (line_starts_with(line, "lib ")) {
+            lib_lines.append(buf_create_from_buf(line));
+        } else {
+            return cache_miss(g, "corrupt manifest");
+        }
+    }
+
+    // libraries that the cached code depends on through extern declarations
+    for (size_t i = 0; i < lib_lines.length; i += 1) {
+        // lib <name> [symbol]
+        Buf *lib_line = lib_lines.at(i);
+        char *name = buf_ptr(lib_line) + 4;
+        char *space = strchr(name, ' ');
+        if (space == nullptr) {
+            add_link_lib(g, buf_create_from_str(name));
+        } else {
+            add_link_lib_symbol(g, buf_create_from_mem(name, space - name), buf_create_from_str(space + 1));
+        }
+    }
+    lib_lines.deinit();
+
+    g->cache_hit_count += 1;
+    for (size_t i = 0; i < object_count; i += 1) {
+        g->link_objects.append(cache_object_path(g, i));
+    }
+    return true;
+}
+
+void cache_save(CodeGen *g) {
+    if (g->cache_disabled)
+        return;
+
+    Buf *manifest = buf_alloc();
+    buf_appendf(manifest, "key %016" PRIx64 "\n", g->cache_key);
+
+    auto it = g->import_table.entry_iterator();
+    for (;;) {
+        auto *entry = it.next();
+        if (!entry)
+            break;
+        ImportTableEntry *import = entry->value;
+        buf_appendf(manifest, "dep %016" PRIx64 " %s\n", cache_hash_buf(import->source_code),
+                buf_ptr(entry->key));
+    }
+    // the root file of a package that was never imported does not show up
+    // in the import table
+    ZigList<PackageTableEntry *> packages = {};
+    append_packages(g, nullptr, &packages);
+    for (size_t i = 0; i < packages.length; i += 1) {
+        PackageTableEntry *pkg = packages.at(i);
+        Buf *path = buf_alloc();
+        os_path_join(&pkg->root_src_dir, &pkg->root_src_path, path);
+        Buf contents = BUF_INIT;
+        if (!os_fetch_file_path(path, &contents))
+            cache_add_dep(g, path, &contents);
+        buf_deinit(&contents);
+    }
+    packages.deinit();
+
+    for (size_t i = 0; i < g->cache_deps.length; i += 1) {
+        CacheDep *dep = &g->cache_deps.at(i);
+        buf_appendf(manifest, "dep %016" PRIx64 " %s\n", dep->hash, buf_ptr(dep->path));
+    }
+
+    for (size_t i = 0; i < g->link_libs_list.length; i += 1) {
+        LinkLib *link_lib = g->link_libs_list.at(i);
+        buf_appendf(manifest, "lib %s\n", buf_ptr(link_lib->name));
+        for (size_t j = 0; j < link_lib->symbols.length; j += 1) {
+            buf_appendf(manifest, "lib %s %s\n", buf_ptr(link_lib->name), buf_ptr(link_lib->symbols.at(j)));
+        }
+    }
+
+    Buf *manifest_path = cache_manifest_path(g);
+    Buf *tmp_path = os_tmp_path_for(manifest_path);
+    os_write_file(tmp_path, manifest);
+    int err;
+    if ((err = os_rename(tmp_path, manifest_path)))
+        zig_panic("unable to rename %s: %s", buf_ptr(tmp_path), err_str(err));
+}
+
+static void print_cache_line(CodeGen *g, FILE *f) {
+    if (g->cache_hit_count + g->cache_miss_count == 0)
+        return;
+    fprintf(f, "%20s%12zu%12zu%12zu  %s\n", buf_ptr(g->root_out_name), g->cache_hit_count,
+            g->cache_miss_count, g->cache_files_checked, g->cache_miss_reason ? g->cache_miss_reason : "");
+}
+
+void cache_print_report(CodeGen *g, FILE *f) {
+    fprintf(f, "\n%20s%12s%12s%12s  %s\n", "Cache", "Hits", "Misses", "Checked", "Reason");
+    print_cache_line(g, f);
+    for (size_t i = 0; i < g->child_gens.length; i += 1) {
+        print_cache_line(g->child_gens.at(i), f);
+    }
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2017 Andrew Kelley
+ *
+ * This file is part of zig, which is MIT licensed.
+ * See http://opensource.org/licenses/MIT
+ */
+
+#ifndef ZIG_CACHE_HPP
+#define ZIG_CACHE_HPP
+
+#include "all_types.hpp"
+
+#include <stdio.h>
+
+uint64_t cache_hash_buf(Buf *buf);
+Buf *cache_compiler_id(void);
+Buf *cache_object_path(CodeGen *g, size_t index);
+void cache_add_dep(CodeGen *g, Buf *path, Buf *contents);
+bool cache_restore(CodeGen *g);
+void cache_save(CodeGen *g);
+void cache_print_report(CodeGen *g, FILE *f);
+
+#endif
@@ -7,12 +7,14 @@
 
 #include "analyze.hpp"
 #include "ast_render.hpp"
+#include "cache.hpp"
 #include "codegen.hpp"
 #include "config.h"
 #include "errmsg.hpp"
 #include "error.hpp"
 #include "hash_map.hpp"
 #include "ir.hpp"
+#include "ir_print.hpp"
 #include "link.hpp"
 #include "os.hpp"
 #include "parseh.hpp"
@@ -22,6 +24,11 @@
 #include <stdio.h>
 #include <errno.h>
 
+// how many backward branches a comptime evaluation may take before it is
+// assumed to loop forever, unless --comptime-quota or @setEvalBranchQuota
+// say otherwise
+static const size_t default_backward_branch_quota = 1000;
+
 static void init_darwin_native(CodeGen *g) {
     char *osx_target = getenv("MACOSX_DEPLOYMENT_TARGET");
     char *ios_target = getenv("IPHONEOS_DEPLOYMENT_TARGET");
@@ -60,8 +67,15 @@ CodeGen *codegen_create(Buf *root_src_path, const ZigTarget *target, OutType out
 
     codegen_add_time_event(g, "Initialize");
 
+    arena_init(&g->parse_arena, "Parse");
+    arena_init(&g->ir_arena, "IR");
+    arena_init(&g->const_val_arena, "Const Values");
+    arena_init(&g->type_arena, "Types");
+    g->ir_stats = allocate<IrInstructionStats>(1);
+
     g->build_mode = build_mode;
     g->out_type = out_type;
+    g->intern_table.init(1024);
     g->import_table.init(32);
     g->builtin_fn_table.init(32);
     g->primitive_type_table.init(32);
@@ -71,6 +85,8 @@ CodeGen *codegen_create(Buf *root_src_path, const ZigTarget *target, OutType out
     g->generic_table.init(16);
     g->llvm_fn_table.init(16);
     g->memoized_fn_eval_table.init(16);
+    g->comptime_call_sites.init(16);
+    g->comptime_quota = default_backward_branch_quota;
     g->exported_symbol_names.init(8);
     g->external_prototypes.init(8);
     g->is_test_build = false;
@@ -157,6 +173,65 @@ void codegen_set_omit_zigrt(CodeGen *g, bool omit_zigrt) {
     g->omit_zigrt = omit_zigrt;
 }
 
+void codegen_set_codegen_threads(CodeGen *g, size_t codegen_threads) {
+    g->codegen_threads = codegen_threads;
+}
+
+void codegen_set_thin_lto(CodeGen *g, bool thin_lto) {
+    g->thin_lto = thin_lto;
+}
+
+// dir may be null, in which case the profile is written to the working
+// directory of the instrumented executable
+void codegen_set_profile_generate(CodeGen *g, Buf *dir) {
+    Buf *basename = buf_create_from_str("default.profraw");
+    if (dir == nullptr) {
+        g->profile_generate_path = basename;
+    } else {
+        g->profile_generate_path = buf_alloc();
+        os_path_join(dir, basename, g->profile_generate_path);
+    }
+}
+
+// contents is what main read from path; the cached object depends on it
+void codegen_set_profile_use(CodeGen *g, Buf *path, Buf *contents) {
+    g->profile_use_path = path;
+    cache_add_dep(g, path, contents);
+}
+
+void codegen_set_analysis_threads(CodeGen *g, size_t analysis_threads) {
+    g->analysis_threads = analysis_threads;
+}
+
+void codegen_set_comptime_quota(CodeGen *g, size_t comptime_quota) {
+    g->comptime_quota = comptime_quota;
+}
+
+void codegen_set_comptime_report(CodeGen *g, bool comptime_report) {
+    g->comptime_report = comptime_report;
+}
+
+void codegen_set_free_ir(CodeGen *g, bool free_ir) {
+    g->free_ir = free_ir;
+}
+
+void codegen_set_target_cpu(CodeGen *g, Buf *cpu) {
+    g->target_cpu = cpu;
+}
+
+void codegen_set_target_features(CodeGen *g, Buf *features) {
+    g->target_features = features;
+}
+
+// Object outputs cannot be split since they are handed to the user as one
+// file; everything else goes through the linker. With ThinLTO the linker
+// does the codegen and parallelizes it itself.
+size_t codegen_object_count(CodeGen *g) {
+    if (g->out_type == OutTypeObj || g->thin_lto || g->codegen_threads <= 1)
+        return 1;
+    return g->codegen_threads;
+}
+
 void codegen_set_test_filter(CodeGen *g, Buf *filter) {
     g->test_filter = filter;
 }
@@ -299,6 +374,15 @@ static void addLLVMFnAttrStr(LLVMValueRef fn_val, const char *attr_name, const c
     return addLLVMAttrStr(fn_val, -1, attr_name, attr_val);
 }
 
+// The machine code of a module compiled with --lto=thin is generated by the
+// linker, which only learns the CPU and its features from these.
+static void add_target_fn_attrs(CodeGen *g, LLVMValueRef fn_val) {
+    if (buf_len(g->target_cpu) != 0)
+        addLLVMFnAttrStr(fn_val, "target-cpu", buf_ptr(g->target_cpu));
+    if (buf_len(g->target_features) != 0)
+        addLLVMFnAttrStr(fn_val, "target-features", buf_ptr(g->target_features));
+}
+
 static void addLLVMArgAttr(LLVMValueRef arg_val, unsigned param_index, const char *attr_name) {
     return addLLVMAttr(arg_val, param_index + 1, attr_name);
 }
@@ -428,7 +512,8 @@ static LLVMValueRef fn_llvm_value(CodeGen *g, FnTableEntry *fn_table_entry) {
     }
 
     if (fn_table_entry->body_node != nullptr) {
-        bool want_fn_safety = g->build_mode != BuildModeFastRelease && !fn_table_entry->def_scope->safety_off;
+        bool want_fn_safety = g->build_mode != BuildModeFastRelease &&
+            g->build_mode != BuildModeSmallRelease && !fn_table_entry->def_scope->safety_off;
         if (want_fn_safety) {
             if (g->libc_link_lib != nullptr) {
                 addLLVMFnAttr(fn_table_entry->llvm_value, "sspstrong");
@@ -438,6 +523,11 @@ static LLVMValueRef fn_llvm_value(CodeGen *g, FnTableEntry *fn_table_entry) {
     }
 
     addLLVMFnAttr(fn_table_entry->llvm_value, "nounwind");
+    add_target_fn_attrs(g, fn_table_entry->llvm_value);
+    if (g->build_mode == BuildModeSmallRelease) {
+        addLLVMFnAttr(fn_table_entry->llvm_value, "optsize");
+        addLLVMFnAttr(fn_table_entry->llvm_value, "minsize");
+    }
     if (g->build_mode == BuildModeDebug && fn_table_entry->fn_inline != FnInlineAlways) {
         ZigLLVMAddFunctionAttr(fn_table_entry->llvm_value, "no-frame-pointer-elim", "true");
         ZigLLVMAddFunctionAttr(fn_table_entry->llvm_value, "no-frame-pointer-elim-non-leaf", nullptr);
@@ -633,7 +723,7 @@ static bool ir_want_fast_math(CodeGen *g, IrInstruction *instruction) {
 }
 
 static bool ir_want_debug_safety(CodeGen *g, IrInstruction *instruction) {
-    if (g->build_mode == BuildModeFastRelease)
+    if (g->build_mode == BuildModeFastRelease || g->build_mode == BuildModeSmallRelease)
         return false;
 
     // TODO memoize
@@ -804,6 +894,7 @@ static LLVMValueRef get_safety_crash_err_fn(CodeGen *g) {
     LLVMSetLinkage(fn_val, LLVMInternalLinkage);
     LLVMSetFunctionCallConv(fn_val, LLVMFastCallConv);
     addLLVMFnAttr(fn_val, "nounwind");
+    add_target_fn_attrs(g, fn_val);
     if (g->build_mode == BuildModeDebug) {
         ZigLLVMAddFunctionAttr(fn_val, "no-frame-pointer-elim", "true");
         ZigLLVMAddFunctionAttr(fn_val, "no-frame-pointer-elim-non-leaf", nullptr);
@@ -1109,22 +1200,22 @@ static void gen_var_debug_decl(CodeGen *g, VariableTableEntry *var) {
 }
 
 static LLVMValueRef ir_llvm_value(CodeGen *g, IrInstruction *instruction) {
-    if (!type_has_bits(instruction->value.type))
+    if (!type_has_bits(instruction->value->type))
         return nullptr;
     if (!instruction->llvm_value) {
-        assert(instruction->value.special != ConstValSpecialRuntime);
-        assert(instruction->value.type);
-        render_const_val(g, &instruction->value);
+        assert(instruction->value->special != ConstValSpecialRuntime);
+        assert(instruction->value->type);
+        render_const_val(g, instruction->value);
         // we might have to do some pointer casting here due to the way union
         // values are rendered with a type other than the one we expect
-        if (handle_is_ptr(instruction->value.type)) {
-            render_const_val_global(g, &instruction->value, "");
-            TypeTableEntry *ptr_type = get_pointer_to_type(g, instruction->value.type, true);
-            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value.global_refs->llvm_global, ptr_type->type_ref, "");
-        } else if (instruction->value.type->id == TypeTableEntryIdPointer) {
-            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value.global_refs->llvm_value, instruction->value.type->type_ref, "");
+        if (handle_is_ptr(instruction->value->type)) {
+            render_const_val_global(g, instruction->value, "");
+            TypeTableEntry *ptr_type = get_pointer_to_type(g, instruction->value->type, true);
+            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value->global_refs->llvm_global, ptr_type->type_ref, "");
+        } else if (instruction->value->type->id == TypeTableEntryIdPointer) {
+            instruction->llvm_value = LLVMBuildBitCast(g->builder, instruction->value->global_refs->llvm_value, instruction->value->type->type_ref, "");
         } else {
-            instruction->llvm_value = instruction->value.global_refs->llvm_value;
+            instruction->llvm_value = instruction->value->global_refs->llvm_value;
         }
         assert(instruction->llvm_value);
     }
@@ -1133,7 +1224,7 @@ static LLVMValueRef ir_llvm_value(CodeGen *g, IrInstruction *instruction) {
 
 static LLVMValueRef ir_render_return(CodeGen *g, IrExecutable *executable, IrInstructionReturn *return_instruction) {
     LLVMValueRef value = ir_llvm_value(g, return_instruction->value);
-    TypeTableEntry *return_type = return_instruction->value->value.type;
+    TypeTableEntry *return_type = return_instruction->value->value->type;
     if (handle_is_ptr(return_type)) {
         if (calling_convention_does_first_arg_return(g->cur_fn->type_entry->data.fn.fn_type_id.cc)) {
             assert(g->cur_ret_ptr);
@@ -1404,8 +1495,8 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
     IrInstruction *op1 = bin_op_instruction->op1;
     IrInstruction *op2 = bin_op_instruction->op2;
 
-    assert(op1->value.type == op2->value.type);
-    TypeTableEntry *type_entry = op1->value.type;
+    assert(op1->value->type == op2->value->type);
+    TypeTableEntry *type_entry = op1->value->type;
 
     bool want_debug_safety = bin_op_instruction->safety_check_on &&
         ir_want_debug_safety(g, &bin_op_instruction->base);
@@ -1561,8 +1652,8 @@ static LLVMValueRef ir_render_bin_op(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionCast *cast_instruction)
 {
-    TypeTableEntry *actual_type = cast_instruction->value->value.type;
-    TypeTableEntry *wanted_type = cast_instruction->base.value.type;
+    TypeTableEntry *actual_type = cast_instruction->value->value->type;
+    TypeTableEntry *wanted_type = cast_instruction->base.value->type;
     LLVMValueRef expr_val = ir_llvm_value(g, cast_instruction->value);
     assert(expr_val);
 
@@ -1688,7 +1779,7 @@ static LLVMValueRef ir_render_cast(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_ptr_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionPtrCast *instruction)
 {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     LLVMValueRef ptr = ir_llvm_value(g, instruction->ptr);
     return LLVMBuildBitCast(g->builder, ptr, wanted_type->type_ref, "");
 }
@@ -1696,7 +1787,7 @@ static LLVMValueRef ir_render_ptr_cast(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_bit_cast(CodeGen *g, IrExecutable *executable,
         IrInstructionBitCast *instruction)
 {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     LLVMValueRef value = ir_llvm_value(g, instruction->value);
     return LLVMBuildBitCast(g->builder, value, wanted_type->type_ref, "");
 }
@@ -1704,7 +1795,7 @@ static LLVMValueRef ir_render_bit_cast(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_widen_or_shorten(CodeGen *g, IrExecutable *executable,
         IrInstructionWidenOrShorten *instruction)
 {
-    TypeTableEntry *actual_type = instruction->target->value.type;
+    TypeTableEntry *actual_type = instruction->target->value->type;
     // TODO instead of this logic, use the Noop instruction to change the type from
     // enum_tag to the underlying int type
     TypeTableEntry *int_type;
@@ -1717,23 +1808,23 @@ static LLVMValueRef ir_render_widen_or_shorten(CodeGen *g, IrExecutable *executa
     }
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     return gen_widen_or_shorten(g, ir_want_debug_safety(g, &instruction->base), int_type,
-            instruction->base.value.type, target_val);
+            instruction->base.value->type, target_val);
 }
 
 static LLVMValueRef ir_render_int_to_ptr(CodeGen *g, IrExecutable *executable, IrInstructionIntToPtr *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     return LLVMBuildIntToPtr(g->builder, target_val, wanted_type->type_ref, "");
 }
 
 static LLVMValueRef ir_render_ptr_to_int(CodeGen *g, IrExecutable *executable, IrInstructionPtrToInt *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     return LLVMBuildPtrToInt(g->builder, target_val, wanted_type->type_ref, "");
 }
 
 static LLVMValueRef ir_render_int_to_enum(CodeGen *g, IrExecutable *executable, IrInstructionIntToEnum *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     assert(wanted_type->id == TypeTableEntryIdEnum);
     TypeTableEntry *tag_type = wanted_type->data.enumeration.tag_type;
     TypeTableEntry *wanted_int_type;
@@ -1747,14 +1838,14 @@ static LLVMValueRef ir_render_int_to_enum(CodeGen *g, IrExecutable *executable,
 
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
     return gen_widen_or_shorten(g, ir_want_debug_safety(g, &instruction->base),
-            instruction->target->value.type, wanted_int_type, target_val);
+            instruction->target->value->type, wanted_int_type, target_val);
 }
 
 static LLVMValueRef ir_render_int_to_err(CodeGen *g, IrExecutable *executable, IrInstructionIntToErr *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     assert(wanted_type->id == TypeTableEntryIdPureError);
 
-    TypeTableEntry *actual_type = instruction->target->value.type;
+    TypeTableEntry *actual_type = instruction->target->value->type;
     assert(actual_type->id == TypeTableEntryIdInt);
     assert(!actual_type->data.integral.is_signed);
 
@@ -1788,11 +1879,11 @@ static LLVMValueRef ir_render_int_to_err(CodeGen *g, IrExecutable *executable, I
 }
 
 static LLVMValueRef ir_render_err_to_int(CodeGen *g, IrExecutable *executable, IrInstructionErrToInt *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
     assert(wanted_type->id == TypeTableEntryIdInt);
     assert(!wanted_type->data.integral.is_signed);
 
-    TypeTableEntry *actual_type = instruction->target->value.type;
+    TypeTableEntry *actual_type = instruction->target->value->type;
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
 
     if (actual_type->id == TypeTableEntryIdPureError) {
@@ -1839,7 +1930,7 @@ static LLVMValueRef ir_render_br(CodeGen *g, IrExecutable *executable, IrInstruc
 static LLVMValueRef ir_render_un_op(CodeGen *g, IrExecutable *executable, IrInstructionUnOp *un_op_instruction) {
     IrUnOp op_id = un_op_instruction->op_id;
     LLVMValueRef expr = ir_llvm_value(g, un_op_instruction->value);
-    TypeTableEntry *expr_type = un_op_instruction->value->value.type;
+    TypeTableEntry *expr_type = un_op_instruction->value->value->type;
 
     switch (op_id) {
         case IrUnOpInvalid:
@@ -1896,12 +1987,12 @@ static LLVMValueRef ir_render_decl_var(CodeGen *g, IrExecutable *executable,
 
     bool have_init_expr = false;
 
-    ConstExprValue *const_val = &init_value->value;
+    ConstExprValue *const_val = init_value->value;
     if (const_val->special == ConstValSpecialRuntime || const_val->special == ConstValSpecialStatic)
         have_init_expr = true;
 
     if (have_init_expr) {
-        assert(var->value->type == init_value->value.type);
+        assert(var->value->type == init_value->value->type);
         gen_assign_raw(g, var->value_ref, get_pointer_to_type(g, var->value->type, false),
                 ir_llvm_value(g, init_value));
     } else {
@@ -1936,12 +2027,12 @@ static LLVMValueRef ir_render_decl_var(CodeGen *g, IrExecutable *executable,
 }
 
 static LLVMValueRef ir_render_load_ptr(CodeGen *g, IrExecutable *executable, IrInstructionLoadPtr *instruction) {
-    TypeTableEntry *child_type = instruction->base.value.type;
+    TypeTableEntry *child_type = instruction->base.value->type;
     if (!type_has_bits(child_type))
         return nullptr;
 
     LLVMValueRef ptr = ir_llvm_value(g, instruction->ptr);
-    TypeTableEntry *ptr_type = instruction->ptr->value.type;
+    TypeTableEntry *ptr_type = instruction->ptr->value->type;
     assert(ptr_type->id == TypeTableEntryIdPointer);
     bool is_volatile = ptr_type->data.pointer.is_volatile;
 
@@ -1967,8 +2058,8 @@ static LLVMValueRef ir_render_store_ptr(CodeGen *g, IrExecutable *executable, Ir
     LLVMValueRef ptr = ir_llvm_value(g, instruction->ptr);
     LLVMValueRef value = ir_llvm_value(g, instruction->value);
 
-    assert(instruction->ptr->value.type->id == TypeTableEntryIdPointer);
-    TypeTableEntry *ptr_type = instruction->ptr->value.type;
+    assert(instruction->ptr->value->type->id == TypeTableEntryIdPointer);
+    TypeTableEntry *ptr_type = instruction->ptr->value->type;
 
     gen_assign_raw(g, ptr, ptr_type, value);
 
@@ -1987,7 +2078,7 @@ static LLVMValueRef ir_render_var_ptr(CodeGen *g, IrExecutable *executable, IrIn
 
 static LLVMValueRef ir_render_elem_ptr(CodeGen *g, IrExecutable *executable, IrInstructionElemPtr *instruction) {
     LLVMValueRef array_ptr_ptr = ir_llvm_value(g, instruction->array_ptr);
-    TypeTableEntry *array_ptr_type = instruction->array_ptr->value.type;
+    TypeTableEntry *array_ptr_type = instruction->array_ptr->value->type;
     assert(array_ptr_type->id == TypeTableEntryIdPointer);
     bool is_volatile = array_ptr_type->data.pointer.is_volatile;
     TypeTableEntry *array_type = array_ptr_type->data.pointer.child_type;
@@ -2013,7 +2104,7 @@ static LLVMValueRef ir_render_elem_ptr(CodeGen *g, IrExecutable *executable, IrI
         if (child_type->id == TypeTableEntryIdStruct &&
             child_type->data.structure.layout == ContainerLayoutPacked)
         {
-            size_t unaligned_bit_count = instruction->base.value.type->data.pointer.unaligned_bit_count;
+            size_t unaligned_bit_count = instruction->base.value->type->data.pointer.unaligned_bit_count;
             if (unaligned_bit_count != 0) {
                 LLVMTypeRef ptr_u8_type_ref = LLVMPointerType(LLVMInt8Type(), 0);
                 LLVMValueRef u8_array_ptr = LLVMBuildBitCast(g->builder, array_ptr, ptr_u8_type_ref, "");
@@ -2071,7 +2162,7 @@ static LLVMValueRef ir_render_call(CodeGen *g, IrExecutable *executable, IrInstr
     } else {
         assert(instruction->fn_ref);
         fn_val = ir_llvm_value(g, instruction->fn_ref);
-        fn_type = instruction->fn_ref->value.type;
+        fn_type = instruction->fn_ref->value->type;
     }
 
     FnTypeId *fn_type_id = &fn_type->data.fn.fn_type_id;
@@ -2088,7 +2179,7 @@ static LLVMValueRef ir_render_call(CodeGen *g, IrExecutable *executable, IrInstr
     }
     for (size_t call_i = 0; call_i < instruction->arg_count; call_i += 1) {
         IrInstruction *param_instruction = instruction->args[call_i];
-        TypeTableEntry *param_type = param_instruction->value.type;
+        TypeTableEntry *param_type = param_instruction->value->type;
         if (is_var_args || type_has_bits(param_type)) {
             LLVMValueRef param_value = ir_llvm_value(g, param_instruction);
             assert(param_value);
@@ -2127,7 +2218,7 @@ static LLVMValueRef ir_render_struct_field_ptr(CodeGen *g, IrExecutable *executa
 {
     LLVMValueRef struct_ptr = ir_llvm_value(g, instruction->struct_ptr);
     // not necessarily a pointer. could be TypeTableEntryIdStruct
-    TypeTableEntry *struct_ptr_type = instruction->struct_ptr->value.type;
+    TypeTableEntry *struct_ptr_type = instruction->struct_ptr->value->type;
     TypeStructField *field = instruction->field;
 
     if (!type_has_bits(field->type_entry))
@@ -2261,7 +2352,7 @@ static LLVMValueRef ir_render_asm(CodeGen *g, IrExecutable *executable, IrInstru
             buf_append_char(&constraint_buf, ',');
         }
 
-        param_types[param_index] = ir_input->value.type->type_ref;
+        param_types[param_index] = ir_input->value->type->type_ref;
         param_values[param_index] = ir_llvm_value(g, ir_input);
     }
     for (size_t i = 0; i < asm_expr->clobber_list.length; i += 1, total_index += 1) {
@@ -2276,7 +2367,7 @@ static LLVMValueRef ir_render_asm(CodeGen *g, IrExecutable *executable, IrInstru
     if (instruction->return_count == 0) {
         ret_type = LLVMVoidType();
     } else {
-        ret_type = instruction->base.value.type->type_ref;
+        ret_type = instruction->base.value->type->type_ref;
     }
     LLVMTypeRef function_type = LLVMFunctionType(ret_type, param_types, (unsigned)input_and_output_count, false);
 
@@ -2306,13 +2397,13 @@ static LLVMValueRef gen_non_null_bit(CodeGen *g, TypeTableEntry *maybe_type, LLV
 static LLVMValueRef ir_render_test_non_null(CodeGen *g, IrExecutable *executable,
     IrInstructionTestNonNull *instruction)
 {
-    return gen_non_null_bit(g, instruction->value->value.type, ir_llvm_value(g, instruction->value));
+    return gen_non_null_bit(g, instruction->value->value->type, ir_llvm_value(g, instruction->value));
 }
 
 static LLVMValueRef ir_render_unwrap_maybe(CodeGen *g, IrExecutable *executable,
         IrInstructionUnwrapMaybe *instruction)
 {
-    TypeTableEntry *ptr_type = instruction->value->value.type;
+    TypeTableEntry *ptr_type = instruction->value->value->type;
     assert(ptr_type->id == TypeTableEntryIdPointer);
     bool is_volatile = ptr_type->data.pointer.is_volatile;
     TypeTableEntry *maybe_type = ptr_type->data.pointer.child_type;
@@ -2376,7 +2467,7 @@ static LLVMValueRef get_int_builtin_fn(CodeGen *g, TypeTableEntry *int_type, Bui
 }
 
 static LLVMValueRef ir_render_clz(CodeGen *g, IrExecutable *executable, IrInstructionClz *instruction) {
-    TypeTableEntry *int_type = instruction->base.value.type;
+    TypeTableEntry *int_type = instruction->base.value->type;
     LLVMValueRef fn_val = get_int_builtin_fn(g, int_type, BuiltinFnIdClz);
     LLVMValueRef operand = ir_llvm_value(g, instruction->value);
     LLVMValueRef params[] {
@@ -2387,7 +2478,7 @@ static LLVMValueRef ir_render_clz(CodeGen *g, IrExecutable *executable, IrInstru
 }
 
 static LLVMValueRef ir_render_ctz(CodeGen *g, IrExecutable *executable, IrInstructionCtz *instruction) {
-    TypeTableEntry *int_type = instruction->base.value.type;
+    TypeTableEntry *int_type = instruction->base.value->type;
     LLVMValueRef fn_val = get_int_builtin_fn(g, int_type, BuiltinFnIdCtz);
     LLVMValueRef operand = ir_llvm_value(g, instruction->value);
     LLVMValueRef params[] {
@@ -2410,14 +2501,14 @@ static LLVMValueRef ir_render_switch_br(CodeGen *g, IrExecutable *executable, Ir
 }
 
 static LLVMValueRef ir_render_phi(CodeGen *g, IrExecutable *executable, IrInstructionPhi *instruction) {
-    if (!type_has_bits(instruction->base.value.type))
+    if (!type_has_bits(instruction->base.value->type))
         return nullptr;
 
     LLVMTypeRef phi_type;
-    if (handle_is_ptr(instruction->base.value.type)) {
-        phi_type = LLVMPointerType(instruction->base.value.type->type_ref, 0);
+    if (handle_is_ptr(instruction->base.value->type)) {
+        phi_type = LLVMPointerType(instruction->base.value->type->type_ref, 0);
     } else {
-        phi_type = instruction->base.value.type->type_ref;
+        phi_type = instruction->base.value->type->type_ref;
     }
 
     LLVMValueRef phi = LLVMBuildPhi(g->builder, phi_type, "");
@@ -2433,7 +2524,7 @@ static LLVMValueRef ir_render_phi(CodeGen *g, IrExecutable *executable, IrInstru
 
 static LLVMValueRef ir_render_ref(CodeGen *g, IrExecutable *executable, IrInstructionRef *instruction) {
     LLVMValueRef value = ir_llvm_value(g, instruction->value);
-    if (handle_is_ptr(instruction->value->value.type)) {
+    if (handle_is_ptr(instruction->value->value->type)) {
         return value;
     } else {
         assert(instruction->tmp_ptr);
@@ -2467,7 +2558,7 @@ static LLVMValueRef ir_render_err_name(CodeGen *g, IrExecutable *executable, IrI
 static LLVMValueRef ir_render_enum_tag_name(CodeGen *g, IrExecutable *executable,
         IrInstructionEnumTagName *instruction)
 {
-    TypeTableEntry *enum_tag_type = instruction->target->value.type;
+    TypeTableEntry *enum_tag_type = instruction->target->value->type;
     assert(enum_tag_type->data.enum_tag.generate_name_table);
 
     LLVMValueRef enum_tag_value = ir_llvm_value(g, instruction->target);
@@ -2489,7 +2580,7 @@ static LLVMValueRef ir_render_enum_tag_name(CodeGen *g, IrExecutable *executable
 static LLVMValueRef ir_render_field_parent_ptr(CodeGen *g, IrExecutable *executable,
         IrInstructionFieldParentPtr *instruction)
 {
-    TypeTableEntry *container_ptr_type = instruction->base.value.type;
+    TypeTableEntry *container_ptr_type = instruction->base.value->type;
     assert(container_ptr_type->id == TypeTableEntryIdPointer);
 
     TypeTableEntry *container_type = container_ptr_type->data.pointer.child_type;
@@ -2549,8 +2640,8 @@ static LLVMValueRef ir_render_fence(CodeGen *g, IrExecutable *executable, IrInst
 
 static LLVMValueRef ir_render_truncate(CodeGen *g, IrExecutable *executable, IrInstructionTruncate *instruction) {
     LLVMValueRef target_val = ir_llvm_value(g, instruction->target);
-    TypeTableEntry *dest_type = instruction->base.value.type;
-    TypeTableEntry *src_type = instruction->target->value.type;
+    TypeTableEntry *dest_type = instruction->base.value->type;
+    TypeTableEntry *src_type = instruction->target->value->type;
     if (dest_type == src_type) {
         // no-op
         return target_val;
@@ -2571,7 +2662,7 @@ static LLVMValueRef ir_render_memset(CodeGen *g, IrExecutable *executable, IrIns
 
     LLVMValueRef dest_ptr_casted = LLVMBuildBitCast(g->builder, dest_ptr, ptr_u8, "");
 
-    TypeTableEntry *ptr_type = instruction->dest_ptr->value.type;
+    TypeTableEntry *ptr_type = instruction->dest_ptr->value->type;
     assert(ptr_type->id == TypeTableEntryIdPointer);
 
     LLVMValueRef is_volatile = ptr_type->data.pointer.is_volatile ?
@@ -2599,8 +2690,8 @@ static LLVMValueRef ir_render_memcpy(CodeGen *g, IrExecutable *executable, IrIns
     LLVMValueRef dest_ptr_casted = LLVMBuildBitCast(g->builder, dest_ptr, ptr_u8, "");
     LLVMValueRef src_ptr_casted = LLVMBuildBitCast(g->builder, src_ptr, ptr_u8, "");
 
-    TypeTableEntry *dest_ptr_type = instruction->dest_ptr->value.type;
-    TypeTableEntry *src_ptr_type = instruction->src_ptr->value.type;
+    TypeTableEntry *dest_ptr_type = instruction->dest_ptr->value->type;
+    TypeTableEntry *src_ptr_type = instruction->src_ptr->value->type;
 
     assert(dest_ptr_type->id == TypeTableEntryIdPointer);
     assert(src_ptr_type->id == TypeTableEntryIdPointer);
@@ -2624,7 +2715,7 @@ static LLVMValueRef ir_render_slice(CodeGen *g, IrExecutable *executable, IrInst
     assert(instruction->tmp_ptr);
 
     LLVMValueRef array_ptr_ptr = ir_llvm_value(g, instruction->ptr);
-    TypeTableEntry *array_ptr_type = instruction->ptr->value.type;
+    TypeTableEntry *array_ptr_type = instruction->ptr->value->type;
     assert(array_ptr_type->id == TypeTableEntryIdPointer);
     bool is_volatile = array_ptr_type->data.pointer.is_volatile;
     TypeTableEntry *array_type = array_ptr_type->data.pointer.child_type;
@@ -2810,7 +2901,7 @@ static LLVMValueRef ir_render_overflow_op(CodeGen *g, IrExecutable *executable,
 }
 
 static LLVMValueRef ir_render_test_err(CodeGen *g, IrExecutable *executable, IrInstructionTestErr *instruction) {
-    TypeTableEntry *err_union_type = instruction->value->value.type;
+    TypeTableEntry *err_union_type = instruction->value->value->type;
     TypeTableEntry *child_type = err_union_type->data.error.child_type;
     LLVMValueRef err_union_handle = ir_llvm_value(g, instruction->value);
 
@@ -2827,7 +2918,7 @@ static LLVMValueRef ir_render_test_err(CodeGen *g, IrExecutable *executable, IrI
 }
 
 static LLVMValueRef ir_render_unwrap_err_code(CodeGen *g, IrExecutable *executable, IrInstructionUnwrapErrCode *instruction) {
-    TypeTableEntry *ptr_type = instruction->value->value.type;
+    TypeTableEntry *ptr_type = instruction->value->value->type;
     assert(ptr_type->id == TypeTableEntryIdPointer);
     bool is_volatile = ptr_type->data.pointer.is_volatile;
     TypeTableEntry *err_union_type = ptr_type->data.pointer.child_type;
@@ -2844,7 +2935,7 @@ static LLVMValueRef ir_render_unwrap_err_code(CodeGen *g, IrExecutable *executab
 }
 
 static LLVMValueRef ir_render_unwrap_err_payload(CodeGen *g, IrExecutable *executable, IrInstructionUnwrapErrPayload *instruction) {
-    TypeTableEntry *ptr_type = instruction->value->value.type;
+    TypeTableEntry *ptr_type = instruction->value->value->type;
     assert(ptr_type->id == TypeTableEntryIdPointer);
     bool is_volatile = ptr_type->data.pointer.is_volatile;
     TypeTableEntry *err_union_type = ptr_type->data.pointer.child_type;
@@ -2880,7 +2971,7 @@ static LLVMValueRef ir_render_unwrap_err_payload(CodeGen *g, IrExecutable *execu
 }
 
 static LLVMValueRef ir_render_maybe_wrap(CodeGen *g, IrExecutable *executable, IrInstructionMaybeWrap *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
 
     assert(wanted_type->id == TypeTableEntryIdMaybe);
 
@@ -2900,7 +2991,7 @@ static LLVMValueRef ir_render_maybe_wrap(CodeGen *g, IrExecutable *executable, I
     assert(instruction->tmp_ptr);
 
     LLVMValueRef val_ptr = LLVMBuildStructGEP(g->builder, instruction->tmp_ptr, maybe_child_index, "");
-    // child_type and instruction->value->value.type may differ by constness
+    // child_type and instruction->value->value->type may differ by constness
     gen_assign_raw(g, val_ptr, get_pointer_to_type(g, child_type, false), payload_val);
     LLVMValueRef maybe_ptr = LLVMBuildStructGEP(g->builder, instruction->tmp_ptr, maybe_null_index, "");
     LLVMBuildStore(g->builder, LLVMConstAllOnes(LLVMInt1Type()), maybe_ptr);
@@ -2909,7 +3000,7 @@ static LLVMValueRef ir_render_maybe_wrap(CodeGen *g, IrExecutable *executable, I
 }
 
 static LLVMValueRef ir_render_err_wrap_code(CodeGen *g, IrExecutable *executable, IrInstructionErrWrapCode *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
 
     assert(wanted_type->id == TypeTableEntryIdErrorUnion);
 
@@ -2928,7 +3019,7 @@ static LLVMValueRef ir_render_err_wrap_code(CodeGen *g, IrExecutable *executable
 }
 
 static LLVMValueRef ir_render_err_wrap_payload(CodeGen *g, IrExecutable *executable, IrInstructionErrWrapPayload *instruction) {
-    TypeTableEntry *wanted_type = instruction->base.value.type;
+    TypeTableEntry *wanted_type = instruction->base.value->type;
 
     assert(wanted_type->id == TypeTableEntryIdErrorUnion);
 
@@ -2953,7 +3044,7 @@ static LLVMValueRef ir_render_err_wrap_payload(CodeGen *g, IrExecutable *executa
 }
 
 static LLVMValueRef ir_render_enum_tag(CodeGen *g, IrExecutable *executable, IrInstructionEnumTag *instruction) {
-    TypeTableEntry *enum_type = instruction->value->value.type;
+    TypeTableEntry *enum_type = instruction->value->value->type;
     TypeTableEntry *tag_type = enum_type->data.enumeration.tag_type;
     if (!type_has_bits(tag_type))
         return nullptr;
@@ -3016,7 +3107,7 @@ static LLVMValueRef ir_render_struct_init(CodeGen *g, IrExecutable *executable,
 static LLVMValueRef ir_render_container_init_list(CodeGen *g, IrExecutable *executable,
         IrInstructionContainerInitList *instruction)
 {
-    TypeTableEntry *array_type = instruction->base.value.type;
+    TypeTableEntry *array_type = instruction->base.value->type;
     assert(array_type->id == TypeTableEntryIdArray);
     LLVMValueRef tmp_array_ptr = instruction->tmp_ptr;
     assert(tmp_array_ptr);
@@ -3097,6 +3188,7 @@ static LLVMValueRef ir_render_instruction(CodeGen *g, IrExecutable *executable,
         case IrInstructionIdSwitchVar:
         case IrInstructionIdOffsetOf:
         case IrInstructionIdTypeId:
+        case IrInstructionIdSetEvalBranchQuota:
             zig_unreachable();
         case IrInstructionIdReturn:
             return ir_render_return(g, executable, (IrInstructionReturn *)instruction);
@@ -3253,8 +3345,7 @@ static LLVMValueRef gen_parent_ptr(CodeGen *g, ConstExprValue *val, ConstParent
 }
 
 static LLVMValueRef gen_const_ptr_array_recursive(CodeGen *g, ConstExprValue *array_const_val, size_t index) {
-    expand_undef_array(g, array_const_val);
-    ConstParent *parent = &array_const_val->data.x_array.s_none.parent;
+    ConstParent *parent = &array_const_val->data.x_array.parent;
     LLVMValueRef base_ptr = gen_parent_ptr(g, array_const_val, parent);
 
     TypeTableEntry *usize = g->builtin_types.entry_usize;
@@ -3488,12 +3579,23 @@ static LLVMValueRef gen_const_val(CodeGen *g, ConstExprValue *const_val) {
                 uint64_t len = type_entry->data.array.len;
                 if (const_val->data.x_array.special == ConstArraySpecialUndef) {
                     return LLVMGetUndef(type_entry->type_ref);
+                } else if (const_val->data.x_array.special == ConstArraySpecialBuf) {
+                    Buf *buf = const_val->data.x_array.s_buf;
+                    return LLVMConstString(buf_ptr(buf), (unsigned)buf_len(buf), true);
                 }
 
                 LLVMValueRef *values = allocate<LLVMValueRef>(len);
-                for (uint64_t i = 0; i < len; i += 1) {
-                    ConstExprValue *elem_value = &const_val->data.x_array.s_none.elements[i];
-                    values[i] = gen_const_val(g, elem_value);
+                if (const_val->data.x_array.special == ConstArraySpecialDense) {
+                    ConstExprValue elem_value = {};
+                    for (uint64_t i = 0; i < len; i += 1) {
+                        dense_const_array_get(const_val, i, &elem_value);
+                        values[i] = gen_const_val(g, &elem_value);
+                    }
+                } else {
+                    for (uint64_t i = 0; i < len; i += 1) {
+                        ConstExprValue *elem_value = &const_val->data.x_array.s_none.elements[i];
+                        values[i] = gen_const_val(g, elem_value);
+                    }
                 }
                 return LLVMConstArray(LLVMTypeOf(values[0]), values, (unsigned)len);
             }
@@ -3801,8 +3903,8 @@ static void gen_global_var(CodeGen *g, VariableTableEntry *var, LLVMValueRef ini
     assert(import);
 
     bool is_local_to_unit = true;
-    ZigLLVMCreateGlobalVariable(g->dbuilder, get_di_scope(g, var->parent_scope), buf_ptr(&var->name),
-        buf_ptr(&var->name), import->di_file,
+    ZigLLVMCreateGlobalVariable(g->dbuilder, get_di_scope(g, var->parent_scope), buf_ptr(var->name),
+        buf_ptr(var->name), import->di_file,
         (unsigned)(var->decl_node->line + 1),
         type_entry->di_type, is_local_to_unit);
     // TODO ^^ make an actual global variable
@@ -3827,6 +3929,9 @@ static void report_errors_and_maybe_exit(CodeGen *g) {
             ErrorMsg *err = g->errors.at(i);
             print_err_msg(err, g->err_color);
         }
+        // the report is most useful when a comptime evaluation ran out of quota
+        if (g->comptime_report)
+            codegen_print_comptime_report(g, stderr);
         exit(1);
     }
 }
@@ -3842,6 +3947,27 @@ static void validate_inline_fns(CodeGen *g) {
     report_errors_and_maybe_exit(g);
 }
 
+// Nothing reads the IR once the function bodies have been rendered, so with
+// --free-ir it is gone before LLVM emits the object file, which is when the
+// most memory is needed. A function's analyzed IR cannot go as soon as the
+// function has been rendered: comptime values of other functions, such as
+// the comptime arguments of generic instances, can point into it.
+static void free_rendered_ir(CodeGen *g) {
+    for (size_t fn_i = 0; fn_i < g->fn_defs.length; fn_i += 1) {
+        FnTableEntry *fn_table_entry = g->fn_defs.at(fn_i);
+        IrExecutable *executable = &fn_table_entry->analyzed_executable;
+        for (size_t block_i = 0; block_i < executable->basic_block_list.length; block_i += 1) {
+            executable->basic_block_list.at(block_i)->instruction_list.deinit();
+        }
+        executable->basic_block_list.deinit();
+        executable->basic_block_list = {};
+        fn_table_entry->alloca_list.deinit();
+        fn_table_entry->alloca_list = {};
+    }
+    g->ir_bytes_freed = g->ir_arena.bytes_reserved;
+    arena_deinit(&g->ir_arena);
+}
+
 static void do_code_gen(CodeGen *g) {
     if (g->verbose) {
         fprintf(stderr, "\nCode Generation:\n");
@@ -3889,7 +4015,7 @@ static void do_code_gen(CodeGen *g) {
 
         LLVMValueRef global_value;
         if (var->linkage == VarLinkageExternal) {
-            global_value = LLVMAddGlobal(g->module, var->value->type->type_ref, buf_ptr(&var->name));
+            global_value = LLVMAddGlobal(g->module, var->value->type->type_ref, buf_ptr(var->name));
 
             // TODO debug info for the extern variable
 
@@ -3897,7 +4023,7 @@ static void do_code_gen(CodeGen *g) {
         } else {
             bool exported = (var->linkage == VarLinkageExport);
             render_const_val(g, var->value);
-            render_const_val_global(g, var->value, buf_ptr(get_mangled_name(g, &var->name, exported)));
+            render_const_val_global(g, var->value, buf_ptr(get_mangled_name(g, var->name, exported)));
             global_value = var->value->global_refs->llvm_global;
 
             if (exported) {
@@ -3991,15 +4117,15 @@ static void do_code_gen(CodeGen *g) {
         for (size_t alloca_i = 0; alloca_i < fn_table_entry->alloca_list.length; alloca_i += 1) {
             IrInstruction *instruction = fn_table_entry->alloca_list.at(alloca_i);
             LLVMValueRef *slot;
-            TypeTableEntry *slot_type = instruction->value.type;
+            TypeTableEntry *slot_type = instruction->value->type;
             if (instruction->id == IrInstructionIdCast) {
                 IrInstructionCast *cast_instruction = (IrInstructionCast *)instruction;
                 slot = &cast_instruction->tmp_ptr;
             } else if (instruction->id == IrInstructionIdRef) {
                 IrInstructionRef *ref_instruction = (IrInstructionRef *)instruction;
                 slot = &ref_instruction->tmp_ptr;
-                assert(instruction->value.type->id == TypeTableEntryIdPointer);
-                slot_type = instruction->value.type->data.pointer.child_type;
+                assert(instruction->value->type->id == TypeTableEntryIdPointer);
+                slot_type = instruction->value->type->data.pointer.child_type;
             } else if (instruction->id == IrInstructionIdContainerInitList) {
                 IrInstructionContainerInitList *container_init_list_instruction = (IrInstructionContainerInitList *)instruction;
                 slot = &container_init_list_instruction->tmp_ptr;
@@ -4045,10 +4171,10 @@ static void do_code_gen(CodeGen *g) {
                 continue;
 
             if (var->src_arg_index == SIZE_MAX) {
-                var->value_ref = build_alloca(g, var->value->type, buf_ptr(&var->name));
+                var->value_ref = build_alloca(g, var->value->type, buf_ptr(var->name));
 
                 var->di_loc_var = ZigLLVMCreateAutoVariable(g->dbuilder, get_di_scope(g, var->parent_scope),
-                        buf_ptr(&var->name), import->di_file, (unsigned)(var->decl_node->line + 1),
+                        buf_ptr(var->name), import->di_file, (unsigned)(var->decl_node->line + 1),
                         var->value->type->di_type, !g->strip_debug_symbols, 0);
 
             } else {
@@ -4065,11 +4191,11 @@ static void do_code_gen(CodeGen *g) {
                     var->value_ref = LLVMGetParam(fn, (unsigned)var->gen_arg_index);
                 } else {
                     gen_type = var->value->type;
-                    var->value_ref = build_alloca(g, var->value->type, buf_ptr(&var->name));
+                    var->value_ref = build_alloca(g, var->value->type, buf_ptr(var->name));
                 }
                 if (var->decl_node) {
                     var->di_loc_var = ZigLLVMCreateParameterVariable(g->dbuilder, get_di_scope(g, var->parent_scope),
-                            buf_ptr(&var->name), import->di_file,
+                            buf_ptr(var->name), import->di_file,
                             (unsigned)(var->decl_node->line + 1),
                             gen_type->di_type, !g->strip_debug_symbols, 0, (unsigned)(var->gen_arg_index + 1));
                 }
@@ -4109,6 +4235,9 @@ static void do_code_gen(CodeGen *g) {
     }
     assert(!g->errors.length);
 
+    if (g->free_ir)
+        free_rendered_ir(g);
+
     if (buf_len(&g->global_asm) != 0) {
         LLVMSetModuleInlineAsm(g->module, buf_ptr(&g->global_asm));
     }
@@ -4129,21 +4258,35 @@ static void do_code_gen(CodeGen *g) {
     codegen_add_time_event(g, "LLVM Emit Object");
 
     char *err_msg = nullptr;
-    Buf *o_basename = buf_create_from_buf(g->root_out_name);
-    const char *o_ext = target_o_file_ext(&g->zig_target);
-    buf_append_str(o_basename, o_ext);
-    Buf *output_path = buf_alloc();
-    os_path_join(g->cache_dir, o_basename, output_path);
+    size_t object_count = codegen_object_count(g);
+    // the objects are written next to their final paths and renamed into
+    // place, so that no build ever links a half written object
+    const char **output_paths = allocate<const char *>(object_count);
+    for (size_t i = 0; i < object_count; i += 1) {
+        output_paths[i] = buf_ptr(os_tmp_path_for(cache_object_path(g, i)));
+    }
     ensure_cache_dir(g);
-    if (ZigLLVMTargetMachineEmitToFile(g->target_machine, g->module, buf_ptr(output_path),
-                LLVMObjectFile, &err_msg, g->build_mode == BuildModeDebug))
+    const char *profile_generate_path = (g->profile_generate_path == nullptr) ?
+        nullptr : buf_ptr(g->profile_generate_path);
+    const char *profile_use_path = (g->profile_use_path == nullptr) ? nullptr : buf_ptr(g->profile_use_path);
+    if (ZigLLVMTargetMachineEmitToFiles(g->target_machine, g->module, output_paths, object_count,
+                LLVMObjectFile, &err_msg, g->build_mode == BuildModeDebug,
+                g->build_mode == BuildModeSmallRelease, g->thin_lto,
+                profile_generate_path, profile_use_path))
     {
         zig_panic("unable to write object file: %s", err_msg);
     }
 
     validate_inline_fns(g);
 
-    g->link_objects.append(output_path);
+    for (size_t i = 0; i < object_count; i += 1) {
+        Buf *object_path = cache_object_path(g, i);
+        int err;
+        if ((err = os_rename(buf_create_from_str(output_paths[i]), object_path))) {
+            zig_panic("unable to rename object file into place: %s", err_str(err));
+        }
+        g->link_objects.append(object_path);
+    }
 }
 
 static const uint8_t int_sizes_in_bits[] = {
@@ -4187,53 +4330,53 @@ static const GlobalLinkageValue global_linkage_values[] = {
 static void define_builtin_types(CodeGen *g) {
     {
         // if this type is anywhere in the AST, we should never hit codegen.
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdInvalid);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdInvalid);
         buf_init_from_str(&entry->name, "(invalid)");
         entry->zero_bits = true;
         g->builtin_types.entry_invalid = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdNamespace);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdNamespace);
         buf_init_from_str(&entry->name, "(namespace)");
         entry->zero_bits = true;
         g->builtin_types.entry_namespace = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdBlock);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdBlock);
         buf_init_from_str(&entry->name, "(block)");
         entry->zero_bits = true;
         g->builtin_types.entry_block = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdNumLitFloat);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdNumLitFloat);
         buf_init_from_str(&entry->name, "(float literal)");
         entry->zero_bits = true;
         g->builtin_types.entry_num_lit_float = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdNumLitInt);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdNumLitInt);
         buf_init_from_str(&entry->name, "(integer literal)");
         entry->zero_bits = true;
         g->builtin_types.entry_num_lit_int = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdUndefLit);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdUndefLit);
         buf_init_from_str(&entry->name, "(undefined)");
         g->builtin_types.entry_undef = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdNullLit);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdNullLit);
         buf_init_from_str(&entry->name, "(null)");
         entry->zero_bits = true;
         g->builtin_types.entry_null = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdVar);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdVar);
         buf_init_from_str(&entry->name, "(var)");
         g->builtin_types.entry_var = entry;
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdArgTuple);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdArgTuple);
         buf_init_from_str(&entry->name, "(args)");
         entry->zero_bits = true;
         g->builtin_types.entry_arg_tuple = entry;
@@ -4244,7 +4387,7 @@ static void define_builtin_types(CodeGen *g) {
         for (size_t is_sign_i = 0; is_sign_i < array_length(is_signed_list); is_sign_i += 1) {
             bool is_signed = is_signed_list[is_sign_i];
             TypeTableEntry *entry = make_int_type(g, is_signed, size_in_bits);
-            g->primitive_type_table.put(&entry->name, entry);
+            g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
             get_int_type_ptr(g, is_signed, size_in_bits)[0] = entry;
         }
     }
@@ -4254,7 +4397,7 @@ static void define_builtin_types(CodeGen *g) {
         uint32_t size_in_bits = target_c_type_size_in_bits(&g->zig_target, info->id);
         bool is_signed = info->is_signed;
 
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdInt);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdInt);
         entry->type_ref = LLVMIntType(size_in_bits);
 
         buf_init_from_str(&entry->name, info->name);
@@ -4265,13 +4408,13 @@ static void define_builtin_types(CodeGen *g) {
                 is_signed ? ZigLLVMEncoding_DW_ATE_signed() : ZigLLVMEncoding_DW_ATE_unsigned());
         entry->data.integral.is_signed = is_signed;
         entry->data.integral.bit_count = size_in_bits;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
 
         get_c_int_type_ptr(g, info->id)[0] = entry;
     }
 
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdBool);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdBool);
         entry->type_ref = LLVMInt1Type();
         buf_init_from_str(&entry->name, "bool");
         uint64_t debug_size_in_bits = 8*LLVMStoreSizeOfType(g->target_data_ref, entry->type_ref);
@@ -4279,13 +4422,13 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_boolean());
         g->builtin_types.entry_bool = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
 
     for (size_t sign_i = 0; sign_i < array_length(is_signed_list); sign_i += 1) {
         bool is_signed = is_signed_list[sign_i];
 
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdInt);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdInt);
         entry->type_ref = LLVMIntType(g->pointer_size_bytes * 8);
 
         const char u_or_i = is_signed ? 'i' : 'u';
@@ -4299,7 +4442,7 @@ static void define_builtin_types(CodeGen *g) {
         entry->di_type = ZigLLVMCreateDebugBasicType(g->dbuilder, buf_ptr(&entry->name),
                 debug_size_in_bits,
                 is_signed ? ZigLLVMEncoding_DW_ATE_signed() : ZigLLVMEncoding_DW_ATE_unsigned());
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
 
         if (is_signed) {
             g->builtin_types.entry_isize = entry;
@@ -4308,7 +4451,7 @@ static void define_builtin_types(CodeGen *g) {
         }
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdFloat);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdFloat);
         entry->type_ref = LLVMFloatType();
         buf_init_from_str(&entry->name, "f32");
         entry->data.floating.bit_count = 32;
@@ -4318,10 +4461,10 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_f32 = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdFloat);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdFloat);
         entry->type_ref = LLVMDoubleType();
         buf_init_from_str(&entry->name, "f64");
         entry->data.floating.bit_count = 64;
@@ -4331,10 +4474,10 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_f64 = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdFloat);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdFloat);
         entry->type_ref = LLVMX86FP80Type();
         buf_init_from_str(&entry->name, "c_longdouble");
         entry->data.floating.bit_count = 80;
@@ -4344,10 +4487,10 @@ static void define_builtin_types(CodeGen *g) {
                 debug_size_in_bits,
                 ZigLLVMEncoding_DW_ATE_float());
         g->builtin_types.entry_c_longdouble = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdVoid);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdVoid);
         entry->type_ref = LLVMVoidType();
         entry->zero_bits = true;
         buf_init_from_str(&entry->name, "void");
@@ -4355,23 +4498,23 @@ static void define_builtin_types(CodeGen *g) {
                 0,
                 ZigLLVMEncoding_DW_ATE_unsigned());
         g->builtin_types.entry_void = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdUnreachable);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdUnreachable);
         entry->type_ref = LLVMVoidType();
         entry->zero_bits = true;
         buf_init_from_str(&entry->name, "noreturn");
         entry->di_type = g->builtin_types.entry_void->di_type;
         g->builtin_types.entry_unreachable = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdMetaType);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdMetaType);
         buf_init_from_str(&entry->name, "type");
         entry->zero_bits = true;
         g->builtin_types.entry_type = entry;
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
 
     g->builtin_types.entry_u8 = get_int_type(g, false, 8);
@@ -4385,11 +4528,12 @@ static void define_builtin_types(CodeGen *g) {
 
     {
         g->builtin_types.entry_c_void = get_opaque_type(g, nullptr, nullptr, "c_void");
-        g->primitive_type_table.put(&g->builtin_types.entry_c_void->name, g->builtin_types.entry_c_void);
+        g->primitive_type_table.put(intern_buf(g, &g->builtin_types.entry_c_void->name),
+                g->builtin_types.entry_c_void);
     }
 
     {
-        TypeTableEntry *entry = new_type_table_entry(TypeTableEntryIdPureError);
+        TypeTableEntry *entry = new_type_table_entry(g, TypeTableEntryIdPureError);
         buf_init_from_str(&entry->name, "error");
 
         // TODO allow overriding this type and keep track of max value and emit an
@@ -4400,7 +4544,7 @@ static void define_builtin_types(CodeGen *g) {
         entry->type_ref = g->err_tag_type->type_ref;
         entry->di_type = g->err_tag_type->di_type;
 
-        g->primitive_type_table.put(&entry->name, entry);
+        g->primitive_type_table.put(intern_buf(g, &entry->name), entry);
     }
 
 }
@@ -4411,7 +4555,7 @@ static BuiltinFnEntry *create_builtin_fn(CodeGen *g, BuiltinFnId id, const char
     buf_init_from_str(&builtin_fn->name, name);
     builtin_fn->id = id;
     builtin_fn->param_count = count;
-    g->builtin_fn_table.put(&builtin_fn->name, builtin_fn);
+    g->builtin_fn_table.put(intern_buf(g, &builtin_fn->name), builtin_fn);
     return builtin_fn;
 }
 
@@ -4537,6 +4681,7 @@ static void define_builtin_fns(CodeGen *g) {
     create_builtin_fn(g, BuiltinFnIdMod, "mod", 2);
     create_builtin_fn(g, BuiltinFnIdInlineCall, "inlineCall", SIZE_MAX);
     create_builtin_fn(g, BuiltinFnIdTypeId, "typeId", 1);
+    create_builtin_fn(g, BuiltinFnIdSetEvalBranchQuota, "setEvalBranchQuota", 1);
 }
 
 static const char *bool_to_str(bool b) {
@@ -4548,10 +4693,72 @@ static const char *build_mode_to_str(BuildMode build_mode) {
         case BuildModeDebug: return "Mode.Debug";
         case BuildModeSafeRelease: return "Mode.ReleaseSafe";
         case BuildModeFastRelease: return "Mode.ReleaseFast";
+        case BuildModeSmallRelease: return "Mode.ReleaseSmall";
+    }
+    zig_unreachable();
+}
+
+static LLVMCodeGenOptLevel build_mode_to_codegen_opt_level(BuildMode build_mode) {
+    switch (build_mode) {
+        case BuildModeDebug: return LLVMCodeGenLevelNone;
+        case BuildModeSafeRelease: return LLVMCodeGenLevelAggressive;
+        case BuildModeFastRelease: return LLVMCodeGenLevelAggressive;
+        case BuildModeSmallRelease: return LLVMCodeGenLevelDefault;
     }
     zig_unreachable();
 }
 
+// Appends the names of the +feature and -feature flags in features to names,
+// leaving out the ones that are in seen already.
+static void append_feature_names(ZigList<Buf *> *names, HashMap<Buf *, bool, buf_hash, buf_eql_buf> *seen,
+        const char *features)
+{
+    const char *flag = features;
+    while (*flag != 0) {
+        const char *end = strchr(flag, ',');
+        size_t flag_len = (end == nullptr) ? strlen(flag) : (size_t)(end - flag);
+        if (flag_len > 1) {
+            Buf *name = buf_create_from_mem(flag + 1, flag_len - 1);
+            if (seen->put_unique(name, true) == nullptr)
+                names->append(name);
+        }
+        if (end == nullptr)
+            break;
+        flag = end + 1;
+    }
+}
+
+// LLVM 4.0 cannot list the features of a target, so the features that are
+// reported in builtin.zig are picked from the ones that were asked for and,
+// when the target has the host's architecture, the ones the host knows of.
+// This also finds the features implied by --target-cpu on such targets.
+static void append_cpu_features(CodeGen *g, Buf *contents) {
+    ZigList<Buf *> names = {};
+    HashMap<Buf *, bool, buf_hash, buf_eql_buf> seen = {};
+    seen.init(64);
+    append_feature_names(&names, &seen, buf_ptr(g->target_features));
+
+    ZigTarget native;
+    get_native_target(&native);
+    if (native.arch.arch == g->zig_target.arch.arch) {
+        char *host_features = ZigLLVMGetNativeFeatures();
+        append_feature_names(&names, &seen, host_features);
+        free(host_features);
+    }
+
+    buf_appendf(contents, "pub const cpu = \"%s\";\n", buf_ptr(g->target_cpu));
+    buf_appendf(contents, "pub const cpu_features = [][]const u8 {\n");
+    for (size_t i = 0; i < names.length; i += 1) {
+        Buf *name = names.at(i);
+        if (ZigLLVMTargetMachineHasFeature(g->target_machine, buf_ptr(name)))
+            buf_appendf(contents, "    \"%s\",\n", buf_ptr(name));
+    }
+    buf_appendf(contents, "};\n");
+
+    seen.deinit();
+    names.deinit();
+}
+
 static void define_builtin_compile_vars(CodeGen *g) {
     if (g->std_package == nullptr)
         return;
@@ -4666,6 +4873,7 @@ static void define_builtin_compile_vars(CodeGen *g) {
             "    Debug,\n"
             "    ReleaseSafe,\n"
             "    ReleaseFast,\n"
+            "    ReleaseSmall,\n"
             "};\n\n");
     }
     {
@@ -4694,6 +4902,14 @@ static void define_builtin_compile_vars(CodeGen *g) {
     buf_appendf(contents, "pub const object_format = ObjectFormat.%s;\n", cur_obj_fmt);
     buf_appendf(contents, "pub const mode = %s;\n", build_mode_to_str(g->build_mode));
     buf_appendf(contents, "pub const link_libc = %s;\n", bool_to_str(g->libc_link_lib != nullptr));
+    buf_appendf(contents, "pub const profile_generate = %s;\n", bool_to_str(g->profile_generate_path != nullptr));
+    Buf profile_generate_path = BUF_INIT;
+    if (g->profile_generate_path != nullptr)
+        string_literal_escape(g->profile_generate_path, &profile_generate_path);
+    else
+        buf_resize(&profile_generate_path, 0);
+    buf_appendf(contents, "pub const profile_generate_path = \"%s\";\n", buf_ptr(&profile_generate_path));
+    append_cpu_features(g, contents);
 
     buf_appendf(contents, "pub const __zig_panic_implementation_provided = %s; // overwritten later\n",
             bool_to_str(false));
@@ -4735,22 +4951,34 @@ static void init(CodeGen *g) {
     }
 
     bool is_optimized = g->build_mode != BuildModeDebug;
-    LLVMCodeGenOptLevel opt_level = is_optimized ? LLVMCodeGenLevelAggressive : LLVMCodeGenLevelNone;
+    LLVMCodeGenOptLevel opt_level = build_mode_to_codegen_opt_level(g->build_mode);
 
     LLVMRelocMode reloc_mode = g->is_static ? LLVMRelocStatic : LLVMRelocPIC;
 
-    const char *target_specific_cpu_args;
-    const char *target_specific_features;
-    if (g->is_native_target) {
-        target_specific_cpu_args = ZigLLVMGetHostCPUName();
-        target_specific_features = ZigLLVMGetNativeFeatures();
-    } else {
-        target_specific_cpu_args = "";
-        target_specific_features = "";
+    // the native target defaults to the host CPU and its features, and the
+    // other targets to LLVM's generic CPU for the architecture. the host's
+    // features are left out when another CPU is asked for.
+    if (g->target_features == nullptr) {
+        if (g->is_native_target && g->target_cpu == nullptr) {
+            char *features = ZigLLVMGetNativeFeatures();
+            g->target_features = buf_create_from_str(features);
+            free(features);
+        } else {
+            g->target_features = buf_create_from_str("");
+        }
+    }
+    if (g->target_cpu == nullptr) {
+        if (g->is_native_target) {
+            char *cpu_name = ZigLLVMGetHostCPUName();
+            g->target_cpu = buf_create_from_str(cpu_name);
+            free(cpu_name);
+        } else {
+            g->target_cpu = buf_create_from_str("");
+        }
     }
 
     g->target_machine = LLVMCreateTargetMachine(target_ref, buf_ptr(&g->triple_str),
-            target_specific_cpu_args, target_specific_features, opt_level, reloc_mode, LLVMCodeModelDefault);
+            buf_ptr(g->target_cpu), buf_ptr(g->target_features), opt_level, reloc_mode, LLVMCodeModelDefault);
 
     g->target_data_ref = LLVMCreateTargetDataLayout(g->target_machine);
 
@@ -4779,8 +5007,9 @@ static void init(CodeGen *g) {
     define_builtin_types(g);
 
     g->invalid_instruction = allocate<IrInstruction>(1);
-    g->invalid_instruction->value.type = g->builtin_types.entry_invalid;
-    g->invalid_instruction->value.global_refs = allocate<ConstGlobalRefs>(1);
+    g->invalid_instruction->value = allocate<ConstExprValue>(1);
+    g->invalid_instruction->value->type = g->builtin_types.entry_invalid;
+    g->invalid_instruction->value->global_refs = allocate<ConstGlobalRefs>(1);
 
     g->const_void_val.special = ConstValSpecialStatic;
     g->const_void_val.type = g->builtin_types.entry_void;
@@ -4840,7 +5069,7 @@ static ImportTableEntry *add_special_code(CodeGen *g, PackageTableEntry *package
         zig_panic("unable to open '%s': %s", buf_ptr(&path_to_code_src), err_str(err));
     }
     Buf *import_code = buf_alloc();
-    if ((err = os_fetch_file_path(abs_full_path, import_code))) {
+    if ((err = os_map_file_path(abs_full_path, import_code))) {
         zig_panic("unable to open '%s': %s", buf_ptr(&path_to_code_src), err_str(err));
     }
 
@@ -4878,10 +5107,10 @@ static void create_test_compile_var_and_add_test_runner(CodeGen *g) {
     TypeTableEntry *field_types[] = { str_type, fn_type, };
     TypeTableEntry *struct_type = get_struct_type(g, "ZigTestFn", field_names, field_types, 2);
 
-    ConstExprValue *test_fn_array = create_const_vals(1);
+    ConstExprValue *test_fn_array = create_const_vals(g, 1);
     test_fn_array->type = get_array_type(g, struct_type, g->test_fns.length);
     test_fn_array->special = ConstValSpecialStatic;
-    test_fn_array->data.x_array.s_none.elements = create_const_vals(g->test_fns.length);
+    test_fn_array->data.x_array.s_none.elements = create_const_vals(g, g->test_fns.length);
 
     for (size_t i = 0; i < g->test_fns.length; i += 1) {
         FnTableEntry *test_fn_entry = g->test_fns.at(i);
@@ -4892,7 +5121,7 @@ static void create_test_compile_var_and_add_test_runner(CodeGen *g) {
         this_val->data.x_struct.parent.id = ConstParentIdArray;
         this_val->data.x_struct.parent.data.p_array.array_val = test_fn_array;
         this_val->data.x_struct.parent.data.p_array.elem_index = i;
-        this_val->data.x_struct.fields = create_const_vals(2);
+        this_val->data.x_struct.fields = create_const_vals(g, 2);
 
         ConstExprValue *name_field = &this_val->data.x_struct.fields[0];
         ConstExprValue *name_array_val = create_const_str_lit(g, &test_fn_entry->symbol_name);
@@ -4927,7 +5156,7 @@ static void gen_root_source(CodeGen *g) {
     }
 
     Buf *source_code = buf_alloc();
-    if ((err = os_fetch_file_path(rel_full_path, source_code))) {
+    if ((err = os_map_file_path(rel_full_path, source_code))) {
         zig_panic("unable to open '%s': %s", buf_ptr(rel_full_path), err_str(err));
     }
 
@@ -4961,6 +5190,7 @@ static void gen_root_source(CodeGen *g) {
             semantic_analyze(g);
         }
     }
+    free_prefetched_imports(g);
 
     report_errors_and_maybe_exit(g);
     if (g->verbose) {
@@ -4974,14 +5204,16 @@ void codegen_add_assembly(CodeGen *g, Buf *path) {
 }
 
 static void gen_global_asm(CodeGen *g) {
-    Buf contents = BUF_INIT;
     int err;
     for (size_t i = 0; i < g->assembly_files.length; i += 1) {
         Buf *asm_file = g->assembly_files.at(i);
+        Buf contents = BUF_INIT;
         if ((err = os_fetch_file_path(asm_file, &contents))) {
             zig_panic("Unable to read %s: %s", buf_ptr(asm_file), err_str(err));
         }
+        cache_add_dep(g, asm_file, &contents);
         buf_append_buf(&g->global_asm, &contents);
+        buf_deinit(&contents);
     }
 }
 
@@ -5210,37 +5442,190 @@ static void gen_h_file(CodeGen *g) {
 
     if (fclose(out_h))
         zig_panic("unable to close h file: %s", strerror(errno));
+
+    // a build restored from the cache does not write the header again, so
+    // make sure it is still there
+    Buf h_contents = BUF_INIT;
+    int err;
+    if ((err = os_fetch_file_path(g->out_h_path, &h_contents)))
+        zig_panic("unable to read %s: %s", buf_ptr(g->out_h_path), err_str(err));
+    cache_add_dep(g, g->out_h_path, &h_contents);
+    buf_deinit(&h_contents);
+}
+
+struct IrInstructionKindStats {
+    IrInstructionId id;
+    size_t count;
+    size_t bytes;
+};
+
+static int compare_instruction_kinds_by_bytes(const void *a, const void *b) {
+    const IrInstructionKindStats *kind_a = reinterpret_cast<const IrInstructionKindStats *>(a);
+    const IrInstructionKindStats *kind_b = reinterpret_cast<const IrInstructionKindStats *>(b);
+    if (kind_a->bytes != kind_b->bytes)
+        return (kind_a->bytes < kind_b->bytes) ? 1 : -1;
+    return (kind_a->id < kind_b->id) ? -1 : 1;
+}
+
+static void print_ir_instruction_report(CodeGen *g, FILE *f) {
+    IrInstructionKindStats kinds[ir_instruction_id_count];
+    size_t total_count = 0;
+    size_t total_bytes = 0;
+    for (size_t id = 0; id < ir_instruction_id_count; id += 1) {
+        kinds[id] = {(IrInstructionId)id, g->ir_stats->count[id], g->ir_stats->bytes[id]};
+        total_count += kinds[id].count;
+        total_bytes += kinds[id].bytes;
+    }
+    qsort(kinds, ir_instruction_id_count, sizeof(IrInstructionKindStats), compare_instruction_kinds_by_bytes);
+
+    // bytes include the values, which only some kinds get in full
+    fprintf(f, "\n%20s%12s%12s%12s\n", "IR Instructions", "Count", "Bytes", "Bytes/Inst");
+    for (size_t i = 0; i < ir_instruction_id_count && kinds[i].count != 0; i += 1) {
+        fprintf(f, "%20s%12zu%12zu%12.1f\n", ir_instruction_id_name(kinds[i].id), kinds[i].count,
+                kinds[i].bytes, (double)kinds[i].bytes / kinds[i].count);
+    }
+    fprintf(f, "%20s%12zu%12zu%12.1f\n", "Total", total_count, total_bytes,
+            (total_count != 0) ? ((double)total_bytes / total_count) : 0.0);
 }
 
 void codegen_print_timing_report(CodeGen *g, FILE *f) {
     double start_time = g->timing_events.at(0).time;
     double end_time = g->timing_events.last().time;
     double total = end_time - start_time;
-    fprintf(f, "%20s%12s%12s%12s%12s\n", "Name", "Start", "End", "Duration", "Percent");
+    // the peak RSS of a phase is the peak of the process by the end of it
+    fprintf(f, "%20s%12s%12s%12s%12s%12s\n", "Name", "Start", "End", "Duration", "Percent", "Peak MiB");
     for (size_t i = 0; i < g->timing_events.length - 1; i += 1) {
         TimeEvent *te = &g->timing_events.at(i);
         TimeEvent *next_te = &g->timing_events.at(i + 1);
-        fprintf(f, "%20s%12.4f%12.4f%12.4f%12.4f\n", te->name,
+        fprintf(f, "%20s%12.4f%12.4f%12.4f%12.4f%12.1f\n", te->name,
                 te->time - start_time,
                 next_te->time - start_time,
                 next_te->time - te->time,
-                (next_te->time - te->time) / total);
+                (next_te->time - te->time) / total,
+                next_te->peak_rss / (1024.0 * 1024.0));
+    }
+    fprintf(f, "%20s%12.4f%12.4f%12.4f%12.4f%12.1f\n", "Total", 0.0, total, total, 1.0,
+            g->timing_events.last().peak_rss / (1024.0 * 1024.0));
+
+    double tokenize_mb_per_sec = (g->tokenize_seconds > 0.0) ?
+        (g->tokenize_byte_count / g->tokenize_seconds / 1000000.0) : 0.0;
+    fprintf(f, "\n%20s%12s%12s%12s%12s\n", "Tokenizer", "Bytes", "Tokens", "Seconds", "MB/s");
+    fprintf(f, "%20s%12zu%12zu%12.4f%12.1f\n", "", g->tokenize_byte_count, g->tokenize_token_count,
+            g->tokenize_seconds, tokenize_mb_per_sec);
+
+    fprintf(f, "\n%20s%12s%12s%12s%12s\n", "Arena", "Allocs", "Used", "Reserved", "Chunks");
+    arena_print_report(&g->parse_arena, f);
+    arena_print_report(&g->ir_arena, f);
+    arena_print_report(&g->const_val_arena, f);
+    arena_print_report(&g->type_arena, f);
+    if (g->free_ir) {
+        fprintf(f, "\n%20s%12s%12s\n", "Freed IR", "Pass 1", "Rendered");
+        fprintf(f, "%20s%12zu%12zu\n", "", g->pass1_ir_bytes_freed, g->ir_bytes_freed);
+    }
+    fprintf(f, "\n%20s%12s%12s\n", "Comptime Scratch", "Freed", "Kept");
+    fprintf(f, "%20s%12zu%12zu\n", "", g->comptime_scratch_bytes_freed, g->comptime_scratch_bytes_kept);
+
+    // the parse arena also holds the number literal values, which are few
+    double bytes_per_node = (g->next_node_index != 0) ?
+        ((double)g->parse_arena.bytes_used / g->next_node_index) : 0.0;
+    fprintf(f, "\n%20s%12s%12s\n", "AST", "Nodes", "Bytes/Node");
+    fprintf(f, "%20s%12zu%12.1f\n", "", (size_t)g->next_node_index, bytes_per_node);
+
+    print_ir_instruction_report(g, f);
+
+    fprintf(f, "\n%20s%12s%12s%12s%12s\n", "Comptime Calls", "IR Gen", "IR Reused", "Bytecode", "Bailed");
+    fprintf(f, "%20s%12zu%12zu%12zu%12zu\n", "", g->comptime_ir_gen_count, g->comptime_ir_reuse_count,
+            g->comptime_bytecode_run_count, g->comptime_bytecode_bail_count);
+
+    cache_print_report(g, f);
+}
+
+static const size_t comptime_report_max_sites = 10;
+
+// The sites come out of a hash table keyed by pointer, so ties are broken by
+// source location to keep the report the same from run to run.
+static int compare_call_site_locations(const ComptimeCallSite *site_a, const ComptimeCallSite *site_b) {
+    AstNode *node_a = site_a->source_node;
+    AstNode *node_b = site_b->source_node;
+    int path_cmp = strcmp(buf_ptr(node_a->owner->path), buf_ptr(node_b->owner->path));
+    if (path_cmp != 0)
+        return path_cmp;
+    if (node_a->line != node_b->line)
+        return (node_a->line < node_b->line) ? -1 : 1;
+    if (node_a->column != node_b->column)
+        return (node_a->column < node_b->column) ? -1 : 1;
+    return 0;
+}
+
+static int compare_call_sites_by_branches(const void *a, const void *b) {
+    const ComptimeCallSite *site_a = *reinterpret_cast<ComptimeCallSite * const *>(a);
+    const ComptimeCallSite *site_b = *reinterpret_cast<ComptimeCallSite * const *>(b);
+    if (site_a->backward_branch_count != site_b->backward_branch_count)
+        return (site_a->backward_branch_count < site_b->backward_branch_count) ? 1 : -1;
+    return compare_call_site_locations(site_a, site_b);
+}
+
+static int compare_call_sites_by_seconds(const void *a, const void *b) {
+    const ComptimeCallSite *site_a = *reinterpret_cast<ComptimeCallSite * const *>(a);
+    const ComptimeCallSite *site_b = *reinterpret_cast<ComptimeCallSite * const *>(b);
+    if (site_a->seconds != site_b->seconds)
+        return (site_a->seconds < site_b->seconds) ? 1 : -1;
+    return compare_call_site_locations(site_a, site_b);
+}
+
+static void print_call_sites(ZigList<ComptimeCallSite *> *sites, FILE *f) {
+    fprintf(f, "%12s%12s%12s  %s\n", "Calls", "Branches", "Seconds", "Call Site");
+    size_t count = (sites->length < comptime_report_max_sites) ? sites->length : comptime_report_max_sites;
+    for (size_t i = 0; i < count; i += 1) {
+        ComptimeCallSite *site = sites->at(i);
+        AstNode *node = site->source_node;
+        fprintf(f, "%12zu%12zu%12.4f  %s:%zu:%zu %s\n", site->call_count, site->backward_branch_count,
+                site->seconds, buf_ptr(node->owner->path), (size_t)node->line + 1, (size_t)node->column + 1,
+                buf_ptr(&site->fn_entry->symbol_name));
+    }
+}
+
+// The comptime function calls that took the most backward branches and the
+// most time. The branch counts include the calls made from the callee, so
+// they tell which call site's quota to raise with @setEvalBranchQuota.
+void codegen_print_comptime_report(CodeGen *g, FILE *f) {
+    ZigList<ComptimeCallSite *> sites = {};
+    auto it = g->comptime_call_sites.entry_iterator();
+    for (;;) {
+        auto *entry = it.next();
+        if (!entry)
+            break;
+        sites.append(entry->value);
     }
-    fprintf(f, "%20s%12.4f%12.4f%12.4f%12.4f\n", "Total", 0.0, total, total, 1.0);
+
+    fprintf(f, "\nComptime call sites by backward branches (quota %zu):\n", g->comptime_quota);
+    qsort(sites.items, sites.length, sizeof(ComptimeCallSite *), compare_call_sites_by_branches);
+    print_call_sites(&sites, f);
+
+    fprintf(f, "\nComptime call sites by time:\n");
+    qsort(sites.items, sites.length, sizeof(ComptimeCallSite *), compare_call_sites_by_seconds);
+    print_call_sites(&sites, f);
+
+    sites.deinit();
 }
 
 void codegen_add_time_event(CodeGen *g, const char *name) {
-    g->timing_events.append({os_get_time(), name});
+    g->timing_events.append({os_get_time(), name, os_get_peak_rss()});
 }
 
 void codegen_build(CodeGen *g) {
     assert(g->out_type != OutTypeUnknown);
     init(g);
 
+    // a cache hit skips analysis, which would leave nothing to report
+    if (!g->comptime_report && cache_restore(g))
+        return;
+
     gen_global_asm(g);
     gen_root_source(g);
     do_code_gen(g);
     gen_h_file(g);
+    cache_save(g);
 }
 
 PackageTableEntry *codegen_create_package(CodeGen *g, const char *root_src_dir, const char *root_src_path) {
@@ -42,6 +42,17 @@ void codegen_set_mmacosx_version_min(CodeGen *g, Buf *mmacosx_version_min);
 void codegen_set_mios_version_min(CodeGen *g, Buf *mios_version_min);
 void codegen_set_linker_script(CodeGen *g, const char *linker_script);
 void codegen_set_omit_zigrt(CodeGen *g, bool omit_zigrt);
+void codegen_set_codegen_threads(CodeGen *g, size_t codegen_threads);
+void codegen_set_thin_lto(CodeGen *g, bool thin_lto);
+void codegen_set_profile_generate(CodeGen *g, Buf *dir);
+void codegen_set_profile_use(CodeGen *g, Buf *path, Buf *contents);
+void codegen_set_analysis_threads(CodeGen *g, size_t analysis_threads);
+void codegen_set_comptime_quota(CodeGen *g, size_t comptime_quota);
+void codegen_set_comptime_report(CodeGen *g, bool comptime_report);
+void codegen_set_free_ir(CodeGen *g, bool free_ir);
+void codegen_set_target_cpu(CodeGen *g, Buf *cpu);
+void codegen_set_target_features(CodeGen *g, Buf *features);
+size_t codegen_object_count(CodeGen *g);
 void codegen_set_test_filter(CodeGen *g, Buf *filter);
 void codegen_set_test_name_prefix(CodeGen *g, Buf *prefix);
 void codegen_set_lib_version(CodeGen *g, size_t major, size_t minor, size_t patch);
@@ -49,6 +60,7 @@ void codegen_set_cache_dir(CodeGen *g, Buf *cache_dir);
 void codegen_set_output_h_path(CodeGen *g, Buf *h_path);
 void codegen_add_time_event(CodeGen *g, const char *name);
 void codegen_print_timing_report(CodeGen *g, FILE *f);
+void codegen_print_comptime_report(CodeGen *g, FILE *f);
 void codegen_build(CodeGen *g);
 
 PackageTableEntry *codegen_create_package(CodeGen *g, const char *root_src_dir, const char *root_src_path);
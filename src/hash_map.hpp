@@ -12,29 +12,37 @@
 
 #include <stdint.h>
 
+// Open addressing with linear probing and robin hood insertion. The capacity
+// is always a power of two so that probing can mask instead of divide, and
+// each entry remembers the full hash of its key so that EqualFn is only
+// called when the hashes match. Since only the low bits pick the slot, the
+// hash function's result is mixed first; many of ours hash aligned pointers.
 template<typename K, typename V, uint32_t (*HashFunction)(K key), bool (*EqualFn)(K a, K b)>
 class HashMap {
 public:
     void init(int capacity) {
-        init_capacity(capacity);
+        int pow2_capacity = 1;
+        while (pow2_capacity < capacity)
+            pow2_capacity *= 2;
+        init_capacity(pow2_capacity);
     }
     void deinit(void) {
         free(_entries);
     }
 
     struct Entry {
-        bool used;
-        int distance_from_start_index;
         K key;
         V value;
+        uint32_t hash;
+        // 1 + the distance from the slot that hash maps to, or 0 if unused
+        uint32_t probe_len;
     };
 
     void clear() {
         for (int i = 0; i < _capacity; i += 1) {
-            _entries[i].used = false;
+            _entries[i].probe_len = 0;
         }
         _size = 0;
-        _max_distance_from_start_index = 0;
         _modification_count += 1;
     }
 
@@ -43,31 +51,62 @@ public:
     }
 
     void put(const K &key, const V &value) {
+        bool existed;
+        Entry *entry = get_or_insert(key, value, &existed);
+        if (existed)
+            entry->value = value;
+    }
+
+    // Returns the existing entry for key, or inserts key with value and
+    // returns nullptr.
+    Entry *put_unique(const K &key, const V &value) {
+        bool existed;
+        Entry *entry = get_or_insert(key, value, &existed);
+        return existed ? entry : nullptr;
+    }
+
+    // Looks key up and inserts it with value if it is missing, with a single
+    // probe sequence either way. Sets *existed to whether the key was already
+    // present; the existing value is left alone in that case. The returned
+    // entry is valid until the next modification of the map.
+    Entry *get_or_insert(const K &key, const V &value, bool *existed) {
         _modification_count += 1;
-        internal_put(key, value);
-
-        // if we get too full (60%), double the capacity
-        if (_size * 5 >= _capacity * 3) {
-            Entry *old_entries = _entries;
-            int old_capacity = _capacity;
-            init_capacity(_capacity * 2);
-            // dump all of the old elements into the new table
-            for (int i = 0; i < old_capacity; i += 1) {
-                Entry *old_entry = &old_entries[i];
-                if (old_entry->used)
-                    internal_put(old_entry->key, old_entry->value);
+
+        // if we would get too full (60%), double the capacity
+        if ((_size + 1) * 5 > _capacity * 3)
+            grow();
+
+        uint32_t hash = key_hash(key);
+        uint32_t index = hash & _mask;
+        uint32_t probe_len = 1;
+        for (;; probe_len += 1, index = (index + 1) & _mask) {
+            Entry *entry = &_entries[index];
+            if (entry->probe_len < probe_len)
+                break;
+            if (entry->hash == hash && EqualFn(entry->key, key)) {
+                *existed = true;
+                return entry;
             }
-            free(old_entries);
         }
-    }
 
-    Entry *put_unique(const K &key, const V &value) {
-        // TODO make this more efficient
-        Entry *entry = internal_get(key);
-        if (entry)
-            return entry;
-        put(key, value);
-        return nullptr;
+        *existed = false;
+        _size += 1;
+        Entry *result = &_entries[index];
+        Entry carry = {key, value, hash, probe_len};
+        for (;; index = (index + 1) & _mask) {
+            Entry *entry = &_entries[index];
+            if (entry->probe_len == 0) {
+                *entry = carry;
+                return result;
+            }
+            if (entry->probe_len < carry.probe_len) {
+                // robin hood to the rescue
+                Entry tmp = *entry;
+                *entry = carry;
+                carry = tmp;
+            }
+            carry.probe_len += 1;
+        }
     }
 
     const V &get(const K &key) const {
@@ -82,39 +121,16 @@ public:
     }
 
     void maybe_remove(const K &key) {
-        if (maybe_get(key)) {
-            remove(key);
-        }
+        Entry *entry = internal_get(key);
+        if (entry)
+            remove_entry(entry);
     }
 
     void remove(const K &key) {
-        _modification_count += 1;
-        int start_index = key_to_index(key);
-        for (int roll_over = 0; roll_over <= _max_distance_from_start_index; roll_over += 1) {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (!entry->used)
-                zig_panic("key not found");
-
-            if (!EqualFn(entry->key, key))
-                continue;
-
-            for (; roll_over < _capacity; roll_over += 1) {
-                int next_index = (start_index + roll_over + 1) % _capacity;
-                Entry *next_entry = &_entries[next_index];
-                if (!next_entry->used || next_entry->distance_from_start_index == 0) {
-                    entry->used = false;
-                    _size -= 1;
-                    return;
-                }
-                *entry = *next_entry;
-                entry->distance_from_start_index -= 1;
-                entry = next_entry;
-            }
-            zig_panic("shifting everything in the table");
-        }
-        zig_panic("key not found");
+        Entry *entry = internal_get(key);
+        if (!entry)
+            zig_panic("key not found");
+        remove_entry(entry);
     }
 
     class Iterator {
@@ -126,7 +142,7 @@ public:
                 return NULL;
             for (; _index < _table->_capacity; _index += 1) {
                 Entry *entry = &_table->_entries[_index];
-                if (entry->used) {
+                if (entry->probe_len != 0) {
                     _index += 1;
                     _count += 1;
                     return entry;
@@ -157,85 +173,90 @@ private:
 
     Entry *_entries;
     int _capacity;
+    uint32_t _mask;
     int _size;
-    int _max_distance_from_start_index;
     // this is used to detect bugs where a hashtable is edited while an iterator is running.
     uint32_t _modification_count;
 
     void init_capacity(int capacity) {
+        assert(is_power_of_2(capacity));
         _capacity = capacity;
+        _mask = (uint32_t)(capacity - 1);
         _entries = allocate<Entry>(_capacity);
         _size = 0;
-        _max_distance_from_start_index = 0;
-        for (int i = 0; i < _capacity; i += 1) {
-            _entries[i].used = false;
-        }
     }
 
-    void internal_put(K key, V value) {
-        int start_index = key_to_index(key);
-        for (int roll_over = 0, distance_from_start_index = 0;
-                roll_over < _capacity; roll_over += 1, distance_from_start_index += 1)
-        {
-            int index = (start_index + roll_over) % _capacity;
-            Entry *entry = &_entries[index];
-
-            if (entry->used && !EqualFn(entry->key, key)) {
-                if (entry->distance_from_start_index < distance_from_start_index) {
-                    // robin hood to the rescue
+    void grow() {
+        Entry *old_entries = _entries;
+        int old_capacity = _capacity;
+        int old_size = _size;
+        init_capacity(_capacity * 2);
+        // dump all of the old elements into the new table, reusing the
+        // stored hashes. keys are known to be unique so no EqualFn calls.
+        for (int i = 0; i < old_capacity; i += 1) {
+            Entry *old_entry = &old_entries[i];
+            if (old_entry->probe_len == 0)
+                continue;
+            Entry carry = *old_entry;
+            carry.probe_len = 1;
+            for (uint32_t index = carry.hash & _mask;; index = (index + 1) & _mask) {
+                Entry *entry = &_entries[index];
+                if (entry->probe_len == 0) {
+                    *entry = carry;
+                    break;
+                }
+                if (entry->probe_len < carry.probe_len) {
                     Entry tmp = *entry;
-                    if (distance_from_start_index > _max_distance_from_start_index)
-                        _max_distance_from_start_index = distance_from_start_index;
-                    *entry = {
-                        true,
-                        distance_from_start_index,
-                        key,
-                        value,
-                    };
-                    key = tmp.key;
-                    value = tmp.value;
-                    distance_from_start_index = tmp.distance_from_start_index;
+                    *entry = carry;
+                    carry = tmp;
                 }
-                continue;
+                carry.probe_len += 1;
             }
+        }
+        _size = old_size;
+        free(old_entries);
+    }
 
-            if (!entry->used) {
-                // adding an entry. otherwise overwriting old value with
-                // same key
-                _size += 1;
+    // backward shift deletion: pull the following entries of the cluster
+    // one slot closer to their home so that no tombstones are needed
+    void remove_entry(Entry *entry) {
+        _modification_count += 1;
+        _size -= 1;
+        uint32_t index = (uint32_t)(entry - _entries);
+        for (;;) {
+            uint32_t next_index = (index + 1) & _mask;
+            Entry *next_entry = &_entries[next_index];
+            if (next_entry->probe_len <= 1) {
+                _entries[index].probe_len = 0;
+                return;
             }
-
-            if (distance_from_start_index > _max_distance_from_start_index)
-                _max_distance_from_start_index = distance_from_start_index;
-            *entry = {
-                true,
-                distance_from_start_index,
-                key,
-                value,
-            };
-            return;
+            _entries[index] = *next_entry;
+            _entries[index].probe_len -= 1;
+            index = next_index;
         }
-        zig_panic("put into a full HashMap");
     }
 
+    static uint32_t key_hash(const K &key) {
+        // murmur3 finalizer
+        uint32_t h = HashFunction(key);
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        return h;
+    }
 
     Entry *internal_get(const K &key) const {
-        int start_index = key_to_index(key);
-        for (int roll_over = 0; roll_over <= _max_distance_from_start_index; roll_over += 1) {
-            int index = (start_index + roll_over) % _capacity;
+        uint32_t hash = key_hash(key);
+        uint32_t index = hash & _mask;
+        for (uint32_t probe_len = 1;; probe_len += 1, index = (index + 1) & _mask) {
             Entry *entry = &_entries[index];
-
-            if (!entry->used)
+            if (entry->probe_len < probe_len)
                 return NULL;
-
-            if (EqualFn(entry->key, key))
+            if (entry->hash == hash && EqualFn(entry->key, key))
                 return entry;
         }
-        return NULL;
-    }
-
-    int key_to_index(const K &key) const {
-        return (int)(HashFunction(key) % ((uint32_t)_capacity));
     }
 };
 
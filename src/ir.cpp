@@ -7,6 +7,7 @@
 
 #include "analyze.hpp"
 #include "ast_render.hpp"
+#include "cache.hpp"
 #include "error.hpp"
 #include "ir.hpp"
 #include "ir_print.hpp"
@@ -60,9 +61,31 @@ ConstExprValue *const_ptr_pointee(CodeGen *g, ConstExprValue *const_val) {
         case ConstPtrSpecialRef:
             return const_val->data.x_ptr.data.ref.pointee;
         case ConstPtrSpecialBaseArray:
-            expand_undef_array(g, const_val->data.x_ptr.data.base_array.array_val);
-            return &const_val->data.x_ptr.data.base_array.array_val->data.x_array.s_none.elements[
-                const_val->data.x_ptr.data.base_array.elem_index];
+            {
+                ConstExprValue *array_val = const_val->data.x_ptr.data.base_array.array_val;
+                size_t elem_index = const_val->data.x_ptr.data.base_array.elem_index;
+                if (array_val->data.x_array.special == ConstArraySpecialBuf &&
+                    const_val->data.x_ptr.mut == ConstPtrMutComptimeConst)
+                {
+                    // the pointee cannot be written through this pointer, so hand
+                    // out a copy of the byte instead of expanding the whole array
+                    ConstExprValue *byte_val = create_const_vals(g, 1);
+                    init_const_unsigned_negative(byte_val, g->builtin_types.entry_u8,
+                            (uint8_t)buf_ptr(array_val->data.x_array.s_buf)[elem_index], false);
+                    return byte_val;
+                }
+                if (array_val->data.x_array.special != ConstArraySpecialNone &&
+                    make_dense_const_array(g, array_val))
+                {
+                    // elements of a dense array are only written by
+                    // ir_analyze_instruction_store_ptr, so a copy is enough here
+                    ConstExprValue *elem_val = create_const_vals(g, 1);
+                    dense_const_array_get(array_val, elem_index, elem_val);
+                    return elem_val;
+                }
+                expand_undef_array(g, array_val);
+                return &array_val->data.x_array.s_none.elements[elem_index];
+            }
         case ConstPtrSpecialBaseStruct:
             return &const_val->data.x_ptr.data.base_struct.struct_val->data.x_struct.fields[
                 const_val->data.x_ptr.data.base_struct.field_index];
@@ -116,12 +139,23 @@ static bool value_is_comptime(ConstExprValue *const_val) {
     return const_val->special != ConstValSpecialRuntime;
 }
 
+static size_t ir_value_size(IrInstructionId id);
+
+// Only the kinds of instruction that ir_value_size gives the whole value can
+// have a compile-time known result; the value of the others is cut short.
+static void ir_assert_whole_value(IrInstruction *instruction) {
+    assert(ir_value_size(instruction->id) == sizeof(ConstExprValue));
+}
+
 static bool instr_is_comptime(IrInstruction *instruction) {
-    return value_is_comptime(&instruction->value);
+    if (!value_is_comptime(instruction->value))
+        return false;
+    ir_assert_whole_value(instruction);
+    return true;
 }
 
 static bool instr_is_unreachable(IrInstruction *instruction) {
-    return instruction->value.type && instruction->value.type->id == TypeTableEntryIdUnreachable;
+    return instruction->value->type && instruction->value->type->id == TypeTableEntryIdUnreachable;
 }
 
 static void ir_link_new_instruction(IrInstruction *new_instruction, IrInstruction *old_instruction) {
@@ -149,8 +183,12 @@ static void ir_ref_var(VariableTableEntry *var) {
     var->ref_count += 1;
 }
 
+static Arena *ir_exec_arena(IrBuilder *irb) {
+    return (irb->exec->arena != nullptr) ? irb->exec->arena : get_ir_arena(irb->codegen);
+}
+
 static IrBasicBlock *ir_create_basic_block(IrBuilder *irb, Scope *scope, const char *name_hint) {
-    IrBasicBlock *result = allocate<IrBasicBlock>(1);
+    IrBasicBlock *result = arena_allocate<IrBasicBlock>(ir_exec_arena(irb), 1);
     result->scope = scope;
     result->name_hint = name_hint;
     result->debug_id = exec_next_debug_id(irb->exec);
@@ -549,15 +587,64 @@ static constexpr IrInstructionId ir_instruction_id(IrInstructionTypeId *) {
     return IrInstructionIdTypeId;
 }
 
+static constexpr IrInstructionId ir_instruction_id(IrInstructionSetEvalBranchQuota *) {
+    return IrInstructionIdSetEvalBranchQuota;
+}
+
+// Only the kinds of instruction that can have a compile-time known result get
+// the whole value. The value of the others ends after the runtime hints, the
+// only part of the data union that is used for runtime values.
+static const size_t ir_runtime_value_size = offsetof(ConstExprValue, data) + sizeof(RuntimeHintPtr);
+static_assert(sizeof(RuntimeHintPtr) == sizeof(RuntimeHintMaybe) &&
+        sizeof(RuntimeHintPtr) == sizeof(RuntimeHintErrorUnion), "runtime hints differ in size");
+
+static size_t ir_value_size(IrInstructionId id) {
+    switch (id) {
+        case IrInstructionIdConst:
+        case IrInstructionIdVarPtr:
+        case IrInstructionIdFieldPtr:
+        case IrInstructionIdElemPtr:
+        // void and unreachable, but static
+        case IrInstructionIdCondBr:
+        case IrInstructionIdBr:
+        case IrInstructionIdSwitchBr:
+        case IrInstructionIdReturn:
+        case IrInstructionIdUnreachable:
+        case IrInstructionIdStorePtr:
+        case IrInstructionIdDeclVar:
+        case IrInstructionIdPanic:
+            return sizeof(ConstExprValue);
+        default:
+            return ir_runtime_value_size;
+    }
+}
+
+// copies of the value share global_refs, and analysis copies constants
+// out of IR that may be freed before the copies are rendered
+static void ir_alloc_global_refs(IrBuilder *irb, IrInstruction *instruction) {
+    assert(ir_value_size(instruction->id) == sizeof(ConstExprValue));
+    Arena *arena = (irb->exec->arena != nullptr) ? get_const_val_arena(irb->codegen) : ir_exec_arena(irb);
+    instruction->value->global_refs = arena_allocate<ConstGlobalRefs>(arena, 1);
+}
+
 template<typename T>
 static T *ir_create_instruction(IrBuilder *irb, Scope *scope, AstNode *source_node) {
-    T *special_instruction = allocate<T>(1);
+    Arena *arena = ir_exec_arena(irb);
+    T *special_instruction = arena_allocate<T>(arena, 1);
     special_instruction->base.id = ir_instruction_id(special_instruction);
     special_instruction->base.scope = scope;
     special_instruction->base.source_node = source_node;
     special_instruction->base.debug_id = exec_next_debug_id(irb->exec);
     special_instruction->base.owner_bb = irb->current_basic_block;
-    special_instruction->base.value.global_refs = allocate<ConstGlobalRefs>(1);
+    size_t value_size = ir_value_size(special_instruction->base.id);
+    special_instruction->base.value = reinterpret_cast<ConstExprValue *>(
+            arena_alloc_bytes(arena, value_size, alignof(ConstExprValue)));
+    if (special_instruction->base.id == IrInstructionIdConst)
+        ir_alloc_global_refs(irb, &special_instruction->base);
+
+    IrInstructionStats *stats = get_ir_stats(irb->codegen);
+    stats->count[special_instruction->base.id] += 1;
+    stats->bytes[special_instruction->base.id] += sizeof(T) + value_size;
     return special_instruction;
 }
 
@@ -585,8 +672,8 @@ static IrInstruction *ir_build_cond_br(IrBuilder *irb, Scope *scope, AstNode *so
         IrBasicBlock *then_block, IrBasicBlock *else_block, IrInstruction *is_comptime)
 {
     IrInstructionCondBr *cond_br_instruction = ir_build_instruction<IrInstructionCondBr>(irb, scope, source_node);
-    cond_br_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    cond_br_instruction->base.value.special = ConstValSpecialStatic;
+    cond_br_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    cond_br_instruction->base.value->special = ConstValSpecialStatic;
     cond_br_instruction->condition = condition;
     cond_br_instruction->then_block = then_block;
     cond_br_instruction->else_block = else_block;
@@ -611,8 +698,8 @@ static IrInstruction *ir_build_cond_br_from(IrBuilder *irb, IrInstruction *old_i
 
 static IrInstruction *ir_build_return(IrBuilder *irb, Scope *scope, AstNode *source_node, IrInstruction *return_value) {
     IrInstructionReturn *return_instruction = ir_build_instruction<IrInstructionReturn>(irb, scope, source_node);
-    return_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    return_instruction->base.value.special = ConstValSpecialStatic;
+    return_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    return_instruction->base.value->special = ConstValSpecialStatic;
     return_instruction->value = return_value;
 
     ir_ref_instruction(return_value, irb->current_basic_block);
@@ -633,54 +720,54 @@ static IrInstruction *ir_create_const(IrBuilder *irb, Scope *scope, AstNode *sou
 {
     assert(type_entry);
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = type_entry;
-    const_instruction->base.value.special = ConstValSpecialStatic;
+    const_instruction->base.value->type = type_entry;
+    const_instruction->base.value->special = ConstValSpecialStatic;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_void(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_void;
-    const_instruction->base.value.special = ConstValSpecialStatic;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_void;
+    const_instruction->base.value->special = ConstValSpecialStatic;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_undefined(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.special = ConstValSpecialUndef;
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_undef;
+    const_instruction->base.value->special = ConstValSpecialUndef;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_undef;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_uint(IrBuilder *irb, Scope *scope, AstNode *source_node, uint64_t value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_num_lit_int;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bignum_init_unsigned(&const_instruction->base.value.data.x_bignum, value);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_num_lit_int;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bignum_init_unsigned(&const_instruction->base.value->data.x_bignum, value);
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_bignum(IrBuilder *irb, Scope *scope, AstNode *source_node, BigNum *bignum) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = (bignum->kind == BigNumKindInt) ?
+    const_instruction->base.value->type = (bignum->kind == BigNumKindInt) ?
         irb->codegen->builtin_types.entry_num_lit_int : irb->codegen->builtin_types.entry_num_lit_float;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_bignum = *bignum;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_bignum = *bignum;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_null(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_null;
-    const_instruction->base.value.special = ConstValSpecialStatic;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_null;
+    const_instruction->base.value->special = ConstValSpecialStatic;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_usize(IrBuilder *irb, Scope *scope, AstNode *source_node, uint64_t value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_usize;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    bignum_init_unsigned(&const_instruction->base.value.data.x_bignum, value);
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_usize;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    bignum_init_unsigned(&const_instruction->base.value->data.x_bignum, value);
     return &const_instruction->base;
 }
 
@@ -688,9 +775,9 @@ static IrInstruction *ir_create_const_type(IrBuilder *irb, Scope *scope, AstNode
         TypeTableEntry *type_entry)
 {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_type;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_type = type_entry;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_type;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_type = type_entry;
     return &const_instruction->base;
 }
 
@@ -704,9 +791,9 @@ static IrInstruction *ir_build_const_type(IrBuilder *irb, Scope *scope, AstNode
 
 static IrInstruction *ir_create_const_fn(IrBuilder *irb, Scope *scope, AstNode *source_node, FnTableEntry *fn_entry) {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = fn_entry->type_entry;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_fn.fn_entry = fn_entry;
+    const_instruction->base.value->type = fn_entry->type_entry;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_fn.fn_entry = fn_entry;
     return &const_instruction->base;
 }
 
@@ -718,9 +805,9 @@ static IrInstruction *ir_build_const_fn(IrBuilder *irb, Scope *scope, AstNode *s
 
 static IrInstruction *ir_build_const_import(IrBuilder *irb, Scope *scope, AstNode *source_node, ImportTableEntry *import) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_namespace;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_import = import;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_namespace;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_import = import;
     return &const_instruction->base;
 }
 
@@ -728,17 +815,17 @@ static IrInstruction *ir_build_const_scope(IrBuilder *irb, Scope *parent_scope,
         Scope *target_scope)
 {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, parent_scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_block;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_block = target_scope;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_block;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_block = target_scope;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_build_const_bool(IrBuilder *irb, Scope *scope, AstNode *source_node, bool value) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = irb->codegen->builtin_types.entry_bool;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_bool = value;
+    const_instruction->base.value->type = irb->codegen->builtin_types.entry_bool;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_bool = value;
     return &const_instruction->base;
 }
 
@@ -746,16 +833,16 @@ static IrInstruction *ir_build_const_bound_fn(IrBuilder *irb, Scope *scope, AstN
     FnTableEntry *fn_entry, IrInstruction *first_arg)
 {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    const_instruction->base.value.type = get_bound_fn_type(irb->codegen, fn_entry);
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_bound_fn.fn = fn_entry;
-    const_instruction->base.value.data.x_bound_fn.first_arg = first_arg;
+    const_instruction->base.value->type = get_bound_fn_type(irb->codegen, fn_entry);
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_bound_fn.fn = fn_entry;
+    const_instruction->base.value->data.x_bound_fn.first_arg = first_arg;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_create_const_str_lit(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *str) {
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(irb, scope, source_node);
-    init_const_str_lit(irb->codegen, &const_instruction->base.value, str);
+    init_const_str_lit(irb->codegen, const_instruction->base.value, str);
 
     return &const_instruction->base;
 }
@@ -767,7 +854,7 @@ static IrInstruction *ir_build_const_str_lit(IrBuilder *irb, Scope *scope, AstNo
 
 static IrInstruction *ir_build_const_c_str_lit(IrBuilder *irb, Scope *scope, AstNode *source_node, Buf *str) {
     IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, source_node);
-    init_const_c_str_lit(irb->codegen, &const_instruction->base.value, str);
+    init_const_c_str_lit(irb->codegen, const_instruction->base.value, str);
     return &const_instruction->base;
 }
 
@@ -947,8 +1034,8 @@ static IrInstruction *ir_create_br(IrBuilder *irb, Scope *scope, AstNode *source
         IrBasicBlock *dest_block, IrInstruction *is_comptime)
 {
     IrInstructionBr *br_instruction = ir_create_instruction<IrInstructionBr>(irb, scope, source_node);
-    br_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    br_instruction->base.value.special = ConstValSpecialStatic;
+    br_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    br_instruction->base.value->special = ConstValSpecialStatic;
     br_instruction->dest_block = dest_block;
     br_instruction->is_comptime = is_comptime;
 
@@ -1060,8 +1147,8 @@ static IrInstruction *ir_build_struct_init_from(IrBuilder *irb, IrInstruction *o
 static IrInstruction *ir_build_unreachable(IrBuilder *irb, Scope *scope, AstNode *source_node) {
     IrInstructionUnreachable *unreachable_instruction =
         ir_build_instruction<IrInstructionUnreachable>(irb, scope, source_node);
-    unreachable_instruction->base.value.special = ConstValSpecialStatic;
-    unreachable_instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
+    unreachable_instruction->base.value->special = ConstValSpecialStatic;
+    unreachable_instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
     return &unreachable_instruction->base;
 }
 
@@ -1075,8 +1162,8 @@ static IrInstruction *ir_build_store_ptr(IrBuilder *irb, Scope *scope, AstNode *
         IrInstruction *ptr, IrInstruction *value)
 {
     IrInstructionStorePtr *instruction = ir_build_instruction<IrInstructionStorePtr>(irb, scope, source_node);
-    instruction->base.value.special = ConstValSpecialStatic;
-    instruction->base.value.type = irb->codegen->builtin_types.entry_void;
+    instruction->base.value->special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_void;
     instruction->ptr = ptr;
     instruction->value = value;
 
@@ -1099,8 +1186,8 @@ static IrInstruction *ir_build_var_decl(IrBuilder *irb, Scope *scope, AstNode *s
         VariableTableEntry *var, IrInstruction *var_type, IrInstruction *init_value)
 {
     IrInstructionDeclVar *decl_var_instruction = ir_build_instruction<IrInstructionDeclVar>(irb, scope, source_node);
-    decl_var_instruction->base.value.special = ConstValSpecialStatic;
-    decl_var_instruction->base.value.type = irb->codegen->builtin_types.entry_void;
+    decl_var_instruction->base.value->special = ConstValSpecialStatic;
+    decl_var_instruction->base.value->type = irb->codegen->builtin_types.entry_void;
     decl_var_instruction->var = var;
     decl_var_instruction->var_type = var_type;
     decl_var_instruction->init_value = init_value;
@@ -1359,8 +1446,8 @@ static IrInstruction *ir_build_switch_br(IrBuilder *irb, Scope *scope, AstNode *
         IrBasicBlock *else_block, size_t case_count, IrInstructionSwitchBrCase *cases, IrInstruction *is_comptime)
 {
     IrInstructionSwitchBr *instruction = ir_build_instruction<IrInstructionSwitchBr>(irb, scope, source_node);
-    instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
-    instruction->base.value.special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
+    instruction->base.value->special = ConstValSpecialStatic;
     instruction->target_value = target_value;
     instruction->else_block = else_block;
     instruction->case_count = case_count;
@@ -2124,8 +2211,8 @@ static IrInstruction *ir_build_decl_ref(IrBuilder *irb, Scope *scope, AstNode *s
 
 static IrInstruction *ir_build_panic(IrBuilder *irb, Scope *scope, AstNode *source_node, IrInstruction *msg) {
     IrInstructionPanic *instruction = ir_build_instruction<IrInstructionPanic>(irb, scope, source_node);
-    instruction->base.value.special = ConstValSpecialStatic;
-    instruction->base.value.type = irb->codegen->builtin_types.entry_unreachable;
+    instruction->base.value->special = ConstValSpecialStatic;
+    instruction->base.value->type = irb->codegen->builtin_types.entry_unreachable;
     instruction->msg = msg;
 
     ir_ref_instruction(msg, irb->current_basic_block);
@@ -2185,6 +2272,17 @@ static IrInstruction *ir_build_type_id(IrBuilder *irb, Scope *scope, AstNode *so
     return &instruction->base;
 }
 
+static IrInstruction *ir_build_set_eval_branch_quota(IrBuilder *irb, Scope *scope, AstNode *source_node,
+        IrInstruction *new_quota)
+{
+    IrInstructionSetEvalBranchQuota *instruction = ir_build_instruction<IrInstructionSetEvalBranchQuota>(irb, scope, source_node);
+    instruction->new_quota = new_quota;
+
+    ir_ref_instruction(new_quota, irb->current_basic_block);
+
+    return &instruction->base;
+}
+
 static IrInstruction *ir_instruction_br_get_dep(IrInstructionBr *instruction, size_t index) {
     return nullptr;
 }
@@ -2874,6 +2972,15 @@ static IrInstruction *ir_instruction_typeid_get_dep(IrInstructionTypeId *instruc
     }
 }
 
+static IrInstruction *ir_instruction_setevalbranchquota_get_dep(IrInstructionSetEvalBranchQuota *instruction,
+        size_t index)
+{
+    switch (index) {
+        case 0: return instruction->new_quota;
+        default: return nullptr;
+    }
+}
+
 static IrInstruction *ir_instruction_get_dep(IrInstruction *instruction, size_t index) {
     switch (instruction->id) {
         case IrInstructionIdInvalid:
@@ -3068,6 +3175,8 @@ static IrInstruction *ir_instruction_get_dep(IrInstruction *instruction, size_t
             return ir_instruction_offsetof_get_dep((IrInstructionOffsetOf *) instruction, index);
         case IrInstructionIdTypeId:
             return ir_instruction_typeid_get_dep((IrInstructionTypeId *) instruction, index);
+        case IrInstructionIdSetEvalBranchQuota:
+            return ir_instruction_setevalbranchquota_get_dep((IrInstructionSetEvalBranchQuota *) instruction, index);
     }
     zig_unreachable();
 }
@@ -3241,10 +3350,11 @@ static VariableTableEntry *create_local_var(CodeGen *codegen, AstNode *node, Sco
     variable_entry->mem_slot_index = SIZE_MAX;
     variable_entry->is_comptime = is_comptime;
     variable_entry->src_arg_index = SIZE_MAX;
-    variable_entry->value = create_const_vals(1);
+    variable_entry->value = create_const_vals(codegen, 1);
 
     if (name) {
-        buf_init_from_buf(&variable_entry->name, name);
+        name = intern_buf(codegen, name);
+        variable_entry->name = name;
 
         VariableTableEntry *existing_var = find_variable(codegen, parent_scope, name);
         if (existing_var && !existing_var->shadowable) {
@@ -3275,7 +3385,7 @@ static VariableTableEntry *create_local_var(CodeGen *codegen, AstNode *node, Sco
         // TODO make this name not actually be in scope. user should be able to make a variable called "_anon"
         // might already be solved, let's just make sure it has test coverage
         // maybe we put a prefix on this so the debug info doesn't clobber user debug info for same named variables
-        buf_init_from_str(&variable_entry->name, "_anon");
+        variable_entry->name = intern_buf(codegen, buf_create_from_str("_anon"));
     }
 
     variable_entry->src_is_const = src_is_const;
@@ -3723,10 +3833,10 @@ static IrInstruction *ir_gen_symbol(IrBuilder *irb, Scope *scope, AstNode *node,
 
     if (buf_eql_str(variable_name, "_") && lval.is_ptr) {
         IrInstructionConst *const_instruction = ir_build_instruction<IrInstructionConst>(irb, scope, node);
-        const_instruction->base.value.type = get_pointer_to_type(irb->codegen,
+        const_instruction->base.value->type = get_pointer_to_type(irb->codegen,
                 irb->codegen->builtin_types.entry_void, false);
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_ptr.special = ConstPtrSpecialDiscard;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_ptr.special = ConstPtrSpecialDiscard;
         return &const_instruction->base;
     }
 
@@ -3934,6 +4044,8 @@ static IrInstruction *ir_gen_builtin_fn_call(IrBuilder *irb, Scope *scope, AstNo
             }
         case BuiltinFnIdCImport:
             {
+                // the block is evaluated with this scope during analysis
+                irb->exec->captures_scope = true;
                 return ir_build_c_import(irb, scope, node);
             }
         case BuiltinFnIdCInclude:
@@ -4435,6 +4547,15 @@ static IrInstruction *ir_gen_builtin_fn_call(IrBuilder *irb, Scope *scope, AstNo
 
                 return ir_build_type_id(irb, scope, node, arg0_value);
             }
+        case BuiltinFnIdSetEvalBranchQuota:
+            {
+                AstNode *arg0_node = node->data.fn_call_expr.params.at(0);
+                IrInstruction *arg0_value = ir_gen_node(irb, arg0_node, scope);
+                if (arg0_value == irb->codegen->invalid_instruction)
+                    return arg0_value;
+
+                return ir_build_set_eval_branch_quota(irb, scope, node, arg0_value);
+            }
     }
     zig_unreachable();
 }
@@ -5205,6 +5326,7 @@ static IrInstruction *ir_gen_asm_expr(IrBuilder *irb, Scope *scope, AstNode *nod
         } else {
             Buf *variable_name = asm_output->variable_name;
             VariableTableEntry *var = find_variable(irb->codegen, scope, variable_name);
+            irb->exec->captures_scope = true;
             if (var) {
                 output_vars[i] = var;
             } else {
@@ -5846,6 +5968,9 @@ static bool render_instance_name_recursive(CodeGen *codegen, Buf *name, Scope *o
 static IrInstruction *ir_gen_container_decl(IrBuilder *irb, Scope *parent_scope, AstNode *node) {
     assert(node->type == NodeTypeContainerDecl);
 
+    // the container type is created here, with parent_scope as its parent
+    irb->exec->captures_scope = true;
+
     ContainerKind kind = node->data.container_decl.kind;
     Buf *name;
     if (irb->exec->name) {
@@ -5860,14 +5985,14 @@ static IrInstruction *ir_gen_container_decl(IrBuilder *irb, Scope *parent_scope,
             buf_appendf(name, ")");
         } else {
             name = buf_sprintf("(anonymous %s at %s:%" ZIG_PRI_usize ":%" ZIG_PRI_usize ")", container_string(kind),
-                buf_ptr(node->owner->path), node->line + 1, node->column + 1);
+                buf_ptr(node->owner->path), (size_t)node->line + 1, (size_t)node->column + 1);
         }
     }
 
 
     VisibMod visib_mod = VisibModPub;
     TldContainer *tld_container = allocate<TldContainer>(1);
-    init_tld(&tld_container->base, TldIdContainer, name, visib_mod, node, parent_scope);
+    init_tld(irb->codegen, &tld_container->base, TldIdContainer, name, visib_mod, node, parent_scope);
 
     ContainerLayout layout = node->data.container_decl.layout;
     TypeTableEntry *container_type = get_partial_container_type(irb->codegen, parent_scope,
@@ -6127,6 +6252,11 @@ bool ir_gen_fn(CodeGen *codegen, FnTableEntry *fn_entry) {
 
     assert(fn_entry->child_scope);
 
+    if (codegen->free_ir) {
+        arena_init(&fn_entry->ir_arena, codegen->ir_arena.name);
+        ir_executable->arena = &fn_entry->ir_arena;
+    }
+
     return ir_gen(codegen, body_node, fn_entry->child_scope, ir_executable);
 }
 
@@ -6161,7 +6291,7 @@ static IrInstruction *ir_exec_const_result(CodeGen *codegen, IrExecutable *exec)
         if (instruction->id == IrInstructionIdReturn) {
             IrInstructionReturn *ret_inst = (IrInstructionReturn *)instruction;
             IrInstruction *value = ret_inst->value;
-            if (value->value.special == ConstValSpecialRuntime) {
+            if (value->value->special == ConstValSpecialRuntime) {
                 exec_add_error_node(codegen, exec, value->source_node,
                         buf_sprintf("unable to evaluate constant expression"));
                 return codegen->invalid_instruction;
@@ -6189,7 +6319,7 @@ static bool ir_num_lit_fits_in_other_type(IrAnalyze *ira, IrInstruction *instruc
         return false;
     }
 
-    ConstExprValue *const_val = &instruction->value;
+    ConstExprValue *const_val = instruction->value;
     assert(const_val->special != ConstValSpecialRuntime);
     if (other_type->id == TypeTableEntryIdFloat) {
         return true;
@@ -6410,7 +6540,7 @@ static ImplicitCastMatchResult ir_types_match_with_implicit_cast(IrAnalyze *ira,
 
     // implicit typed number to integer or float literal.
     // works when the number is known
-    if (value->value.special == ConstValSpecialStatic) {
+    if (value->value->special == ConstValSpecialStatic) {
         if (actual_type->id == TypeTableEntryIdInt && expected_type->id == TypeTableEntryIdNumLitInt) {
             return ImplicitCastMatchResultYes;
         } else if (actual_type->id == TypeTableEntryIdFloat && expected_type->id == TypeTableEntryIdNumLitFloat) {
@@ -6437,16 +6567,16 @@ static ImplicitCastMatchResult ir_types_match_with_implicit_cast(IrAnalyze *ira,
 static TypeTableEntry *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_node, IrInstruction **instructions, size_t instruction_count) {
     assert(instruction_count >= 1);
     IrInstruction *prev_inst = instructions[0];
-    if (type_is_invalid(prev_inst->value.type)) {
+    if (type_is_invalid(prev_inst->value->type)) {
         return ira->codegen->builtin_types.entry_invalid;
     }
-    bool any_are_pure_error = (prev_inst->value.type->id == TypeTableEntryIdPureError);
-    bool any_are_null = (prev_inst->value.type->id == TypeTableEntryIdNullLit);
+    bool any_are_pure_error = (prev_inst->value->type->id == TypeTableEntryIdPureError);
+    bool any_are_null = (prev_inst->value->type->id == TypeTableEntryIdNullLit);
     bool convert_to_const_slice = false;
     for (size_t i = 1; i < instruction_count; i += 1) {
         IrInstruction *cur_inst = instructions[i];
-        TypeTableEntry *cur_type = cur_inst->value.type;
-        TypeTableEntry *prev_type = prev_inst->value.type;
+        TypeTableEntry *cur_type = cur_inst->value->type;
+        TypeTableEntry *prev_type = prev_inst->value->type;
         if (type_is_invalid(cur_type)) {
             return cur_type;
         } else if (prev_type->id == TypeTableEntryIdUnreachable) {
@@ -6570,43 +6700,43 @@ static TypeTableEntry *ir_resolve_peer_types(IrAnalyze *ira, AstNode *source_nod
         }
     }
     if (convert_to_const_slice) {
-        assert(prev_inst->value.type->id == TypeTableEntryIdArray);
-        TypeTableEntry *slice_type = get_slice_type(ira->codegen, prev_inst->value.type->data.array.child_type, true);
+        assert(prev_inst->value->type->id == TypeTableEntryIdArray);
+        TypeTableEntry *slice_type = get_slice_type(ira->codegen, prev_inst->value->type->data.array.child_type, true);
         if (any_are_pure_error) {
             return get_error_type(ira->codegen, slice_type);
         } else {
             return slice_type;
         }
-    } else if (any_are_pure_error && prev_inst->value.type->id != TypeTableEntryIdPureError) {
-        if (prev_inst->value.type->id == TypeTableEntryIdNumLitInt ||
-            prev_inst->value.type->id == TypeTableEntryIdNumLitFloat)
+    } else if (any_are_pure_error && prev_inst->value->type->id != TypeTableEntryIdPureError) {
+        if (prev_inst->value->type->id == TypeTableEntryIdNumLitInt ||
+            prev_inst->value->type->id == TypeTableEntryIdNumLitFloat)
         {
             ir_add_error_node(ira, source_node,
                 buf_sprintf("unable to make error union out of number literal"));
             return ira->codegen->builtin_types.entry_invalid;
-        } else if (prev_inst->value.type->id == TypeTableEntryIdNullLit) {
+        } else if (prev_inst->value->type->id == TypeTableEntryIdNullLit) {
             ir_add_error_node(ira, source_node,
                 buf_sprintf("unable to make error union out of null literal"));
             return ira->codegen->builtin_types.entry_invalid;
-        } else if (prev_inst->value.type->id == TypeTableEntryIdErrorUnion) {
-            return prev_inst->value.type;
+        } else if (prev_inst->value->type->id == TypeTableEntryIdErrorUnion) {
+            return prev_inst->value->type;
         } else {
-            return get_error_type(ira->codegen, prev_inst->value.type);
+            return get_error_type(ira->codegen, prev_inst->value->type);
         }
-    } else if (any_are_null && prev_inst->value.type->id != TypeTableEntryIdNullLit) {
-        if (prev_inst->value.type->id == TypeTableEntryIdNumLitInt ||
-            prev_inst->value.type->id == TypeTableEntryIdNumLitFloat)
+    } else if (any_are_null && prev_inst->value->type->id != TypeTableEntryIdNullLit) {
+        if (prev_inst->value->type->id == TypeTableEntryIdNumLitInt ||
+            prev_inst->value->type->id == TypeTableEntryIdNumLitFloat)
         {
             ir_add_error_node(ira, source_node,
                 buf_sprintf("unable to make maybe out of number literal"));
             return ira->codegen->builtin_types.entry_invalid;
-        } else if (prev_inst->value.type->id == TypeTableEntryIdMaybe) {
-            return prev_inst->value.type;
+        } else if (prev_inst->value->type->id == TypeTableEntryIdMaybe) {
+            return prev_inst->value->type;
         } else {
-            return get_maybe_type(ira->codegen, prev_inst->value.type);
+            return get_maybe_type(ira->codegen, prev_inst->value->type);
         }
     } else {
-        return prev_inst->value.type;
+        return prev_inst->value->type;
     }
 }
 
@@ -6618,15 +6748,20 @@ static void ir_add_alloca(IrAnalyze *ira, IrInstruction *instruction, TypeTableE
     }
 }
 
-static void copy_const_val(ConstExprValue *dest, ConstExprValue *src, bool same_global_refs) {
+static void copy_const_val(CodeGen *g, ConstExprValue *dest, ConstExprValue *src, bool same_global_refs) {
     ConstGlobalRefs *global_refs = dest->global_refs;
     *dest = *src;
     if (!same_global_refs) {
         dest->global_refs = global_refs;
+        if (src->special == ConstValSpecialStatic && src->type->id == TypeTableEntryIdArray &&
+            src->data.x_array.special == ConstArraySpecialDense)
+        {
+            copy_dense_const_array(g, dest, src);
+        }
     }
 }
 
-static void eval_const_expr_implicit_cast(CastOp cast_op,
+static void eval_const_expr_implicit_cast(CodeGen *g, CastOp cast_op,
         ConstExprValue *other_val, TypeTableEntry *other_type,
         ConstExprValue *const_val, TypeTableEntry *new_type)
 {
@@ -6638,7 +6773,7 @@ static void eval_const_expr_implicit_cast(CastOp cast_op,
             zig_unreachable();
         case CastOpNoop:
             {
-                copy_const_val(const_val, other_val, other_val->special == ConstValSpecialStatic);
+                copy_const_val(g, const_val, other_val, other_val->special == ConstValSpecialStatic);
                 const_val->type = new_type;
                 break;
             }
@@ -6667,15 +6802,15 @@ static void eval_const_expr_implicit_cast(CastOp cast_op,
 static IrInstruction *ir_resolve_cast(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value,
         TypeTableEntry *wanted_type, CastOp cast_op, bool need_alloca)
 {
-    if (value->value.special != ConstValSpecialRuntime) {
+    if (value->value->special != ConstValSpecialRuntime) {
         IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, wanted_type);
-        eval_const_expr_implicit_cast(cast_op, &value->value, value->value.type,
-                &result->value, wanted_type);
+        eval_const_expr_implicit_cast(ira->codegen, cast_op, value->value, value->value->type,
+                result->value, wanted_type);
         return result;
     } else {
         IrInstruction *result = ir_build_cast(&ira->new_irb, source_instr->scope, source_instr->source_node, wanted_type, value, cast_op);
-        result->value.type = wanted_type;
+        result->value->type = wanted_type;
         if (need_alloca) {
             FnTableEntry *fn_entry = exec_fn_entry(ira->new_irb.exec);
             if (fn_entry)
@@ -6768,7 +6903,7 @@ static TypeTableEntry *ir_unreach_error(IrAnalyze *ira) {
 
 static bool ir_emit_backward_branch(IrAnalyze *ira, IrInstruction *source_instruction) {
     size_t *bbc = ira->new_irb.exec->backward_branch_count;
-    size_t quota = ira->new_irb.exec->backward_branch_quota;
+    size_t quota = *ira->new_irb.exec->backward_branch_quota;
 
     // If we're already over quota, we've already given an error message for this.
     if (*bbc > quota)
@@ -6799,13 +6934,22 @@ static TypeTableEntry *ir_finish_anal(IrAnalyze *ira, TypeTableEntry *result_typ
     return result_type;
 }
 
+static VariableTableEntry *ir_remap_var(IrAnalyze *ira, VariableTableEntry *var) {
+    IrExecutable *exec = ira->new_irb.exec;
+    for (size_t i = 0; i < exec->param_var_count; i += 1) {
+        if (exec->param_vars_old[i] == var)
+            return exec->param_vars_new[i];
+    }
+    return var;
+}
+
 static IrInstruction *ir_get_const(IrAnalyze *ira, IrInstruction *old_instruction) {
     IrInstruction *new_instruction;
     if (old_instruction->id == IrInstructionIdVarPtr) {
         IrInstructionVarPtr *old_var_ptr_instruction = (IrInstructionVarPtr *)old_instruction;
         IrInstructionVarPtr *var_ptr_instruction = ir_create_instruction<IrInstructionVarPtr>(&ira->new_irb,
                 old_instruction->scope, old_instruction->source_node);
-        var_ptr_instruction->var = old_var_ptr_instruction->var;
+        var_ptr_instruction->var = ir_remap_var(ira, old_var_ptr_instruction->var);
         new_instruction = &var_ptr_instruction->base;
     } else if (old_instruction->id == IrInstructionIdFieldPtr) {
         IrInstructionFieldPtr *field_ptr_instruction = ir_create_instruction<IrInstructionFieldPtr>(&ira->new_irb,
@@ -6820,14 +6964,16 @@ static IrInstruction *ir_get_const(IrAnalyze *ira, IrInstruction *old_instructio
                 old_instruction->scope, old_instruction->source_node);
         new_instruction = &const_instruction->base;
     }
-    new_instruction->value.special = ConstValSpecialStatic;
+    if (new_instruction->value->global_refs == nullptr)
+        ir_alloc_global_refs(&ira->new_irb, new_instruction);
+    new_instruction->value->special = ConstValSpecialStatic;
     return new_instruction;
 }
 
 static ConstExprValue *ir_build_const_from(IrAnalyze *ira, IrInstruction *old_instruction) {
     IrInstruction *new_instruction = ir_get_const(ira, old_instruction);
     ir_link_new_instruction(new_instruction, old_instruction);
-    return &new_instruction->value;
+    return new_instruction->value;
 }
 
 static TypeTableEntry *ir_analyze_void(IrAnalyze *ira, IrInstruction *instruction) {
@@ -6847,7 +6993,7 @@ static IrInstruction *ir_get_const_ptr(IrAnalyze *ira, IrInstruction *instructio
         }
 
         IrInstruction *const_instr = ir_get_const(ira, instruction);
-        ConstExprValue *const_val = &const_instr->value;
+        ConstExprValue *const_val = const_instr->value;
         const_val->type = pointee_type;
         type_ensure_zero_bits_known(ira->codegen, type_entry);
         const_val->data.x_type = get_pointer_to_type_extra(ira->codegen, type_entry,
@@ -6857,7 +7003,7 @@ static IrInstruction *ir_get_const_ptr(IrAnalyze *ira, IrInstruction *instructio
         TypeTableEntry *ptr_type = get_pointer_to_type_extra(ira->codegen, pointee_type,
                 ptr_is_const, ptr_is_volatile, 0, 0);
         IrInstruction *const_instr = ir_get_const(ira, instruction);
-        ConstExprValue *const_val = &const_instr->value;
+        ConstExprValue *const_val = const_instr->value;
         const_val->type = ptr_type;
         const_val->data.x_ptr.special = ConstPtrSpecialRef;
         const_val->data.x_ptr.mut = ptr_mut;
@@ -6873,7 +7019,7 @@ static TypeTableEntry *ir_analyze_const_ptr(IrAnalyze *ira, IrInstruction *instr
     IrInstruction *const_instr = ir_get_const_ptr(ira, instruction, pointee,
             pointee_type, ptr_mut, ptr_is_const, ptr_is_volatile);
     ir_link_new_instruction(const_instr, instruction);
-    return const_instr->value.type;
+    return const_instr->value->type;
 }
 
 static TypeTableEntry *ir_analyze_const_usize(IrAnalyze *ira, IrInstruction *instruction, uint64_t value) {
@@ -6888,15 +7034,17 @@ enum UndefAllowed {
 };
 
 static ConstExprValue *ir_resolve_const(IrAnalyze *ira, IrInstruction *value, UndefAllowed undef_allowed) {
-    switch (value->value.special) {
+    switch (value->value->special) {
         case ConstValSpecialStatic:
-            return &value->value;
+            ir_assert_whole_value(value);
+            return value->value;
         case ConstValSpecialRuntime:
             ir_add_error(ira, value, buf_sprintf("unable to evaluate constant expression"));
             return nullptr;
         case ConstValSpecialUndef:
+            ir_assert_whole_value(value);
             if (undef_allowed == UndefOk) {
-                return &value->value;
+                return value->value;
             } else {
                 ir_add_error(ira, value, buf_sprintf("use of undefined value"));
                 return nullptr;
@@ -6905,29 +7053,117 @@ static ConstExprValue *ir_resolve_const(IrAnalyze *ira, IrInstruction *value, Un
     zig_unreachable();
 }
 
+// The parameter variables that a comptime call of fn_entry declared, from
+// the first parameter to the last.
+static void ir_collect_param_vars(FnTableEntry *fn_entry, Scope *scope, ZigList<VariableTableEntry *> *out) {
+    out->resize(0);
+    for (; scope != &fn_entry->fndef_scope->base; scope = scope->parent) {
+        assert(scope->id == ScopeIdVarDecl);
+        out->append(((ScopeVarDecl *)scope)->var);
+    }
+    for (size_t i = 0; i < out->length / 2; i += 1) {
+        VariableTableEntry *tmp = out->at(i);
+        out->at(i) = out->at(out->length - 1 - i);
+        out->at(out->length - 1 - i) = tmp;
+    }
+}
+
+// Forget which new basic blocks and instructions a previous analysis of
+// exec produced, so that it can be analyzed again from scratch.
+static void ir_reset_analysis(IrExecutable *exec) {
+    for (size_t bb_i = 0; bb_i < exec->basic_block_list.length; bb_i += 1) {
+        IrBasicBlock *bb = exec->basic_block_list.at(bb_i);
+        bb->other = nullptr;
+        for (size_t instr_i = 0; instr_i < bb->instruction_list.length; instr_i += 1) {
+            bb->instruction_list.at(instr_i)->other = nullptr;
+        }
+    }
+}
+
+// The pass-1 IR of a comptime expression is generated into a scratch arena.
+// Analysis copies out everything the result refers to, so the IR is freed
+// once it has been analyzed, unless it is kept to be reused by later calls or
+// declared a container, whose scope outlives the evaluation.
+static void ir_release_comptime_scratch(CodeGen *g, IrExecutable *exec, bool keep) {
+    Arena *scratch_arena = exec->arena;
+    exec->arena = nullptr;
+    if (keep) {
+        g->comptime_scratch_bytes_kept += scratch_arena->bytes_reserved;
+        arena_adopt(get_ir_arena(g), scratch_arena);
+        return;
+    }
+
+    for (size_t block_i = 0; block_i < exec->basic_block_list.length; block_i += 1) {
+        exec->basic_block_list.at(block_i)->instruction_list.deinit();
+    }
+    exec->basic_block_list.deinit();
+    exec->all_labels.deinit();
+    exec->goto_list.deinit();
+    free(exec);
+
+    g->comptime_scratch_bytes_freed += scratch_arena->bytes_reserved;
+    arena_deinit(scratch_arena);
+}
+
 IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node,
-        TypeTableEntry *expected_type, size_t *backward_branch_count, size_t backward_branch_quota,
+        TypeTableEntry *expected_type, size_t *backward_branch_count, size_t *backward_branch_quota,
         FnTableEntry *fn_entry, Buf *c_import_buf, AstNode *source_node, Buf *exec_name,
         IrExecutable *parent_exec)
 {
-    IrExecutable ir_executable = {0};
-    ir_executable.source_node = source_node;
-    ir_executable.parent_exec = parent_exec;
-    ir_executable.name = exec_name;
-    ir_executable.is_inline = true;
-    ir_executable.fn_entry = fn_entry;
-    ir_executable.c_import_buf = c_import_buf;
-    ir_executable.begin_scope = scope;
-    ir_gen(codegen, node, scope, &ir_executable);
-
-    if (ir_executable.invalid)
-        return codegen->invalid_instruction;
+    // Comptime calls of a function analyze the same pass-1 IR each time,
+    // unless the IR captured its scope or the function is already being
+    // analyzed further up the stack. The parameters that the IR refers to
+    // are swapped for the ones of this call during analysis.
+    bool is_fn_body = (fn_entry != nullptr && node == fn_entry->body_node);
+    bool shares_ir;
+    IrExecutable *ir_executable;
+    ZigList<VariableTableEntry *> param_vars = {};
+    Arena scratch_arena;
+    if (is_fn_body && fn_entry->comptime_ir != nullptr && !fn_entry->comptime_ir_in_use) {
+        ir_collect_param_vars(fn_entry, scope, &param_vars);
+        assert(param_vars.length == fn_entry->comptime_ir_params.length);
+        ir_executable = fn_entry->comptime_ir;
+        shares_ir = true;
+        ir_reset_analysis(ir_executable);
+        codegen->comptime_ir_reuse_count += 1;
+    } else {
+        ir_executable = allocate<IrExecutable>(1);
+        ir_executable->source_node = source_node;
+        ir_executable->parent_exec = parent_exec;
+        ir_executable->name = exec_name;
+        ir_executable->is_inline = true;
+        ir_executable->fn_entry = fn_entry;
+        ir_executable->c_import_buf = c_import_buf;
+        ir_executable->begin_scope = scope;
+        arena_init(&scratch_arena, "Comptime Scratch");
+        ir_executable->arena = &scratch_arena;
+        ir_gen(codegen, node, scope, ir_executable);
+
+        if (ir_executable->invalid) {
+            ir_release_comptime_scratch(codegen, ir_executable, ir_executable->captures_scope);
+            return codegen->invalid_instruction;
+        }
+
+        shares_ir = false;
+        if (is_fn_body) {
+            codegen->comptime_ir_gen_count += 1;
+            if (fn_entry->comptime_ir == nullptr && !fn_entry->comptime_ir_uncacheable) {
+                if (ir_executable->captures_scope) {
+                    fn_entry->comptime_ir_uncacheable = true;
+                } else {
+                    fn_entry->comptime_ir = ir_executable;
+                    ir_collect_param_vars(fn_entry, scope, &fn_entry->comptime_ir_params);
+                    shares_ir = true;
+                }
+            }
+        }
+    }
 
     if (codegen->verbose) {
         fprintf(stderr, "\nSource: ");
         ast_render(codegen, stderr, node, 4);
         fprintf(stderr, "\n{ // (IR)\n");
-        ir_print(codegen, stderr, &ir_executable, 4);
+        ir_print(codegen, stderr, ir_executable, 4);
         fprintf(stderr, "}\n");
     }
     IrExecutable analyzed_executable = {0};
@@ -6940,7 +7176,17 @@ IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node
     analyzed_executable.backward_branch_count = backward_branch_count;
     analyzed_executable.backward_branch_quota = backward_branch_quota;
     analyzed_executable.begin_scope = scope;
-    TypeTableEntry *result_type = ir_analyze(codegen, &ir_executable, &analyzed_executable, expected_type, node);
+    if (shares_ir) {
+        analyzed_executable.param_vars_old = fn_entry->comptime_ir_params.items;
+        analyzed_executable.param_vars_new = param_vars.items;
+        analyzed_executable.param_var_count = param_vars.length;
+        fn_entry->comptime_ir_in_use = true;
+    }
+    TypeTableEntry *result_type = ir_analyze(codegen, ir_executable, &analyzed_executable, expected_type, node);
+    if (shares_ir)
+        fn_entry->comptime_ir_in_use = false;
+    if (ir_executable->arena == &scratch_arena)
+        ir_release_comptime_scratch(codegen, ir_executable, shares_ir || ir_executable->captures_scope);
     if (type_is_invalid(result_type))
         return codegen->invalid_instruction;
 
@@ -6954,12 +7200,12 @@ IrInstruction *ir_eval_const_value(CodeGen *codegen, Scope *scope, AstNode *node
 }
 
 static TypeTableEntry *ir_resolve_type(IrAnalyze *ira, IrInstruction *type_value) {
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (type_value->value.type->id != TypeTableEntryIdMetaType) {
+    if (type_value->value->type->id != TypeTableEntryIdMetaType) {
         ir_add_error(ira, type_value,
-                buf_sprintf("expected type 'type', found '%s'", buf_ptr(&type_value->value.type->name)));
+                buf_sprintf("expected type 'type', found '%s'", buf_ptr(&type_value->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
@@ -6974,12 +7220,12 @@ static FnTableEntry *ir_resolve_fn(IrAnalyze *ira, IrInstruction *fn_value) {
     if (fn_value == ira->codegen->invalid_instruction)
         return nullptr;
 
-    if (type_is_invalid(fn_value->value.type))
+    if (type_is_invalid(fn_value->value->type))
         return nullptr;
 
-    if (fn_value->value.type->id != TypeTableEntryIdFn) {
+    if (fn_value->value->type->id != TypeTableEntryIdFn) {
         ir_add_error_node(ira, fn_value->source_node,
-                buf_sprintf("expected function type, found '%s'", buf_ptr(&fn_value->value.type->name)));
+                buf_sprintf("expected function type, found '%s'", buf_ptr(&fn_value->value->type->name)));
         return nullptr;
     }
 
@@ -6996,7 +7242,7 @@ static IrInstruction *ir_analyze_maybe_wrap(IrAnalyze *ira, IrInstruction *sourc
     if (instr_is_comptime(value)) {
         TypeTableEntry *payload_type = wanted_type->data.maybe.child_type;
         IrInstruction *casted_payload = ir_implicit_cast(ira, value, payload_type);
-        if (type_is_invalid(casted_payload->value.type))
+        if (type_is_invalid(casted_payload->value->type))
             return ira->codegen->invalid_instruction;
 
         ConstExprValue *val = ir_resolve_const(ira, casted_payload, UndefBad);
@@ -7005,15 +7251,15 @@ static IrInstruction *ir_analyze_maybe_wrap(IrAnalyze *ira, IrInstruction *sourc
 
         IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                 source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_maybe = val;
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_maybe = val;
         return &const_instruction->base;
     }
 
     IrInstruction *result = ir_build_maybe_wrap(&ira->new_irb, source_instr->scope, source_instr->source_node, value);
-    result->value.type = wanted_type;
-    result->value.data.rh_maybe = RuntimeHintMaybeNonNull;
+    result->value->type = wanted_type;
+    result->value->data.rh_maybe = RuntimeHintMaybeNonNull;
     ir_add_alloca(ira, result, wanted_type);
     return result;
 }
@@ -7026,7 +7272,7 @@ static IrInstruction *ir_analyze_err_wrap_payload(IrAnalyze *ira, IrInstruction
     if (instr_is_comptime(value)) {
         TypeTableEntry *payload_type = wanted_type->data.error.child_type;
         IrInstruction *casted_payload = ir_implicit_cast(ira, value, payload_type);
-        if (type_is_invalid(casted_payload->value.type))
+        if (type_is_invalid(casted_payload->value->type))
             return ira->codegen->invalid_instruction;
 
         ConstExprValue *val = ir_resolve_const(ira, casted_payload, UndefBad);
@@ -7035,16 +7281,16 @@ static IrInstruction *ir_analyze_err_wrap_payload(IrAnalyze *ira, IrInstruction
 
         IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                 source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_err_union.err = nullptr;
-        const_instruction->base.value.data.x_err_union.payload = val;
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_err_union.err = nullptr;
+        const_instruction->base.value->data.x_err_union.payload = val;
         return &const_instruction->base;
     }
 
     IrInstruction *result = ir_build_err_wrap_payload(&ira->new_irb, source_instr->scope, source_instr->source_node, value);
-    result->value.type = wanted_type;
-    result->value.data.rh_error_union = RuntimeHintErrorUnionNonError;
+    result->value->type = wanted_type;
+    result->value->data.rh_error_union = RuntimeHintErrorUnionNonError;
     ir_add_alloca(ira, result, wanted_type);
     return result;
 }
@@ -7059,16 +7305,16 @@ static IrInstruction *ir_analyze_err_wrap_code(IrAnalyze *ira, IrInstruction *so
 
         IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                 source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_err_union.err = val->data.x_pure_err;
-        const_instruction->base.value.data.x_err_union.payload = nullptr;
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_err_union.err = val->data.x_pure_err;
+        const_instruction->base.value->data.x_err_union.payload = nullptr;
         return &const_instruction->base;
     }
 
     IrInstruction *result = ir_build_err_wrap_code(&ira->new_irb, source_instr->scope, source_instr->source_node, value);
-    result->value.type = wanted_type;
-    result->value.data.rh_error_union = RuntimeHintErrorUnionError;
+    result->value->type = wanted_type;
+    result->value->data.rh_error_union = RuntimeHintErrorUnionError;
     ir_add_alloca(ira, result, wanted_type);
     return result;
 }
@@ -7083,10 +7329,10 @@ static IrInstruction *ir_analyze_cast_ref(IrAnalyze *ira, IrInstruction *source_
 
         IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                 source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = wanted_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        const_instruction->base.value.data.x_ptr.special = ConstPtrSpecialRef;
-        const_instruction->base.value.data.x_ptr.data.ref.pointee = val;
+        const_instruction->base.value->type = wanted_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        const_instruction->base.value->data.x_ptr.special = ConstPtrSpecialRef;
+        const_instruction->base.value->data.x_ptr.data.ref.pointee = val;
         return &const_instruction->base;
     }
 
@@ -7096,7 +7342,7 @@ static IrInstruction *ir_analyze_cast_ref(IrAnalyze *ira, IrInstruction *source_
     } else {
         IrInstruction *new_instruction = ir_build_ref(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, value, true, false);
-        new_instruction->value.type = wanted_type;
+        new_instruction->value->type = wanted_type;
 
         TypeTableEntry *child_type = wanted_type->data.pointer.child_type;
         if (type_has_bits(child_type)) {
@@ -7116,21 +7362,21 @@ static IrInstruction *ir_analyze_null_to_maybe(IrAnalyze *ira, IrInstruction *so
     assert(val);
 
     IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb, source_instr->scope, source_instr->source_node);
-    const_instruction->base.value.type = wanted_type;
-    const_instruction->base.value.special = ConstValSpecialStatic;
-    const_instruction->base.value.data.x_maybe = nullptr;
+    const_instruction->base.value->type = wanted_type;
+    const_instruction->base.value->special = ConstValSpecialStatic;
+    const_instruction->base.value->data.x_maybe = nullptr;
     return &const_instruction->base;
 }
 
 static IrInstruction *ir_get_ref(IrAnalyze *ira, IrInstruction *source_instruction, IrInstruction *value,
         bool is_const, bool is_volatile)
 {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
     if (value->id == IrInstructionIdLoadPtr) {
         IrInstructionLoadPtr *load_ptr_inst = (IrInstructionLoadPtr *) value;
-        if (load_ptr_inst->ptr->value.type->data.pointer.is_const) {
+        if (load_ptr_inst->ptr->value->type->data.pointer.is_const) {
             return load_ptr_inst->ptr;
         }
     }
@@ -7139,18 +7385,18 @@ static IrInstruction *ir_get_ref(IrAnalyze *ira, IrInstruction *source_instructi
         ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
         if (!val)
             return ira->codegen->invalid_instruction;
-        bool final_is_const = (value->value.type->id == TypeTableEntryIdMetaType) ? is_const : true;
-        return ir_get_const_ptr(ira, source_instruction, val, value->value.type,
+        bool final_is_const = (value->value->type->id == TypeTableEntryIdMetaType) ? is_const : true;
+        return ir_get_const_ptr(ira, source_instruction, val, value->value->type,
                 ConstPtrMutComptimeConst, final_is_const, is_volatile);
     }
 
-    TypeTableEntry *ptr_type = get_pointer_to_type_extra(ira->codegen, value->value.type, is_const, is_volatile, 0, 0);
+    TypeTableEntry *ptr_type = get_pointer_to_type_extra(ira->codegen, value->value->type, is_const, is_volatile, 0, 0);
     FnTableEntry *fn_entry = exec_fn_entry(ira->new_irb.exec);
     assert(fn_entry);
     IrInstruction *new_instruction = ir_build_ref(&ira->new_irb, source_instruction->scope,
             source_instruction->source_node, value, is_const, is_volatile);
-    new_instruction->value.type = ptr_type;
-    new_instruction->value.data.rh_ptr = RuntimeHintPtrStack;
+    new_instruction->value->type = ptr_type;
+    new_instruction->value->data.rh_ptr = RuntimeHintPtrStack;
     fn_entry->alloca_list.append(new_instruction);
     return new_instruction;
 }
@@ -7164,37 +7410,37 @@ static IrInstruction *ir_analyze_array_to_slice(IrAnalyze *ira, IrInstruction *s
 
     IrInstruction *array_ptr = nullptr;
     IrInstruction *array;
-    if (array_arg->value.type->id == TypeTableEntryIdPointer) {
+    if (array_arg->value->type->id == TypeTableEntryIdPointer) {
         array = ir_get_deref(ira, source_instr, array_arg);
         array_ptr = array_arg;
     } else {
         array = array_arg;
     }
-    TypeTableEntry *array_type = array->value.type;
+    TypeTableEntry *array_type = array->value->type;
     assert(array_type->id == TypeTableEntryIdArray);
 
     if (instr_is_comptime(array)) {
         IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, wanted_type);
-        init_const_slice(ira->codegen, &result->value, &array->value, 0, array_type->data.array.len, true);
-        result->value.type = wanted_type;
+        init_const_slice(ira->codegen, result->value, array->value, 0, array_type->data.array.len, true);
+        result->value->type = wanted_type;
         return result;
     }
 
     IrInstruction *start = ir_create_const(&ira->new_irb, source_instr->scope,
             source_instr->source_node, ira->codegen->builtin_types.entry_usize);
-    init_const_usize(ira->codegen, &start->value, 0);
+    init_const_usize(ira->codegen, start->value, 0);
 
     IrInstruction *end = ir_create_const(&ira->new_irb, source_instr->scope,
             source_instr->source_node, ira->codegen->builtin_types.entry_usize);
-    init_const_usize(ira->codegen, &end->value, array_type->data.array.len);
+    init_const_usize(ira->codegen, end->value, array_type->data.array.len);
 
     if (!array_ptr) array_ptr = ir_get_ref(ira, source_instr, array, true, false);
 
     IrInstruction *result = ir_build_slice(&ira->new_irb, source_instr->scope,
             source_instr->source_node, array_ptr, start, end, false);
-    result->value.type = wanted_type;
-    ir_add_alloca(ira, result, result->value.type);
+    result->value->type = wanted_type;
+    ir_add_alloca(ira, result, result->value->type);
 
     return result;
 }
@@ -7210,13 +7456,13 @@ static IrInstruction *ir_analyze_enum_to_int(IrAnalyze *ira, IrInstruction *sour
             return ira->codegen->invalid_instruction;
         IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, wanted_type);
-        init_const_unsigned_negative(&result->value, wanted_type, val->data.x_enum.tag, false);
+        init_const_unsigned_negative(result->value, wanted_type, val->data.x_enum.tag, false);
         return result;
     }
 
     IrInstruction *result = ir_build_widen_or_shorten(&ira->new_irb, source_instr->scope,
             source_instr->source_node, target);
-    result->value.type = wanted_type;
+    result->value->type = wanted_type;
     return result;
 }
 
@@ -7225,7 +7471,7 @@ static IrInstruction *ir_analyze_undefined_to_anything(IrAnalyze *ira, IrInstruc
 {
     IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
             source_instr->source_node, wanted_type);
-    init_const_undefined(ira->codegen, &result->value);
+    init_const_undefined(ira->codegen, result->value);
     return result;
 }
 
@@ -7249,20 +7495,20 @@ static IrInstruction *ir_analyze_widen_or_shorten(IrAnalyze *ira, IrInstruction
             {
                 ir_add_error(ira, source_instr,
                     buf_sprintf("cast from '%s' to '%s' truncates bits",
-                        buf_ptr(&target->value.type->name), buf_ptr(&wanted_type->name)));
+                        buf_ptr(&target->value->type->name), buf_ptr(&wanted_type->name)));
                 return ira->codegen->invalid_instruction;
             }
         }
         IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, wanted_type);
-        result->value.data.x_bignum = val->data.x_bignum;
-        result->value.type = wanted_type;
+        result->value->data.x_bignum = val->data.x_bignum;
+        result->value->type = wanted_type;
         return result;
     }
 
     IrInstruction *result = ir_build_widen_or_shorten(&ira->new_irb, source_instr->scope,
             source_instr->source_node, target);
-    result->value.type = wanted_type;
+    result->value->type = wanted_type;
     return result;
 }
 
@@ -7278,14 +7524,14 @@ static IrInstruction *ir_analyze_ptr_to_int(IrAnalyze *ira, IrInstruction *sourc
         if (val->data.x_ptr.special == ConstPtrSpecialHardCodedAddr) {
             IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
                     source_instr->source_node, wanted_type);
-            bignum_init_unsigned(&result->value.data.x_bignum, val->data.x_ptr.data.hard_coded_addr.addr);
+            bignum_init_unsigned(&result->value->data.x_bignum, val->data.x_ptr.data.hard_coded_addr.addr);
             return result;
         }
     }
 
     IrInstruction *result = ir_build_ptr_to_int(&ira->new_irb, source_instr->scope,
             source_instr->source_node, target);
-    result->value.type = wanted_type;
+    result->value->type = wanted_type;
     return result;
 }
 
@@ -7301,13 +7547,13 @@ static IrInstruction *ir_analyze_int_to_enum(IrAnalyze *ira, IrInstruction *sour
             return ira->codegen->invalid_instruction;
         IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
                 source_instr->source_node, wanted_type);
-        result->value.data.x_enum.tag = val->data.x_bignum.data.x_uint;
+        result->value->data.x_enum.tag = val->data.x_bignum.data.x_uint;
         return result;
     }
 
     IrInstruction *result = ir_build_int_to_enum(&ira->new_irb, source_instr->scope,
             source_instr->source_node, target);
-    result->value.type = wanted_type;
+    result->value->type = wanted_type;
     return result;
 }
 
@@ -7320,13 +7566,13 @@ static IrInstruction *ir_analyze_number_to_literal(IrAnalyze *ira, IrInstruction
 
     IrInstruction *result = ir_create_const(&ira->new_irb, source_instr->scope,
             source_instr->source_node, wanted_type);
-    bignum_init_bignum(&result->value.data.x_bignum, &val->data.x_bignum);
+    bignum_init_bignum(&result->value->data.x_bignum, &val->data.x_bignum);
     return result;
 }
 
 static IrInstruction *ir_analyze_int_to_err(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *target) {
-    assert(target->value.type->id == TypeTableEntryIdInt);
-    assert(!target->value.type->data.integral.is_signed);
+    assert(target->value->type->id == TypeTableEntryIdInt);
+    assert(!target->value->type->data.integral.is_signed);
 
     if (instr_is_comptime(target)) {
         ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
@@ -7344,12 +7590,12 @@ static IrInstruction *ir_analyze_int_to_err(IrAnalyze *ira, IrInstruction *sourc
         }
 
         AstNode *error_decl_node = ira->codegen->error_decls.at(index);
-        result->value.data.x_pure_err = error_decl_node->data.error_value_decl.err;
+        result->value->data.x_pure_err = error_decl_node->data.error_value_decl.err;
         return result;
     }
 
     IrInstruction *result = ir_build_int_to_err(&ira->new_irb, source_instr->scope, source_instr->source_node, target);
-    result->value.type = ira->codegen->builtin_types.entry_pure_error;
+    result->value->type = ira->codegen->builtin_types.entry_pure_error;
     return result;
 }
 
@@ -7358,7 +7604,7 @@ static IrInstruction *ir_analyze_err_to_int(IrAnalyze *ira, IrInstruction *sourc
 {
     assert(wanted_type->id == TypeTableEntryIdInt);
 
-    TypeTableEntry *err_type = target->value.type;
+    TypeTableEntry *err_type = target->value->type;
 
     if (instr_is_comptime(target)) {
         ConstExprValue *val = ir_resolve_const(ira, target, UndefBad);
@@ -7376,11 +7622,11 @@ static IrInstruction *ir_analyze_err_to_int(IrAnalyze *ira, IrInstruction *sourc
         } else {
             zig_unreachable();
         }
-        result->value.type = wanted_type;
+        result->value->type = wanted_type;
         uint64_t err_value = err ? err->value : 0;
-        bignum_init_unsigned(&result->value.data.x_bignum, err_value);
+        bignum_init_unsigned(&result->value->data.x_bignum, err_value);
 
-        if (!bignum_fits_in_bits(&result->value.data.x_bignum,
+        if (!bignum_fits_in_bits(&result->value->data.x_bignum,
             wanted_type->data.integral.bit_count, wanted_type->data.integral.is_signed))
         {
             ir_add_error_node(ira, source_instr->source_node,
@@ -7401,14 +7647,14 @@ static IrInstruction *ir_analyze_err_to_int(IrAnalyze *ira, IrInstruction *sourc
     }
 
     IrInstruction *result = ir_build_err_to_int(&ira->new_irb, source_instr->scope, source_instr->source_node, target);
-    result->value.type = wanted_type;
+    result->value->type = wanted_type;
     return result;
 }
 
 static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_instr,
     TypeTableEntry *wanted_type, IrInstruction *value)
 {
-    TypeTableEntry *actual_type = value->value.type;
+    TypeTableEntry *actual_type = value->value->type;
     TypeTableEntry *usize_type = ira->codegen->builtin_types.entry_usize;
 
     if (type_is_invalid(wanted_type) || type_is_invalid(actual_type)) {
@@ -7500,11 +7746,11 @@ static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_inst
                 types_match_const_cast_only(ptr_type->data.pointer.child_type, actual_type->data.array.child_type))
         {
             IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.pointer.child_type, value);
-            if (type_is_invalid(cast1->value.type))
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1);
-            if (type_is_invalid(cast2->value.type))
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
 
             return cast2;
@@ -7523,11 +7769,11 @@ static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_inst
                 types_match_const_cast_only(ptr_type->data.pointer.child_type, actual_type->data.array.child_type))
         {
             IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.maybe.child_type, value);
-            if (type_is_invalid(cast1->value.type))
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1);
-            if (type_is_invalid(cast2->value.type))
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
 
             return cast2;
@@ -7615,11 +7861,11 @@ static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_inst
                 types_match_const_cast_only(ptr_type->data.pointer.child_type, actual_type->data.array.child_type))
         {
             IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.error.child_type, value);
-            if (type_is_invalid(cast1->value.type))
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1);
-            if (type_is_invalid(cast2->value.type))
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
 
             return cast2;
@@ -7645,11 +7891,11 @@ static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_inst
             actual_type->id == TypeTableEntryIdNumLitFloat)
         {
             IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.error.child_type, value);
-            if (type_is_invalid(cast1->value.type))
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1);
-            if (type_is_invalid(cast2->value.type))
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
 
             return cast2;
@@ -7665,11 +7911,11 @@ static IrInstruction *ir_analyze_cast(IrAnalyze *ira, IrInstruction *source_inst
             wanted_type->data.pointer.is_const)
         {
             IrInstruction *cast1 = ir_analyze_cast(ira, source_instr, wanted_type->data.pointer.child_type, value);
-            if (type_is_invalid(cast1->value.type))
+            if (type_is_invalid(cast1->value->type))
                 return ira->codegen->invalid_instruction;
 
             IrInstruction *cast2 = ir_analyze_cast(ira, source_instr, wanted_type, cast1);
-            if (type_is_invalid(cast2->value.type))
+            if (type_is_invalid(cast2->value->type))
                 return ira->codegen->invalid_instruction;
 
             return cast2;
@@ -7760,22 +8006,22 @@ static IrInstruction *ir_implicit_cast(IrAnalyze *ira, IrInstruction *value, Typ
     assert(value);
     assert(value != ira->codegen->invalid_instruction);
     assert(!expected_type || !type_is_invalid(expected_type));
-    assert(value->value.type);
-    assert(!type_is_invalid(value->value.type));
+    assert(value->value->type);
+    assert(!type_is_invalid(value->value->type));
     if (expected_type == nullptr)
         return value; // anything will do
-    if (expected_type == value->value.type)
+    if (expected_type == value->value->type)
         return value; // match
-    if (value->value.type->id == TypeTableEntryIdUnreachable)
+    if (value->value->type->id == TypeTableEntryIdUnreachable)
         return value;
 
-    ImplicitCastMatchResult result = ir_types_match_with_implicit_cast(ira, expected_type, value->value.type, value);
+    ImplicitCastMatchResult result = ir_types_match_with_implicit_cast(ira, expected_type, value->value->type, value);
     switch (result) {
         case ImplicitCastMatchResultNo:
             ir_add_error(ira, value,
                 buf_sprintf("expected type '%s', found '%s'",
                     buf_ptr(&expected_type->name),
-                    buf_ptr(&value->value.type->name)));
+                    buf_ptr(&value->value->type->name)));
             return ira->codegen->invalid_instruction;
 
         case ImplicitCastMatchResultYes:
@@ -7788,27 +8034,27 @@ static IrInstruction *ir_implicit_cast(IrAnalyze *ira, IrInstruction *value, Typ
 }
 
 static IrInstruction *ir_implicit_byval_const_ref_cast(IrAnalyze *ira, IrInstruction *inst) {
-    if (type_is_copyable(ira->codegen, inst->value.type))
+    if (type_is_copyable(ira->codegen, inst->value->type))
         return inst;
-    TypeTableEntry *const_ref_type = get_pointer_to_type(ira->codegen, inst->value.type, true);
+    TypeTableEntry *const_ref_type = get_pointer_to_type(ira->codegen, inst->value->type, true);
     return ir_implicit_cast(ira, inst, const_ref_type);
 }
 
 static IrInstruction *ir_get_deref(IrAnalyze *ira, IrInstruction *source_instruction, IrInstruction *ptr) {
-    TypeTableEntry *type_entry = ptr->value.type;
+    TypeTableEntry *type_entry = ptr->value->type;
     if (type_is_invalid(type_entry)) {
         return ira->codegen->invalid_instruction;
     } else if (type_entry->id == TypeTableEntryIdPointer) {
         TypeTableEntry *child_type = type_entry->data.pointer.child_type;
         if (instr_is_comptime(ptr)) {
-            if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst ||
-                ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar)
+            if (ptr->value->data.x_ptr.mut == ConstPtrMutComptimeConst ||
+                ptr->value->data.x_ptr.mut == ConstPtrMutComptimeVar)
             {
-                ConstExprValue *pointee = const_ptr_pointee(ira->codegen, &ptr->value);
+                ConstExprValue *pointee = const_ptr_pointee(ira->codegen, ptr->value);
                 if (pointee->special != ConstValSpecialRuntime) {
                     IrInstruction *result = ir_create_const(&ira->new_irb, source_instruction->scope,
                         source_instruction->source_node, child_type);
-                    copy_const_val(&result->value, pointee, ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst);
+                    copy_const_val(ira->codegen, result->value, pointee, ptr->value->data.x_ptr.mut == ConstPtrMutComptimeConst);
                     return result;
                 }
             }
@@ -7816,7 +8062,7 @@ static IrInstruction *ir_get_deref(IrAnalyze *ira, IrInstruction *source_instruc
         // TODO if the instruction is a const ref instruction we can skip it
         IrInstruction *load_ptr_instruction = ir_build_load_ptr(&ira->new_irb, source_instruction->scope,
                 source_instruction->source_node, ptr);
-        load_ptr_instruction->value.type = child_type;
+        load_ptr_instruction->value->type = child_type;
         return load_ptr_instruction;
     } else if (type_entry->id == TypeTableEntryIdMetaType) {
         ConstExprValue *ptr_val = ir_resolve_const(ira, ptr, UndefBad);
@@ -7846,15 +8092,15 @@ static TypeTableEntry *ir_analyze_ref(IrAnalyze *ira, IrInstruction *source_inst
 {
     IrInstruction *result = ir_get_ref(ira, source_instruction, value, is_const, is_volatile);
     ir_link_new_instruction(result, source_instruction);
-    return result->value.type;
+    return result->value->type;
 }
 
 static bool ir_resolve_usize(IrAnalyze *ira, IrInstruction *value, uint64_t *out) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return false;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_usize);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return false;
 
     ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
@@ -7866,11 +8112,11 @@ static bool ir_resolve_usize(IrAnalyze *ira, IrInstruction *value, uint64_t *out
 }
 
 static bool ir_resolve_bool(IrAnalyze *ira, IrInstruction *value, bool *out) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return false;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_bool);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return false;
 
     ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
@@ -7890,11 +8136,11 @@ static bool ir_resolve_comptime(IrAnalyze *ira, IrInstruction *value, bool *out)
 }
 
 static bool ir_resolve_atomic_order(IrAnalyze *ira, IrInstruction *value, AtomicOrder *out) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return false;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_atomic_order_enum);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return false;
 
     ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
@@ -7906,11 +8152,11 @@ static bool ir_resolve_atomic_order(IrAnalyze *ira, IrInstruction *value, Atomic
 }
 
 static bool ir_resolve_global_linkage(IrAnalyze *ira, IrInstruction *value, GlobalLinkageId *out) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return false;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, ira->codegen->builtin_types.entry_global_linkage_enum);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return false;
 
     ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
@@ -7923,12 +8169,12 @@ static bool ir_resolve_global_linkage(IrAnalyze *ira, IrInstruction *value, Glob
 
 
 static Buf *ir_resolve_str(IrAnalyze *ira, IrInstruction *value) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return nullptr;
 
     TypeTableEntry *str_type = get_slice_type(ira->codegen, ira->codegen->builtin_types.entry_u8, true);
     IrInstruction *casted_value = ir_implicit_cast(ira, value, str_type);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return nullptr;
 
     ConstExprValue *const_val = ir_resolve_const(ira, casted_value, UndefBad);
@@ -7940,8 +8186,12 @@ static Buf *ir_resolve_str(IrAnalyze *ira, IrInstruction *value) {
 
     assert(ptr_field->data.x_ptr.special == ConstPtrSpecialBaseArray);
     ConstExprValue *array_val = ptr_field->data.x_ptr.data.base_array.array_val;
-    expand_undef_array(ira->codegen, array_val);
     size_t len = len_field->data.x_bignum.data.x_uint;
+    if (array_val->data.x_array.special == ConstArraySpecialBuf) {
+        size_t start = ptr_field->data.x_ptr.data.base_array.elem_index;
+        return buf_create_from_mem(buf_ptr(array_val->data.x_array.s_buf) + start, len);
+    }
+    expand_undef_array(ira->codegen, array_val);
     Buf *result = buf_alloc();
     buf_resize(result, len);
     for (size_t i = 0; i < len; i += 1) {
@@ -7960,7 +8210,7 @@ static Buf *ir_resolve_str(IrAnalyze *ira, IrInstruction *value) {
 }
 
 static ConstExprValue *get_builtin_value(CodeGen *codegen, const char *name) {
-    Tld *tld = codegen->compile_var_import->decls_scope->decl_table.get(buf_create_from_str(name));
+    Tld *tld = codegen->compile_var_import->decls_scope->decl_table.get(intern_buf(codegen, buf_create_from_str(name)));
     resolve_top_level_decl(codegen, tld, false, nullptr);
     assert(tld->id == TldIdVar);
     TldVar *tld_var = (TldVar *)tld;
@@ -7973,7 +8223,7 @@ static TypeTableEntry *ir_analyze_instruction_return(IrAnalyze *ira,
     IrInstructionReturn *return_instruction)
 {
     IrInstruction *value = return_instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ir_unreach_error(ira);
     ira->implicit_return_type_list.append(value);
 
@@ -7981,9 +8231,9 @@ static TypeTableEntry *ir_analyze_instruction_return(IrAnalyze *ira,
     if (casted_value == ira->codegen->invalid_instruction)
         return ir_unreach_error(ira);
 
-    if (casted_value->value.special == ConstValSpecialRuntime &&
-        casted_value->value.type->id == TypeTableEntryIdPointer &&
-        casted_value->value.data.rh_ptr == RuntimeHintPtrStack)
+    if (casted_value->value->special == ConstValSpecialRuntime &&
+        casted_value->value->type->id == TypeTableEntryIdPointer &&
+        casted_value->value->data.rh_ptr == RuntimeHintPtrStack)
     {
         ir_add_error(ira, casted_value, buf_sprintf("function returns address of local variable"));
         return ir_unreach_error(ira);
@@ -7994,17 +8244,17 @@ static TypeTableEntry *ir_analyze_instruction_return(IrAnalyze *ira,
 
 static TypeTableEntry *ir_analyze_instruction_const(IrAnalyze *ira, IrInstructionConst *const_instruction) {
     ConstExprValue *out_val = ir_build_const_from(ira, &const_instruction->base);
-    *out_val = const_instruction->base.value;
-    return const_instruction->base.value.type;
+    *out_val = *const_instruction->base.value;
+    return const_instruction->base.value->type;
 }
 
 static TypeTableEntry *ir_analyze_bin_op_bool(IrAnalyze *ira, IrInstructionBinOp *bin_op_instruction) {
     IrInstruction *op1 = bin_op_instruction->op1->other;
-    if (type_is_invalid(op1->value.type))
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *op2 = bin_op_instruction->op2->other;
-    if (type_is_invalid(op2->value.type))
+    if (type_is_invalid(op2->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *bool_type = ira->codegen->builtin_types.entry_bool;
@@ -8017,13 +8267,13 @@ static TypeTableEntry *ir_analyze_bin_op_bool(IrAnalyze *ira, IrInstructionBinOp
     if (casted_op2 == ira->codegen->invalid_instruction)
         return ira->codegen->builtin_types.entry_invalid;
 
-    ConstExprValue *op1_val = &casted_op1->value;
-    ConstExprValue *op2_val = &casted_op2->value;
+    ConstExprValue *op1_val = casted_op1->value;
+    ConstExprValue *op2_val = casted_op2->value;
     if (op1_val->special != ConstValSpecialRuntime && op2_val->special != ConstValSpecialRuntime) {
         ConstExprValue *out_val = ir_build_const_from(ira, &bin_op_instruction->base);
 
-        assert(casted_op1->value.type->id == TypeTableEntryIdBool);
-        assert(casted_op2->value.type->id == TypeTableEntryIdBool);
+        assert(casted_op1->value->type->id == TypeTableEntryIdBool);
+        assert(casted_op2->value->type->id == TypeTableEntryIdBool);
         if (bin_op_instruction->op_id == IrBinOpBoolOr) {
             out_val->data.x_bool = op1_val->data.x_bool || op2_val->data.x_bool;
         } else if (bin_op_instruction->op_id == IrBinOpBoolAnd) {
@@ -8046,19 +8296,19 @@ static TypeTableEntry *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp
     IrBinOp op_id = bin_op_instruction->op_id;
     bool is_equality_cmp = (op_id == IrBinOpCmpEq || op_id == IrBinOpCmpNotEq);
     if (is_equality_cmp &&
-        ((op1->value.type->id == TypeTableEntryIdNullLit && op2->value.type->id == TypeTableEntryIdMaybe) ||
-        (op2->value.type->id == TypeTableEntryIdNullLit && op1->value.type->id == TypeTableEntryIdMaybe) ||
-        (op1->value.type->id == TypeTableEntryIdNullLit && op2->value.type->id == TypeTableEntryIdNullLit)))
+        ((op1->value->type->id == TypeTableEntryIdNullLit && op2->value->type->id == TypeTableEntryIdMaybe) ||
+        (op2->value->type->id == TypeTableEntryIdNullLit && op1->value->type->id == TypeTableEntryIdMaybe) ||
+        (op1->value->type->id == TypeTableEntryIdNullLit && op2->value->type->id == TypeTableEntryIdNullLit)))
     {
-        if (op1->value.type->id == TypeTableEntryIdNullLit && op2->value.type->id == TypeTableEntryIdNullLit) {
+        if (op1->value->type->id == TypeTableEntryIdNullLit && op2->value->type->id == TypeTableEntryIdNullLit) {
             ConstExprValue *out_val = ir_build_const_from(ira, &bin_op_instruction->base);
             out_val->data.x_bool = (op_id == IrBinOpCmpEq);
             return ira->codegen->builtin_types.entry_bool;
         }
         IrInstruction *maybe_op;
-        if (op1->value.type->id == TypeTableEntryIdNullLit) {
+        if (op1->value->type->id == TypeTableEntryIdNullLit) {
             maybe_op = op2;
-        } else if (op2->value.type->id == TypeTableEntryIdNullLit) {
+        } else if (op2->value->type->id == TypeTableEntryIdNullLit) {
             maybe_op = op1;
         } else {
             zig_unreachable();
@@ -8075,7 +8325,7 @@ static TypeTableEntry *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp
 
         IrInstruction *is_non_null = ir_build_test_nonnull(&ira->new_irb, bin_op_instruction->base.scope,
             bin_op_instruction->base.source_node, maybe_op);
-        is_non_null->value.type = ira->codegen->builtin_types.entry_bool;
+        is_non_null->value->type = ira->codegen->builtin_types.entry_bool;
 
         if (op_id == IrBinOpCmpEq) {
             ir_build_bool_not_from(&ira->new_irb, &bin_op_instruction->base, is_non_null);
@@ -8154,8 +8404,8 @@ static TypeTableEntry *ir_analyze_bin_op_cmp(IrAnalyze *ira, IrInstructionBinOp
     if (casted_op2 == ira->codegen->invalid_instruction)
         return ira->codegen->builtin_types.entry_invalid;
 
-    ConstExprValue *op1_val = &casted_op1->value;
-    ConstExprValue *op2_val = &casted_op2->value;
+    ConstExprValue *op1_val = casted_op1->value;
+    ConstExprValue *op2_val = casted_op2->value;
     if ((value_is_comptime(op1_val) && value_is_comptime(op2_val)) || resolved_type->id == TypeTableEntryIdVoid) {
         bool type_can_gt_lt_cmp = (resolved_type->id == TypeTableEntryIdNumLitFloat ||
                 resolved_type->id == TypeTableEntryIdNumLitInt ||
@@ -8398,14 +8648,14 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
     bool is_signed = ((resolved_type->id == TypeTableEntryIdInt && resolved_type->data.integral.is_signed) ||
             resolved_type->id == TypeTableEntryIdFloat ||
             (resolved_type->id == TypeTableEntryIdNumLitFloat &&
-                (op1->value.data.x_bignum.data.x_float < 0.0 || op2->value.data.x_bignum.data.x_float < 0.0)) ||
+                (op1->value->data.x_bignum.data.x_float < 0.0 || op2->value->data.x_bignum.data.x_float < 0.0)) ||
             (resolved_type->id == TypeTableEntryIdNumLitInt &&
-                (op1->value.data.x_bignum.is_negative || op2->value.data.x_bignum.is_negative)));
+                (op1->value->data.x_bignum.is_negative || op2->value->data.x_bignum.is_negative)));
     if (op_id == IrBinOpDivUnspecified) {
         if (is_int && is_signed) {
             bool ok = false;
             if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
-				if (op2->value.data.x_bignum.data.x_uint == 0) {
+				if (op2->value->data.x_bignum.data.x_uint == 0) {
                     // the division by zero error will be caught later, but we don't have a
                     // division function ambiguity problem.
                     op_id = IrBinOpDivTrunc;
@@ -8413,10 +8663,10 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
 				} else {
 					BigNum trunc_result;
 					BigNum floor_result;
-					if (bignum_div_trunc(&trunc_result, &op1->value.data.x_bignum, &op2->value.data.x_bignum)) {
+					if (bignum_div_trunc(&trunc_result, &op1->value->data.x_bignum, &op2->value->data.x_bignum)) {
 						zig_unreachable();
 					}
-					if (bignum_div_floor(&floor_result, &op1->value.data.x_bignum, &op2->value.data.x_bignum)) {
+					if (bignum_div_floor(&floor_result, &op1->value->data.x_bignum, &op2->value->data.x_bignum)) {
 						zig_unreachable();
 					}
 					if (bignum_cmp_eq(&trunc_result, &floor_result)) {
@@ -8428,8 +8678,8 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
             if (!ok) {
                 ir_add_error(ira, &bin_op_instruction->base,
                     buf_sprintf("division with '%s' and '%s': signed integers must use @divTrunc, @divFloor, or @divExact",
-                        buf_ptr(&op1->value.type->name),
-                        buf_ptr(&op2->value.type->name)));
+                        buf_ptr(&op1->value->type->name),
+                        buf_ptr(&op2->value->type->name)));
                 return ira->codegen->builtin_types.entry_invalid;
             }
         } else if (is_int) {
@@ -8439,8 +8689,8 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
         if (is_signed) {
             bool ok = false;
             if (instr_is_comptime(op1) && instr_is_comptime(op2)) {
-                if ((is_int && op2->value.data.x_bignum.data.x_uint == 0) ||
-                    (!is_int && op2->value.data.x_bignum.data.x_float == 0.0))
+                if ((is_int && op2->value->data.x_bignum.data.x_uint == 0) ||
+                    (!is_int && op2->value->data.x_bignum.data.x_float == 0.0))
                 {
                     // the division by zero error will be caught later, but we don't
                     // have a remainder function ambiguity problem
@@ -8448,10 +8698,10 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
                 } else {
                     BigNum rem_result;
                     BigNum mod_result;
-                    if (bignum_rem(&rem_result, &op1->value.data.x_bignum, &op2->value.data.x_bignum)) {
+                    if (bignum_rem(&rem_result, &op1->value->data.x_bignum, &op2->value->data.x_bignum)) {
                         zig_unreachable();
                     }
-                    if (bignum_mod(&mod_result, &op1->value.data.x_bignum, &op2->value.data.x_bignum)) {
+                    if (bignum_mod(&mod_result, &op1->value->data.x_bignum, &op2->value->data.x_bignum)) {
                         zig_unreachable();
                     }
                     ok = bignum_cmp_eq(&rem_result, &mod_result);
@@ -8460,8 +8710,8 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
             if (!ok) {
                 ir_add_error(ira, &bin_op_instruction->base,
                     buf_sprintf("remainder division with '%s' and '%s': signed integers and floats must use @rem or @mod",
-                        buf_ptr(&op1->value.type->name),
-                        buf_ptr(&op2->value.type->name)));
+                        buf_ptr(&op1->value->type->name),
+                        buf_ptr(&op2->value->type->name)));
                 return ira->codegen->builtin_types.entry_invalid;
             }
         }
@@ -8489,8 +8739,8 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
         AstNode *source_node = bin_op_instruction->base.source_node;
         ir_add_error_node(ira, source_node,
             buf_sprintf("invalid operands to binary expression: '%s' and '%s'",
-                buf_ptr(&op1->value.type->name),
-                buf_ptr(&op2->value.type->name)));
+                buf_ptr(&op1->value->type->name),
+                buf_ptr(&op2->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
@@ -8503,12 +8753,10 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
         return ira->codegen->builtin_types.entry_invalid;
 
 
-    if (casted_op1->value.special != ConstValSpecialRuntime && casted_op2->value.special != ConstValSpecialRuntime) {
-        ConstExprValue *op1_val = &casted_op1->value;
-        ConstExprValue *op2_val = &casted_op2->value;
-        ConstExprValue *out_val = &bin_op_instruction->base.value;
-
-        bin_op_instruction->base.other = &bin_op_instruction->base;
+    if (casted_op1->value->special != ConstValSpecialRuntime && casted_op2->value->special != ConstValSpecialRuntime) {
+        ConstExprValue *op1_val = casted_op1->value;
+        ConstExprValue *op2_val = casted_op2->value;
+        ConstExprValue *out_val = ir_build_const_from(ira, &bin_op_instruction->base);
 
         int err;
         if ((err = ir_eval_math_op(resolved_type, op1_val, op_id, op2_val, out_val))) {
@@ -8530,7 +8778,7 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
             return ira->codegen->builtin_types.entry_invalid;
         }
 
-        ir_num_lit_fits_in_other_type(ira, &bin_op_instruction->base, resolved_type);
+        ir_num_lit_fits_in_other_type(ira, bin_op_instruction->base.other, resolved_type);
         return resolved_type;
     }
 
@@ -8542,12 +8790,12 @@ static TypeTableEntry *ir_analyze_bin_op_math(IrAnalyze *ira, IrInstructionBinOp
 
 static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *instruction) {
     IrInstruction *op1 = instruction->op1->other;
-    TypeTableEntry *op1_type = op1->value.type;
+    TypeTableEntry *op1_type = op1->value->type;
     if (type_is_invalid(op1_type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *op2 = instruction->op2->other;
-    TypeTableEntry *op2_type = op2->value.type;
+    TypeTableEntry *op2_type = op2->value->type;
     if (type_is_invalid(op2_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -8587,7 +8835,7 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         op1_array_end = op1_array_val->type->data.array.len;
     } else {
         ir_add_error(ira, op1,
-            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op1->value.type->name)));
+            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op1->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
@@ -8598,7 +8846,7 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         if (op2_type->data.array.child_type != child_type) {
             ir_add_error(ira, op2, buf_sprintf("expected array of type '%s', found '%s'",
                         buf_ptr(&child_type->name),
-                        buf_ptr(&op2->value.type->name)));
+                        buf_ptr(&op2->value->type->name)));
             return ira->codegen->builtin_types.entry_invalid;
         }
         op2_array_val = op2_val;
@@ -8612,7 +8860,7 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         if (child_type != ira->codegen->builtin_types.entry_u8) {
             ir_add_error(ira, op2, buf_sprintf("expected array of type '%s', found '%s'",
                         buf_ptr(&child_type->name),
-                        buf_ptr(&op2->value.type->name)));
+                        buf_ptr(&op2->value->type->name)));
             return ira->codegen->builtin_types.entry_invalid;
         }
         op2_array_val = op2_val->data.x_ptr.data.base_array.array_val;
@@ -8623,7 +8871,7 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         if (ptr_type->data.pointer.child_type != child_type) {
             ir_add_error(ira, op2, buf_sprintf("expected array of type '%s', found '%s'",
                         buf_ptr(&child_type->name),
-                        buf_ptr(&op2->value.type->name)));
+                        buf_ptr(&op2->value->type->name)));
             return ira->codegen->builtin_types.entry_invalid;
         }
         ConstExprValue *ptr_val = &op2_val->data.x_struct.fields[slice_ptr_index];
@@ -8633,7 +8881,7 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         op2_array_end = op2_array_val->type->data.array.len;
     } else {
         ir_add_error(ira, op2,
-            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op2->value.type->name)));
+            buf_sprintf("expected array or C string literal, found '%s'", buf_ptr(&op2->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
@@ -8651,7 +8899,7 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
 
         result_type = get_pointer_to_type(ira->codegen, child_type, true);
 
-        out_array_val = create_const_vals(1);
+        out_array_val = create_const_vals(ira->codegen, 1);
         out_array_val->special = ConstValSpecialStatic;
         out_array_val->type = get_array_type(ira->codegen, child_type, new_len);
         out_val->data.x_ptr.special = ConstPtrSpecialBaseArray;
@@ -8659,9 +8907,25 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
         out_val->data.x_ptr.data.base_array.array_val = out_array_val;
         out_val->data.x_ptr.data.base_array.elem_index = 0;
     }
-    out_array_val->data.x_array.s_none.elements = create_const_vals(new_len);
+    if (op1_array_val->data.x_array.special == ConstArraySpecialBuf &&
+        op2_array_val->data.x_array.special == ConstArraySpecialBuf)
+    {
+        Buf *out_buf = buf_create_from_mem(buf_ptr(op1_array_val->data.x_array.s_buf) + op1_array_index,
+                op1_array_end - op1_array_index);
+        buf_append_mem(out_buf, buf_ptr(op2_array_val->data.x_array.s_buf) + op2_array_index,
+                op2_array_end - op2_array_index);
+        if (buf_len(out_buf) < new_len)
+            buf_append_char(out_buf, 0);
+        assert(buf_len(out_buf) == new_len);
+        out_array_val->data.x_array.special = ConstArraySpecialBuf;
+        out_array_val->data.x_array.s_buf = out_buf;
+        return result_type;
+    }
+
+    out_array_val->data.x_array.s_none.elements = create_const_vals(ira->codegen, new_len);
 
     expand_undef_array(ira->codegen, op1_array_val);
+    expand_undef_array(ira->codegen, op2_array_val);
 
     size_t next_index = 0;
     for (size_t i = op1_array_index; i < op1_array_end; i += 1, next_index += 1) {
@@ -8682,11 +8946,11 @@ static TypeTableEntry *ir_analyze_array_cat(IrAnalyze *ira, IrInstructionBinOp *
 
 static TypeTableEntry *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp *instruction) {
     IrInstruction *op1 = instruction->op1->other;
-    if (type_is_invalid(op1->value.type))
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *op2 = instruction->op2->other;
-    if (type_is_invalid(op2->value.type))
+    if (type_is_invalid(op2->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     ConstExprValue *array_val = ir_resolve_const(ira, op1, UndefBad);
@@ -8697,9 +8961,9 @@ static TypeTableEntry *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp
     if (!ir_resolve_usize(ira, op2, &mult_amt))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *array_type = op1->value.type;
+    TypeTableEntry *array_type = op1->value->type;
     if (array_type->id != TypeTableEntryIdArray) {
-        ir_add_error(ira, op1, buf_sprintf("expected array type, found '%s'", buf_ptr(&op1->value.type->name)));
+        ir_add_error(ira, op1, buf_sprintf("expected array type, found '%s'", buf_ptr(&op1->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
@@ -8715,7 +8979,20 @@ static TypeTableEntry *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
 
     uint64_t new_array_len = array_len.data.x_uint;
-    out_val->data.x_array.s_none.elements = create_const_vals(new_array_len);
+    TypeTableEntry *child_type = array_type->data.array.child_type;
+
+    if (array_val->data.x_array.special == ConstArraySpecialBuf) {
+        Buf *out_buf = buf_alloc();
+        for (uint64_t x = 0; x < mult_amt; x += 1) {
+            buf_append_buf(out_buf, array_val->data.x_array.s_buf);
+        }
+        assert(buf_len(out_buf) == new_array_len);
+        out_val->data.x_array.special = ConstArraySpecialBuf;
+        out_val->data.x_array.s_buf = out_buf;
+        return get_array_type(ira->codegen, child_type, new_array_len);
+    }
+
+    out_val->data.x_array.s_none.elements = create_const_vals(ira->codegen, new_array_len);
 
     expand_undef_array(ira->codegen, array_val);
 
@@ -8728,7 +9005,6 @@ static TypeTableEntry *ir_analyze_array_mult(IrAnalyze *ira, IrInstructionBinOp
     }
     assert(i == new_array_len);
 
-    TypeTableEntry *child_type = array_type->data.array.child_type;
     return get_array_type(ira->codegen, child_type, new_array_len);
 }
 
@@ -8779,7 +9055,7 @@ static TypeTableEntry *ir_analyze_instruction_decl_var(IrAnalyze *ira, IrInstruc
     VariableTableEntry *var = decl_var_instruction->var;
 
     IrInstruction *init_value = decl_var_instruction->init_value->other;
-    if (type_is_invalid(init_value->value.type)) {
+    if (type_is_invalid(init_value->value->type)) {
         var->value->type = ira->codegen->builtin_types.entry_invalid;
         return var->value->type;
     }
@@ -8805,7 +9081,7 @@ static TypeTableEntry *ir_analyze_instruction_decl_var(IrAnalyze *ira, IrInstruc
     AstNode *source_node = decl_var_instruction->base.source_node;
 
     IrInstruction *casted_init_value = ir_implicit_cast(ira, init_value, explicit_type);
-    TypeTableEntry *result_type = casted_init_value->value.type;
+    TypeTableEntry *result_type = casted_init_value->value->type;
     if (type_is_invalid(result_type)) {
         result_type = ira->codegen->builtin_types.entry_invalid;
     }
@@ -8834,7 +9110,7 @@ static TypeTableEntry *ir_analyze_instruction_decl_var(IrAnalyze *ira, IrInstruc
             break;
         case TypeTableEntryIdMetaType:
         case TypeTableEntryIdNamespace:
-            if (casted_init_value->value.special == ConstValSpecialRuntime) {
+            if (casted_init_value->value->special == ConstValSpecialRuntime) {
                 ir_add_error_node(ira, source_node,
                     buf_sprintf("variable of type '%s' must be constant", buf_ptr(&result_type->name)));
                 result_type = ira->codegen->builtin_types.entry_invalid;
@@ -8870,11 +9146,12 @@ static TypeTableEntry *ir_analyze_instruction_decl_var(IrAnalyze *ira, IrInstruc
 
     bool is_comptime = ir_get_var_is_comptime(var);
 
-    if (casted_init_value->value.special != ConstValSpecialRuntime) {
+    if (casted_init_value->value->special != ConstValSpecialRuntime) {
         if (var->mem_slot_index != SIZE_MAX) {
             assert(var->mem_slot_index < ira->exec_context.mem_slot_count);
             ConstExprValue *mem_slot = &ira->exec_context.mem_slot_list[var->mem_slot_index];
-            *mem_slot = casted_init_value->value;
+            ir_assert_whole_value(casted_init_value);
+            *mem_slot = *casted_init_value->value;
 
             if (is_comptime) {
                 ir_build_const_from(ira, &decl_var_instruction->base);
@@ -8897,6 +9174,790 @@ static TypeTableEntry *ir_analyze_instruction_decl_var(IrAnalyze *ira, IrInstruc
     return ira->codegen->builtin_types.entry_void;
 }
 
+// Comptime calls of a function whose body has already been analyzed for
+// runtime can run a register bytecode lowered once from the analyzed IR,
+// instead of analyzing the pass-1 IR of the body all over again. Only
+// integer, bool and void values are supported. Anything else, and any
+// call that would end in a compile error, is left to ir_eval_const_value,
+// which then starts over as if the bytecode had never run. Backward branches
+// and calls are counted and calls are memoized just like analysis does it,
+// so the quota runs out at the same point either way.
+enum IrOpId {
+    IrOpIdMove,
+    IrOpIdMath,
+    IrOpIdCmp,
+    IrOpIdBoolOp,
+    IrOpIdBoolNot,
+    IrOpIdNegate,
+    IrOpIdBinNot,
+    IrOpIdWidenOrShorten,
+    IrOpIdPhi,
+    IrOpIdBr,
+    IrOpIdCondBr,
+    IrOpIdCall,
+    IrOpIdReturn,
+};
+
+struct IrOp {
+    IrOpId id;
+    IrBinOp bin_op;
+    bool is_wrap;
+    uint32_t dest;
+    uint32_t op1;
+    uint32_t op2;
+    TypeTableEntry *type;
+    FnTableEntry *fn_entry;
+    // Br: the destination, CondBr: the then and else destinations, each a
+    // block index followed by whether the branch is a backward branch.
+    // Phi: pairs of incoming block index and slot. Call: the argument slots.
+    uint32_t *extra;
+};
+
+struct IrBytecodeConst {
+    uint32_t slot;
+    ConstExprValue *value;
+};
+
+struct IrBytecode {
+    ZigList<IrOp> ops;
+    // index of the first op of each basic block
+    ZigList<uint32_t> block_starts;
+    // values that are copied into their slot when a call starts
+    ZigList<IrBytecodeConst> consts;
+    // the parameters are in the first slots
+    size_t param_count;
+    size_t slot_count;
+};
+
+struct IrLower {
+    IrBytecode *bc;
+    // indexed by debug id of the analyzed IR
+    uint32_t *instruction_slots;
+    uint32_t *block_indexes;
+    size_t debug_id_count;
+    ZigList<VariableTableEntry *> vars;
+    ZigList<uint32_t> var_slots;
+};
+
+static const uint32_t ir_no_slot = UINT32_MAX;
+
+static bool ir_bytecode_type_ok(TypeTableEntry *type) {
+    return type->id == TypeTableEntryIdInt || type->id == TypeTableEntryIdBool ||
+        type->id == TypeTableEntryIdVoid;
+}
+
+static uint32_t ir_bytecode_new_slot(IrLower *lower) {
+    uint32_t slot = (uint32_t)lower->bc->slot_count;
+    lower->bc->slot_count += 1;
+    return slot;
+}
+
+static bool ir_bytecode_operand(IrLower *lower, IrInstruction *instruction, uint32_t *out_slot) {
+    if (!ir_bytecode_type_ok(instruction->value->type))
+        return false;
+    if (instruction->value->special != ConstValSpecialRuntime) {
+        uint32_t slot = ir_bytecode_new_slot(lower);
+        lower->bc->consts.append({slot, instruction->value});
+        *out_slot = slot;
+        return true;
+    }
+    if (instruction->debug_id >= lower->debug_id_count)
+        return false;
+    *out_slot = lower->instruction_slots[instruction->debug_id];
+    return *out_slot != ir_no_slot;
+}
+
+static bool ir_bytecode_var_slot(IrLower *lower, IrInstruction *ptr, uint32_t *out_slot) {
+    if (ptr->id != IrInstructionIdVarPtr || ptr->value->special != ConstValSpecialRuntime)
+        return false;
+    VariableTableEntry *var = ((IrInstructionVarPtr *)ptr)->var;
+    if (!ir_bytecode_type_ok(var->value->type))
+        return false;
+    if (var->src_arg_index != SIZE_MAX) {
+        if (var->src_arg_index >= lower->bc->param_count)
+            return false;
+        *out_slot = (uint32_t)var->src_arg_index;
+        return true;
+    }
+    for (size_t i = 0; i < lower->vars.length; i += 1) {
+        if (lower->vars.at(i) == var) {
+            *out_slot = lower->var_slots.at(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool ir_bytecode_block_index(IrLower *lower, IrBasicBlock *bb, uint32_t *out_index) {
+    if (bb->debug_id >= lower->debug_id_count)
+        return false;
+    *out_index = lower->block_indexes[bb->debug_id];
+    return *out_index != ir_no_slot;
+}
+
+// A branch counts against the quota when analysis of the comptime IR would
+// count it, which is when the destination does not come after the basic
+// block of the pass-1 branch instruction.
+static bool ir_bytecode_dest(IrLower *lower, IrInstruction *branch, IrBasicBlock *dest_bb, uint32_t *out) {
+    IrInstruction *old_branch = branch->other;
+    IrBasicBlock *old_dest_bb = dest_bb->other;
+    if (old_branch == nullptr || old_branch->owner_bb == nullptr || old_dest_bb == nullptr)
+        return false;
+    if (!ir_bytecode_block_index(lower, dest_bb, &out[0]))
+        return false;
+    out[1] = (old_dest_bb->debug_id <= old_branch->owner_bb->debug_id);
+    return true;
+}
+
+static bool ir_lower_instruction(IrLower *lower, IrInstruction *instruction) {
+    IrOp op = {};
+    bool has_dest = true;
+    switch (instruction->id) {
+        case IrInstructionIdDeclVar:
+            {
+                IrInstructionDeclVar *decl_var_instruction = (IrInstructionDeclVar *)instruction;
+                op.id = IrOpIdMove;
+                op.dest = ir_no_slot;
+                for (size_t i = 0; i < lower->vars.length; i += 1) {
+                    if (lower->vars.at(i) == decl_var_instruction->var)
+                        op.dest = lower->var_slots.at(i);
+                }
+                if (!ir_bytecode_operand(lower, decl_var_instruction->init_value, &op.op1))
+                    return false;
+                break;
+            }
+        case IrInstructionIdVarPtr:
+            // only loads and stores through the pointer are supported
+            return true;
+        case IrInstructionIdLoadPtr:
+            {
+                IrInstructionLoadPtr *load_ptr_instruction = (IrInstructionLoadPtr *)instruction;
+                op.id = IrOpIdMove;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                if (!ir_bytecode_var_slot(lower, load_ptr_instruction->ptr, &op.op1))
+                    return false;
+                break;
+            }
+        case IrInstructionIdStorePtr:
+            {
+                IrInstructionStorePtr *store_ptr_instruction = (IrInstructionStorePtr *)instruction;
+                op.id = IrOpIdMove;
+                if (!ir_bytecode_var_slot(lower, store_ptr_instruction->ptr, &op.dest))
+                    return false;
+                if (!ir_bytecode_operand(lower, store_ptr_instruction->value, &op.op1))
+                    return false;
+                break;
+            }
+        case IrInstructionIdBinOp:
+            {
+                IrInstructionBinOp *bin_op_instruction = (IrInstructionBinOp *)instruction;
+                TypeTableEntry *op_type = bin_op_instruction->op1->value->type;
+                op.bin_op = bin_op_instruction->op_id;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                switch (op.bin_op) {
+                    case IrBinOpBoolOr:
+                    case IrBinOpBoolAnd:
+                        op.id = IrOpIdBoolOp;
+                        break;
+                    case IrBinOpCmpEq:
+                    case IrBinOpCmpNotEq:
+                        if (op_type->id != TypeTableEntryIdInt && op_type->id != TypeTableEntryIdBool)
+                            return false;
+                        op.id = IrOpIdCmp;
+                        break;
+                    case IrBinOpCmpLessThan:
+                    case IrBinOpCmpGreaterThan:
+                    case IrBinOpCmpLessOrEq:
+                    case IrBinOpCmpGreaterOrEq:
+                        if (op_type->id != TypeTableEntryIdInt)
+                            return false;
+                        op.id = IrOpIdCmp;
+                        break;
+                    case IrBinOpInvalid:
+                    case IrBinOpArrayCat:
+                    case IrBinOpArrayMult:
+                    case IrBinOpDivUnspecified:
+                    case IrBinOpRemUnspecified:
+                        return false;
+                    default:
+                        if (instruction->value->type->id != TypeTableEntryIdInt)
+                            return false;
+                        op.id = IrOpIdMath;
+                        op.type = instruction->value->type;
+                        break;
+                }
+                if (!ir_bytecode_operand(lower, bin_op_instruction->op1, &op.op1))
+                    return false;
+                if (!ir_bytecode_operand(lower, bin_op_instruction->op2, &op.op2))
+                    return false;
+                break;
+            }
+        case IrInstructionIdUnOp:
+            {
+                IrInstructionUnOp *un_op_instruction = (IrInstructionUnOp *)instruction;
+                if (instruction->value->type->id != TypeTableEntryIdInt)
+                    return false;
+                if (un_op_instruction->op_id == IrUnOpBinNot) {
+                    op.id = IrOpIdBinNot;
+                } else if (un_op_instruction->op_id == IrUnOpNegation ||
+                        un_op_instruction->op_id == IrUnOpNegationWrap)
+                {
+                    op.id = IrOpIdNegate;
+                    op.is_wrap = (un_op_instruction->op_id == IrUnOpNegationWrap);
+                } else {
+                    return false;
+                }
+                op.type = instruction->value->type;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                if (!ir_bytecode_operand(lower, un_op_instruction->value, &op.op1))
+                    return false;
+                break;
+            }
+        case IrInstructionIdBoolNot:
+            {
+                IrInstructionBoolNot *bool_not_instruction = (IrInstructionBoolNot *)instruction;
+                op.id = IrOpIdBoolNot;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                if (!ir_bytecode_operand(lower, bool_not_instruction->value, &op.op1))
+                    return false;
+                break;
+            }
+        case IrInstructionIdWidenOrShorten:
+            {
+                IrInstructionWidenOrShorten *widen_instruction = (IrInstructionWidenOrShorten *)instruction;
+                if (instruction->value->type->id != TypeTableEntryIdInt ||
+                    widen_instruction->target->value->type->id != TypeTableEntryIdInt)
+                {
+                    return false;
+                }
+                op.id = IrOpIdWidenOrShorten;
+                op.type = instruction->value->type;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                if (!ir_bytecode_operand(lower, widen_instruction->target, &op.op1))
+                    return false;
+                break;
+            }
+        case IrInstructionIdPhi:
+            {
+                IrInstructionPhi *phi_instruction = (IrInstructionPhi *)instruction;
+                op.id = IrOpIdPhi;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                op.op1 = (uint32_t)phi_instruction->incoming_count;
+                op.extra = allocate<uint32_t>(phi_instruction->incoming_count * 2);
+                for (size_t i = 0; i < phi_instruction->incoming_count; i += 1) {
+                    if (!ir_bytecode_block_index(lower, phi_instruction->incoming_blocks[i], &op.extra[i * 2]))
+                        return false;
+                    if (!ir_bytecode_operand(lower, phi_instruction->incoming_values[i], &op.extra[i * 2 + 1]))
+                        return false;
+                }
+                break;
+            }
+        case IrInstructionIdBr:
+            {
+                IrInstructionBr *br_instruction = (IrInstructionBr *)instruction;
+                op.id = IrOpIdBr;
+                has_dest = false;
+                op.extra = allocate<uint32_t>(2);
+                if (!ir_bytecode_dest(lower, instruction, br_instruction->dest_block, op.extra))
+                    return false;
+                break;
+            }
+        case IrInstructionIdCondBr:
+            {
+                IrInstructionCondBr *cond_br_instruction = (IrInstructionCondBr *)instruction;
+                op.id = IrOpIdCondBr;
+                has_dest = false;
+                if (!ir_bytecode_operand(lower, cond_br_instruction->condition, &op.op1))
+                    return false;
+                op.extra = allocate<uint32_t>(4);
+                if (!ir_bytecode_dest(lower, instruction, cond_br_instruction->then_block, &op.extra[0]))
+                    return false;
+                if (!ir_bytecode_dest(lower, instruction, cond_br_instruction->else_block, &op.extra[2]))
+                    return false;
+                break;
+            }
+        case IrInstructionIdCall:
+            {
+                IrInstructionCall *call_instruction = (IrInstructionCall *)instruction;
+                FnTableEntry *fn_entry = call_instruction->fn_entry;
+                // calls of generic function instances are memoized by the
+                // arguments of the generic function, which the call does not have
+                if (fn_entry == nullptr || fn_entry->body_node == nullptr || fn_entry->param_source_nodes != nullptr)
+                    return false;
+                if (!ir_bytecode_type_ok(instruction->value->type))
+                    return false;
+                op.id = IrOpIdCall;
+                op.fn_entry = fn_entry;
+                op.dest = lower->instruction_slots[instruction->debug_id];
+                op.op1 = (uint32_t)call_instruction->arg_count;
+                op.extra = allocate<uint32_t>(call_instruction->arg_count);
+                for (size_t i = 0; i < call_instruction->arg_count; i += 1) {
+                    if (!ir_bytecode_operand(lower, call_instruction->args[i], &op.extra[i]))
+                        return false;
+                }
+                break;
+            }
+        case IrInstructionIdReturn:
+            {
+                IrInstructionReturn *return_instruction = (IrInstructionReturn *)instruction;
+                op.id = IrOpIdReturn;
+                has_dest = false;
+                if (!ir_bytecode_operand(lower, return_instruction->value, &op.op1))
+                    return false;
+                break;
+            }
+        default:
+            // instructions with a compile-time known value are folded into
+            // their users
+            return instruction->value->special != ConstValSpecialRuntime && !ir_has_side_effects(instruction);
+    }
+    if (has_dest && op.dest == ir_no_slot)
+        return false;
+    lower->bc->ops.append(op);
+    return true;
+}
+
+static IrBytecode *ir_lower_bytecode(FnTableEntry *fn_entry) {
+    IrExecutable *exec = &fn_entry->analyzed_executable;
+    FnTypeId *fn_type_id = &fn_entry->type_entry->data.fn.fn_type_id;
+
+    // Comptime branches and calls that runtime analysis evaluated do not
+    // show up in the analyzed IR, but analysis of a comptime call would
+    // count them again.
+    if (fn_entry->prealloc_bbc != 0 || exec->basic_block_list.length == 0)
+        return nullptr;
+    if (fn_type_id->is_var_args || !ir_bytecode_type_ok(fn_type_id->return_type))
+        return nullptr;
+    for (size_t i = 0; i < fn_type_id->param_count; i += 1) {
+        if (!ir_bytecode_type_ok(fn_type_id->param_info[i].type))
+            return nullptr;
+    }
+
+    IrLower lower = {};
+    lower.bc = allocate<IrBytecode>(1);
+    lower.bc->param_count = fn_type_id->param_count;
+    lower.bc->slot_count = fn_type_id->param_count;
+    lower.debug_id_count = exec->next_debug_id;
+    lower.instruction_slots = allocate_nonzero<uint32_t>(lower.debug_id_count);
+    lower.block_indexes = allocate_nonzero<uint32_t>(lower.debug_id_count);
+    for (size_t i = 0; i < lower.debug_id_count; i += 1) {
+        lower.instruction_slots[i] = ir_no_slot;
+        lower.block_indexes[i] = ir_no_slot;
+    }
+
+    // phis can refer to instructions of later blocks, so every slot is
+    // assigned before the first op is lowered
+    bool ok = true;
+    for (size_t bb_i = 0; bb_i < exec->basic_block_list.length && ok; bb_i += 1) {
+        IrBasicBlock *bb = exec->basic_block_list.at(bb_i);
+        if (bb->debug_id >= lower.debug_id_count || bb->instruction_list.length == 0) {
+            ok = false;
+            break;
+        }
+        lower.block_indexes[bb->debug_id] = (uint32_t)bb_i;
+        for (size_t instr_i = 0; instr_i < bb->instruction_list.length; instr_i += 1) {
+            IrInstruction *instruction = bb->instruction_list.at(instr_i);
+            if (instruction->debug_id >= lower.debug_id_count) {
+                ok = false;
+                break;
+            }
+            if (instruction->value->special == ConstValSpecialRuntime)
+                lower.instruction_slots[instruction->debug_id] = ir_bytecode_new_slot(&lower);
+            if (instruction->id == IrInstructionIdDeclVar) {
+                VariableTableEntry *var = ((IrInstructionDeclVar *)instruction)->var;
+                if (!ir_bytecode_type_ok(var->value->type)) {
+                    ok = false;
+                    break;
+                }
+                lower.vars.append(var);
+                lower.var_slots.append(ir_bytecode_new_slot(&lower));
+            }
+        }
+    }
+
+    for (size_t bb_i = 0; bb_i < exec->basic_block_list.length && ok; bb_i += 1) {
+        IrBasicBlock *bb = exec->basic_block_list.at(bb_i);
+        lower.bc->block_starts.append((uint32_t)lower.bc->ops.length);
+        for (size_t instr_i = 0; instr_i < bb->instruction_list.length; instr_i += 1) {
+            if (!ir_lower_instruction(&lower, bb->instruction_list.at(instr_i))) {
+                ok = false;
+                break;
+            }
+        }
+        IrOpId last_id = (lower.bc->ops.length == 0) ? IrOpIdMove : lower.bc->ops.last().id;
+        if (last_id != IrOpIdBr && last_id != IrOpIdCondBr && last_id != IrOpIdReturn)
+            ok = false;
+    }
+
+    free(lower.instruction_slots);
+    free(lower.block_indexes);
+    lower.vars.deinit();
+    lower.var_slots.deinit();
+    return ok ? lower.bc : nullptr;
+}
+
+static IrBytecode *ir_get_bytecode(CodeGen *g, FnTableEntry *fn_entry) {
+    if (fn_entry->comptime_bytecode != nullptr)
+        return fn_entry->comptime_bytecode;
+    if (fn_entry->comptime_bytecode_unsupported)
+        return nullptr;
+    if (fn_entry->body_node == nullptr || fn_entry->type_entry->data.fn.is_generic ||
+        fn_entry->param_source_nodes != nullptr)
+    {
+        fn_entry->comptime_bytecode_unsupported = true;
+        return nullptr;
+    }
+
+    // The body would be analyzed later on anyway. Doing it while a top level
+    // declaration or a container is being resolved could report that it
+    // depends on itself though.
+    if (fn_entry->anal_state == FnAnalStateReady && g->const_eval_depth == 0)
+        analyze_fn_body(g, fn_entry);
+    if (fn_entry->anal_state == FnAnalStateReady || fn_entry->anal_state == FnAnalStateProbing)
+        return nullptr;
+
+    if (fn_entry->anal_state == FnAnalStateComplete)
+        fn_entry->comptime_bytecode = ir_lower_bytecode(fn_entry);
+    fn_entry->comptime_bytecode_unsupported = (fn_entry->comptime_bytecode == nullptr);
+    return fn_entry->comptime_bytecode;
+}
+
+struct IrVm {
+    CodeGen *codegen;
+    size_t *backward_branch_count;
+    size_t *backward_branch_quota;
+    // the memoized calls, which are forgotten again if the evaluation bails
+    ZigList<Scope *> memoized_scopes;
+};
+
+static void ir_vm_set_value(ConstExprValue *dest, ConstExprValue *src) {
+    ConstGlobalRefs *global_refs = dest->global_refs;
+    *dest = *src;
+    dest->global_refs = global_refs;
+}
+
+static IrInstruction *ir_vm_create_result(CodeGen *g, AstNode *source_node) {
+    IrInstructionConst *result = arena_allocate<IrInstructionConst>(&g->ir_arena, 1);
+    result->base.id = IrInstructionIdConst;
+    result->base.source_node = source_node;
+    result->base.value = arena_allocate<ConstExprValue>(&g->ir_arena, 1);
+    result->base.value->global_refs = arena_allocate<ConstGlobalRefs>(&g->ir_arena, 1);
+    return &result->base;
+}
+
+// Frees the pass-1 IR of a function body that has been analyzed. The
+// variables it declared point into it, so they are pointed elsewhere. The
+// analyzed IR links back to it through `other` as well, which only bytecode
+// lowering follows; comptime calls of the function fall back to analysis.
+void ir_free_fn_pass1(CodeGen *g, FnTableEntry *fn_entry) {
+    IrExecutable *exec = &fn_entry->ir_executable;
+    if (exec->arena == nullptr)
+        return;
+
+    for (size_t block_i = 0; block_i < exec->basic_block_list.length; block_i += 1) {
+        IrBasicBlock *bb = exec->basic_block_list.at(block_i);
+        for (size_t instr_i = 0; instr_i < bb->instruction_list.length; instr_i += 1) {
+            IrInstruction *instruction = bb->instruction_list.at(instr_i);
+            if (instruction->id != IrInstructionIdDeclVar)
+                continue;
+            VariableTableEntry *var = ((IrInstructionDeclVar *)instruction)->var;
+            if (var->is_comptime != nullptr) {
+                if (ir_get_var_is_comptime(var)) {
+                    IrInstruction *is_comptime = ir_vm_create_result(g, var->is_comptime->source_node);
+                    is_comptime->value->special = ConstValSpecialStatic;
+                    is_comptime->value->type = g->builtin_types.entry_bool;
+                    is_comptime->value->data.x_bool = true;
+                    var->is_comptime = is_comptime;
+                } else {
+                    var->is_comptime = nullptr;
+                }
+            }
+            var->decl_instruction = nullptr;
+        }
+        bb->instruction_list.deinit();
+    }
+    exec->basic_block_list.deinit();
+    exec->basic_block_list = {};
+    exec->all_labels.deinit();
+    exec->all_labels = {};
+    exec->goto_list.deinit();
+    exec->goto_list = {};
+
+    if (fn_entry->comptime_bytecode == nullptr)
+        fn_entry->comptime_bytecode_unsupported = true;
+
+    g->pass1_ir_bytes_freed += exec->arena->bytes_reserved;
+    arena_deinit(exec->arena);
+    exec->arena = nullptr;
+}
+
+static bool ir_vm_call(IrVm *vm, FnTableEntry *fn_entry, ConstExprValue *args, ConstExprValue *out_val);
+
+static bool ir_vm_backward_branch(IrVm *vm) {
+    *vm->backward_branch_count += 1;
+    return *vm->backward_branch_count <= *vm->backward_branch_quota;
+}
+
+static bool ir_vm_op_call(IrVm *vm, IrOp *op, ConstExprValue *slots) {
+    CodeGen *g = vm->codegen;
+    FnTableEntry *fn_entry = op->fn_entry;
+    AstNode *fn_proto_node = fn_entry->proto_node;
+    size_t arg_count = op->op1;
+
+    if (!ir_vm_backward_branch(vm))
+        return false;
+
+    // Bail before the parameters are declared where possible. Declaring them
+    // cannot report errors, since a function whose parameters could not be
+    // declared gets no bytecode, so the evaluator which takes over after a
+    // later bail only repeats the declarations.
+    for (size_t i = 0; i < arg_count; i += 1) {
+        if (slots[op->extra[i]].special != ConstValSpecialStatic)
+            return false;
+    }
+    if (ir_get_bytecode(g, fn_entry) == nullptr)
+        return false;
+
+    Scope *exec_scope = &fn_entry->fndef_scope->base;
+    ConstExprValue *args = create_const_vals(g, arg_count);
+    for (size_t i = 0; i < arg_count; i += 1) {
+        ir_vm_set_value(&args[i], &slots[op->extra[i]]);
+
+        AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(i);
+        Buf *param_name = param_decl_node->data.param_decl.name;
+        VariableTableEntry *var = add_variable(g, param_decl_node, exec_scope, param_name, true, &args[i], nullptr);
+        exec_scope = var->child_scope;
+    }
+
+    auto entry = g->memoized_fn_eval_table.maybe_get(exec_scope);
+    if (entry) {
+        ir_vm_set_value(&slots[op->dest], entry->value->value);
+        return true;
+    }
+
+    IrInstruction *result = ir_vm_create_result(g, fn_entry->body_node);
+    if (!ir_vm_call(vm, fn_entry, args, result->value))
+        return false;
+    g->memoized_fn_eval_table.put(exec_scope, result);
+    vm->memoized_scopes.append(exec_scope);
+    ir_vm_set_value(&slots[op->dest], result->value);
+    return true;
+}
+
+static bool ir_vm_run(IrVm *vm, IrBytecode *bc, ConstExprValue *slots, ConstExprValue *out_val) {
+    uint32_t block = 0;
+    uint32_t prev_block = ir_no_slot;
+    size_t pc = bc->block_starts.at(0);
+    for (;;) {
+        IrOp *op = &bc->ops.items[pc];
+        pc += 1;
+        switch (op->id) {
+            case IrOpIdMove:
+                slots[op->dest] = slots[op->op1];
+                break;
+            case IrOpIdMath:
+                {
+                    ConstExprValue *op1_val = &slots[op->op1];
+                    ConstExprValue *op2_val = &slots[op->op2];
+                    if (op1_val->special != ConstValSpecialStatic || op2_val->special != ConstValSpecialStatic)
+                        return false;
+                    ConstExprValue *dest_val = &slots[op->dest];
+                    dest_val->type = op->type;
+                    if (ir_eval_math_op(op->type, op1_val, op->bin_op, op2_val, dest_val))
+                        return false;
+                    break;
+                }
+            case IrOpIdCmp:
+            case IrOpIdBoolOp:
+                {
+                    ConstExprValue *op1_val = &slots[op->op1];
+                    ConstExprValue *op2_val = &slots[op->op2];
+                    if (op1_val->special != ConstValSpecialStatic || op2_val->special != ConstValSpecialStatic)
+                        return false;
+                    bool answer;
+                    if (op->bin_op == IrBinOpBoolOr) {
+                        answer = op1_val->data.x_bool || op2_val->data.x_bool;
+                    } else if (op->bin_op == IrBinOpBoolAnd) {
+                        answer = op1_val->data.x_bool && op2_val->data.x_bool;
+                    } else if (op1_val->type->id == TypeTableEntryIdBool) {
+                        bool are_equal = (op1_val->data.x_bool == op2_val->data.x_bool);
+                        answer = (op->bin_op == IrBinOpCmpEq) ? are_equal : !are_equal;
+                    } else {
+                        BigNum *op1_bn = &op1_val->data.x_bignum;
+                        BigNum *op2_bn = &op2_val->data.x_bignum;
+                        switch (op->bin_op) {
+                            case IrBinOpCmpEq: answer = bignum_cmp_eq(op1_bn, op2_bn); break;
+                            case IrBinOpCmpNotEq: answer = bignum_cmp_neq(op1_bn, op2_bn); break;
+                            case IrBinOpCmpLessThan: answer = bignum_cmp_lt(op1_bn, op2_bn); break;
+                            case IrBinOpCmpGreaterThan: answer = bignum_cmp_gt(op1_bn, op2_bn); break;
+                            case IrBinOpCmpLessOrEq: answer = bignum_cmp_lte(op1_bn, op2_bn); break;
+                            case IrBinOpCmpGreaterOrEq: answer = bignum_cmp_gte(op1_bn, op2_bn); break;
+                            default: zig_unreachable();
+                        }
+                    }
+                    ConstExprValue *dest_val = &slots[op->dest];
+                    dest_val->special = ConstValSpecialStatic;
+                    dest_val->type = vm->codegen->builtin_types.entry_bool;
+                    dest_val->data.x_bool = answer;
+                    break;
+                }
+            case IrOpIdBoolNot:
+                {
+                    ConstExprValue *op1_val = &slots[op->op1];
+                    if (op1_val->special != ConstValSpecialStatic)
+                        return false;
+                    ConstExprValue *dest_val = &slots[op->dest];
+                    dest_val->special = ConstValSpecialStatic;
+                    dest_val->type = vm->codegen->builtin_types.entry_bool;
+                    dest_val->data.x_bool = !op1_val->data.x_bool;
+                    break;
+                }
+            case IrOpIdNegate:
+            case IrOpIdBinNot:
+                {
+                    ConstExprValue *op1_val = &slots[op->op1];
+                    if (op1_val->special != ConstValSpecialStatic)
+                        return false;
+                    ConstExprValue *dest_val = &slots[op->dest];
+                    dest_val->special = ConstValSpecialStatic;
+                    dest_val->type = op->type;
+                    if (op->id == IrOpIdBinNot) {
+                        bignum_not(&dest_val->data.x_bignum, &op1_val->data.x_bignum,
+                                op->type->data.integral.bit_count, op->type->data.integral.is_signed);
+                    } else {
+                        bignum_negate(&dest_val->data.x_bignum, &op1_val->data.x_bignum);
+                        if (!bignum_fits_in_bits(&dest_val->data.x_bignum, op->type->data.integral.bit_count, true)) {
+                            if (!op->is_wrap)
+                                return false;
+                            dest_val->data.x_bignum.is_negative = true;
+                        }
+                    }
+                    break;
+                }
+            case IrOpIdWidenOrShorten:
+                {
+                    ConstExprValue *op1_val = &slots[op->op1];
+                    if (op1_val->special != ConstValSpecialStatic)
+                        return false;
+                    if (op1_val->data.x_bignum.is_negative && !op->type->data.integral.is_signed)
+                        return false;
+                    if (!bignum_fits_in_bits(&op1_val->data.x_bignum, op->type->data.integral.bit_count,
+                                op->type->data.integral.is_signed))
+                    {
+                        return false;
+                    }
+                    ConstExprValue *dest_val = &slots[op->dest];
+                    dest_val->special = ConstValSpecialStatic;
+                    dest_val->type = op->type;
+                    dest_val->data.x_bignum = op1_val->data.x_bignum;
+                    break;
+                }
+            case IrOpIdPhi:
+                {
+                    size_t i = 0;
+                    for (; i < op->op1; i += 1) {
+                        if (op->extra[i * 2] == prev_block)
+                            break;
+                    }
+                    if (i == op->op1)
+                        return false;
+                    slots[op->dest] = slots[op->extra[i * 2 + 1]];
+                    break;
+                }
+            case IrOpIdBr:
+            case IrOpIdCondBr:
+                {
+                    uint32_t *dest = op->extra;
+                    if (op->id == IrOpIdCondBr) {
+                        ConstExprValue *cond_val = &slots[op->op1];
+                        if (cond_val->special != ConstValSpecialStatic)
+                            return false;
+                        if (!cond_val->data.x_bool)
+                            dest += 2;
+                    }
+                    if (dest[1] && !ir_vm_backward_branch(vm))
+                        return false;
+                    prev_block = block;
+                    block = dest[0];
+                    pc = bc->block_starts.at(block);
+                    break;
+                }
+            case IrOpIdCall:
+                if (!ir_vm_op_call(vm, op, slots))
+                    return false;
+                break;
+            case IrOpIdReturn:
+                {
+                    ConstExprValue *return_val = &slots[op->op1];
+                    if (return_val->special != ConstValSpecialStatic)
+                        return false;
+                    ir_vm_set_value(out_val, return_val);
+                    return true;
+                }
+        }
+    }
+}
+
+static bool ir_vm_call(IrVm *vm, FnTableEntry *fn_entry, ConstExprValue *args, ConstExprValue *out_val) {
+    IrBytecode *bc = ir_get_bytecode(vm->codegen, fn_entry);
+    if (bc == nullptr)
+        return false;
+
+    ConstExprValue *slots = allocate<ConstExprValue>(bc->slot_count);
+    for (size_t i = 0; i < bc->param_count; i += 1) {
+        slots[i] = args[i];
+    }
+    for (size_t i = 0; i < bc->consts.length; i += 1) {
+        IrBytecodeConst *bc_const = &bc->consts.at(i);
+        slots[bc_const->slot] = *bc_const->value;
+    }
+    bool ok = ir_vm_run(vm, bc, slots, out_val);
+    free(slots);
+    return ok;
+}
+
+// Evaluates a comptime call of fn_entry, whose parameters have been declared
+// in exec_scope, with the bytecode of the function. Returns nullptr, having
+// changed nothing, when the call must be analyzed instead.
+static IrInstruction *ir_eval_fn_call_bytecode(IrAnalyze *ira, FnTableEntry *fn_entry, Scope *exec_scope,
+        AstNode *source_node)
+{
+    CodeGen *g = ira->codegen;
+    if (ir_get_bytecode(g, fn_entry) == nullptr)
+        return nullptr;
+
+    ZigList<VariableTableEntry *> param_vars = {};
+    ir_collect_param_vars(fn_entry, exec_scope, &param_vars);
+    ConstExprValue *args = allocate<ConstExprValue>(param_vars.length);
+    bool args_ok = (param_vars.length == fn_entry->comptime_bytecode->param_count);
+    for (size_t i = 0; i < param_vars.length && args_ok; i += 1) {
+        args[i] = *param_vars.at(i)->value;
+        args_ok = ir_bytecode_type_ok(args[i].type);
+    }
+    param_vars.deinit();
+
+    IrVm vm = {};
+    vm.codegen = g;
+    vm.backward_branch_count = ira->new_irb.exec->backward_branch_count;
+    vm.backward_branch_quota = ira->new_irb.exec->backward_branch_quota;
+    size_t old_backward_branch_count = *vm.backward_branch_count;
+
+    IrInstruction *result = ir_vm_create_result(g, source_node);
+    if (!args_ok || !ir_vm_call(&vm, fn_entry, args, result->value)) {
+        *vm.backward_branch_count = old_backward_branch_count;
+        for (size_t i = 0; i < vm.memoized_scopes.length; i += 1) {
+            g->memoized_fn_eval_table.remove(vm.memoized_scopes.at(i));
+        }
+        g->comptime_bytecode_bail_count += 1;
+        result = nullptr;
+    } else {
+        g->comptime_bytecode_run_count += 1;
+    }
+    free(args);
+    vm.memoized_scopes.deinit();
+    return result;
+}
+
 static bool ir_analyze_fn_call_inline_arg(IrAnalyze *ira, AstNode *fn_proto_node,
     IrInstruction *arg, Scope **exec_scope, size_t *next_proto_i)
 {
@@ -8908,7 +9969,7 @@ static bool ir_analyze_fn_call_inline_arg(IrAnalyze *ira, AstNode *fn_proto_node
         return false;
 
     IrInstruction *casted_arg = ir_implicit_cast(ira, arg, param_type);
-    if (type_is_invalid(casted_arg->value.type))
+    if (type_is_invalid(casted_arg->value->type))
         return false;
 
     ConstExprValue *arg_val = ir_resolve_const(ira, casted_arg, UndefBad);
@@ -8949,7 +10010,7 @@ static bool ir_analyze_fn_call_generic_arg(IrAnalyze *ira, AstNode *fn_proto_nod
             casted_arg = ir_implicit_byval_const_ref_cast(ira, arg);
         } else {
             casted_arg = ir_implicit_cast(ira, arg, param_type);
-            if (type_is_invalid(casted_arg->value.type))
+            if (type_is_invalid(casted_arg->value->type))
                 return false;
         }
     }
@@ -8964,7 +10025,7 @@ static bool ir_analyze_fn_call_generic_arg(IrAnalyze *ira, AstNode *fn_proto_nod
         if (!arg_val)
             return false;
     } else {
-        arg_val = create_const_runtime(casted_arg->value.type);
+        arg_val = create_const_runtime(ira->codegen, casted_arg->value->type);
     }
     if (arg_part_of_generic_id) {
         generic_id->params[generic_id->param_count] = *arg_val;
@@ -8982,15 +10043,15 @@ static bool ir_analyze_fn_call_generic_arg(IrAnalyze *ira, AstNode *fn_proto_nod
     }
 
     if (!comptime_arg) {
-        if (type_requires_comptime(casted_arg->value.type)) {
+        if (type_requires_comptime(casted_arg->value->type)) {
             ir_add_error(ira, casted_arg,
-                buf_sprintf("parameter of type '%s' requires comptime", buf_ptr(&casted_arg->value.type->name)));
+                buf_sprintf("parameter of type '%s' requires comptime", buf_ptr(&casted_arg->value->type->name)));
             return false;
         }
 
         casted_args[fn_type_id->param_count] = casted_arg;
         FnTypeParamInfo *param_info = &fn_type_id->param_info[fn_type_id->param_count];
-        param_info->type = casted_arg->value.type;
+        param_info->type = casted_arg->value->type;
         param_info->is_noalias = param_decl_node->data.param_decl.is_noalias;
         impl_fn->param_source_nodes[fn_type_id->param_count] = param_decl_node;
         fn_type_id->param_count += 1;
@@ -9051,16 +10112,34 @@ static IrInstruction *ir_get_var_ptr(IrAnalyze *ira, IrInstruction *instruction,
     } else {
         IrInstruction *var_ptr_instruction = ir_build_var_ptr(&ira->new_irb,
                 instruction->scope, instruction->source_node, var, is_const, is_volatile);
-        var_ptr_instruction->value.type = get_pointer_to_type(ira->codegen, var->value->type, var->src_is_const);
+        var_ptr_instruction->value->type = get_pointer_to_type(ira->codegen, var->value->type, var->src_is_const);
         type_ensure_zero_bits_known(ira->codegen, var->value->type);
 
         bool in_fn_scope = (scope_fn_entry(var->parent_scope) != nullptr);
-        var_ptr_instruction->value.data.rh_ptr = in_fn_scope ? RuntimeHintPtrStack : RuntimeHintPtrNonStack;
+        var_ptr_instruction->value->data.rh_ptr = in_fn_scope ? RuntimeHintPtrStack : RuntimeHintPtrNonStack;
 
         return var_ptr_instruction;
     }
 }
 
+// Accumulates the cost of one comptime call for --comptime-report. The
+// backward branches include those taken by the calls the callee makes.
+static void ir_record_comptime_call(IrAnalyze *ira, AstNode *source_node, FnTableEntry *fn_entry,
+        size_t backward_branch_count, double seconds)
+{
+    bool existed;
+    auto *entry = ira->codegen->comptime_call_sites.get_or_insert(source_node, nullptr, &existed);
+    if (!existed) {
+        entry->value = allocate<ComptimeCallSite>(1);
+        entry->value->source_node = source_node;
+        entry->value->fn_entry = fn_entry;
+    }
+    ComptimeCallSite *site = entry->value;
+    site->call_count += 1;
+    site->backward_branch_count += backward_branch_count;
+    site->seconds += seconds;
+}
+
 static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *call_instruction,
     FnTableEntry *fn_entry, TypeTableEntry *fn_type, IrInstruction *fn_ref,
     IrInstruction *first_arg_ptr, bool comptime_fn_call, bool inline_fn_call)
@@ -9110,12 +10189,12 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         size_t next_proto_i = 0;
         if (first_arg_ptr) {
             IrInstruction *first_arg;
-            assert(first_arg_ptr->value.type->id == TypeTableEntryIdPointer);
-            if (handle_is_ptr(first_arg_ptr->value.type->data.pointer.child_type)) {
+            assert(first_arg_ptr->value->type->id == TypeTableEntryIdPointer);
+            if (handle_is_ptr(first_arg_ptr->value->type->data.pointer.child_type)) {
                 first_arg = first_arg_ptr;
             } else {
                 first_arg = ir_get_deref(ira, first_arg_ptr, first_arg_ptr);
-                if (type_is_invalid(first_arg->value.type))
+                if (type_is_invalid(first_arg->value->type))
                     return ira->codegen->builtin_types.entry_invalid;
             }
 
@@ -9132,7 +10211,7 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
 
         for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
             IrInstruction *old_arg = call_instruction->args[call_i]->other;
-            if (type_is_invalid(old_arg->value.type))
+            if (type_is_invalid(old_arg->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             if (!ir_analyze_fn_call_inline_arg(ira, fn_proto_node, old_arg, &exec_scope, &next_proto_i))
@@ -9149,20 +10228,34 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         auto entry = ira->codegen->memoized_fn_eval_table.maybe_get(exec_scope);
         if (entry) {
             result = entry->value;
+            if (ira->codegen->comptime_report)
+                ir_record_comptime_call(ira, call_instruction->base.source_node, fn_entry, 0, 0.0);
         } else {
-            // Analyze the fn body block like any other constant expression.
-            AstNode *body_node = fn_entry->body_node;
-            result = ir_eval_const_value(ira->codegen, exec_scope, body_node, return_type,
-                ira->new_irb.exec->backward_branch_count, ira->new_irb.exec->backward_branch_quota, fn_entry,
-                nullptr, call_instruction->base.source_node, nullptr, ira->new_irb.exec);
-            if (type_is_invalid(result->value.type))
+            size_t start_branch_count = *ira->new_irb.exec->backward_branch_count;
+            double start_time = ira->codegen->comptime_report ? os_get_time() : 0.0;
+
+            result = ir_eval_fn_call_bytecode(ira, fn_entry, exec_scope, call_instruction->base.source_node);
+            if (result == nullptr) {
+                // Analyze the fn body block like any other constant expression.
+                AstNode *body_node = fn_entry->body_node;
+                result = ir_eval_const_value(ira->codegen, exec_scope, body_node, return_type,
+                    ira->new_irb.exec->backward_branch_count, ira->new_irb.exec->backward_branch_quota, fn_entry,
+                    nullptr, call_instruction->base.source_node, nullptr, ira->new_irb.exec);
+            }
+
+            if (ira->codegen->comptime_report) {
+                ir_record_comptime_call(ira, call_instruction->base.source_node, fn_entry,
+                    *ira->new_irb.exec->backward_branch_count - start_branch_count, os_get_time() - start_time);
+            }
+            if (type_is_invalid(result->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             ira->codegen->memoized_fn_eval_table.put(exec_scope, result);
         }
 
         ConstExprValue *out_val = ir_build_const_from(ira, &call_instruction->base);
-        *out_val = result->value;
+        ir_assert_whole_value(result);
+        *out_val = *result->value;
         return ir_finish_anal(ira, return_type);
     }
 
@@ -9177,11 +10270,11 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         size_t new_fn_arg_count = first_arg_1_or_0;
         for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
             IrInstruction *arg = call_instruction->args[call_i]->other;
-            if (type_is_invalid(arg->value.type))
+            if (type_is_invalid(arg->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
-            if (arg->value.type->id == TypeTableEntryIdArgTuple) {
-                new_fn_arg_count += arg->value.data.x_arg_tuple.end_index - arg->value.data.x_arg_tuple.start_index;
+            if (arg->value->type->id == TypeTableEntryIdArgTuple) {
+                new_fn_arg_count += arg->value->data.x_arg_tuple.end_index - arg->value->data.x_arg_tuple.start_index;
             } else {
                 new_fn_arg_count += 1;
             }
@@ -9206,17 +10299,17 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         GenericFnTypeId *generic_id = allocate<GenericFnTypeId>(1);
         generic_id->fn_entry = fn_entry;
         generic_id->param_count = 0;
-        generic_id->params = create_const_vals(new_fn_arg_count);
+        generic_id->params = create_const_vals(ira->codegen, new_fn_arg_count);
         size_t next_proto_i = 0;
 
         if (first_arg_ptr) {
             IrInstruction *first_arg;
-            assert(first_arg_ptr->value.type->id == TypeTableEntryIdPointer);
-            if (handle_is_ptr(first_arg_ptr->value.type->data.pointer.child_type)) {
+            assert(first_arg_ptr->value->type->id == TypeTableEntryIdPointer);
+            if (handle_is_ptr(first_arg_ptr->value->type->data.pointer.child_type)) {
                 first_arg = first_arg_ptr;
             } else {
                 first_arg = ir_get_deref(ira, first_arg_ptr, first_arg_ptr);
-                if (type_is_invalid(first_arg->value.type))
+                if (type_is_invalid(first_arg->value->type))
                     return ira->codegen->builtin_types.entry_invalid;
             }
 
@@ -9234,7 +10327,7 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
         assert(parent_fn_entry);
         for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
             IrInstruction *arg = call_instruction->args[call_i]->other;
-            if (type_is_invalid(arg->value.type))
+            if (type_is_invalid(arg->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             AstNode *param_decl_node = fn_proto_node->data.fn_proto.params.at(next_proto_i);
@@ -9245,18 +10338,18 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
                 found_first_var_arg = true;
             }
 
-            if (arg->value.type->id == TypeTableEntryIdArgTuple) {
-                for (size_t arg_tuple_i = arg->value.data.x_arg_tuple.start_index;
-                    arg_tuple_i < arg->value.data.x_arg_tuple.end_index; arg_tuple_i += 1)
+            if (arg->value->type->id == TypeTableEntryIdArgTuple) {
+                for (size_t arg_tuple_i = arg->value->data.x_arg_tuple.start_index;
+                    arg_tuple_i < arg->value->data.x_arg_tuple.end_index; arg_tuple_i += 1)
                 {
                     VariableTableEntry *arg_var = get_fn_var_by_index(parent_fn_entry, arg_tuple_i);
                     assert(arg_var != nullptr);
                     IrInstruction *arg_var_ptr_inst = ir_get_var_ptr(ira, arg, arg_var, true, false);
-                    if (type_is_invalid(arg_var_ptr_inst->value.type))
+                    if (type_is_invalid(arg_var_ptr_inst->value->type))
                         return ira->codegen->builtin_types.entry_invalid;
 
                     IrInstruction *arg_tuple_arg = ir_get_deref(ira, arg, arg_var_ptr_inst);
-                    if (type_is_invalid(arg_tuple_arg->value.type))
+                    if (type_is_invalid(arg_tuple_arg->value->type))
                         return ira->codegen->builtin_types.entry_invalid;
 
                     if (!ir_analyze_fn_call_generic_arg(ira, fn_proto_node, arg_tuple_arg, &impl_fn->child_scope,
@@ -9332,12 +10425,12 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
     size_t next_arg_index = 0;
     if (first_arg_ptr) {
         IrInstruction *first_arg;
-        assert(first_arg_ptr->value.type->id == TypeTableEntryIdPointer);
-        if (handle_is_ptr(first_arg_ptr->value.type->data.pointer.child_type)) {
+        assert(first_arg_ptr->value->type->id == TypeTableEntryIdPointer);
+        if (handle_is_ptr(first_arg_ptr->value->type->data.pointer.child_type)) {
             first_arg = first_arg_ptr;
         } else {
             first_arg = ir_get_deref(ira, first_arg_ptr, first_arg_ptr);
-            if (type_is_invalid(first_arg->value.type))
+            if (type_is_invalid(first_arg->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
         }
 
@@ -9346,7 +10439,7 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
             return ira->codegen->builtin_types.entry_invalid;
 
         IrInstruction *casted_arg = ir_implicit_cast(ira, first_arg, param_type);
-        if (type_is_invalid(casted_arg->value.type))
+        if (type_is_invalid(casted_arg->value->type))
             return ira->codegen->builtin_types.entry_invalid;
 
         casted_args[next_arg_index] = casted_arg;
@@ -9354,7 +10447,7 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
     }
     for (size_t call_i = 0; call_i < call_instruction->arg_count; call_i += 1) {
         IrInstruction *old_arg = call_instruction->args[call_i]->other;
-        if (type_is_invalid(old_arg->value.type))
+        if (type_is_invalid(old_arg->value->type))
             return ira->codegen->builtin_types.entry_invalid;
         IrInstruction *casted_arg;
         if (next_arg_index < src_param_count) {
@@ -9362,7 +10455,7 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
             if (type_is_invalid(param_type))
                 return ira->codegen->builtin_types.entry_invalid;
             casted_arg = ir_implicit_cast(ira, old_arg, param_type);
-            if (type_is_invalid(casted_arg->value.type))
+            if (type_is_invalid(casted_arg->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
         } else {
             casted_arg = old_arg;
@@ -9387,14 +10480,14 @@ static TypeTableEntry *ir_analyze_fn_call(IrAnalyze *ira, IrInstructionCall *cal
 
 static TypeTableEntry *ir_analyze_instruction_call(IrAnalyze *ira, IrInstructionCall *call_instruction) {
     IrInstruction *fn_ref = call_instruction->fn_ref->other;
-    if (type_is_invalid(fn_ref->value.type))
+    if (type_is_invalid(fn_ref->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     bool is_comptime = call_instruction->is_comptime ||
         ir_should_inline(ira->new_irb.exec, call_instruction->base.scope);
 
     if (is_comptime || instr_is_comptime(fn_ref)) {
-        if (fn_ref->value.type->id == TypeTableEntryIdMetaType) {
+        if (fn_ref->value->type->id == TypeTableEntryIdMetaType) {
             TypeTableEntry *dest_type = ir_resolve_type(ira, fn_ref);
             if (type_is_invalid(dest_type))
                 return ira->codegen->builtin_types.entry_invalid;
@@ -9410,34 +10503,34 @@ static TypeTableEntry *ir_analyze_instruction_call(IrAnalyze *ira, IrInstruction
             IrInstruction *arg = call_instruction->args[0]->other;
 
             IrInstruction *cast_instruction = ir_analyze_cast(ira, &call_instruction->base, dest_type, arg);
-            if (type_is_invalid(cast_instruction->value.type))
+            if (type_is_invalid(cast_instruction->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             ir_link_new_instruction(cast_instruction, &call_instruction->base);
-            return ir_finish_anal(ira, cast_instruction->value.type);
-        } else if (fn_ref->value.type->id == TypeTableEntryIdFn) {
+            return ir_finish_anal(ira, cast_instruction->value->type);
+        } else if (fn_ref->value->type->id == TypeTableEntryIdFn) {
             FnTableEntry *fn_table_entry = ir_resolve_fn(ira, fn_ref);
             return ir_analyze_fn_call(ira, call_instruction, fn_table_entry, fn_table_entry->type_entry,
                 fn_ref, nullptr, is_comptime, call_instruction->is_inline);
-        } else if (fn_ref->value.type->id == TypeTableEntryIdBoundFn) {
-            assert(fn_ref->value.special == ConstValSpecialStatic);
-            FnTableEntry *fn_table_entry = fn_ref->value.data.x_bound_fn.fn;
-            IrInstruction *first_arg_ptr = fn_ref->value.data.x_bound_fn.first_arg;
+        } else if (fn_ref->value->type->id == TypeTableEntryIdBoundFn) {
+            assert(fn_ref->value->special == ConstValSpecialStatic);
+            FnTableEntry *fn_table_entry = fn_ref->value->data.x_bound_fn.fn;
+            IrInstruction *first_arg_ptr = fn_ref->value->data.x_bound_fn.first_arg;
             return ir_analyze_fn_call(ira, call_instruction, fn_table_entry, fn_table_entry->type_entry,
                 nullptr, first_arg_ptr, is_comptime, call_instruction->is_inline);
         } else {
             ir_add_error_node(ira, fn_ref->source_node,
-                buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value.type->name)));
+                buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value->type->name)));
             return ira->codegen->builtin_types.entry_invalid;
         }
     }
 
-    if (fn_ref->value.type->id == TypeTableEntryIdFn) {
-        return ir_analyze_fn_call(ira, call_instruction, nullptr, fn_ref->value.type,
+    if (fn_ref->value->type->id == TypeTableEntryIdFn) {
+        return ir_analyze_fn_call(ira, call_instruction, nullptr, fn_ref->value->type,
             fn_ref, nullptr, false, false);
     } else {
         ir_add_error_node(ira, fn_ref->source_node,
-            buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value.type->name)));
+            buf_sprintf("type '%s' not a function", buf_ptr(&fn_ref->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 }
@@ -9498,7 +10591,7 @@ static TypeTableEntry *ir_analyze_unary_prefix_op_err(IrAnalyze *ira, IrInstruct
 static TypeTableEntry *ir_analyze_dereference(IrAnalyze *ira, IrInstructionUnOp *un_op_instruction) {
     IrInstruction *value = un_op_instruction->value->other;
 
-    TypeTableEntry *ptr_type = value->value.type;
+    TypeTableEntry *ptr_type = value->value->type;
     TypeTableEntry *child_type;
     if (type_is_invalid(ptr_type)) {
         return ira->codegen->builtin_types.entry_invalid;
@@ -9515,10 +10608,10 @@ static TypeTableEntry *ir_analyze_dereference(IrAnalyze *ira, IrInstructionUnOp
     // one of the ptr instructions
 
     if (instr_is_comptime(value)) {
-        ConstExprValue *pointee = const_ptr_pointee(ira->codegen, &value->value);
+        ConstExprValue *pointee = const_ptr_pointee(ira->codegen, value->value);
         if (pointee->type == child_type) {
             ConstExprValue *out_val = ir_build_const_from(ira, &un_op_instruction->base);
-            copy_const_val(out_val, pointee, value->value.data.x_ptr.mut == ConstPtrMutComptimeConst);
+            copy_const_val(ira->codegen, out_val, pointee, value->value->data.x_ptr.mut == ConstPtrMutComptimeConst);
             return child_type;
         }
     }
@@ -9575,7 +10668,7 @@ static TypeTableEntry *ir_analyze_maybe(IrAnalyze *ira, IrInstructionUnOp *un_op
 
 static TypeTableEntry *ir_analyze_negation(IrAnalyze *ira, IrInstructionUnOp *un_op_instruction) {
     IrInstruction *value = un_op_instruction->value->other;
-    TypeTableEntry *expr_type = value->value.type;
+    TypeTableEntry *expr_type = value->value->type;
     if (type_is_invalid(expr_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -9621,7 +10714,7 @@ static TypeTableEntry *ir_analyze_negation(IrAnalyze *ira, IrInstructionUnOp *un
 
 static TypeTableEntry *ir_analyze_bin_not(IrAnalyze *ira, IrInstructionUnOp *instruction) {
     IrInstruction *value = instruction->value->other;
-    TypeTableEntry *expr_type = value->value.type;
+    TypeTableEntry *expr_type = value->value->type;
     if (type_is_invalid(expr_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -9692,7 +10785,7 @@ static TypeTableEntry *ir_analyze_instruction_br(IrAnalyze *ira, IrInstructionBr
 
 static TypeTableEntry *ir_analyze_instruction_cond_br(IrAnalyze *ira, IrInstructionCondBr *cond_br_instruction) {
     IrInstruction *condition = cond_br_instruction->condition->other;
-    if (type_is_invalid(condition->value.type))
+    if (type_is_invalid(condition->value->type))
         return ir_unreach_error(ira);
 
     bool is_comptime;
@@ -9742,17 +10835,18 @@ static TypeTableEntry *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionP
             if (predecessor != ira->const_predecessor_bb)
                 continue;
             IrInstruction *value = phi_instruction->incoming_values[i]->other;
-            assert(value->value.type);
-            if (type_is_invalid(value->value.type))
+            assert(value->value->type);
+            if (type_is_invalid(value->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
-            if (value->value.special != ConstValSpecialRuntime) {
+            if (value->value->special != ConstValSpecialRuntime) {
                 ConstExprValue *out_val = ir_build_const_from(ira, &phi_instruction->base);
-                *out_val = value->value;
+                ir_assert_whole_value(value);
+                *out_val = *value->value;
             } else {
                 phi_instruction->base.other = value;
             }
-            return value->value.type;
+            return value->value->type;
         }
         zig_unreachable();
     }
@@ -9769,10 +10863,10 @@ static TypeTableEntry *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionP
         IrInstruction *old_value = phi_instruction->incoming_values[i];
         assert(old_value);
         IrInstruction *new_value = old_value->other;
-        if (!new_value || new_value->value.type->id == TypeTableEntryIdUnreachable)
+        if (!new_value || new_value->value->type->id == TypeTableEntryIdUnreachable)
             continue;
 
-        if (type_is_invalid(new_value->value.type))
+        if (type_is_invalid(new_value->value->type))
             return ira->codegen->builtin_types.entry_invalid;
 
 
@@ -9789,7 +10883,7 @@ static TypeTableEntry *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionP
     if (new_incoming_blocks.length == 1) {
         IrInstruction *first_value = new_incoming_values.at(0);
         phi_instruction->base.other = first_value;
-        return first_value->value.type;
+        return first_value->value->type;
     }
 
     TypeTableEntry *resolved_type = ir_resolve_peer_types(ira, phi_instruction->base.source_node,
@@ -9822,8 +10916,8 @@ static TypeTableEntry *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionP
         new_incoming_values.items[i] = casted_value;
         predecessor->instruction_list.append(branch_instruction);
 
-        if (all_stack_ptrs && (casted_value->value.special != ConstValSpecialRuntime ||
-            casted_value->value.data.rh_ptr != RuntimeHintPtrStack))
+        if (all_stack_ptrs && (casted_value->value->special != ConstValSpecialRuntime ||
+            casted_value->value->data.rh_ptr != RuntimeHintPtrStack))
         {
             all_stack_ptrs = false;
         }
@@ -9834,8 +10928,8 @@ static TypeTableEntry *ir_analyze_instruction_phi(IrAnalyze *ira, IrInstructionP
             new_incoming_blocks.items, new_incoming_values.items);
 
     if (all_stack_ptrs) {
-        assert(result->value.special == ConstValSpecialRuntime);
-        result->value.data.rh_ptr = RuntimeHintPtrStack;
+        assert(result->value->special == ConstValSpecialRuntime);
+        result->value->data.rh_ptr = RuntimeHintPtrStack;
     }
 
     return resolved_type;
@@ -9846,25 +10940,25 @@ static TypeTableEntry *ir_analyze_var_ptr(IrAnalyze *ira, IrInstruction *instruc
 {
     IrInstruction *result = ir_get_var_ptr(ira, instruction, var, is_const_ptr, is_volatile_ptr);
     ir_link_new_instruction(result, instruction);
-    return result->value.type;
+    return result->value->type;
 }
 
 static TypeTableEntry *ir_analyze_instruction_var_ptr(IrAnalyze *ira, IrInstructionVarPtr *var_ptr_instruction) {
-    VariableTableEntry *var = var_ptr_instruction->var;
+    VariableTableEntry *var = ir_remap_var(ira, var_ptr_instruction->var);
     return ir_analyze_var_ptr(ira, &var_ptr_instruction->base, var, var_ptr_instruction->is_const,
             var_ptr_instruction->is_volatile);
 }
 
 static TypeTableEntry *ir_analyze_instruction_elem_ptr(IrAnalyze *ira, IrInstructionElemPtr *elem_ptr_instruction) {
     IrInstruction *array_ptr = elem_ptr_instruction->array_ptr->other;
-    if (type_is_invalid(array_ptr->value.type))
+    if (type_is_invalid(array_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *elem_index = elem_ptr_instruction->elem_index->other;
-    if (type_is_invalid(elem_index->value.type))
+    if (type_is_invalid(elem_index->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *ptr_type = array_ptr->value.type;
+    TypeTableEntry *ptr_type = array_ptr->value->type;
     if (ptr_type->id == TypeTableEntryIdMetaType) {
         ir_add_error(ira, &elem_ptr_instruction->base,
                 buf_sprintf("array access of non-array type '%s'", buf_ptr(&ptr_type->name)));
@@ -9945,7 +11039,7 @@ static TypeTableEntry *ir_analyze_instruction_elem_ptr(IrAnalyze *ira, IrInstruc
 
     bool safety_check_on = elem_ptr_instruction->safety_check_on;
     if (instr_is_comptime(casted_elem_index)) {
-        uint64_t index = casted_elem_index->value.data.x_bignum.data.x_uint;
+        uint64_t index = casted_elem_index->value->data.x_bignum.data.x_uint;
         if (array_type->id == TypeTableEntryIdArray) {
             uint64_t array_len = array_type->data.array.len;
             if (index >= array_len) {
@@ -9958,9 +11052,9 @@ static TypeTableEntry *ir_analyze_instruction_elem_ptr(IrAnalyze *ira, IrInstruc
         }
 
         ConstExprValue *array_ptr_val;
-        if (array_ptr->value.special != ConstValSpecialRuntime &&
-            (array_ptr->value.data.x_ptr.mut != ConstPtrMutRuntimeVar || array_type->id == TypeTableEntryIdArray) &&
-            (array_ptr_val = const_ptr_pointee(ira->codegen, &array_ptr->value)) &&
+        if (array_ptr->value->special != ConstValSpecialRuntime &&
+            (array_ptr->value->data.x_ptr.mut != ConstPtrMutRuntimeVar || array_type->id == TypeTableEntryIdArray) &&
+            (array_ptr_val = const_ptr_pointee(ira->codegen, array_ptr->value)) &&
             array_ptr_val->special != ConstValSpecialRuntime &&
             (array_type->id != TypeTableEntryIdPointer ||
                 array_ptr_val->data.x_ptr.special != ConstPtrSpecialHardCodedAddr))
@@ -10059,7 +11153,7 @@ static TypeTableEntry *ir_analyze_instruction_elem_ptr(IrAnalyze *ira, IrInstruc
             } else if (array_type->id == TypeTableEntryIdArray) {
                 ConstExprValue *out_val = ir_build_const_from(ira, &elem_ptr_instruction->base);
                 out_val->data.x_ptr.special = ConstPtrSpecialBaseArray;
-                out_val->data.x_ptr.mut = array_ptr->value.data.x_ptr.mut;
+                out_val->data.x_ptr.mut = array_ptr->value->data.x_ptr.mut;
                 out_val->data.x_ptr.data.base_array.array_val = array_ptr_val;
                 out_val->data.x_ptr.data.base_array.elem_index = index;
                 return return_type;
@@ -10109,9 +11203,9 @@ static TypeTableEntry *ir_analyze_container_field_ptr(IrAnalyze *ira, Buf *field
     TypeTableEntry *bare_type = container_ref_type(container_type);
     ensure_complete_type(ira->codegen, bare_type);
 
-    assert(container_ptr->value.type->id == TypeTableEntryIdPointer);
-    bool is_const = container_ptr->value.type->data.pointer.is_const;
-    bool is_volatile = container_ptr->value.type->data.pointer.is_volatile;
+    assert(container_ptr->value->type->id == TypeTableEntryIdPointer);
+    bool is_const = container_ptr->value->type->data.pointer.is_const;
+    bool is_volatile = container_ptr->value->type->data.pointer.is_volatile;
     if (bare_type->id == TypeTableEntryIdStruct) {
         if (bare_type->data.structure.is_invalid)
             return ira->codegen->builtin_types.entry_invalid;
@@ -10130,14 +11224,14 @@ static TypeTableEntry *ir_analyze_container_field_ptr(IrAnalyze *ira, Buf *field
                             is_const, is_volatile, 0, 0);
                     ConstExprValue *const_val = ir_build_const_from(ira, &field_ptr_instruction->base);
                     const_val->data.x_ptr.special = ConstPtrSpecialBaseStruct;
-                    const_val->data.x_ptr.mut = container_ptr->value.data.x_ptr.mut;
+                    const_val->data.x_ptr.mut = container_ptr->value->data.x_ptr.mut;
                     const_val->data.x_ptr.data.base_struct.struct_val = struct_val;
                     const_val->data.x_ptr.data.base_struct.field_index = field->src_index;
                     return ptr_type;
                 }
             }
-            size_t ptr_bit_offset = container_ptr->value.type->data.pointer.bit_offset;
-            size_t ptr_unaligned_bit_count = container_ptr->value.type->data.pointer.unaligned_bit_count;
+            size_t ptr_bit_offset = container_ptr->value->type->data.pointer.bit_offset;
+            size_t ptr_unaligned_bit_count = container_ptr->value->type->data.pointer.unaligned_bit_count;
             size_t unaligned_bit_count_for_result_type = (ptr_unaligned_bit_count == 0) ?
                 field->unaligned_bit_count : type_size_bits(ira->codegen, field->type_entry);
             ir_build_struct_field_ptr_from(&ira->new_irb, &field_ptr_instruction->base, container_ptr, field);
@@ -10182,7 +11276,7 @@ static TypeTableEntry *ir_analyze_decl_ref(IrAnalyze *ira, IrInstruction *source
             TldVar *tld_var = (TldVar *)tld;
             VariableTableEntry *var = tld_var->var;
             if (tld_var->extern_lib_name != nullptr) {
-                add_link_lib_symbol(ira->codegen, tld_var->extern_lib_name, &var->name);
+                add_link_lib_symbol(ira->codegen, tld_var->extern_lib_name, var->name);
             }
 
             return ir_analyze_var_ptr(ira, source_instruction, var, false, false);
@@ -10198,7 +11292,7 @@ static TypeTableEntry *ir_analyze_decl_ref(IrAnalyze *ira, IrInstruction *source
 
             // TODO instead of allocating this every time, put it in the tld value and we can reference
             // the same one every time
-            ConstExprValue *const_val = create_const_vals(1);
+            ConstExprValue *const_val = create_const_vals(ira->codegen, 1);
             const_val->special = ConstValSpecialStatic;
             const_val->type = fn_entry->type_entry;
             const_val->data.x_fn.fn_entry = fn_entry;
@@ -10218,14 +11312,14 @@ static TypeTableEntry *ir_analyze_decl_ref(IrAnalyze *ira, IrInstruction *source
 
 static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstructionFieldPtr *field_ptr_instruction) {
     IrInstruction *container_ptr = field_ptr_instruction->container_ptr->other;
-    if (type_is_invalid(container_ptr->value.type))
+    if (type_is_invalid(container_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *container_type;
-    if (container_ptr->value.type->id == TypeTableEntryIdPointer) {
-        container_type = container_ptr->value.type->data.pointer.child_type;
-    } else if (container_ptr->value.type->id == TypeTableEntryIdMetaType) {
-        container_type = container_ptr->value.type;
+    if (container_ptr->value->type->id == TypeTableEntryIdPointer) {
+        container_type = container_ptr->value->type->data.pointer.child_type;
+    } else if (container_ptr->value->type->id == TypeTableEntryIdMetaType) {
+        container_type = container_ptr->value->type;
     } else {
         zig_unreachable();
     }
@@ -10236,7 +11330,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
     if (type_is_invalid(container_type)) {
         return container_type;
     } else if (is_container_ref(container_type)) {
-        assert(container_ptr->value.type->id == TypeTableEntryIdPointer);
+        assert(container_ptr->value->type->id == TypeTableEntryIdPointer);
         if (container_type->id == TypeTableEntryIdPointer) {
             TypeTableEntry *bare_type = container_ref_type(container_type);
             IrInstruction *container_child = ir_get_deref(ira, &field_ptr_instruction->base, container_ptr);
@@ -10246,7 +11340,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
         }
     } else if (container_type->id == TypeTableEntryIdArray) {
         if (buf_eql_str(field_name, "len")) {
-            ConstExprValue *len_val = create_const_vals(1);
+            ConstExprValue *len_val = create_const_vals(ira->codegen, 1);
             init_const_usize(ira->codegen, len_val, container_type->data.array.len);
 
             TypeTableEntry *usize = ira->codegen->builtin_types.entry_usize;
@@ -10265,11 +11359,11 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
         if (!container_ptr_val)
             return ira->codegen->builtin_types.entry_invalid;
 
-        assert(container_ptr->value.type->id == TypeTableEntryIdPointer);
+        assert(container_ptr->value->type->id == TypeTableEntryIdPointer);
         ConstExprValue *child_val = const_ptr_pointee(ira->codegen, container_ptr_val);
 
         if (buf_eql_str(field_name, "len")) {
-            ConstExprValue *len_val = create_const_vals(1);
+            ConstExprValue *len_val = create_const_vals(ira->codegen, 1);
             size_t len = child_val->data.x_arg_tuple.end_index - child_val->data.x_arg_tuple.start_index;
             init_const_usize(ira->codegen, len_val, len);
 
@@ -10290,11 +11384,11 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
             return ira->codegen->builtin_types.entry_invalid;
 
         TypeTableEntry *child_type;
-        if (container_ptr->value.type->id == TypeTableEntryIdMetaType) {
+        if (container_ptr->value->type->id == TypeTableEntryIdMetaType) {
             TypeTableEntry *ptr_type = container_ptr_val->data.x_type;
             assert(ptr_type->id == TypeTableEntryIdPointer);
             child_type = ptr_type->data.pointer.child_type;
-        } else if (container_ptr->value.type->id == TypeTableEntryIdPointer) {
+        } else if (container_ptr->value->type->id == TypeTableEntryIdPointer) {
             ConstExprValue *child_val = const_ptr_pointee(ira->codegen, container_ptr_val);
             child_type = child_val->data.x_type;
         } else {
@@ -10315,13 +11409,13 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
                         bool ptr_is_const = true;
                         bool ptr_is_volatile = false;
                         return ir_analyze_const_ptr(ira, &field_ptr_instruction->base,
-                                create_const_enum_tag(child_type, field->value), child_type,
+                                create_const_enum_tag(ira->codegen, child_type, field->value), child_type,
                                 ConstPtrMutComptimeConst, ptr_is_const, ptr_is_volatile);
                     } else {
                         bool ptr_is_const = true;
                         bool ptr_is_volatile = false;
                         return ir_analyze_const_ptr(ira, &field_ptr_instruction->base,
-                            create_const_unsigned_negative(child_type->data.enumeration.tag_type, field->value, false),
+                            create_const_unsigned_negative(ira->codegen, child_type->data.enumeration.tag_type, field->value, false),
                             child_type->data.enumeration.tag_type,
                             ConstPtrMutComptimeConst, ptr_is_const, ptr_is_volatile);
                     }
@@ -10342,7 +11436,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
         } else if (child_type->id == TypeTableEntryIdPureError) {
             auto err_table_entry = ira->codegen->error_table.maybe_get(field_name);
             if (err_table_entry) {
-                ConstExprValue *const_val = create_const_vals(1);
+                ConstExprValue *const_val = create_const_vals(ira->codegen, 1);
                 const_val->special = ConstValSpecialStatic;
                 const_val->type = child_type;
                 const_val->data.x_pure_err = err_table_entry->value;
@@ -10361,7 +11455,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
                 bool ptr_is_const = true;
                 bool ptr_is_volatile = false;
                 return ir_analyze_const_ptr(ira, &field_ptr_instruction->base,
-                    create_const_unsigned_negative(ira->codegen->builtin_types.entry_num_lit_int,
+                    create_const_unsigned_negative(ira->codegen, ira->codegen->builtin_types.entry_num_lit_int,
                         child_type->data.integral.bit_count, false),
                     ira->codegen->builtin_types.entry_num_lit_int,
                     ConstPtrMutComptimeConst, ptr_is_const, ptr_is_volatile);
@@ -10383,7 +11477,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
                 bool ptr_is_const = true;
                 bool ptr_is_volatile = false;
                 return ir_analyze_const_ptr(ira, &field_ptr_instruction->base,
-                    create_const_unsigned_negative(ira->codegen->builtin_types.entry_num_lit_int,
+                    create_const_unsigned_negative(ira->codegen, ira->codegen->builtin_types.entry_num_lit_int,
                         child_type->data.floating.bit_count, false),
                     ira->codegen->builtin_types.entry_num_lit_int,
                     ConstPtrMutComptimeConst, ptr_is_const, ptr_is_volatile);
@@ -10399,7 +11493,7 @@ static TypeTableEntry *ir_analyze_instruction_field_ptr(IrAnalyze *ira, IrInstru
             return ira->codegen->builtin_types.entry_invalid;
         }
     } else if (container_type->id == TypeTableEntryIdNamespace) {
-        assert(container_ptr->value.type->id == TypeTableEntryIdPointer);
+        assert(container_ptr->value->type->id == TypeTableEntryIdPointer);
         ConstExprValue *container_ptr_val = ir_resolve_const(ira, container_ptr, UndefBad);
         if (!container_ptr_val)
             return ira->codegen->builtin_types.entry_invalid;
@@ -10437,49 +11531,62 @@ static TypeTableEntry *ir_analyze_instruction_load_ptr(IrAnalyze *ira, IrInstruc
     IrInstruction *ptr = load_ptr_instruction->ptr->other;
     IrInstruction *result = ir_get_deref(ira, &load_ptr_instruction->base, ptr);
     ir_link_new_instruction(result, &load_ptr_instruction->base);
-    assert(result->value.type);
-    return result->value.type;
+    assert(result->value->type);
+    return result->value->type;
 }
 
 static TypeTableEntry *ir_analyze_instruction_store_ptr(IrAnalyze *ira, IrInstructionStorePtr *store_ptr_instruction) {
     IrInstruction *ptr = store_ptr_instruction->ptr->other;
-    if (type_is_invalid(ptr->value.type))
-        return ptr->value.type;
+    if (type_is_invalid(ptr->value->type))
+        return ptr->value->type;
 
     IrInstruction *value = store_ptr_instruction->value->other;
-    if (type_is_invalid(value->value.type))
-        return value->value.type;
+    if (type_is_invalid(value->value->type))
+        return value->value->type;
 
-    if (ptr->value.type->id != TypeTableEntryIdPointer) {
+    if (ptr->value->type->id != TypeTableEntryIdPointer) {
         ir_add_error(ira, ptr,
-            buf_sprintf("attempt to dereference non pointer type '%s'", buf_ptr(&ptr->value.type->name)));
+            buf_sprintf("attempt to dereference non pointer type '%s'", buf_ptr(&ptr->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
-    if (ptr->value.data.x_ptr.special == ConstPtrSpecialDiscard) {
+    if (ptr->value->data.x_ptr.special == ConstPtrSpecialDiscard) {
         return ir_analyze_void(ira, &store_ptr_instruction->base);
     }
 
-    if (ptr->value.type->data.pointer.is_const && !store_ptr_instruction->base.is_gen) {
+    if (ptr->value->type->data.pointer.is_const && !store_ptr_instruction->base.is_gen) {
         ir_add_error(ira, &store_ptr_instruction->base, buf_sprintf("cannot assign to constant"));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
-    TypeTableEntry *child_type = ptr->value.type->data.pointer.child_type;
+    TypeTableEntry *child_type = ptr->value->type->data.pointer.child_type;
     IrInstruction *casted_value = ir_implicit_cast(ira, value, child_type);
     if (casted_value == ira->codegen->invalid_instruction)
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (instr_is_comptime(ptr) && ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr) {
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeConst) {
+    if (instr_is_comptime(ptr) && ptr->value->data.x_ptr.special != ConstPtrSpecialHardCodedAddr) {
+        if (ptr->value->data.x_ptr.mut == ConstPtrMutComptimeConst) {
             ir_add_error(ira, &store_ptr_instruction->base, buf_sprintf("cannot assign to constant"));
             return ira->codegen->builtin_types.entry_invalid;
         }
-        if (ptr->value.data.x_ptr.mut == ConstPtrMutComptimeVar) {
+        if (ptr->value->data.x_ptr.mut == ConstPtrMutComptimeVar) {
+            if (instr_is_comptime(casted_value) && ptr->value->data.x_ptr.special == ConstPtrSpecialBaseArray) {
+                ConstExprValue *array_val = ptr->value->data.x_ptr.data.base_array.array_val;
+                if (array_val->data.x_array.special != ConstArraySpecialNone &&
+                    make_dense_const_array(ira->codegen, array_val))
+                {
+                    dense_const_array_set(array_val, ptr->value->data.x_ptr.data.base_array.elem_index,
+                            casted_value->value);
+                    if (!ira->new_irb.current_basic_block->must_be_comptime_source_instr) {
+                        ira->new_irb.current_basic_block->must_be_comptime_source_instr = &store_ptr_instruction->base;
+                    }
+                    return ir_analyze_void(ira, &store_ptr_instruction->base);
+                }
+            }
             if (instr_is_comptime(casted_value)) {
-                ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, &ptr->value);
+                ConstExprValue *dest_val = const_ptr_pointee(ira->codegen, ptr->value);
                 if (dest_val->special != ConstValSpecialRuntime) {
-                    *dest_val = casted_value->value;
+                    *dest_val = *casted_value->value;
                     if (!ira->new_irb.current_basic_block->must_be_comptime_source_instr) {
                         ira->new_irb.current_basic_block->must_be_comptime_source_instr = &store_ptr_instruction->base;
                     }
@@ -10498,7 +11605,7 @@ static TypeTableEntry *ir_analyze_instruction_store_ptr(IrAnalyze *ira, IrInstru
 
 static TypeTableEntry *ir_analyze_instruction_typeof(IrAnalyze *ira, IrInstructionTypeOf *typeof_instruction) {
     IrInstruction *expr_value = typeof_instruction->value->other;
-    TypeTableEntry *type_entry = expr_value->value.type;
+    TypeTableEntry *type_entry = expr_value->value->type;
     if (type_is_invalid(type_entry))
         return ira->codegen->builtin_types.entry_invalid;
     switch (type_entry->id) {
@@ -10548,7 +11655,7 @@ static TypeTableEntry *ir_analyze_instruction_to_ptr_type(IrAnalyze *ira,
         IrInstructionToPtrType *to_ptr_type_instruction)
 {
     IrInstruction *value = to_ptr_type_instruction->value->other;
-    TypeTableEntry *type_entry = value->value.type;
+    TypeTableEntry *type_entry = value->value->type;
     if (type_is_invalid(type_entry))
         return type_entry;
 
@@ -10621,7 +11728,7 @@ static TypeTableEntry *ir_analyze_instruction_set_global_align(IrAnalyze *ira,
 
         if (tld_var->var->linkage == VarLinkageExternal) {
             ErrorMsg *msg = ir_add_error(ira, &instruction->base,
-                    buf_sprintf("cannot set alignment of external variable '%s'", buf_ptr(&tld_var->var->name)));
+                    buf_sprintf("cannot set alignment of external variable '%s'", buf_ptr(tld_var->var->name)));
             add_error_note(ira->codegen, msg, tld->source_node, buf_sprintf("declared here"));
             return ira->codegen->builtin_types.entry_invalid;
         }
@@ -10679,7 +11786,7 @@ static TypeTableEntry *ir_analyze_instruction_set_global_section(IrAnalyze *ira,
 
         if (tld_var->var->linkage == VarLinkageExternal) {
             ErrorMsg *msg = ir_add_error(ira, &instruction->base,
-                    buf_sprintf("cannot set section of external variable '%s'", buf_ptr(&tld_var->var->name)));
+                    buf_sprintf("cannot set section of external variable '%s'", buf_ptr(tld_var->var->name)));
             add_error_note(ira->codegen, msg, tld->source_node, buf_sprintf("declared here"));
             return ira->codegen->builtin_types.entry_invalid;
         }
@@ -10756,7 +11863,7 @@ static TypeTableEntry *ir_analyze_instruction_set_debug_safety(IrAnalyze *ira,
         IrInstructionSetDebugSafety *set_debug_safety_instruction)
 {
     IrInstruction *target_instruction = set_debug_safety_instruction->scope_value->other;
-    TypeTableEntry *target_type = target_instruction->value.type;
+    TypeTableEntry *target_type = target_instruction->value->type;
     if (type_is_invalid(target_type))
         return ira->codegen->builtin_types.entry_invalid;
     ConstExprValue *target_val = ir_resolve_const(ira, target_instruction, UndefBad);
@@ -10825,7 +11932,7 @@ static TypeTableEntry *ir_analyze_instruction_set_float_mode(IrAnalyze *ira,
         IrInstructionSetFloatMode *instruction)
 {
     IrInstruction *target_instruction = instruction->scope_value->other;
-    TypeTableEntry *target_type = target_instruction->value.type;
+    TypeTableEntry *target_type = target_instruction->value->type;
     if (type_is_invalid(target_type))
         return ira->codegen->builtin_types.entry_invalid;
     ConstExprValue *target_val = ir_resolve_const(ira, target_instruction, UndefBad);
@@ -10876,10 +11983,10 @@ static TypeTableEntry *ir_analyze_instruction_set_float_mode(IrAnalyze *ira,
     TypeTableEntry *float_mode_enum_type = float_mode_val->data.x_type;
 
     IrInstruction *float_mode_value = instruction->mode_value->other;
-    if (type_is_invalid(float_mode_value->value.type))
+    if (type_is_invalid(float_mode_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
     IrInstruction *casted_value = ir_implicit_cast(ira, float_mode_value, float_mode_enum_type);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
     ConstExprValue *mode_val = ir_resolve_const(ira, casted_value, UndefBad);
     if (!mode_val)
@@ -10905,7 +12012,7 @@ static TypeTableEntry *ir_analyze_instruction_slice_type(IrAnalyze *ira,
         IrInstructionSliceType *slice_type_instruction)
 {
     IrInstruction *child_type = slice_type_instruction->child_type->other;
-    if (type_is_invalid(child_type->value.type))
+    if (type_is_invalid(child_type->value->type))
         return ira->codegen->builtin_types.entry_invalid;
     bool is_const = slice_type_instruction->is_const;
 
@@ -10999,7 +12106,7 @@ static TypeTableEntry *ir_analyze_instruction_asm(IrAnalyze *ira, IrInstructionA
 
     for (size_t i = 0; i < asm_expr->input_list.length; i += 1) {
         input_list[i] = asm_instruction->input_list[i]->other;
-        if (type_is_invalid(input_list[i]->value.type))
+        if (type_is_invalid(input_list[i]->value->type))
             return ira->codegen->builtin_types.entry_invalid;
     }
 
@@ -11116,10 +12223,10 @@ static TypeTableEntry *ir_analyze_instruction_size_of(IrAnalyze *ira,
 
 static TypeTableEntry *ir_analyze_instruction_test_non_null(IrAnalyze *ira, IrInstructionTestNonNull *instruction) {
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *type_entry = value->value.type;
+    TypeTableEntry *type_entry = value->value->type;
 
     if (type_entry->id == TypeTableEntryIdMaybe) {
         if (instr_is_comptime(value)) {
@@ -11149,10 +12256,10 @@ static TypeTableEntry *ir_analyze_instruction_unwrap_maybe(IrAnalyze *ira,
         IrInstructionUnwrapMaybe *unwrap_maybe_instruction)
 {
     IrInstruction *value = unwrap_maybe_instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *ptr_type = value->value.type;
+    TypeTableEntry *ptr_type = value->value->type;
     if (ptr_type->id == TypeTableEntryIdMetaType) {
         // surprise! actually this is just ??T not an unwrap maybe instruction
         TypeTableEntry *ptr_type_ptr = ir_resolve_type(ira, value);
@@ -11166,7 +12273,7 @@ static TypeTableEntry *ir_analyze_instruction_unwrap_maybe(IrAnalyze *ira,
         IrInstruction *const_instr = ir_build_const_type(&ira->new_irb, unwrap_maybe_instruction->base.scope,
                 unwrap_maybe_instruction->base.source_node, result_type);
         ir_link_new_instruction(const_instr, &unwrap_maybe_instruction->base);
-        return const_instr->value.type;
+        return const_instr->value->type;
     }
 
     assert(ptr_type->id == TypeTableEntryIdPointer);
@@ -11209,59 +12316,59 @@ static TypeTableEntry *ir_analyze_instruction_unwrap_maybe(IrAnalyze *ira,
 
 static TypeTableEntry *ir_analyze_instruction_ctz(IrAnalyze *ira, IrInstructionCtz *ctz_instruction) {
     IrInstruction *value = ctz_instruction->value->other;
-    if (type_is_invalid(value->value.type)) {
+    if (type_is_invalid(value->value->type)) {
         return ira->codegen->builtin_types.entry_invalid;
-    } else if (value->value.type->id == TypeTableEntryIdInt) {
-        if (value->value.special != ConstValSpecialRuntime) {
-            uint32_t result = bignum_ctz(&value->value.data.x_bignum,
-                    value->value.type->data.integral.bit_count);
+    } else if (value->value->type->id == TypeTableEntryIdInt) {
+        if (value->value->special != ConstValSpecialRuntime) {
+            uint32_t result = bignum_ctz(&value->value->data.x_bignum,
+                    value->value->type->data.integral.bit_count);
             ConstExprValue *out_val = ir_build_const_from(ira, &ctz_instruction->base);
             bignum_init_unsigned(&out_val->data.x_bignum, result);
-            return value->value.type;
+            return value->value->type;
         }
 
         ir_build_ctz_from(&ira->new_irb, &ctz_instruction->base, value);
-        return value->value.type;
+        return value->value->type;
     } else {
         ir_add_error_node(ira, ctz_instruction->base.source_node,
-            buf_sprintf("expected integer type, found '%s'", buf_ptr(&value->value.type->name)));
+            buf_sprintf("expected integer type, found '%s'", buf_ptr(&value->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 }
 
 static TypeTableEntry *ir_analyze_instruction_clz(IrAnalyze *ira, IrInstructionClz *clz_instruction) {
     IrInstruction *value = clz_instruction->value->other;
-    if (type_is_invalid(value->value.type)) {
+    if (type_is_invalid(value->value->type)) {
         return ira->codegen->builtin_types.entry_invalid;
-    } else if (value->value.type->id == TypeTableEntryIdInt) {
-        if (value->value.special != ConstValSpecialRuntime) {
-            uint32_t result = bignum_clz(&value->value.data.x_bignum,
-                    value->value.type->data.integral.bit_count);
+    } else if (value->value->type->id == TypeTableEntryIdInt) {
+        if (value->value->special != ConstValSpecialRuntime) {
+            uint32_t result = bignum_clz(&value->value->data.x_bignum,
+                    value->value->type->data.integral.bit_count);
             ConstExprValue *out_val = ir_build_const_from(ira, &clz_instruction->base);
             bignum_init_unsigned(&out_val->data.x_bignum, result);
-            return value->value.type;
+            return value->value->type;
         }
 
         ir_build_clz_from(&ira->new_irb, &clz_instruction->base, value);
-        return value->value.type;
+        return value->value->type;
     } else {
         ir_add_error_node(ira, clz_instruction->base.source_node,
-            buf_sprintf("expected integer type, found '%s'", buf_ptr(&value->value.type->name)));
+            buf_sprintf("expected integer type, found '%s'", buf_ptr(&value->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 }
 
 static IrInstruction *ir_analyze_enum_tag(IrAnalyze *ira, IrInstruction *source_instr, IrInstruction *value) {
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->invalid_instruction;
 
-    if (value->value.type->id != TypeTableEntryIdEnum) {
+    if (value->value->type->id != TypeTableEntryIdEnum) {
         ir_add_error(ira, source_instr,
-            buf_sprintf("expected enum type, found '%s'", buf_ptr(&value->value.type->name)));
+            buf_sprintf("expected enum type, found '%s'", buf_ptr(&value->value->type->name)));
         return ira->codegen->invalid_instruction;
     }
 
-    TypeTableEntry *tag_type = value->value.type->data.enumeration.tag_type;
+    TypeTableEntry *tag_type = value->value->type->data.enumeration.tag_type;
 
     if (instr_is_comptime(value)) {
         ConstExprValue *val = ir_resolve_const(ira, value, UndefBad);
@@ -11270,14 +12377,14 @@ static IrInstruction *ir_analyze_enum_tag(IrAnalyze *ira, IrInstruction *source_
 
         IrInstructionConst *const_instruction = ir_create_instruction<IrInstructionConst>(&ira->new_irb,
                 source_instr->scope, source_instr->source_node);
-        const_instruction->base.value.type = tag_type;
-        const_instruction->base.value.special = ConstValSpecialStatic;
-        bignum_init_unsigned(&const_instruction->base.value.data.x_bignum, val->data.x_enum.tag);
+        const_instruction->base.value->type = tag_type;
+        const_instruction->base.value->special = ConstValSpecialStatic;
+        bignum_init_unsigned(&const_instruction->base.value->data.x_bignum, val->data.x_enum.tag);
         return &const_instruction->base;
     }
 
     IrInstruction *result = ir_build_enum_tag(&ira->new_irb, source_instr->scope, source_instr->source_node, value);
-    result->value.type = tag_type;
+    result->value->type = tag_type;
     return result;
 }
 
@@ -11285,7 +12392,7 @@ static TypeTableEntry *ir_analyze_instruction_switch_br(IrAnalyze *ira,
         IrInstructionSwitchBr *switch_br_instruction)
 {
     IrInstruction *target_value = switch_br_instruction->target_value->other;
-    if (type_is_invalid(target_value->value.type))
+    if (type_is_invalid(target_value->value->type))
         return ir_unreach_error(ira);
 
     size_t case_count = switch_br_instruction->case_count;
@@ -11303,17 +12410,17 @@ static TypeTableEntry *ir_analyze_instruction_switch_br(IrAnalyze *ira,
         for (size_t i = 0; i < case_count; i += 1) {
             IrInstructionSwitchBrCase *old_case = &switch_br_instruction->cases[i];
             IrInstruction *case_value = old_case->value->other;
-            if (type_is_invalid(case_value->value.type))
+            if (type_is_invalid(case_value->value->type))
                 return ir_unreach_error(ira);
 
-            if (case_value->value.type->id == TypeTableEntryIdEnum) {
+            if (case_value->value->type->id == TypeTableEntryIdEnum) {
                 case_value = ir_analyze_enum_tag(ira, &switch_br_instruction->base, case_value);
-                if (type_is_invalid(case_value->value.type))
+                if (type_is_invalid(case_value->value->type))
                     return ir_unreach_error(ira);
             }
 
-            IrInstruction *casted_case_value = ir_implicit_cast(ira, case_value, target_value->value.type);
-            if (type_is_invalid(casted_case_value->value.type))
+            IrInstruction *casted_case_value = ir_implicit_cast(ira, case_value, target_value->value->type);
+            if (type_is_invalid(casted_case_value->value->type))
                 return ir_unreach_error(ira);
 
             ConstExprValue *case_val = ir_resolve_const(ira, casted_case_value, UndefBad);
@@ -11350,17 +12457,17 @@ static TypeTableEntry *ir_analyze_instruction_switch_br(IrAnalyze *ira,
 
         IrInstruction *old_value = old_case->value;
         IrInstruction *new_value = old_value->other;
-        if (type_is_invalid(new_value->value.type))
+        if (type_is_invalid(new_value->value->type))
             continue;
 
-        if (new_value->value.type->id == TypeTableEntryIdEnum) {
+        if (new_value->value->type->id == TypeTableEntryIdEnum) {
             new_value = ir_analyze_enum_tag(ira, &switch_br_instruction->base, new_value);
-            if (type_is_invalid(new_value->value.type))
+            if (type_is_invalid(new_value->value->type))
                 continue;
         }
 
-        IrInstruction *casted_new_value = ir_implicit_cast(ira, new_value, target_value->value.type);
-        if (type_is_invalid(casted_new_value->value.type))
+        IrInstruction *casted_new_value = ir_implicit_cast(ira, new_value, target_value->value->type);
+        if (type_is_invalid(casted_new_value->value->type))
             continue;
 
         if (!ir_resolve_const(ira, casted_new_value, UndefBad))
@@ -11386,12 +12493,12 @@ static TypeTableEntry *ir_analyze_instruction_switch_target(IrAnalyze *ira,
         IrInstructionSwitchTarget *switch_target_instruction)
 {
     IrInstruction *target_value_ptr = switch_target_instruction->target_value_ptr->other;
-    if (type_is_invalid(target_value_ptr->value.type))
+    if (type_is_invalid(target_value_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (target_value_ptr->value.type->id == TypeTableEntryIdMetaType) {
+    if (target_value_ptr->value->type->id == TypeTableEntryIdMetaType) {
         assert(instr_is_comptime(target_value_ptr));
-        TypeTableEntry *ptr_type = target_value_ptr->value.data.x_type;
+        TypeTableEntry *ptr_type = target_value_ptr->value->data.x_type;
         assert(ptr_type->id == TypeTableEntryIdPointer);
         ConstExprValue *out_val = ir_build_const_from(ira, &switch_target_instruction->base);
         out_val->type = ira->codegen->builtin_types.entry_type;
@@ -11399,12 +12506,12 @@ static TypeTableEntry *ir_analyze_instruction_switch_target(IrAnalyze *ira,
         return out_val->type;
     }
 
-    assert(target_value_ptr->value.type->id == TypeTableEntryIdPointer);
+    assert(target_value_ptr->value->type->id == TypeTableEntryIdPointer);
 
-    TypeTableEntry *target_type = target_value_ptr->value.type->data.pointer.child_type;
+    TypeTableEntry *target_type = target_value_ptr->value->type->data.pointer.child_type;
     ConstExprValue *pointee_val = nullptr;
     if (instr_is_comptime(target_value_ptr)) {
-        pointee_val = const_ptr_pointee(ira->codegen, &target_value_ptr->value);
+        pointee_val = const_ptr_pointee(ira->codegen, target_value_ptr->value);
         if (pointee_val->special == ConstValSpecialRuntime)
             pointee_val = nullptr;
     }
@@ -11429,7 +12536,7 @@ static TypeTableEntry *ir_analyze_instruction_switch_target(IrAnalyze *ira,
         case TypeTableEntryIdPureError:
             if (pointee_val) {
                 ConstExprValue *out_val = ir_build_const_from(ira, &switch_target_instruction->base);
-                copy_const_val(out_val, pointee_val, true);
+                copy_const_val(ira->codegen, out_val, pointee_val, true);
                 out_val->type = target_type;
                 return target_type;
             }
@@ -11447,7 +12554,7 @@ static TypeTableEntry *ir_analyze_instruction_switch_target(IrAnalyze *ira,
 
                 IrInstruction *enum_value = ir_build_load_ptr(&ira->new_irb, switch_target_instruction->base.scope,
                     switch_target_instruction->base.source_node, target_value_ptr);
-                enum_value->value.type = target_type;
+                enum_value->value->type = target_type;
                 ir_build_enum_tag_from(&ira->new_irb, &switch_target_instruction->base, enum_value);
                 return tag_type;
             }
@@ -11476,24 +12583,24 @@ static TypeTableEntry *ir_analyze_instruction_switch_target(IrAnalyze *ira,
 
 static TypeTableEntry *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstructionSwitchVar *instruction) {
     IrInstruction *target_value_ptr = instruction->target_value_ptr->other;
-    if (type_is_invalid(target_value_ptr->value.type))
+    if (type_is_invalid(target_value_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *prong_value = instruction->prong_value->other;
-    if (type_is_invalid(prong_value->value.type))
+    if (type_is_invalid(prong_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    assert(target_value_ptr->value.type->id == TypeTableEntryIdPointer);
-    TypeTableEntry *target_type = target_value_ptr->value.type->data.pointer.child_type;
+    assert(target_value_ptr->value->type->id == TypeTableEntryIdPointer);
+    TypeTableEntry *target_type = target_value_ptr->value->type->data.pointer.child_type;
     if (target_type->id == TypeTableEntryIdEnum) {
         ConstExprValue *prong_val = ir_resolve_const(ira, prong_value, UndefBad);
         if (!prong_val)
             return ira->codegen->builtin_types.entry_invalid;
 
         TypeEnumField *field = &target_type->data.enumeration.fields[prong_val->data.x_bignum.data.x_uint];
-        if (prong_value->value.type->id == TypeTableEntryIdEnumTag) {
+        if (prong_value->value->type->id == TypeTableEntryIdEnumTag) {
             field = &target_type->data.enumeration.fields[prong_val->data.x_bignum.data.x_uint];
-        } else if (prong_value->value.type->id == TypeTableEntryIdEnum) {
+        } else if (prong_value->value->type->id == TypeTableEntryIdEnum) {
             field = &target_type->data.enumeration.fields[prong_val->data.x_enum.tag];
         } else {
             zig_unreachable();
@@ -11514,7 +12621,7 @@ static TypeTableEntry *ir_analyze_instruction_switch_var(IrAnalyze *ira, IrInstr
 
         ir_build_enum_field_ptr_from(&ira->new_irb, &instruction->base, target_value_ptr, field);
         return get_pointer_to_type(ira->codegen, field->type_entry,
-                target_value_ptr->value.type->data.pointer.is_const);
+                target_value_ptr->value->type->data.pointer.is_const);
     } else {
         ir_add_error(ira, &instruction->base,
             buf_sprintf("switch on type '%s' provides no expression parameter", buf_ptr(&target_type->name)));
@@ -11526,7 +12633,7 @@ static TypeTableEntry *ir_analyze_instruction_enum_tag(IrAnalyze *ira, IrInstruc
     IrInstruction *value = enum_tag_instruction->value->other;
     IrInstruction *new_instruction = ir_analyze_enum_tag(ira, &enum_tag_instruction->base, value);
     ir_link_new_instruction(new_instruction, &enum_tag_instruction->base);
-    return new_instruction->value.type;
+    return new_instruction->value->type;
 }
 
 static TypeTableEntry *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructionImport *import_instruction) {
@@ -11583,18 +12690,21 @@ static TypeTableEntry *ir_analyze_instruction_import(IrAnalyze *ira, IrInstructi
         return ira->codegen->builtin_types.entry_namespace;
     }
 
-    if ((err = os_fetch_file_path(abs_full_path, import_code))) {
-        if (err == ErrorFileNotFound) {
-            ir_add_error_node(ira, source_node,
-                    buf_sprintf("unable to find '%s'", buf_ptr(import_target_path)));
-            return ira->codegen->builtin_types.entry_invalid;
-        } else {
-            ir_add_error_node(ira, source_node,
-                    buf_sprintf("unable to open '%s': %s", buf_ptr(&full_path), err_str(err)));
-            return ira->codegen->builtin_types.entry_invalid;
+    ImportTableEntry *target_import = take_prefetched_import(ira->codegen, &full_path);
+    if (target_import == nullptr) {
+        if ((err = os_map_file_path(abs_full_path, import_code))) {
+            if (err == ErrorFileNotFound) {
+                ir_add_error_node(ira, source_node,
+                        buf_sprintf("unable to find '%s'", buf_ptr(import_target_path)));
+                return ira->codegen->builtin_types.entry_invalid;
+            } else {
+                ir_add_error_node(ira, source_node,
+                        buf_sprintf("unable to open '%s': %s", buf_ptr(&full_path), err_str(err)));
+                return ira->codegen->builtin_types.entry_invalid;
+            }
         }
+        target_import = add_source_file(ira->codegen, target_package, abs_full_path, import_code);
     }
-    ImportTableEntry *target_import = add_source_file(ira->codegen, target_package, abs_full_path, import_code);
 
     scan_import(ira->codegen, target_import);
 
@@ -11608,15 +12718,15 @@ static TypeTableEntry *ir_analyze_instruction_array_len(IrAnalyze *ira,
         IrInstructionArrayLen *array_len_instruction)
 {
     IrInstruction *array_value = array_len_instruction->array_value->other;
-    TypeTableEntry *type_entry = array_value->value.type;
+    TypeTableEntry *type_entry = array_value->value->type;
     if (type_is_invalid(type_entry)) {
         return ira->codegen->builtin_types.entry_invalid;
     } else if (type_entry->id == TypeTableEntryIdArray) {
         return ir_analyze_const_usize(ira, &array_len_instruction->base,
                 type_entry->data.array.len);
     } else if (is_slice(type_entry)) {
-        if (array_value->value.special != ConstValSpecialRuntime) {
-            ConstExprValue *len_val = &array_value->value.data.x_struct.fields[slice_len_index];
+        if (array_value->value->special != ConstValSpecialRuntime) {
+            ConstExprValue *len_val = &array_value->value->data.x_struct.fields[slice_len_index];
             if (len_val->special != ConstValSpecialRuntime) {
                 return ir_analyze_const_usize(ira, &array_len_instruction->base,
                         len_val->data.x_bignum.data.x_uint);
@@ -11625,12 +12735,12 @@ static TypeTableEntry *ir_analyze_instruction_array_len(IrAnalyze *ira,
         TypeStructField *field = &type_entry->data.structure.fields[slice_len_index];
         IrInstruction *len_ptr = ir_build_struct_field_ptr(&ira->new_irb, array_len_instruction->base.scope,
                 array_len_instruction->base.source_node, array_value, field);
-        len_ptr->value.type = get_pointer_to_type(ira->codegen, ira->codegen->builtin_types.entry_usize, true);
+        len_ptr->value->type = get_pointer_to_type(ira->codegen, ira->codegen->builtin_types.entry_usize, true);
         ir_build_load_ptr_from(&ira->new_irb, &array_len_instruction->base, len_ptr);
         return ira->codegen->builtin_types.entry_usize;
     } else {
         ir_add_error_node(ira, array_len_instruction->base.source_node,
-            buf_sprintf("type '%s' has no field 'len'", buf_ptr(&array_value->value.type->name)));
+            buf_sprintf("type '%s' has no field 'len'", buf_ptr(&array_value->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 }
@@ -11666,12 +12776,12 @@ static TypeTableEntry *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstru
     ConstExprValue const_val = {};
     const_val.special = ConstValSpecialStatic;
     const_val.type = container_type;
-    const_val.data.x_struct.fields = create_const_vals(actual_field_count);
+    const_val.data.x_struct.fields = create_const_vals(ira->codegen, actual_field_count);
     for (size_t i = 0; i < instr_field_count; i += 1) {
         IrInstructionContainerInitFieldsField *field = &fields[i];
 
         IrInstruction *field_value = field->value->other;
-        if (type_is_invalid(field_value->value.type))
+        if (type_is_invalid(field_value->value->type))
             return ira->codegen->builtin_types.entry_invalid;
 
         TypeStructField *type_field = find_struct_type_field(container_type, field->name);
@@ -11702,12 +12812,12 @@ static TypeTableEntry *ir_analyze_container_init_fields(IrAnalyze *ira, IrInstru
         new_fields[field_index].type_struct_field = type_field;
 
         if (const_val.special == ConstValSpecialStatic) {
-            if (is_comptime || casted_field_value->value.special != ConstValSpecialRuntime) {
+            if (is_comptime || casted_field_value->value->special != ConstValSpecialRuntime) {
                 ConstExprValue *field_val = ir_resolve_const(ira, casted_field_value, UndefOk);
                 if (!field_val)
                     return ira->codegen->builtin_types.entry_invalid;
 
-                copy_const_val(&const_val.data.x_struct.fields[field_index], field_val, true);
+                copy_const_val(ira->codegen, &const_val.data.x_struct.fields[field_index], field_val, true);
             } else {
                 first_non_const_instruction = casted_field_value;
                 const_val.special = ConstValSpecialRuntime;
@@ -11760,11 +12870,11 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
         IrInstructionContainerInitList *instruction)
 {
     IrInstruction *container_type_value = instruction->container_type->other;
-    if (type_is_invalid(container_type_value->value.type))
+    if (type_is_invalid(container_type_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     size_t elem_count = instruction->item_count;
-    if (container_type_value->value.type->id == TypeTableEntryIdMetaType) {
+    if (container_type_value->value->type->id == TypeTableEntryIdMetaType) {
         TypeTableEntry *container_type = ir_resolve_type(ira, container_type_value);
         if (type_is_invalid(container_type))
             return ira->codegen->builtin_types.entry_invalid;
@@ -11781,7 +12891,7 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
             ConstExprValue const_val = {};
             const_val.special = ConstValSpecialStatic;
             const_val.type = fixed_size_array_type;
-            const_val.data.x_array.s_none.elements = create_const_vals(elem_count);
+            const_val.data.x_array.s_none.elements = create_const_vals(ira->codegen, elem_count);
 
             bool is_comptime = ir_should_inline(ira->new_irb.exec, instruction->base.scope);
 
@@ -11791,7 +12901,7 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
 
             for (size_t i = 0; i < elem_count; i += 1) {
                 IrInstruction *arg_value = instruction->items[i]->other;
-                if (type_is_invalid(arg_value->value.type))
+                if (type_is_invalid(arg_value->value->type))
                     return ira->codegen->builtin_types.entry_invalid;
 
                 IrInstruction *casted_arg = ir_implicit_cast(ira, arg_value, child_type);
@@ -11801,12 +12911,12 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
                 new_items[i] = casted_arg;
 
                 if (const_val.special == ConstValSpecialStatic) {
-                    if (is_comptime || casted_arg->value.special != ConstValSpecialRuntime) {
+                    if (is_comptime || casted_arg->value->special != ConstValSpecialRuntime) {
                         ConstExprValue *elem_val = ir_resolve_const(ira, casted_arg, UndefBad);
                         if (!elem_val)
                             return ira->codegen->builtin_types.entry_invalid;
 
-                        copy_const_val(&const_val.data.x_array.s_none.elements[i], elem_val, true);
+                        copy_const_val(ira->codegen, &const_val.data.x_array.s_none.elements[i], elem_val, true);
                     } else {
                         first_non_const_instruction = casted_arg;
                         const_val.special = ConstValSpecialRuntime;
@@ -11817,6 +12927,8 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
             if (const_val.special == ConstValSpecialStatic) {
                 ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
                 *out_val = const_val;
+                if (make_dense_const_array(ira->codegen, out_val))
+                    return fixed_size_array_type;
                 for (size_t i = 0; i < elem_count; i += 1) {
                     ConstExprValue *elem_val = &out_val->data.x_array.s_none.elements[i];
                     ConstParent *parent = get_const_val_parent(ira->codegen, elem_val);
@@ -11855,7 +12967,7 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
                     buf_ptr(&container_type->name)));
             return ira->codegen->builtin_types.entry_invalid;
         }
-    } else if (container_type_value->value.type->id == TypeTableEntryIdEnumTag) {
+    } else if (container_type_value->value->type->id == TypeTableEntryIdEnumTag) {
         if (elem_count != 1) {
             ir_add_error(ira, &instruction->base, buf_sprintf("enum initialization requires exactly one element"));
             return ira->codegen->builtin_types.entry_invalid;
@@ -11864,14 +12976,14 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
         if (!tag_value)
             return ira->codegen->builtin_types.entry_invalid;
 
-        TypeTableEntry *enum_type = container_type_value->value.type->data.enum_tag.enum_type;
+        TypeTableEntry *enum_type = container_type_value->value->type->data.enum_tag.enum_type;
 
         uint64_t tag_uint = tag_value->data.x_bignum.data.x_uint;
         TypeEnumField *field = &enum_type->data.enumeration.fields[tag_uint];
         TypeTableEntry *this_field_type = field->type_entry;
 
         IrInstruction *init_value = instruction->items[0]->other;
-        if (type_is_invalid(init_value->value.type))
+        if (type_is_invalid(init_value->value->type))
             return ira->codegen->builtin_types.entry_invalid;
 
         IrInstruction *casted_init_value = ir_implicit_cast(ira, init_value, this_field_type);
@@ -11894,7 +13006,7 @@ static TypeTableEntry *ir_analyze_instruction_container_init_list(IrAnalyze *ira
         return enum_type;
     } else {
         ir_add_error(ira, container_type_value,
-            buf_sprintf("expected type, found '%s'", buf_ptr(&container_type_value->value.type->name)));
+            buf_sprintf("expected type, found '%s'", buf_ptr(&container_type_value->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 }
@@ -12013,10 +13125,10 @@ static TypeTableEntry *ir_analyze_instruction_compile_log(IrAnalyze *ira, IrInst
     fprintf(stderr, "| ");
     for (size_t i = 0; i < instruction->msg_count; i += 1) {
         IrInstruction *msg = instruction->msg_list[i]->other;
-        if (type_is_invalid(msg->value.type))
+        if (type_is_invalid(msg->value->type))
             return ira->codegen->builtin_types.entry_invalid;
         buf_resize(&buf, 0);
-        render_const_value(ira->codegen, &buf, &msg->value);
+        render_const_value(ira->codegen, &buf, msg->value);
         const char *comma_str = (i != 0) ? ", " : "";
         fprintf(stderr, "%s%s", comma_str, buf_ptr(&buf));
     }
@@ -12030,22 +13142,22 @@ static TypeTableEntry *ir_analyze_instruction_compile_log(IrAnalyze *ira, IrInst
 
 static TypeTableEntry *ir_analyze_instruction_err_name(IrAnalyze *ira, IrInstructionErrName *instruction) {
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    IrInstruction *casted_value = ir_implicit_cast(ira, value, value->value.type);
-    if (type_is_invalid(casted_value->value.type))
+    IrInstruction *casted_value = ir_implicit_cast(ira, value, value->value->type);
+    if (type_is_invalid(casted_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *str_type = get_slice_type(ira->codegen, ira->codegen->builtin_types.entry_u8, true);
-    if (casted_value->value.special == ConstValSpecialStatic) {
-        ErrorTableEntry *err = casted_value->value.data.x_pure_err;
+    if (casted_value->value->special == ConstValSpecialStatic) {
+        ErrorTableEntry *err = casted_value->value->data.x_pure_err;
         if (!err->cached_error_name_val) {
             ConstExprValue *array_val = create_const_str_lit(ira->codegen, &err->name);
             err->cached_error_name_val = create_const_slice(ira->codegen, array_val, 0, buf_len(&err->name), true);
         }
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-        copy_const_val(out_val, err->cached_error_name_val, true);
+        copy_const_val(ira->codegen, out_val, err->cached_error_name_val, true);
         return str_type;
     }
 
@@ -12056,14 +13168,14 @@ static TypeTableEntry *ir_analyze_instruction_err_name(IrAnalyze *ira, IrInstruc
 
 static TypeTableEntry *ir_analyze_instruction_enum_tag_name(IrAnalyze *ira, IrInstructionEnumTagName *instruction) {
     IrInstruction *target = instruction->target->other;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    assert(target->value.type->id == TypeTableEntryIdEnumTag);
+    assert(target->value->type->id == TypeTableEntryIdEnumTag);
 
     if (instr_is_comptime(target)) {
-        TypeTableEntry *enum_type = target->value.type->data.enum_tag.enum_type;
-        uint64_t tag_value = target->value.data.x_bignum.data.x_uint;
+        TypeTableEntry *enum_type = target->value->type->data.enum_tag.enum_type;
+        uint64_t tag_value = target->value->data.x_bignum.data.x_uint;
         TypeEnumField *field = &enum_type->data.enumeration.fields[tag_value];
         ConstExprValue *array_val = create_const_str_lit(ira->codegen, field->name);
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
@@ -12071,16 +13183,16 @@ static TypeTableEntry *ir_analyze_instruction_enum_tag_name(IrAnalyze *ira, IrIn
         return out_val->type;
     }
 
-    if (!target->value.type->data.enum_tag.generate_name_table) {
-        target->value.type->data.enum_tag.generate_name_table = true;
-        ira->codegen->name_table_enums.append(target->value.type);
+    if (!target->value->type->data.enum_tag.generate_name_table) {
+        target->value->type->data.enum_tag.generate_name_table = true;
+        ira->codegen->name_table_enums.append(target->value->type);
     }
 
     IrInstruction *result = ir_build_enum_tag_name(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, target);
     ir_link_new_instruction(result, &instruction->base);
-    result->value.type = get_slice_type(ira->codegen, ira->codegen->builtin_types.entry_u8, true);
-    return result->value.type;
+    result->value->type = get_slice_type(ira->codegen, ira->codegen->builtin_types.entry_u8, true);
+    return result->value->type;
 }
 
 static TypeTableEntry *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
@@ -12097,7 +13209,7 @@ static TypeTableEntry *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *field_ptr = instruction->field_ptr->other;
-    if (type_is_invalid(field_ptr->value.type))
+    if (type_is_invalid(field_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     if (container_type->id != TypeTableEntryIdStruct) {
@@ -12116,22 +13228,22 @@ static TypeTableEntry *ir_analyze_instruction_field_parent_ptr(IrAnalyze *ira,
         return ira->codegen->builtin_types.entry_invalid;
     }
 
-    if (field_ptr->value.type->id != TypeTableEntryIdPointer) {
+    if (field_ptr->value->type->id != TypeTableEntryIdPointer) {
         ir_add_error(ira, field_ptr,
-                buf_sprintf("expected pointer, found '%s'", buf_ptr(&field_ptr->value.type->name)));
+                buf_sprintf("expected pointer, found '%s'", buf_ptr(&field_ptr->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
     TypeTableEntry *field_ptr_type = get_pointer_to_type_extra(ira->codegen, field->type_entry,
-            field_ptr->value.type->data.pointer.is_const,
-            field_ptr->value.type->data.pointer.is_volatile, 0, 0);
+            field_ptr->value->type->data.pointer.is_const,
+            field_ptr->value->type->data.pointer.is_volatile, 0, 0);
     IrInstruction *casted_field_ptr = ir_implicit_cast(ira, field_ptr, field_ptr_type);
-    if (type_is_invalid(casted_field_ptr->value.type))
+    if (type_is_invalid(casted_field_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *result_type = get_pointer_to_type_extra(ira->codegen, container_type,
-            casted_field_ptr->value.type->data.pointer.is_const,
-            casted_field_ptr->value.type->data.pointer.is_volatile, 0, 0);
+            casted_field_ptr->value->type->data.pointer.is_const,
+            casted_field_ptr->value->type->data.pointer.is_volatile, 0, 0);
 
     if (instr_is_comptime(casted_field_ptr)) {
         ConstExprValue *field_ptr_val = ir_resolve_const(ira, casted_field_ptr, UndefBad);
@@ -12218,6 +13330,34 @@ static TypeTableEntry *ir_analyze_instruction_type_id(IrAnalyze *ira,
     return result_type;
 }
 
+static TypeTableEntry *ir_analyze_instruction_set_eval_branch_quota(IrAnalyze *ira,
+        IrInstructionSetEvalBranchQuota *instruction)
+{
+    // A comptime call must not raise the quota of the evaluation that made it.
+    IrExecutable *exec = ira->new_irb.exec;
+    if (exec->is_inline && exec->parent_exec != nullptr) {
+        ir_add_error(ira, &instruction->base,
+                buf_sprintf("@setEvalBranchQuota must be called from the top of the comptime stack"));
+        return ira->codegen->builtin_types.entry_invalid;
+    }
+
+    uint64_t new_quota;
+    if (!ir_resolve_usize(ira, instruction->new_quota->other, &new_quota))
+        return ira->codegen->builtin_types.entry_invalid;
+
+    if (new_quota > *exec->backward_branch_quota)
+        *exec->backward_branch_quota = (size_t)new_quota;
+
+    // the analyzed IR no longer has this instruction, so comptime calls of
+    // the function must not run from bytecode
+    FnTableEntry *fn_entry = exec_fn_entry(exec);
+    if (fn_entry != nullptr)
+        fn_entry->comptime_bytecode_unsupported = true;
+
+    ir_build_const_from(ira, &instruction->base);
+    return ira->codegen->builtin_types.entry_void;
+}
+
 static TypeTableEntry *ir_analyze_instruction_type_name(IrAnalyze *ira, IrInstructionTypeName *instruction) {
     IrInstruction *type_value = instruction->type_value->other;
     TypeTableEntry *type_entry = ir_resolve_type(ira, type_value);
@@ -12228,7 +13368,7 @@ static TypeTableEntry *ir_analyze_instruction_type_name(IrAnalyze *ira, IrInstru
         type_entry->cached_const_name_val = create_const_str_lit(ira->codegen, &type_entry->name);
     }
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-    copy_const_val(out_val, type_entry->cached_const_name_val, true);
+    copy_const_val(ira->codegen, out_val, type_entry->cached_const_name_val, true);
     return out_val->type;
 }
 
@@ -12244,11 +13384,14 @@ static TypeTableEntry *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruc
     IrInstruction *result = ir_eval_const_value(ira->codegen, &cimport_scope->base, block_node, void_type,
         ira->new_irb.exec->backward_branch_count, ira->new_irb.exec->backward_branch_quota, nullptr,
         &cimport_scope->buf, block_node, nullptr, nullptr);
-    if (type_is_invalid(result->value.type))
+    if (type_is_invalid(result->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     find_libc_include_path(ira->codegen);
 
+    // the headers that clang reads are not tracked by the build cache
+    ira->codegen->cache_disabled = true;
+
     ImportTableEntry *child_import = allocate<ImportTableEntry>(1);
     child_import->decls_scope = create_decls_scope(node, nullptr, nullptr, child_import);
     child_import->c_import_node = node;
@@ -12283,7 +13426,7 @@ static TypeTableEntry *ir_analyze_instruction_c_import(IrAnalyze *ira, IrInstruc
 
 static TypeTableEntry *ir_analyze_instruction_c_include(IrAnalyze *ira, IrInstructionCInclude *instruction) {
     IrInstruction *name_value = instruction->name->other;
-    if (type_is_invalid(name_value->value.type))
+    if (type_is_invalid(name_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     Buf *include_name = ir_resolve_str(ira, name_value);
@@ -12302,7 +13445,7 @@ static TypeTableEntry *ir_analyze_instruction_c_include(IrAnalyze *ira, IrInstru
 
 static TypeTableEntry *ir_analyze_instruction_c_define(IrAnalyze *ira, IrInstructionCDefine *instruction) {
     IrInstruction *name = instruction->name->other;
-    if (type_is_invalid(name->value.type))
+    if (type_is_invalid(name->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     Buf *define_name = ir_resolve_str(ira, name);
@@ -12310,7 +13453,7 @@ static TypeTableEntry *ir_analyze_instruction_c_define(IrAnalyze *ira, IrInstruc
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     Buf *define_value = ir_resolve_str(ira, value);
@@ -12329,7 +13472,7 @@ static TypeTableEntry *ir_analyze_instruction_c_define(IrAnalyze *ira, IrInstruc
 
 static TypeTableEntry *ir_analyze_instruction_c_undef(IrAnalyze *ira, IrInstructionCUndef *instruction) {
     IrInstruction *name = instruction->name->other;
-    if (type_is_invalid(name->value.type))
+    if (type_is_invalid(name->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     Buf *undef_name = ir_resolve_str(ira, name);
@@ -12348,7 +13491,7 @@ static TypeTableEntry *ir_analyze_instruction_c_undef(IrAnalyze *ira, IrInstruct
 
 static TypeTableEntry *ir_analyze_instruction_embed_file(IrAnalyze *ira, IrInstructionEmbedFile *instruction) {
     IrInstruction *name = instruction->name->other;
-    if (type_is_invalid(name->value.type))
+    if (type_is_invalid(name->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     Buf *rel_file_path = ir_resolve_str(ira, name);
@@ -12364,9 +13507,9 @@ static TypeTableEntry *ir_analyze_instruction_embed_file(IrAnalyze *ira, IrInstr
     os_path_resolve(&source_dir_path, rel_file_path, &file_path);
 
     // load from file system into const expr
-    Buf file_contents = BUF_INIT;
+    Buf *file_contents = buf_alloc();
     int err;
-    if ((err = os_fetch_file_path(&file_path, &file_contents))) {
+    if ((err = os_fetch_file_path(&file_path, file_contents))) {
         if (err == ErrorFileNotFound) {
             ir_add_error(ira, instruction->name, buf_sprintf("unable to find '%s'", buf_ptr(&file_path)));
             return ira->codegen->builtin_types.entry_invalid;
@@ -12376,30 +13519,29 @@ static TypeTableEntry *ir_analyze_instruction_embed_file(IrAnalyze *ira, IrInstr
         }
     }
 
-    // TODO add dependency on the file we embedded so that we know if it changes
-    // we'll have to invalidate the cache
+    cache_add_dep(ira->codegen, buf_create_from_buf(&file_path), file_contents);
 
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-    init_const_str_lit(ira->codegen, out_val, &file_contents);
+    init_const_str_lit(ira->codegen, out_val, file_contents);
 
-    return get_array_type(ira->codegen, ira->codegen->builtin_types.entry_u8, buf_len(&file_contents));
+    return get_array_type(ira->codegen, ira->codegen->builtin_types.entry_u8, buf_len(file_contents));
 }
 
 static TypeTableEntry *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstructionCmpxchg *instruction) {
     IrInstruction *ptr = instruction->ptr->other;
-    if (type_is_invalid(ptr->value.type))
+    if (type_is_invalid(ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *cmp_value = instruction->cmp_value->other;
-    if (type_is_invalid(cmp_value->value.type))
+    if (type_is_invalid(cmp_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *new_value = instruction->new_value->other;
-    if (type_is_invalid(new_value->value.type))
+    if (type_is_invalid(new_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *success_order_value = instruction->success_order_value->other;
-    if (type_is_invalid(success_order_value->value.type))
+    if (type_is_invalid(success_order_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     AtomicOrder success_order;
@@ -12407,27 +13549,27 @@ static TypeTableEntry *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstruct
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *failure_order_value = instruction->failure_order_value->other;
-    if (type_is_invalid(failure_order_value->value.type))
+    if (type_is_invalid(failure_order_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     AtomicOrder failure_order;
     if (!ir_resolve_atomic_order(ira, failure_order_value, &failure_order))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (ptr->value.type->id != TypeTableEntryIdPointer) {
+    if (ptr->value->type->id != TypeTableEntryIdPointer) {
         ir_add_error(ira, instruction->ptr,
-            buf_sprintf("expected pointer argument, found '%s'", buf_ptr(&ptr->value.type->name)));
+            buf_sprintf("expected pointer argument, found '%s'", buf_ptr(&ptr->value->type->name)));
         return ira->codegen->builtin_types.entry_invalid;
     }
 
-    TypeTableEntry *child_type = ptr->value.type->data.pointer.child_type;
+    TypeTableEntry *child_type = ptr->value->type->data.pointer.child_type;
 
     IrInstruction *casted_cmp_value = ir_implicit_cast(ira, cmp_value, child_type);
-    if (type_is_invalid(casted_cmp_value->value.type))
+    if (type_is_invalid(casted_cmp_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_new_value = ir_implicit_cast(ira, new_value, child_type);
-    if (type_is_invalid(casted_new_value->value.type))
+    if (type_is_invalid(casted_new_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     if (success_order < AtomicOrderMonotonic) {
@@ -12458,7 +13600,7 @@ static TypeTableEntry *ir_analyze_instruction_cmpxchg(IrAnalyze *ira, IrInstruct
 
 static TypeTableEntry *ir_analyze_instruction_fence(IrAnalyze *ira, IrInstructionFence *instruction) {
     IrInstruction *order_value = instruction->order_value->other;
-    if (type_is_invalid(order_value->value.type))
+    if (type_is_invalid(order_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     AtomicOrder order;
@@ -12483,7 +13625,7 @@ static TypeTableEntry *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruc
     }
 
     IrInstruction *target = instruction->target->other;
-    TypeTableEntry *src_type = target->value.type;
+    TypeTableEntry *src_type = target->value->type;
     if (type_is_invalid(src_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -12504,9 +13646,9 @@ static TypeTableEntry *ir_analyze_instruction_truncate(IrAnalyze *ira, IrInstruc
         return ira->codegen->builtin_types.entry_invalid;
     }
 
-    if (target->value.special == ConstValSpecialStatic) {
+    if (target->value->special == ConstValSpecialStatic) {
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-        bignum_init_bignum(&out_val->data.x_bignum, &target->value.data.x_bignum);
+        bignum_init_bignum(&out_val->data.x_bignum, &target->value->data.x_bignum);
         bignum_truncate(&out_val->data.x_bignum, dest_type->data.integral.bit_count);
         return dest_type;
     }
@@ -12533,18 +13675,18 @@ static TypeTableEntry *ir_analyze_instruction_int_type(IrAnalyze *ira, IrInstruc
 
 static TypeTableEntry *ir_analyze_instruction_bool_not(IrAnalyze *ira, IrInstructionBoolNot *instruction) {
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *bool_type = ira->codegen->builtin_types.entry_bool;
 
     IrInstruction *casted_value = ir_implicit_cast(ira, value, bool_type);
-    if (type_is_invalid(casted_value->value.type))
+    if (type_is_invalid(casted_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (casted_value->value.special != ConstValSpecialRuntime) {
+    if (casted_value->value->special != ConstValSpecialRuntime) {
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-        out_val->data.x_bool = !casted_value->value.data.x_bool;
+        out_val->data.x_bool = !casted_value->value->data.x_bool;
         return bool_type;
     }
 
@@ -12554,18 +13696,18 @@ static TypeTableEntry *ir_analyze_instruction_bool_not(IrAnalyze *ira, IrInstruc
 
 static TypeTableEntry *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructionMemset *instruction) {
     IrInstruction *dest_ptr = instruction->dest_ptr->other;
-    if (type_is_invalid(dest_ptr->value.type))
+    if (type_is_invalid(dest_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *byte_value = instruction->byte->other;
-    if (type_is_invalid(byte_value->value.type))
+    if (type_is_invalid(byte_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *count_value = instruction->count->other;
-    if (type_is_invalid(count_value->value.type))
+    if (type_is_invalid(count_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *dest_uncasted_type = dest_ptr->value.type;
+    TypeTableEntry *dest_uncasted_type = dest_ptr->value->type;
     bool dest_is_volatile = (dest_uncasted_type->id == TypeTableEntryIdPointer) &&
         dest_uncasted_type->data.pointer.is_volatile;
 
@@ -12574,23 +13716,23 @@ static TypeTableEntry *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructi
     TypeTableEntry *u8_ptr = get_pointer_to_type_extra(ira->codegen, u8, false, dest_is_volatile, 0, 0);
 
     IrInstruction *casted_dest_ptr = ir_implicit_cast(ira, dest_ptr, u8_ptr);
-    if (type_is_invalid(casted_dest_ptr->value.type))
+    if (type_is_invalid(casted_dest_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_byte = ir_implicit_cast(ira, byte_value, u8);
-    if (type_is_invalid(casted_byte->value.type))
+    if (type_is_invalid(casted_byte->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_count = ir_implicit_cast(ira, count_value, usize);
-    if (type_is_invalid(casted_count->value.type))
+    if (type_is_invalid(casted_count->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (casted_dest_ptr->value.special == ConstValSpecialStatic &&
-        casted_byte->value.special == ConstValSpecialStatic &&
-        casted_count->value.special == ConstValSpecialStatic &&
-        casted_dest_ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr)
+    if (casted_dest_ptr->value->special == ConstValSpecialStatic &&
+        casted_byte->value->special == ConstValSpecialStatic &&
+        casted_count->value->special == ConstValSpecialStatic &&
+        casted_dest_ptr->value->data.x_ptr.special != ConstPtrSpecialHardCodedAddr)
     {
-        ConstExprValue *dest_ptr_val = &casted_dest_ptr->value;
+        ConstExprValue *dest_ptr_val = casted_dest_ptr->value;
 
         ConstExprValue *dest_elements;
         size_t start;
@@ -12619,14 +13761,14 @@ static TypeTableEntry *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructi
                 zig_unreachable();
         }
 
-        size_t count = casted_count->value.data.x_bignum.data.x_uint;
+        size_t count = casted_count->value->data.x_bignum.data.x_uint;
         size_t end = start + count;
         if (end > bound_end) {
             ir_add_error(ira, count_value, buf_sprintf("out of bounds pointer access"));
             return ira->codegen->builtin_types.entry_invalid;
         }
 
-        ConstExprValue *byte_val = &casted_byte->value;
+        ConstExprValue *byte_val = casted_byte->value;
         for (size_t i = start; i < end; i += 1) {
             dest_elements[i] = *byte_val;
         }
@@ -12641,19 +13783,19 @@ static TypeTableEntry *ir_analyze_instruction_memset(IrAnalyze *ira, IrInstructi
 
 static TypeTableEntry *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructionMemcpy *instruction) {
     IrInstruction *dest_ptr = instruction->dest_ptr->other;
-    if (type_is_invalid(dest_ptr->value.type))
+    if (type_is_invalid(dest_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *src_ptr = instruction->src_ptr->other;
-    if (type_is_invalid(src_ptr->value.type))
+    if (type_is_invalid(src_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *count_value = instruction->count->other;
-    if (type_is_invalid(count_value->value.type))
+    if (type_is_invalid(count_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *dest_uncasted_type = dest_ptr->value.type;
-    TypeTableEntry *src_uncasted_type = src_ptr->value.type;
+    TypeTableEntry *dest_uncasted_type = dest_ptr->value->type;
+    TypeTableEntry *src_uncasted_type = src_ptr->value->type;
     bool dest_is_volatile = (dest_uncasted_type->id == TypeTableEntryIdPointer) &&
         dest_uncasted_type->data.pointer.is_volatile;
     bool src_is_volatile = (src_uncasted_type->id == TypeTableEntryIdPointer) &&
@@ -12665,25 +13807,25 @@ static TypeTableEntry *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructi
     TypeTableEntry *u8_ptr_const = get_pointer_to_type_extra(ira->codegen, u8, true, src_is_volatile, 0, 0);
 
     IrInstruction *casted_dest_ptr = ir_implicit_cast(ira, dest_ptr, u8_ptr_mut);
-    if (type_is_invalid(casted_dest_ptr->value.type))
+    if (type_is_invalid(casted_dest_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_src_ptr = ir_implicit_cast(ira, src_ptr, u8_ptr_const);
-    if (type_is_invalid(casted_src_ptr->value.type))
+    if (type_is_invalid(casted_src_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_count = ir_implicit_cast(ira, count_value, usize);
-    if (type_is_invalid(casted_count->value.type))
+    if (type_is_invalid(casted_count->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (casted_dest_ptr->value.special == ConstValSpecialStatic &&
-        casted_src_ptr->value.special == ConstValSpecialStatic &&
-        casted_count->value.special == ConstValSpecialStatic &&
-        casted_dest_ptr->value.data.x_ptr.special != ConstPtrSpecialHardCodedAddr)
+    if (casted_dest_ptr->value->special == ConstValSpecialStatic &&
+        casted_src_ptr->value->special == ConstValSpecialStatic &&
+        casted_count->value->special == ConstValSpecialStatic &&
+        casted_dest_ptr->value->data.x_ptr.special != ConstPtrSpecialHardCodedAddr)
     {
-        size_t count = casted_count->value.data.x_bignum.data.x_uint;
+        size_t count = casted_count->value->data.x_bignum.data.x_uint;
 
-        ConstExprValue *dest_ptr_val = &casted_dest_ptr->value;
+        ConstExprValue *dest_ptr_val = casted_dest_ptr->value;
         ConstExprValue *dest_elements;
         size_t dest_start;
         size_t dest_end;
@@ -12716,7 +13858,7 @@ static TypeTableEntry *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructi
             return ira->codegen->builtin_types.entry_invalid;
         }
 
-        ConstExprValue *src_ptr_val = &casted_src_ptr->value;
+        ConstExprValue *src_ptr_val = casted_src_ptr->value;
         ConstExprValue *src_elements;
         size_t src_start;
         size_t src_end;
@@ -12766,29 +13908,29 @@ static TypeTableEntry *ir_analyze_instruction_memcpy(IrAnalyze *ira, IrInstructi
 
 static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructionSlice *instruction) {
     IrInstruction *ptr_ptr = instruction->ptr->other;
-    if (type_is_invalid(ptr_ptr->value.type))
+    if (type_is_invalid(ptr_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *ptr_type = ptr_ptr->value.type;
+    TypeTableEntry *ptr_type = ptr_ptr->value->type;
     assert(ptr_type->id == TypeTableEntryIdPointer);
     TypeTableEntry *array_type = ptr_type->data.pointer.child_type;
 
     IrInstruction *start = instruction->start->other;
-    if (type_is_invalid(start->value.type))
+    if (type_is_invalid(start->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *usize = ira->codegen->builtin_types.entry_usize;
     IrInstruction *casted_start = ir_implicit_cast(ira, start, usize);
-    if (type_is_invalid(casted_start->value.type))
+    if (type_is_invalid(casted_start->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *end;
     if (instruction->end) {
         end = instruction->end->other;
-        if (type_is_invalid(end->value.type))
+        if (type_is_invalid(end->value->type))
             return ira->codegen->builtin_types.entry_invalid;
         end = ir_implicit_cast(ira, end, usize);
-        if (type_is_invalid(end->value.type))
+        if (type_is_invalid(end->value->type))
             return ira->codegen->builtin_types.entry_invalid;
     } else {
         end = nullptr;
@@ -12815,20 +13957,20 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
     }
 
     if (instr_is_comptime(ptr_ptr) &&
-        value_is_comptime(&casted_start->value) &&
-        (!end || value_is_comptime(&end->value)))
+        value_is_comptime(casted_start->value) &&
+        (!end || value_is_comptime(end->value)))
     {
         ConstExprValue *array_val;
         ConstExprValue *parent_ptr;
         size_t abs_offset;
         size_t rel_end;
         if (array_type->id == TypeTableEntryIdArray) {
-            array_val = const_ptr_pointee(ira->codegen, &ptr_ptr->value);
+            array_val = const_ptr_pointee(ira->codegen, ptr_ptr->value);
             abs_offset = 0;
             rel_end = array_type->data.array.len;
             parent_ptr = nullptr;
         } else if (array_type->id == TypeTableEntryIdPointer) {
-            parent_ptr = const_ptr_pointee(ira->codegen, &ptr_ptr->value);
+            parent_ptr = const_ptr_pointee(ira->codegen, ptr_ptr->value);
             switch (parent_ptr->data.x_ptr.special) {
                 case ConstPtrSpecialInvalid:
                 case ConstPtrSpecialDiscard:
@@ -12852,7 +13994,7 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
                     break;
             }
         } else if (is_slice(array_type)) {
-            ConstExprValue *slice_ptr = const_ptr_pointee(ira->codegen, &ptr_ptr->value);
+            ConstExprValue *slice_ptr = const_ptr_pointee(ira->codegen, ptr_ptr->value);
             parent_ptr = &slice_ptr->data.x_struct.fields[slice_ptr_index];
             ConstExprValue *len_val = &slice_ptr->data.x_struct.fields[slice_len_index];
 
@@ -12882,7 +14024,7 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
             zig_unreachable();
         }
 
-        uint64_t start_scalar = casted_start->value.data.x_bignum.data.x_uint;
+        uint64_t start_scalar = casted_start->value->data.x_bignum.data.x_uint;
         if (start_scalar > rel_end) {
             ir_add_error(ira, &instruction->base, buf_sprintf("out of bounds slice"));
             return ira->codegen->builtin_types.entry_invalid;
@@ -12890,7 +14032,7 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
 
         uint64_t end_scalar;
         if (end) {
-            end_scalar = end->value.data.x_bignum.data.x_uint;
+            end_scalar = end->value->data.x_bignum.data.x_uint;
         } else {
             end_scalar = rel_end;
         }
@@ -12904,7 +14046,7 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
         }
 
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-        out_val->data.x_struct.fields = create_const_vals(2);
+        out_val->data.x_struct.fields = create_const_vals(ira->codegen, 2);
 
         ConstExprValue *ptr_val = &out_val->data.x_struct.fields[slice_ptr_index];
 
@@ -12913,7 +14055,7 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
             bool is_const = slice_is_const(return_type);
             init_const_ptr_array(ira->codegen, ptr_val, array_val, index, is_const);
             if (array_type->id == TypeTableEntryIdArray) {
-                ptr_val->data.x_ptr.mut = ptr_ptr->value.data.x_ptr.mut;
+                ptr_val->data.x_ptr.mut = ptr_ptr->value->data.x_ptr.mut;
             }
         } else {
             switch (parent_ptr->data.x_ptr.special) {
@@ -12951,7 +14093,7 @@ static TypeTableEntry *ir_analyze_instruction_slice(IrAnalyze *ira, IrInstructio
 
 static TypeTableEntry *ir_analyze_instruction_member_count(IrAnalyze *ira, IrInstructionMemberCount *instruction) {
     IrInstruction *container = instruction->container->other;
-    if (type_is_invalid(container->value.type))
+    if (type_is_invalid(container->value->type))
         return ira->codegen->builtin_types.entry_invalid;
     TypeTableEntry *container_type = ir_resolve_type(ira, container);
 
@@ -12997,7 +14139,7 @@ static TypeTableEntry *ir_analyze_instruction_frame_address(IrAnalyze *ira, IrIn
 
 static TypeTableEntry *ir_analyze_instruction_alignof(IrAnalyze *ira, IrInstructionAlignOf *instruction) {
     IrInstruction *type_value = instruction->type_value->other;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
     TypeTableEntry *type_entry = ir_resolve_type(ira, type_value);
 
@@ -13018,7 +14160,7 @@ static TypeTableEntry *ir_analyze_instruction_alignof(IrAnalyze *ira, IrInstruct
 
 static TypeTableEntry *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInstructionOverflowOp *instruction) {
     IrInstruction *type_value = instruction->type_value->other;
-    if (type_is_invalid(type_value->value.type))
+    if (type_is_invalid(type_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
     TypeTableEntry *dest_type = ir_resolve_type(ira, type_value);
     if (type_is_invalid(dest_type))
@@ -13031,38 +14173,38 @@ static TypeTableEntry *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInst
     }
 
     IrInstruction *op1 = instruction->op1->other;
-    if (type_is_invalid(op1->value.type))
+    if (type_is_invalid(op1->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_op1 = ir_implicit_cast(ira, op1, dest_type);
-    if (type_is_invalid(casted_op1->value.type))
+    if (type_is_invalid(casted_op1->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *op2 = instruction->op2->other;
-    if (type_is_invalid(op2->value.type))
+    if (type_is_invalid(op2->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_op2 = ir_implicit_cast(ira, op2, dest_type);
-    if (type_is_invalid(casted_op2->value.type))
+    if (type_is_invalid(casted_op2->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *result_ptr = instruction->result_ptr->other;
-    if (type_is_invalid(result_ptr->value.type))
+    if (type_is_invalid(result_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *expected_ptr_type = get_pointer_to_type(ira->codegen, dest_type, false);
     IrInstruction *casted_result_ptr = ir_implicit_cast(ira, result_ptr, expected_ptr_type);
-    if (type_is_invalid(casted_result_ptr->value.type))
+    if (type_is_invalid(casted_result_ptr->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    if (casted_op1->value.special == ConstValSpecialStatic &&
-        casted_op2->value.special == ConstValSpecialStatic &&
-        casted_result_ptr->value.special == ConstValSpecialStatic)
+    if (casted_op1->value->special == ConstValSpecialStatic &&
+        casted_op2->value->special == ConstValSpecialStatic &&
+        casted_result_ptr->value->special == ConstValSpecialStatic)
     {
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-        BigNum *op1_bignum = &casted_op1->value.data.x_bignum;
-        BigNum *op2_bignum = &casted_op2->value.data.x_bignum;
-        ConstExprValue *pointee_val = const_ptr_pointee(ira->codegen, &casted_result_ptr->value);
+        BigNum *op1_bignum = &casted_op1->value->data.x_bignum;
+        BigNum *op2_bignum = &casted_op2->value->data.x_bignum;
+        ConstExprValue *pointee_val = const_ptr_pointee(ira->codegen, casted_result_ptr->value);
         BigNum *dest_bignum = &pointee_val->data.x_bignum;
         switch (instruction->op) {
             case IrOverflowOpAdd:
@@ -13095,10 +14237,10 @@ static TypeTableEntry *ir_analyze_instruction_overflow_op(IrAnalyze *ira, IrInst
 
 static TypeTableEntry *ir_analyze_instruction_test_err(IrAnalyze *ira, IrInstructionTestErr *instruction) {
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    TypeTableEntry *type_entry = value->value.type;
+    TypeTableEntry *type_entry = value->value->type;
     if (type_is_invalid(type_entry)) {
         return ira->codegen->builtin_types.entry_invalid;
     } else if (type_entry->id == TypeTableEntryIdErrorUnion) {
@@ -13131,9 +14273,9 @@ static TypeTableEntry *ir_analyze_instruction_unwrap_err_code(IrAnalyze *ira,
     IrInstructionUnwrapErrCode *instruction)
 {
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
-    TypeTableEntry *ptr_type = value->value.type;
+    TypeTableEntry *ptr_type = value->value->type;
 
     // This will be a pointer type because unwrap err payload IR instruction operates on a pointer to a thing.
     assert(ptr_type->id == TypeTableEntryIdPointer);
@@ -13171,9 +14313,9 @@ static TypeTableEntry *ir_analyze_instruction_unwrap_err_payload(IrAnalyze *ira,
 {
     assert(instruction->value->other);
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
-    TypeTableEntry *ptr_type = value->value.type;
+    TypeTableEntry *ptr_type = value->value->type;
 
     // This will be a pointer type because unwrap err payload IR instruction operates on a pointer to a thing.
     assert(ptr_type->id == TypeTableEntryIdPointer);
@@ -13240,7 +14382,7 @@ static TypeTableEntry *ir_analyze_instruction_fn_proto(IrAnalyze *ira, IrInstruc
             }
         }
         IrInstruction *param_type_value = instruction->param_types[fn_type_id.next_param_index]->other;
-        if (type_is_invalid(param_type_value->value.type)) 
+        if (type_is_invalid(param_type_value->value->type)) 
             return ira->codegen->builtin_types.entry_invalid;
 
         FnTypeParamInfo *param_info = &fn_type_id.param_info[fn_type_id.next_param_index];
@@ -13268,7 +14410,7 @@ static TypeTableEntry *ir_analyze_instruction_fn_proto(IrAnalyze *ira, IrInstruc
 
 static TypeTableEntry *ir_analyze_instruction_test_comptime(IrAnalyze *ira, IrInstructionTestComptime *instruction) {
     IrInstruction *value = instruction->value->other;
-    if (type_is_invalid(value->value.type))
+    if (type_is_invalid(value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
@@ -13280,7 +14422,7 @@ static TypeTableEntry *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira
         IrInstructionCheckSwitchProngs *instruction)
 {
     IrInstruction *target_value = instruction->target_value->other;
-    TypeTableEntry *switch_type = target_value->value.type;
+    TypeTableEntry *switch_type = target_value->value->type;
     if (type_is_invalid(switch_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -13291,26 +14433,26 @@ static TypeTableEntry *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira
             IrInstructionCheckSwitchProngsRange *range = &instruction->ranges[range_i];
 
             IrInstruction *start_value = range->start->other;
-            if (type_is_invalid(start_value->value.type))
+            if (type_is_invalid(start_value->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             IrInstruction *end_value = range->end->other;
-            if (type_is_invalid(end_value->value.type))
+            if (type_is_invalid(end_value->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             size_t start_index;
             size_t end_index;
-            if (start_value->value.type->id == TypeTableEntryIdEnumTag) {
-                start_index = start_value->value.data.x_bignum.data.x_uint;
-            } else if (start_value->value.type->id == TypeTableEntryIdEnum) {
-                start_index = start_value->value.data.x_enum.tag;
+            if (start_value->value->type->id == TypeTableEntryIdEnumTag) {
+                start_index = start_value->value->data.x_bignum.data.x_uint;
+            } else if (start_value->value->type->id == TypeTableEntryIdEnum) {
+                start_index = start_value->value->data.x_enum.tag;
             } else {
                 zig_unreachable();
             }
-            if (end_value->value.type->id == TypeTableEntryIdEnumTag) {
-                end_index = end_value->value.data.x_bignum.data.x_uint;
-            } else if (end_value->value.type->id == TypeTableEntryIdEnum) {
-                end_index = end_value->value.data.x_enum.tag;
+            if (end_value->value->type->id == TypeTableEntryIdEnumTag) {
+                end_index = end_value->value->data.x_bignum.data.x_uint;
+            } else if (end_value->value->type->id == TypeTableEntryIdEnum) {
+                end_index = end_value->value->data.x_enum.tag;
             } else {
                 zig_unreachable();
             }
@@ -13342,11 +14484,11 @@ static TypeTableEntry *ir_analyze_instruction_check_switch_prongs(IrAnalyze *ira
             IrInstructionCheckSwitchProngsRange *range = &instruction->ranges[range_i];
 
             IrInstruction *start_value = range->start->other;
-            if (type_is_invalid(start_value->value.type))
+            if (type_is_invalid(start_value->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             IrInstruction *end_value = range->end->other;
-            if (type_is_invalid(end_value->value.type))
+            if (type_is_invalid(end_value->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             ConstExprValue *start_val = ir_resolve_const(ira, start_value, UndefBad);
@@ -13388,7 +14530,7 @@ static TypeTableEntry *ir_analyze_instruction_check_statement_is_void(IrAnalyze
         IrInstructionCheckStatementIsVoid *instruction)
 {
     IrInstruction *statement_value = instruction->statement_value->other;
-    TypeTableEntry *statement_type = statement_value->value.type;
+    TypeTableEntry *statement_type = statement_value->value->type;
     if (type_is_invalid(statement_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -13409,10 +14551,10 @@ static TypeTableEntry *ir_analyze_instruction_can_implicit_cast(IrAnalyze *ira,
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *target_value = instruction->target_value->other;
-    if (type_is_invalid(target_value->value.type))
+    if (type_is_invalid(target_value->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
-    ImplicitCastMatchResult result = ir_types_match_with_implicit_cast(ira, type_entry, target_value->value.type,
+    ImplicitCastMatchResult result = ir_types_match_with_implicit_cast(ira, type_entry, target_value->value->type,
             target_value);
 
     if (result == ImplicitCastMatchResultReportedError) {
@@ -13426,12 +14568,12 @@ static TypeTableEntry *ir_analyze_instruction_can_implicit_cast(IrAnalyze *ira,
 
 static TypeTableEntry *ir_analyze_instruction_panic(IrAnalyze *ira, IrInstructionPanic *instruction) {
     IrInstruction *msg = instruction->msg->other;
-    if (type_is_invalid(msg->value.type))
+    if (type_is_invalid(msg->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     TypeTableEntry *str_type = get_slice_type(ira->codegen, ira->codegen->builtin_types.entry_u8, true);
     IrInstruction *casted_msg = ir_implicit_cast(ira, msg, str_type);
-    if (type_is_invalid(casted_msg->value.type))
+    if (type_is_invalid(casted_msg->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *new_instruction = ir_build_panic(&ira->new_irb, instruction->base.scope,
@@ -13447,7 +14589,7 @@ static TypeTableEntry *ir_analyze_instruction_ptr_cast(IrAnalyze *ira, IrInstruc
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *ptr = instruction->ptr->other;
-    TypeTableEntry *src_type = ptr->value.type;
+    TypeTableEntry *src_type = ptr->value->type;
     if (type_is_invalid(src_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -13468,7 +14610,7 @@ static TypeTableEntry *ir_analyze_instruction_ptr_cast(IrAnalyze *ira, IrInstruc
             return ira->codegen->builtin_types.entry_invalid;
 
         ConstExprValue *out_val = ir_build_const_from(ira, &instruction->base);
-        copy_const_val(out_val, val, false);
+        copy_const_val(ira->codegen, out_val, val, false);
         out_val->type = dest_type;
         return dest_type;
     }
@@ -13476,7 +14618,7 @@ static TypeTableEntry *ir_analyze_instruction_ptr_cast(IrAnalyze *ira, IrInstruc
     IrInstruction *result = ir_build_ptr_cast(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, ptr);
     ir_link_new_instruction(result, &instruction->base);
-    result->value.type = dest_type;
+    result->value->type = dest_type;
     return dest_type;
 }
 
@@ -13605,7 +14747,7 @@ static TypeTableEntry *ir_analyze_instruction_bit_cast(IrAnalyze *ira, IrInstruc
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *value = instruction->value->other;
-    TypeTableEntry *src_type = value->value.type;
+    TypeTableEntry *src_type = value->value->type;
     if (type_is_invalid(src_type))
         return ira->codegen->builtin_types.entry_invalid;
 
@@ -13692,7 +14834,7 @@ static TypeTableEntry *ir_analyze_instruction_bit_cast(IrAnalyze *ira, IrInstruc
     IrInstruction *result = ir_build_bit_cast(&ira->new_irb, instruction->base.scope,
             instruction->base.source_node, nullptr, value);
     ir_link_new_instruction(result, &instruction->base);
-    result->value.type = dest_type;
+    result->value->type = dest_type;
     return dest_type;
 }
 
@@ -13715,11 +14857,11 @@ static TypeTableEntry *ir_analyze_instruction_int_to_ptr(IrAnalyze *ira, IrInstr
     }
 
     IrInstruction *target = instruction->target->other;
-    if (type_is_invalid(target->value.type))
+    if (type_is_invalid(target->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     IrInstruction *casted_int = ir_implicit_cast(ira, target, ira->codegen->builtin_types.entry_usize);
-    if (type_is_invalid(casted_int->value.type))
+    if (type_is_invalid(casted_int->value->type))
         return ira->codegen->builtin_types.entry_invalid;
 
     if (instr_is_comptime(casted_int)) {
@@ -13760,20 +14902,20 @@ static TypeTableEntry *ir_analyze_instruction_decl_ref(IrAnalyze *ira,
 
             IrInstruction *var_ptr = ir_get_var_ptr(ira, &instruction->base, var,
                     !lval.is_ptr || lval.is_const, lval.is_ptr && lval.is_volatile);
-            if (type_is_invalid(var_ptr->value.type))
+            if (type_is_invalid(var_ptr->value->type))
                 return ira->codegen->builtin_types.entry_invalid;
 
             if (tld_var->extern_lib_name != nullptr) {
-                add_link_lib_symbol(ira->codegen, tld_var->extern_lib_name, &var->name);
+                add_link_lib_symbol(ira->codegen, tld_var->extern_lib_name, var->name);
             }
 
             if (lval.is_ptr) {
                 ir_link_new_instruction(var_ptr, &instruction->base);
-                return var_ptr->value.type;
+                return var_ptr->value->type;
             } else {
                 IrInstruction *loaded_instr = ir_get_deref(ira, &instruction->base, var_ptr);
                 ir_link_new_instruction(loaded_instr, &instruction->base);
-                return loaded_instr->value.type;
+                return loaded_instr->value->type;
             }
         }
         case TldIdFn:
@@ -13791,10 +14933,10 @@ static TypeTableEntry *ir_analyze_instruction_decl_ref(IrAnalyze *ira,
             if (lval.is_ptr) {
                 IrInstruction *ptr_instr = ir_get_ref(ira, &instruction->base, ref_instruction, true, false);
                 ir_link_new_instruction(ptr_instr, &instruction->base);
-                return ptr_instr->value.type;
+                return ptr_instr->value->type;
             } else {
                 ir_link_new_instruction(ref_instruction, &instruction->base);
-                return ref_instruction->value.type;
+                return ref_instruction->value->type;
             }
         }
     }
@@ -13978,6 +15120,8 @@ static TypeTableEntry *ir_analyze_instruction_nocast(IrAnalyze *ira, IrInstructi
             return ir_analyze_instruction_offset_of(ira, (IrInstructionOffsetOf *)instruction);
         case IrInstructionIdTypeId:
             return ir_analyze_instruction_type_id(ira, (IrInstructionTypeId *)instruction);
+        case IrInstructionIdSetEvalBranchQuota:
+            return ir_analyze_instruction_set_eval_branch_quota(ira, (IrInstructionSetEvalBranchQuota *)instruction);
         case IrInstructionIdMaybeWrap:
         case IrInstructionIdErrWrapCode:
         case IrInstructionIdErrWrapPayload:
@@ -13989,9 +15133,11 @@ static TypeTableEntry *ir_analyze_instruction_nocast(IrAnalyze *ira, IrInstructi
 
 static TypeTableEntry *ir_analyze_instruction(IrAnalyze *ira, IrInstruction *instruction) {
     TypeTableEntry *instruction_type = ir_analyze_instruction_nocast(ira, instruction);
-    instruction->value.type = instruction_type;
+    instruction->value->type = instruction_type;
     if (instruction->other) {
-        instruction->other->value.type = instruction_type;
+        if (value_is_comptime(instruction->other->value))
+            ir_assert_whole_value(instruction->other);
+        instruction->other->value->type = instruction_type;
     } else {
         assert(instruction_type->id == TypeTableEntryIdInvalid ||
                instruction_type->id == TypeTableEntryIdUnreachable);
@@ -14020,7 +15166,7 @@ TypeTableEntry *ir_analyze(CodeGen *codegen, IrExecutable *old_exec, IrExecutabl
     ira->new_irb.exec = new_exec;
 
     ira->exec_context.mem_slot_count = ira->old_irb.exec->mem_slot_count;
-    ira->exec_context.mem_slot_list = create_const_vals(ira->exec_context.mem_slot_count);
+    ira->exec_context.mem_slot_list = create_const_vals(ira->codegen, ira->exec_context.mem_slot_count);
 
     IrBasicBlock *old_entry_bb = ira->old_irb.exec->basic_block_list.at(0);
     IrBasicBlock *new_entry_bb = ir_get_new_bb(ira, old_entry_bb, nullptr);
@@ -14074,6 +15220,7 @@ bool ir_has_side_effects(IrInstruction *instruction) {
         case IrInstructionIdUnreachable:
         case IrInstructionIdSetDebugSafety:
         case IrInstructionIdSetFloatMode:
+        case IrInstructionIdSetEvalBranchQuota:
         case IrInstructionIdImport:
         case IrInstructionIdCompileErr:
         case IrInstructionIdCompileLog:
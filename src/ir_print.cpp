@@ -27,7 +27,7 @@ static void ir_print_indent(IrPrint *irp) {
 
 static void ir_print_prefix(IrPrint *irp, IrInstruction *instruction) {
     ir_print_indent(irp);
-    const char *type_name = instruction->value.type ? buf_ptr(&instruction->value.type->name) : "(unknown)";
+    const char *type_name = instruction->value->type ? buf_ptr(&instruction->value->type->name) : "(unknown)";
     const char *ref_count = ir_has_side_effects(instruction) ?
         "-" : buf_ptr(buf_sprintf("%" ZIG_PRI_usize "", instruction->ref_count));
     fprintf(irp->f, "#%-3zu| %-12s| %-2s| ", instruction->debug_id, type_name, ref_count);
@@ -45,8 +45,8 @@ static void ir_print_var_instruction(IrPrint *irp, IrInstruction *instruction) {
 }
 
 static void ir_print_other_instruction(IrPrint *irp, IrInstruction *instruction) {
-    if (instruction->value.special != ConstValSpecialRuntime) {
-        ir_print_const_value(irp, &instruction->value);
+    if (instruction->value->special != ConstValSpecialRuntime) {
+        ir_print_const_value(irp, instruction->value);
     } else {
         ir_print_var_instruction(irp, instruction);
     }
@@ -63,7 +63,7 @@ static void ir_print_return(IrPrint *irp, IrInstructionReturn *return_instructio
 }
 
 static void ir_print_const(IrPrint *irp, IrInstructionConst *const_instruction) {
-    ir_print_const_value(irp, &const_instruction->base.value);
+    ir_print_const_value(irp, const_instruction->base.value);
 }
 
 static const char *ir_bin_op_id_str(IrBinOp op_id) {
@@ -168,7 +168,7 @@ static void ir_print_bin_op(IrPrint *irp, IrInstructionBinOp *bin_op_instruction
 
 static void ir_print_decl_var(IrPrint *irp, IrInstructionDeclVar *decl_var_instruction) {
     const char *var_or_const = decl_var_instruction->var->gen_is_const ? "const" : "var";
-    const char *name = buf_ptr(&decl_var_instruction->var->name);
+    const char *name = buf_ptr(decl_var_instruction->var->name);
     if (decl_var_instruction->var_type) {
         fprintf(irp->f, "%s %s: ", var_or_const, name);
         ir_print_other_instruction(irp, decl_var_instruction->var_type);
@@ -298,7 +298,7 @@ static void ir_print_elem_ptr(IrPrint *irp, IrInstructionElemPtr *instruction) {
 }
 
 static void ir_print_var_ptr(IrPrint *irp, IrInstructionVarPtr *instruction) {
-    fprintf(irp->f, "&%s", buf_ptr(&instruction->var->name));
+    fprintf(irp->f, "&%s", buf_ptr(instruction->var->name));
 }
 
 static void ir_print_load_ptr(IrPrint *irp, IrInstructionLoadPtr *instruction) {
@@ -904,6 +904,12 @@ static void ir_print_type_id(IrPrint *irp, IrInstructionTypeId *instruction) {
     fprintf(irp->f, ")");
 }
 
+static void ir_print_set_eval_branch_quota(IrPrint *irp, IrInstructionSetEvalBranchQuota *instruction) {
+    fprintf(irp->f, "@setEvalBranchQuota(");
+    ir_print_other_instruction(irp, instruction->new_quota);
+    fprintf(irp->f, ")");
+}
+
 static void ir_print_instruction(IrPrint *irp, IrInstruction *instruction) {
     ir_print_prefix(irp, instruction);
     switch (instruction->id) {
@@ -1194,6 +1200,9 @@ static void ir_print_instruction(IrPrint *irp, IrInstruction *instruction) {
         case IrInstructionIdTypeId:
             ir_print_type_id(irp, (IrInstructionTypeId *)instruction);
             break;
+        case IrInstructionIdSetEvalBranchQuota:
+            ir_print_set_eval_branch_quota(irp, (IrInstructionSetEvalBranchQuota *)instruction);
+            break;
     }
     fprintf(irp->f, "\n");
 }
@@ -1215,3 +1224,203 @@ void ir_print(CodeGen *codegen, FILE *f, IrExecutable *executable, int indent_si
         }
     }
 }
+
+const char *ir_instruction_id_name(IrInstructionId id) {
+    switch (id) {
+        case IrInstructionIdInvalid:
+            return "Invalid";
+        case IrInstructionIdBr:
+            return "Br";
+        case IrInstructionIdCondBr:
+            return "CondBr";
+        case IrInstructionIdSwitchBr:
+            return "SwitchBr";
+        case IrInstructionIdSwitchVar:
+            return "SwitchVar";
+        case IrInstructionIdSwitchTarget:
+            return "SwitchTarget";
+        case IrInstructionIdPhi:
+            return "Phi";
+        case IrInstructionIdUnOp:
+            return "UnOp";
+        case IrInstructionIdBinOp:
+            return "BinOp";
+        case IrInstructionIdDeclVar:
+            return "DeclVar";
+        case IrInstructionIdLoadPtr:
+            return "LoadPtr";
+        case IrInstructionIdStorePtr:
+            return "StorePtr";
+        case IrInstructionIdFieldPtr:
+            return "FieldPtr";
+        case IrInstructionIdStructFieldPtr:
+            return "StructFieldPtr";
+        case IrInstructionIdEnumFieldPtr:
+            return "EnumFieldPtr";
+        case IrInstructionIdElemPtr:
+            return "ElemPtr";
+        case IrInstructionIdVarPtr:
+            return "VarPtr";
+        case IrInstructionIdCall:
+            return "Call";
+        case IrInstructionIdConst:
+            return "Const";
+        case IrInstructionIdReturn:
+            return "Return";
+        case IrInstructionIdCast:
+            return "Cast";
+        case IrInstructionIdContainerInitList:
+            return "ContainerInitList";
+        case IrInstructionIdContainerInitFields:
+            return "ContainerInitFields";
+        case IrInstructionIdStructInit:
+            return "StructInit";
+        case IrInstructionIdUnreachable:
+            return "Unreachable";
+        case IrInstructionIdTypeOf:
+            return "TypeOf";
+        case IrInstructionIdToPtrType:
+            return "ToPtrType";
+        case IrInstructionIdPtrTypeChild:
+            return "PtrTypeChild";
+        case IrInstructionIdSetDebugSafety:
+            return "SetDebugSafety";
+        case IrInstructionIdSetFloatMode:
+            return "SetFloatMode";
+        case IrInstructionIdArrayType:
+            return "ArrayType";
+        case IrInstructionIdSliceType:
+            return "SliceType";
+        case IrInstructionIdAsm:
+            return "Asm";
+        case IrInstructionIdSizeOf:
+            return "SizeOf";
+        case IrInstructionIdTestNonNull:
+            return "TestNonNull";
+        case IrInstructionIdUnwrapMaybe:
+            return "UnwrapMaybe";
+        case IrInstructionIdMaybeWrap:
+            return "MaybeWrap";
+        case IrInstructionIdEnumTag:
+            return "EnumTag";
+        case IrInstructionIdClz:
+            return "Clz";
+        case IrInstructionIdCtz:
+            return "Ctz";
+        case IrInstructionIdImport:
+            return "Import";
+        case IrInstructionIdCImport:
+            return "CImport";
+        case IrInstructionIdCInclude:
+            return "CInclude";
+        case IrInstructionIdCDefine:
+            return "CDefine";
+        case IrInstructionIdCUndef:
+            return "CUndef";
+        case IrInstructionIdArrayLen:
+            return "ArrayLen";
+        case IrInstructionIdRef:
+            return "Ref";
+        case IrInstructionIdMinValue:
+            return "MinValue";
+        case IrInstructionIdMaxValue:
+            return "MaxValue";
+        case IrInstructionIdCompileErr:
+            return "CompileErr";
+        case IrInstructionIdCompileLog:
+            return "CompileLog";
+        case IrInstructionIdErrName:
+            return "ErrName";
+        case IrInstructionIdEmbedFile:
+            return "EmbedFile";
+        case IrInstructionIdCmpxchg:
+            return "Cmpxchg";
+        case IrInstructionIdFence:
+            return "Fence";
+        case IrInstructionIdTruncate:
+            return "Truncate";
+        case IrInstructionIdIntType:
+            return "IntType";
+        case IrInstructionIdBoolNot:
+            return "BoolNot";
+        case IrInstructionIdMemset:
+            return "Memset";
+        case IrInstructionIdMemcpy:
+            return "Memcpy";
+        case IrInstructionIdSlice:
+            return "Slice";
+        case IrInstructionIdMemberCount:
+            return "MemberCount";
+        case IrInstructionIdBreakpoint:
+            return "Breakpoint";
+        case IrInstructionIdReturnAddress:
+            return "ReturnAddress";
+        case IrInstructionIdFrameAddress:
+            return "FrameAddress";
+        case IrInstructionIdAlignOf:
+            return "AlignOf";
+        case IrInstructionIdOverflowOp:
+            return "OverflowOp";
+        case IrInstructionIdTestErr:
+            return "TestErr";
+        case IrInstructionIdUnwrapErrCode:
+            return "UnwrapErrCode";
+        case IrInstructionIdUnwrapErrPayload:
+            return "UnwrapErrPayload";
+        case IrInstructionIdErrWrapCode:
+            return "ErrWrapCode";
+        case IrInstructionIdErrWrapPayload:
+            return "ErrWrapPayload";
+        case IrInstructionIdFnProto:
+            return "FnProto";
+        case IrInstructionIdTestComptime:
+            return "TestComptime";
+        case IrInstructionIdInitEnum:
+            return "InitEnum";
+        case IrInstructionIdPtrCast:
+            return "PtrCast";
+        case IrInstructionIdBitCast:
+            return "BitCast";
+        case IrInstructionIdWidenOrShorten:
+            return "WidenOrShorten";
+        case IrInstructionIdIntToPtr:
+            return "IntToPtr";
+        case IrInstructionIdPtrToInt:
+            return "PtrToInt";
+        case IrInstructionIdIntToEnum:
+            return "IntToEnum";
+        case IrInstructionIdIntToErr:
+            return "IntToErr";
+        case IrInstructionIdErrToInt:
+            return "ErrToInt";
+        case IrInstructionIdCheckSwitchProngs:
+            return "CheckSwitchProngs";
+        case IrInstructionIdCheckStatementIsVoid:
+            return "CheckStatementIsVoid";
+        case IrInstructionIdTypeName:
+            return "TypeName";
+        case IrInstructionIdCanImplicitCast:
+            return "CanImplicitCast";
+        case IrInstructionIdSetGlobalAlign:
+            return "SetGlobalAlign";
+        case IrInstructionIdSetGlobalSection:
+            return "SetGlobalSection";
+        case IrInstructionIdSetGlobalLinkage:
+            return "SetGlobalLinkage";
+        case IrInstructionIdDeclRef:
+            return "DeclRef";
+        case IrInstructionIdPanic:
+            return "Panic";
+        case IrInstructionIdEnumTagName:
+            return "EnumTagName";
+        case IrInstructionIdFieldParentPtr:
+            return "FieldParentPtr";
+        case IrInstructionIdOffsetOf:
+            return "OffsetOf";
+        case IrInstructionIdTypeId:
+            return "TypeId";
+        case IrInstructionIdSetEvalBranchQuota:
+            return "SetEvalBranchQuota";
+    }
+    zig_unreachable();
+}
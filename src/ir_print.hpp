@@ -13,5 +13,6 @@
 #include <stdio.h>
 
 void ir_print(CodeGen *codegen, FILE *f, IrExecutable *executable, int indent_size);
+const char *ir_instruction_id_name(IrInstructionId id);
 
 #endif
@@ -10,6 +10,9 @@
 #include "config.h"
 #include "codegen.hpp"
 #include "analyze.hpp"
+#include "cache.hpp"
+
+#include <inttypes.h>
 
 struct LinkJob {
     CodeGen *codegen;
@@ -31,6 +34,58 @@ static const char *get_libc_static_file(CodeGen *g, const char *file) {
     return buf_ptr(out_buf);
 }
 
+// builtin.o and compiler_rt.o depend only on the compiler, the target, its
+// CPU and features, the build mode and the std special sources, so they are
+// built into a cache dir that all of the user's projects share. Each build of
+// the compiler gets a dir of its own, since they all have the same version.
+// The manifest that the child build writes there takes care of noticing
+// changed sources. The objects in it are only ever replaced by renaming, so
+// the linker sees a complete object even when another build replaces it
+// after the lock is released.
+static Buf *get_shared_o_cache_dir(CodeGen *parent_gen) {
+    Buf *user_cache_dir = buf_alloc();
+    if (os_get_user_cache_dir(user_cache_dir))
+        return parent_gen->cache_dir;
+
+    const char *mode_name = nullptr;
+    switch (parent_gen->build_mode) {
+        case BuildModeDebug:
+            mode_name = "debug";
+            break;
+        case BuildModeSafeRelease:
+            mode_name = "release-safe";
+            break;
+        case BuildModeFastRelease:
+            mode_name = "release-fast";
+            break;
+        case BuildModeSmallRelease:
+            mode_name = "release-small";
+            break;
+    }
+    Buf *key_name = buf_sprintf("%s-%s", buf_ptr(&parent_gen->triple_str), mode_name);
+    if (parent_gen->is_native_target)
+        buf_append_str(key_name, "-native");
+    // the feature list of a native target names every feature of the host,
+    // far too long for a directory name
+    Buf *cpu_key = buf_sprintf("%s %s", buf_ptr(parent_gen->target_cpu), buf_ptr(parent_gen->target_features));
+    buf_appendf(key_name, "-cpu%016" PRIx64, cache_hash_buf(cpu_key));
+    if (parent_gen->strip_debug_symbols)
+        buf_append_str(key_name, "-strip");
+    if (parent_gen->is_static)
+        buf_append_str(key_name, "-static");
+    if (parent_gen->mmacosx_version_min)
+        buf_appendf(key_name, "-macosx%s", buf_ptr(parent_gen->mmacosx_version_min));
+    if (parent_gen->mios_version_min)
+        buf_appendf(key_name, "-ios%s", buf_ptr(parent_gen->mios_version_min));
+
+    Buf *version_dir = buf_alloc();
+    Buf *compiler_name = buf_sprintf("%s-%016" PRIx64, ZIG_VERSION_STRING, cache_hash_buf(cache_compiler_id()));
+    os_path_join(user_cache_dir, compiler_name, version_dir);
+    Buf *result = buf_alloc();
+    os_path_join(version_dir, key_name, result);
+    return result;
+}
+
 static Buf *build_o(CodeGen *parent_gen, const char *oname) {
     Buf *source_basename = buf_sprintf("%s.zig", oname);
     Buf *full_path = buf_alloc();
@@ -42,7 +97,12 @@ static Buf *build_o(CodeGen *parent_gen, const char *oname) {
     codegen_set_omit_zigrt(child_gen, true);
     child_gen->want_h_file = false;
 
-    codegen_set_cache_dir(child_gen, parent_gen->cache_dir);
+    // otherwise the child targets the host CPU, which a native build for
+    // another --target-cpu cannot run on
+    codegen_set_target_cpu(child_gen, parent_gen->target_cpu);
+    codegen_set_target_features(child_gen, parent_gen->target_features);
+
+    codegen_set_cache_dir(child_gen, get_shared_o_cache_dir(parent_gen));
 
     codegen_set_strip(child_gen, parent_gen->strip_debug_symbols);
     codegen_set_is_static(child_gen, parent_gen->is_static);
@@ -55,13 +115,24 @@ static Buf *build_o(CodeGen *parent_gen, const char *oname) {
     codegen_set_mmacosx_version_min(child_gen, parent_gen->mmacosx_version_min);
     codegen_set_mios_version_min(child_gen, parent_gen->mios_version_min);
 
+    // other builds may be checking or writing the same objects right now;
+    // the lock keeps one of them from deleting the manifest or replacing an
+    // object while another restores it
+    Buf *lock_path = buf_alloc();
+    os_path_join(child_gen->cache_dir, buf_create_from_str("lock"), lock_path);
+    OsFileLock *lock;
+    int err;
+    if ((err = os_make_path(child_gen->cache_dir)) || (err = os_file_lock(lock_path, &lock))) {
+        zig_panic("unable to lock %s: %s", buf_ptr(lock_path), err_str(err));
+    }
+
     codegen_build(child_gen);
-    const char *o_ext = target_o_file_ext(&child_gen->zig_target);
-    Buf *o_out_name = buf_sprintf("%s%s", oname, o_ext);
-    Buf *output_path = buf_alloc();
-    os_path_join(parent_gen->cache_dir, o_out_name, output_path);
+    Buf *output_path = cache_object_path(child_gen, 0);
     codegen_link(child_gen, buf_ptr(output_path));
 
+    os_file_unlock(lock);
+
+    parent_gen->child_gens.append(child_gen);
     return output_path;
 }
 
@@ -159,6 +230,24 @@ static void construct_linker_job_elf(LinkJob *lj) {
     }
 
     lj->args.append("--gc-sections");
+    if (g->build_mode == BuildModeSmallRelease) {
+        // fold functions which are identical in machine code too
+        lj->args.append("--icf=all");
+    }
+
+    if (g->thin_lto) {
+        // lets incremental re-links reuse the native code of unchanged modules
+        Buf *thinlto_cache_dir = buf_alloc();
+        os_path_join(g->cache_dir, buf_create_from_str("thinlto"), thinlto_cache_dir);
+        lj->args.append(buf_ptr(buf_sprintf("--thinlto-cache-dir=%s", buf_ptr(thinlto_cache_dir))));
+        // LLD 4.0 has no size level for LTO; O2 at least leaves out the
+        // unrolling and vectorization that O3 adds
+        if (g->build_mode == BuildModeSmallRelease) {
+            lj->args.append("--lto-O2");
+        } else if (g->build_mode != BuildModeDebug) {
+            lj->args.append("--lto-O3");
+        }
+    }
 
     lj->args.append("-m");
     lj->args.append(getLDMOption(&g->zig_target));
@@ -328,6 +417,11 @@ static void construct_linker_job_coff(LinkJob *lj) {
 
     lj->args.append("-NOLOGO");
 
+    if (g->build_mode == BuildModeSmallRelease) {
+        lj->args.append("-OPT:REF");
+        lj->args.append("-OPT:ICF");
+    }
+
     if (g->zig_target.arch.arch == ZigLLVM_x86) {
         lj->args.append("-MACHINE:X86");
     } else if (g->zig_target.arch.arch == ZigLLVM_x86_64) {
@@ -590,6 +684,10 @@ static void construct_linker_job_macho(LinkJob *lj) {
 
     lj->args.append("-demangle");
 
+    if (g->build_mode == BuildModeSmallRelease) {
+        lj->args.append("-dead_strip");
+    }
+
     if (g->linker_rdynamic) {
         lj->args.append("-export_dynamic");
     }
@@ -763,9 +861,13 @@ void codegen_link(CodeGen *g, const char *out_file) {
         if (override_out_file) {
             assert(g->link_objects.length == 1);
             Buf *o_file_path = g->link_objects.at(0);
-            int err;
-            if ((err = os_rename(o_file_path, &lj.out_file))) {
-                zig_panic("unable to rename object file into final output: %s", err_str(err));
+            // copy rather than rename so that the next build can reuse the
+            // object in the cache dir
+            if (!buf_eql_buf(o_file_path, &lj.out_file)) {
+                int err;
+                if ((err = os_copy_file(o_file_path, &lj.out_file))) {
+                    zig_panic("unable to copy object file into final output: %s", err_str(err));
+                }
             }
         }
         if (g->verbose) {
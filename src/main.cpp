@@ -28,22 +28,33 @@ static int usage(const char *arg0) {
         "  test [source]                create and run a test build\n"
         "  version                      print version number and exit\n"
         "Compile Options:\n"
+        "  --analysis-threads [count]   parse imports and generate function IR on count threads\n"
         "  --assembly [source]          add assembly file to build\n"
         "  --cache-dir [path]           override the cache directory\n"
         "  --color [auto|off|on]        enable or disable colored error messages\n"
+        "  --comptime-quota [count]     allow count backward branches per comptime evaluation\n"
+        "  --comptime-report            print the most expensive comptime call sites\n"
+        "  --codegen-threads [count]    emit machine code on count threads\n"
         "  --enable-timing-info         print timing diagnostics\n"
+        "  --free-ir                    free function IR as soon as it has been used\n"
         "  --libc-include-dir [path]    directory where libc stdlib.h resides\n"
+        "  --lto=thin                   optimize across objects at link time\n"
         "  --name [name]                override output name\n"
         "  --output [file]              override destination path\n"
         "  --output-h [file]            override generated header file path\n"
         "  --pkg-begin [name] [path]    make package available to import and push current pkg\n"
         "  --pkg-end                    pop current pkg\n"
+        "  --profile-generate[=dir]     instrument the executable to write a profile to dir\n"
+        "  --profile-use=[file]         optimize with a profile merged by llvm-profdata\n"
         "  --release-fast               build with optimizations on and safety off\n"
         "  --release-safe               build with optimizations on and safety on\n"
+        "  --release-small              build for size with optimizations on and safety off\n"
         "  --static                     output will be statically linked\n"
         "  --strip                      exclude debug symbols\n"
         "  --target-arch [name]         specify target architecture\n"
+        "  --target-cpu [name]          specify target CPU, such as haswell\n"
         "  --target-environ [name]      specify target environment\n"
+        "  --target-features [list]     enable and disable CPU features, such as +avx2,-sse4a\n"
         "  --target-os [name]           specify target operating system\n"
         "  --verbose                    turn on compiler debug output\n"
         "  --zig-std-dir [path]         directory where zig standard library resides\n"
@@ -181,6 +192,8 @@ int main(int argc, char **argv) {
     const char *target_arch = nullptr;
     const char *target_os = nullptr;
     const char *target_environ = nullptr;
+    const char *target_cpu = nullptr;
+    const char *target_features = nullptr;
     bool mwindows = false;
     bool mconsole = false;
     bool municode = false;
@@ -195,10 +208,19 @@ int main(int argc, char **argv) {
     ZigList<const char *> asm_files = {0};
     const char *test_filter = nullptr;
     const char *test_name_prefix = nullptr;
+    int codegen_threads = 1;
+    int analysis_threads = 1;
+    int comptime_quota = 0;
+    bool comptime_report = false;
+    bool free_ir = false;
     size_t ver_major = 0;
     size_t ver_minor = 0;
     size_t ver_patch = 0;
     bool timing_info = false;
+    bool thin_lto = false;
+    bool profile_generate = false;
+    const char *profile_generate_dir = nullptr;
+    const char *profile_use_path = nullptr;
     const char *cache_dir = nullptr;
     CliPkg *cur_pkg = allocate<CliPkg>(1);
     BuildMode build_mode = BuildModeDebug;
@@ -324,6 +346,8 @@ int main(int argc, char **argv) {
                 build_mode = BuildModeFastRelease;
             } else if (strcmp(arg, "--release-safe") == 0) {
                 build_mode = BuildModeSafeRelease;
+            } else if (strcmp(arg, "--release-small") == 0) {
+                build_mode = BuildModeSmallRelease;
             } else if (strcmp(arg, "--strip") == 0) {
                 strip = true;
             } else if (strcmp(arg, "--static") == 0) {
@@ -342,6 +366,19 @@ int main(int argc, char **argv) {
                 each_lib_rpath = true;
             } else if (strcmp(arg, "--enable-timing-info") == 0) {
                 timing_info = true;
+            } else if (strcmp(arg, "--lto=thin") == 0) {
+                thin_lto = true;
+            } else if (strcmp(arg, "--comptime-report") == 0) {
+                comptime_report = true;
+            } else if (strcmp(arg, "--free-ir") == 0) {
+                free_ir = true;
+            } else if (strcmp(arg, "--profile-generate") == 0) {
+                profile_generate = true;
+            } else if (strncmp(arg, "--profile-generate=", strlen("--profile-generate=")) == 0) {
+                profile_generate = true;
+                profile_generate_dir = arg + strlen("--profile-generate=");
+            } else if (strncmp(arg, "--profile-use=", strlen("--profile-use=")) == 0) {
+                profile_use_path = arg + strlen("--profile-use=");
             } else if (arg[1] == 'L' && arg[2] != 0) {
                 // alias for --library-path
                 lib_dirs.append(&arg[2]);
@@ -384,6 +421,24 @@ int main(int argc, char **argv) {
                         fprintf(stderr, "--color options are 'auto', 'on', or 'off'\n");
                         return usage(arg0);
                     }
+                } else if (strcmp(arg, "--codegen-threads") == 0) {
+                    codegen_threads = atoi(argv[i]);
+                    if (codegen_threads < 1) {
+                        fprintf(stderr, "--codegen-threads requires a positive count\n");
+                        return usage(arg0);
+                    }
+                } else if (strcmp(arg, "--analysis-threads") == 0) {
+                    analysis_threads = atoi(argv[i]);
+                    if (analysis_threads < 1) {
+                        fprintf(stderr, "--analysis-threads requires a positive count\n");
+                        return usage(arg0);
+                    }
+                } else if (strcmp(arg, "--comptime-quota") == 0) {
+                    comptime_quota = atoi(argv[i]);
+                    if (comptime_quota < 1) {
+                        fprintf(stderr, "--comptime-quota requires a positive count\n");
+                        return usage(arg0);
+                    }
                 } else if (strcmp(arg, "--name") == 0) {
                     out_name = argv[i];
                 } else if (strcmp(arg, "--libc-lib-dir") == 0) {
@@ -418,6 +473,10 @@ int main(int argc, char **argv) {
                     target_os = argv[i];
                 } else if (strcmp(arg, "--target-environ") == 0) {
                     target_environ = argv[i];
+                } else if (strcmp(arg, "--target-cpu") == 0) {
+                    target_cpu = argv[i];
+                } else if (strcmp(arg, "--target-features") == 0) {
+                    target_features = argv[i];
                 } else if (strcmp(arg, "-mlinker-version") == 0) {
                     mlinker_version = argv[i];
                 } else if (strcmp(arg, "-mmacosx-version-min") == 0) {
@@ -573,8 +632,69 @@ int main(int argc, char **argv) {
                     full_cache_dir);
 
             CodeGen *g = codegen_create(zig_root_source_file, target, out_type, build_mode);
+            if (target_cpu) {
+                if (!target_has_cpu(&g->zig_target, target_cpu)) {
+                    fprintf(stderr, "invalid --target-cpu argument: '%s' is not a CPU of the target\n", target_cpu);
+                    return usage(arg0);
+                }
+                codegen_set_target_cpu(g, buf_create_from_str(target_cpu));
+            }
+            if (target_features) {
+                Buf bad_flag = BUF_INIT;
+                if (parse_target_features(&g->zig_target, target_features, &bad_flag)) {
+                    fprintf(stderr, "invalid --target-features argument: '%s' does not enable or disable"
+                            " a feature of the target\n", buf_ptr(&bad_flag));
+                    return usage(arg0);
+                }
+                codegen_set_target_features(g, buf_create_from_str(target_features));
+            }
             codegen_set_out_name(g, buf_out_name);
             codegen_set_lib_version(g, ver_major, ver_minor, ver_patch);
+            codegen_set_codegen_threads(g, codegen_threads);
+            codegen_set_analysis_threads(g, analysis_threads);
+            if (thin_lto) {
+                if (g->zig_target.oformat == ZigLLVM_MachO) {
+                    fprintf(stderr, "--lto=thin is not supported when targeting Mach-O\n");
+                    return EXIT_FAILURE;
+                }
+                codegen_set_thin_lto(g, true);
+            }
+            if (profile_generate) {
+                if (profile_use_path) {
+                    fprintf(stderr, "--profile-generate and --profile-use options not allowed together\n");
+                    return EXIT_FAILURE;
+                }
+                // the profile runtime finds the counters through symbols that
+                // only ELF linkers define, and is part of the executable's startup code
+                if (g->zig_target.oformat != ZigLLVM_ELF || out_type != OutTypeExe) {
+                    fprintf(stderr, "--profile-generate is only supported for executables targeting ELF\n");
+                    return EXIT_FAILURE;
+                }
+                codegen_set_profile_generate(g,
+                        (profile_generate_dir == nullptr) ? nullptr : buf_create_from_str(profile_generate_dir));
+            }
+            if (profile_use_path) {
+                Buf *profile_use_buf = buf_create_from_str(profile_use_path);
+                Buf *profile_contents = buf_alloc();
+                int err;
+                if ((err = os_fetch_file_path(profile_use_buf, profile_contents))) {
+                    fprintf(stderr, "unable to read --profile-use file %s: %s\n", profile_use_path, err_str(err));
+                    return EXIT_FAILURE;
+                }
+                // LLVM only reads indexed profiles, which llvm-profdata merge
+                // makes out of the .profraw files that a profiling run writes
+                static const char indexed_profile_magic[] = "\xff" "lprofi" "\x81";
+                if (buf_len(profile_contents) < 8 || memcmp(buf_ptr(profile_contents), indexed_profile_magic, 8) != 0) {
+                    fprintf(stderr, "--profile-use file %s is not an indexed profile, "
+                            "merge it with llvm-profdata first\n", profile_use_path);
+                    return EXIT_FAILURE;
+                }
+                codegen_set_profile_use(g, profile_use_buf, profile_contents);
+            }
+            if (comptime_quota != 0)
+                codegen_set_comptime_quota(g, comptime_quota);
+            codegen_set_comptime_report(g, comptime_report);
+            codegen_set_free_ir(g, free_ir);
             codegen_set_is_test(g, cmd == CmdTest);
             codegen_set_linker_script(g, linker_script);
             codegen_set_cache_dir(g, full_cache_dir);
@@ -655,6 +775,8 @@ int main(int argc, char **argv) {
                 codegen_link(g, out_file);
                 if (timing_info)
                     codegen_print_timing_report(g, stdout);
+                if (comptime_report)
+                    codegen_print_comptime_report(g, stdout);
                 return EXIT_SUCCESS;
             } else if (cmd == CmdParseH) {
                 codegen_parseh(g, in_file_buf);
@@ -671,8 +793,11 @@ int main(int argc, char **argv) {
                 if (term.how != TerminationIdClean || term.code != 0) {
                     fprintf(stderr, "\nTests failed. Use the following command to reproduce the failure:\n");
                     fprintf(stderr, "./test\n");
-                } else if (timing_info) {
-                    codegen_print_timing_report(g, stdout);
+                } else {
+                    if (timing_info)
+                        codegen_print_timing_report(g, stdout);
+                    if (comptime_report)
+                        codegen_print_comptime_report(g, stdout);
                 }
                 return (term.how == TerminationIdClean) ? term.code : -1;
             } else {
@@ -25,6 +25,7 @@
 
 #include <windows.h>
 #include <io.h>
+#include <psapi.h>
 #else
 #define ZIG_OS_POSIX
 
@@ -32,6 +33,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include <fcntl.h>
 #include <limits.h>
 
@@ -41,6 +45,7 @@
 #if defined(__MACH__)
 #include <mach/clock.h>
 #include <mach/mach.h>
+#include <mach-o/dyld.h>
 #endif
 
 #if defined(ZIG_OS_WINDOWS)
@@ -53,6 +58,10 @@ static clock_serv_t cclock;
 #include <errno.h>
 #include <time.h>
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 // these implementations are lazy. But who cares, we'll make a robust
 // implementation in the zig standard library and then this code all gets
 // deleted when we self-host. it works for now.
@@ -571,25 +580,155 @@ int os_copy_file(Buf *src_path, Buf *dest_path) {
     }
 }
 
+static int open_file_error(int err) {
+    switch (err) {
+        case EACCES:
+            return ErrorAccess;
+        case EINTR:
+            return ErrorInterrupted;
+        case EINVAL:
+            zig_unreachable();
+        case ENFILE:
+        case EMFILE:
+        case ENOMEM:
+            return ErrorSystemResources;
+        case ENOENT:
+            return ErrorFileNotFound;
+        default:
+            return ErrorFileSystem;
+    }
+}
+
+#if defined(ZIG_OS_POSIX)
+static size_t mapped_size(size_t len) {
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    return (len + page_size - 1) & ~(page_size - 1);
+}
+
+// Maps size bytes of fd read-only and points out_contents at them. The mapping
+// is one byte longer than the file, rounded up to whole pages: the tail of the
+// last page of a file mapping reads as zero, and when the file ends exactly on
+// a page boundary the extra page comes from the anonymous reservation, so the
+// terminating 0 that Buf promises is always there without copying.
+static bool map_file(int fd, size_t size, Buf *out_contents) {
+    size_t map_size = mapped_size(size + 1);
+    void *reserved = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED)
+        return false;
+    void *mapped = mmap(reserved, size, PROT_READ, MAP_PRIVATE|MAP_FIXED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        munmap(reserved, map_size);
+        return false;
+    }
+    buf_deinit(out_contents);
+    out_contents->list.items = (char *)mapped;
+    out_contents->list.length = size + 1;
+    out_contents->list.capacity = size + 1;
+    return true;
+}
+
+// Moves contents into an anonymous mapping, so that os_unmap_file can treat
+// it like a mapped file.
+static int map_contents(Buf *contents, Buf *out_contents) {
+    size_t map_size = mapped_size(buf_len(contents) + 1);
+    void *mapped = mmap(nullptr, map_size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED)
+        return ErrorSystemResources;
+    memcpy(mapped, buf_ptr(contents), buf_len(contents));
+    mprotect(mapped, map_size, PROT_READ);
+    buf_deinit(out_contents);
+    out_contents->list.items = (char *)mapped;
+    out_contents->list.length = buf_len(contents) + 1;
+    out_contents->list.capacity = buf_len(contents) + 1;
+    return 0;
+}
+#endif
+
+// For source files that stay around until the process exits. Regular files
+// are mapped into memory rather than read, and out_contents is a read-only
+// view of the file until os_unmap_file: it must not be written to, resized
+// or deinitialized, and each call needs a fresh Buf. The file must not be
+// truncated while it is mapped, so files that other builds may rewrite,
+// such as those in the cache dirs, are read with os_fetch_file_path.
+int os_map_file_path(Buf *full_path, Buf *out_contents) {
+#if defined(ZIG_OS_POSIX)
+    int fd = open(buf_ptr(full_path), O_RDONLY|O_CLOEXEC);
+    if (fd == -1)
+        return open_file_error(errno);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+        (uint64_t)st.st_size < SIZE_MAX && map_file(fd, (size_t)st.st_size, out_contents))
+    {
+        close(fd);
+        return 0;
+    }
+    close(fd);
+
+    // pipes and other special files
+    Buf contents = BUF_INIT;
+    int err;
+    if ((err = os_fetch_file_path(full_path, &contents)))
+        return err;
+    err = map_contents(&contents, out_contents);
+    buf_deinit(&contents);
+    return err;
+#else
+    return os_fetch_file_path(full_path, out_contents);
+#endif
+}
+
+// Releases a Buf that os_map_file_path filled.
+void os_unmap_file(Buf *contents) {
+#if defined(ZIG_OS_POSIX)
+    munmap(contents->list.items, mapped_size(contents->list.length));
+    contents->list.items = nullptr;
+    contents->list.length = 0;
+    contents->list.capacity = 0;
+#else
+    buf_deinit(contents);
+#endif
+}
+
 int os_fetch_file_path(Buf *full_path, Buf *out_contents) {
-    FILE *f = fopen(buf_ptr(full_path), "rb");
-    if (!f) {
-        switch (errno) {
-            case EACCES:
-                return ErrorAccess;
-            case EINTR:
-                return ErrorInterrupted;
-            case EINVAL:
-                zig_unreachable();
-            case ENFILE:
-            case ENOMEM:
-                return ErrorSystemResources;
-            case ENOENT:
-                return ErrorFileNotFound;
-            default:
-                return ErrorFileSystem;
+#if defined(ZIG_OS_POSIX)
+    int fd = open(buf_ptr(full_path), O_RDONLY|O_CLOEXEC);
+    if (fd == -1)
+        return open_file_error(errno);
+
+    // regular files are read in one go
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (uint64_t)st.st_size < SIZE_MAX) {
+        size_t size = (size_t)st.st_size;
+        buf_resize(out_contents, size);
+        size_t amt_read = 0;
+        while (amt_read < size) {
+            ssize_t amt = read(fd, buf_ptr(out_contents) + amt_read, size - amt_read);
+            if (amt == -1 && errno == EINTR)
+                continue;
+            if (amt <= 0)
+                break;
+            amt_read += (size_t)amt;
+        }
+        close(fd);
+        if (amt_read != size) {
+            // the file changed size under us
+            return ErrorFileSystem;
         }
+        return 0;
+    }
+
+    FILE *f = fdopen(fd, "rb");
+    if (!f) {
+        int err = errno;
+        close(fd);
+        return open_file_error(err);
     }
+#else
+    FILE *f = fopen(buf_ptr(full_path), "rb");
+    if (!f)
+        return open_file_error(errno);
+#endif
     int result = os_fetch_file(f, out_contents);
     fclose(f);
     return result;
@@ -618,6 +757,93 @@ int os_get_cwd(Buf *out_cwd) {
 #endif
 }
 
+// the per-user directory for data that is shared between projects and may
+// be deleted at any time
+int os_get_user_cache_dir(Buf *out_path) {
+#if defined(ZIG_OS_WINDOWS)
+    const char *local_app_data = getenv("LOCALAPPDATA");
+    if (!local_app_data)
+        return ErrorFileNotFound;
+    os_path_join(buf_create_from_str(local_app_data), buf_create_from_str("zig"), out_path);
+    return 0;
+#elif defined(ZIG_OS_POSIX)
+    const char *xdg_cache_home = getenv("XDG_CACHE_HOME");
+    if (xdg_cache_home && xdg_cache_home[0]) {
+        os_path_join(buf_create_from_str(xdg_cache_home), buf_create_from_str("zig"), out_path);
+        return 0;
+    }
+    const char *home = getenv("HOME");
+    if (!home)
+        return ErrorFileNotFound;
+    os_path_join(buf_create_from_str(home), buf_create_from_str(".cache/zig"), out_path);
+    return 0;
+#else
+#error "missing os_get_user_cache_dir implementation"
+#endif
+}
+
+// the path of the running compiler binary
+int os_self_exe_path(Buf *out_path) {
+#if defined(ZIG_OS_WINDOWS)
+    buf_resize(out_path, 256);
+    for (;;) {
+        DWORD copied = GetModuleFileNameA(nullptr, buf_ptr(out_path), buf_len(out_path));
+        if (copied == 0)
+            return ErrorFileNotFound;
+        if (copied < buf_len(out_path)) {
+            buf_resize(out_path, copied);
+            return 0;
+        }
+        buf_resize(out_path, buf_len(out_path) * 2);
+    }
+#elif defined(__MACH__)
+    uint32_t size = 256;
+    buf_resize(out_path, size);
+    if (_NSGetExecutablePath(buf_ptr(out_path), &size) != 0) {
+        // size is now the size that is needed
+        buf_resize(out_path, size);
+        if (_NSGetExecutablePath(buf_ptr(out_path), &size) != 0)
+            return ErrorFileNotFound;
+    }
+    buf_resize(out_path, strlen(buf_ptr(out_path)));
+    return 0;
+#elif defined(__linux__)
+    buf_resize(out_path, 256);
+    for (;;) {
+        ssize_t amt = readlink("/proc/self/exe", buf_ptr(out_path), buf_len(out_path));
+        if (amt == -1)
+            return ErrorFileNotFound;
+        if ((size_t)amt < buf_len(out_path)) {
+            buf_resize(out_path, amt);
+            return 0;
+        }
+        buf_resize(out_path, buf_len(out_path) * 2);
+    }
+#else
+    return ErrorFileNotFound;
+#endif
+}
+
+int os_file_size_and_mtime(Buf *full_path, uint64_t *out_size, uint64_t *out_mtime) {
+#if defined(ZIG_OS_WINDOWS)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(buf_ptr(full_path), GetFileExInfoStandard, &data))
+        return ErrorFileNotFound;
+    *out_size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+    *out_mtime = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+    return 0;
+#elif defined(ZIG_OS_POSIX)
+    struct stat st;
+    if (stat(buf_ptr(full_path), &st) != 0)
+        return (errno == EACCES) ? ErrorAccess : ErrorFileNotFound;
+    *out_size = st.st_size;
+    *out_mtime = st.st_mtime;
+    return 0;
+#else
+#error "missing os_file_size_and_mtime implementation"
+#endif
+}
+
 bool os_stderr_tty(void) {
 #if defined(ZIG_OS_WINDOWS)
     return _isatty(STDERR_FILENO) != 0;
@@ -713,10 +939,17 @@ void os_init(void) {
     srand((unsigned)time(NULL));
 }
 
+// replaces dest_path if it exists
 int os_rename(Buf *src_path, Buf *dest_path) {
+#if defined(ZIG_OS_WINDOWS)
+    if (!MoveFileExA(buf_ptr(src_path), buf_ptr(dest_path), MOVEFILE_REPLACE_EXISTING)) {
+        return ErrorFileSystem;
+    }
+#else
     if (rename(buf_ptr(src_path), buf_ptr(dest_path)) == -1) {
         return ErrorFileSystem;
     }
+#endif
     return 0;
 }
 
@@ -744,6 +977,25 @@ double os_get_time(void) {
 #endif
 }
 
+// The largest resident set size the process has had so far, in bytes.
+size_t os_get_peak_rss(void) {
+#if defined(ZIG_OS_WINDOWS)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__MACH__)
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
 int os_make_path(Buf *path) {
     Buf *resolved_path = buf_alloc();
     os_path_resolve(buf_create_from_str("."), path, resolved_path);
@@ -805,6 +1057,132 @@ int os_make_dir(Buf *path) {
 #endif
 }
 
+struct OsMutex {
+    std::recursive_mutex mutex;
+};
+
+OsMutex *os_mutex_create(void) {
+    return new OsMutex();
+}
+
+void os_mutex_destroy(OsMutex *mutex) {
+    delete mutex;
+}
+
+void os_mutex_lock(OsMutex *mutex) {
+    mutex->mutex.lock();
+}
+
+void os_mutex_unlock(OsMutex *mutex) {
+    mutex->mutex.unlock();
+}
+
+struct OsCond {
+    std::condition_variable_any cond;
+};
+
+OsCond *os_cond_create(void) {
+    return new OsCond();
+}
+
+void os_cond_destroy(OsCond *cond) {
+    delete cond;
+}
+
+void os_cond_wait(OsCond *cond, OsMutex *mutex) {
+    cond->cond.wait(mutex->mutex);
+}
+
+void os_cond_broadcast(OsCond *cond) {
+    cond->cond.notify_all();
+}
+
+struct OsThread {
+    std::thread thread;
+};
+
+OsThread *os_thread_create(void (*fn)(void *context), void *context) {
+    OsThread *thread = new OsThread();
+    thread->thread = std::thread(fn, context);
+    return thread;
+}
+
+void os_thread_join(OsThread *thread) {
+    thread->thread.join();
+    delete thread;
+}
+
+void os_run_threads(size_t thread_count, void (*fn)(void *context, size_t thread_index), void *context) {
+    assert(thread_count >= 1);
+    std::thread *threads = new std::thread[thread_count - 1];
+    for (size_t i = 1; i < thread_count; i += 1) {
+        threads[i - 1] = std::thread(fn, context, i);
+    }
+    fn(context, 0);
+    for (size_t i = 1; i < thread_count; i += 1) {
+        threads[i - 1].join();
+    }
+    delete[] threads;
+}
+
+struct OsFileLock {
+#if defined(ZIG_OS_WINDOWS)
+    HANDLE handle;
+#else
+    int fd;
+#endif
+};
+
+int os_file_lock(Buf *path, OsFileLock **out_lock) {
+#if defined(ZIG_OS_WINDOWS)
+    HANDLE handle = CreateFileA(buf_ptr(path), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return ErrorFileSystem;
+    OVERLAPPED overlapped = {};
+    if (!LockFileEx(handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &overlapped)) {
+        CloseHandle(handle);
+        return ErrorFileSystem;
+    }
+    OsFileLock *lock = allocate<OsFileLock>(1);
+    lock->handle = handle;
+#elif defined(ZIG_OS_POSIX)
+    int fd = open(buf_ptr(path), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd == -1)
+        return (errno == EACCES || errno == EPERM) ? ErrorAccess : ErrorFileSystem;
+    while (flock(fd, LOCK_EX) == -1) {
+        if (errno != EINTR) {
+            close(fd);
+            return ErrorFileSystem;
+        }
+    }
+    OsFileLock *lock = allocate<OsFileLock>(1);
+    lock->fd = fd;
+#else
+#error "missing os_file_lock implementation"
+#endif
+    *out_lock = lock;
+    return 0;
+}
+
+void os_file_unlock(OsFileLock *lock) {
+#if defined(ZIG_OS_WINDOWS)
+    CloseHandle(lock->handle);
+#elif defined(ZIG_OS_POSIX)
+    close(lock->fd);
+#endif
+    free(lock);
+}
+
+Buf *os_tmp_path_for(Buf *path) {
+#if defined(ZIG_OS_WINDOWS)
+    unsigned long pid = GetCurrentProcessId();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    return buf_sprintf("%s.tmp%lu", buf_ptr(path), pid);
+}
+
 int zig_os_init(void) {
 #if defined(ZIG_OS_WINDOWS)
     unsigned __int64 frequency;
@@ -48,8 +48,12 @@ int os_copy_file(Buf *src_path, Buf *dest_path);
 
 int os_fetch_file(FILE *file, Buf *out_contents);
 int os_fetch_file_path(Buf *full_path, Buf *out_contents);
+int os_map_file_path(Buf *full_path, Buf *out_contents);
+void os_unmap_file(Buf *contents);
 
 int os_get_cwd(Buf *out_cwd);
+int os_get_user_cache_dir(Buf *out_path);
+int os_self_exe_path(Buf *out_path);
 
 bool os_stderr_tty(void);
 
@@ -57,12 +61,47 @@ int os_buf_to_tmp_file(Buf *contents, Buf *suffix, Buf *out_tmp_path);
 int os_delete_file(Buf *path);
 
 int os_file_exists(Buf *full_path, bool *result);
+int os_file_size_and_mtime(Buf *full_path, uint64_t *out_size, uint64_t *out_mtime);
 
 int os_rename(Buf *src_path, Buf *dest_path);
 double os_get_time(void);
+size_t os_get_peak_rss(void);
 
 bool os_is_sep(uint8_t c);
 
+// A recursive mutex.
+struct OsMutex;
+OsMutex *os_mutex_create(void);
+void os_mutex_destroy(OsMutex *mutex);
+void os_mutex_lock(OsMutex *mutex);
+void os_mutex_unlock(OsMutex *mutex);
+
+struct OsCond;
+OsCond *os_cond_create(void);
+void os_cond_destroy(OsCond *cond);
+// mutex must be locked exactly once by the calling thread
+void os_cond_wait(OsCond *cond, OsMutex *mutex);
+void os_cond_broadcast(OsCond *cond);
+
+struct OsThread;
+OsThread *os_thread_create(void (*fn)(void *context), void *context);
+void os_thread_join(OsThread *thread);
+
+// Calls fn(context, thread_index) once for each thread_index below
+// thread_count, each on its own thread, and returns when all of them have.
+// Index 0 runs on the calling thread.
+void os_run_threads(size_t thread_count, void (*fn)(void *context, size_t thread_index), void *context);
+
+// An exclusive lock on a file, held until os_file_unlock, which other
+// processes wait for. The file is created if it does not exist.
+struct OsFileLock;
+int os_file_lock(Buf *path, OsFileLock **out_lock);
+void os_file_unlock(OsFileLock *lock);
+
+// path with a suffix that no other running process uses, for files that are
+// written and then renamed into place
+Buf *os_tmp_path_for(Buf *path);
+
 #if defined(__APPLE__)
 #define ZIG_OS_DARWIN
 #elif defined(_WIN32)
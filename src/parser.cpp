@@ -13,6 +13,7 @@
 #include <stdio.h>
 #include <limits.h>
 #include <errno.h>
+#include <setjmp.h>
 
 struct ParseContext {
     Buf *buf;
@@ -21,6 +22,11 @@ struct ParseContext {
     ImportTableEntry *owner;
     ErrColor err_color;
     uint32_t *next_node_index;
+    Arena *node_arena;
+    CodeGen *codegen;
+    // set by ast_parse_detached
+    ZigList<AstNode *> *created_nodes;
+    jmp_buf *error_jmp;
     // These buffers are used freqently so we preallocate them once here.
     Buf *void_buf;
     Buf *empty_buf;
@@ -44,6 +50,8 @@ static void ast_asm_error(ParseContext *pc, AstNode *node, size_t offset, const
     ErrorMsg *err = err_msg_create_with_line(pc->owner->path, pos.line, pos.column,
             pc->owner->source_code, pc->owner->line_offsets, msg);
 
+    if (pc->error_jmp != nullptr)
+        longjmp(*pc->error_jmp, 1);
     print_err_msg(err, pc->err_color);
     exit(EXIT_FAILURE);
 }
@@ -62,16 +70,128 @@ static void ast_error(ParseContext *pc, Token *token, const char *format, ...) {
     err->line_start = token->start_line;
     err->column_start = token->start_column;
 
+    if (pc->error_jmp != nullptr)
+        longjmp(*pc->error_jmp, 1);
     print_err_msg(err, pc->err_color);
     exit(EXIT_FAILURE);
 }
 
+static size_t ast_node_data_size(NodeType type) {
+    switch (type) {
+        case NodeTypeRoot:
+            return sizeof(AstNode::data.root);
+        case NodeTypeFnProto:
+            return sizeof(AstNode::data.fn_proto);
+        case NodeTypeFnDef:
+            return sizeof(AstNode::data.fn_def);
+        case NodeTypeFnDecl:
+            return sizeof(AstNode::data.fn_decl);
+        case NodeTypeParamDecl:
+            return sizeof(AstNode::data.param_decl);
+        case NodeTypeBlock:
+            return sizeof(AstNode::data.block);
+        case NodeTypeGroupedExpr:
+            return sizeof(AstNode::data.grouped_expr);
+        case NodeTypeReturnExpr:
+            return sizeof(AstNode::data.return_expr);
+        case NodeTypeDefer:
+            return sizeof(AstNode::data.defer);
+        case NodeTypeVariableDeclaration:
+            return sizeof(AstNode::data.variable_declaration);
+        case NodeTypeErrorValueDecl:
+            return sizeof(AstNode::data.error_value_decl);
+        case NodeTypeTestDecl:
+            return sizeof(AstNode::data.test_decl);
+        case NodeTypeBinOpExpr:
+            return sizeof(AstNode::data.bin_op_expr);
+        case NodeTypeUnwrapErrorExpr:
+            return sizeof(AstNode::data.unwrap_err_expr);
+        case NodeTypeNumberLiteral:
+            return sizeof(AstNode::data.number_literal);
+        case NodeTypeStringLiteral:
+            return sizeof(AstNode::data.string_literal);
+        case NodeTypeCharLiteral:
+            return sizeof(AstNode::data.char_literal);
+        case NodeTypeSymbol:
+            return sizeof(AstNode::data.symbol_expr);
+        case NodeTypePrefixOpExpr:
+            return sizeof(AstNode::data.prefix_op_expr);
+        case NodeTypeFnCallExpr:
+            return sizeof(AstNode::data.fn_call_expr);
+        case NodeTypeArrayAccessExpr:
+            return sizeof(AstNode::data.array_access_expr);
+        case NodeTypeSliceExpr:
+            return sizeof(AstNode::data.slice_expr);
+        case NodeTypeFieldAccessExpr:
+            return sizeof(AstNode::data.field_access_expr);
+        case NodeTypeUse:
+            return sizeof(AstNode::data.use);
+        case NodeTypeBoolLiteral:
+            return sizeof(AstNode::data.bool_literal);
+        case NodeTypeNullLiteral:
+            return sizeof(AstNode::data.null_literal);
+        case NodeTypeUndefinedLiteral:
+            return sizeof(AstNode::data.undefined_literal);
+        case NodeTypeThisLiteral:
+            return sizeof(AstNode::data.this_literal);
+        case NodeTypeUnreachable:
+            return sizeof(AstNode::data.unreachable_expr);
+        case NodeTypeIfBoolExpr:
+            return sizeof(AstNode::data.if_bool_expr);
+        case NodeTypeWhileExpr:
+            return sizeof(AstNode::data.while_expr);
+        case NodeTypeForExpr:
+            return sizeof(AstNode::data.for_expr);
+        case NodeTypeSwitchExpr:
+            return sizeof(AstNode::data.switch_expr);
+        case NodeTypeSwitchProng:
+            return sizeof(AstNode::data.switch_prong);
+        case NodeTypeSwitchRange:
+            return sizeof(AstNode::data.switch_range);
+        case NodeTypeLabel:
+            return sizeof(AstNode::data.label);
+        case NodeTypeGoto:
+            return sizeof(AstNode::data.goto_expr);
+        case NodeTypeCompTime:
+            return sizeof(AstNode::data.comptime_expr);
+        case NodeTypeBreak:
+            return sizeof(AstNode::data.break_expr);
+        case NodeTypeContinue:
+            return sizeof(AstNode::data.continue_expr);
+        case NodeTypeAsmExpr:
+            return sizeof(AstNode::data.asm_expr);
+        case NodeTypeContainerDecl:
+            return sizeof(AstNode::data.container_decl);
+        case NodeTypeStructField:
+            return sizeof(AstNode::data.struct_field);
+        case NodeTypeContainerInitExpr:
+            return sizeof(AstNode::data.container_init_expr);
+        case NodeTypeStructValueField:
+            return sizeof(AstNode::data.struct_val_field);
+        case NodeTypeArrayType:
+            return sizeof(AstNode::data.array_type);
+        case NodeTypeErrorType:
+            return sizeof(AstNode::data.error_type);
+        case NodeTypeVarLiteral:
+            return sizeof(AstNode::data.var_literal);
+        case NodeTypeTryExpr:
+            return sizeof(AstNode::data.try_expr);
+        case NodeTypeTestExpr:
+            return sizeof(AstNode::data.test_expr);
+    }
+    zig_unreachable();
+}
+
 static AstNode *ast_create_node_no_line_info(ParseContext *pc, NodeType type) {
-    AstNode *node = allocate<AstNode>(1);
+    // a symbol needs 32 bytes rather than the 136 of the biggest node
+    size_t size = offsetof(AstNode, data) + ast_node_data_size(type);
+    AstNode *node = reinterpret_cast<AstNode *>(arena_alloc_bytes(pc->node_arena, size, alignof(AstNode)));
     node->type = type;
     node->owner = pc->owner;
     node->create_index = *pc->next_node_index;
     *pc->next_node_index += 1;
+    if (pc->created_nodes != nullptr)
+        pc->created_nodes->append(node);
     return node;
 }
 
@@ -181,24 +301,26 @@ static void parse_asm_template(ParseContext *pc, AstNode *node) {
     }
 }
 
-static Buf *token_buf(Token *token) {
+static Buf *token_buf(ParseContext *pc, Token *token) {
     assert(token->id == TokenIdStringLiteral || token->id == TokenIdSymbol);
-    return &token->data.str_lit.str;
-}
-
-static BigNum *token_bignum(Token *token) {
-    assert(token->id == TokenIdNumberLiteral);
-    return &token->data.num_lit.bignum;
-}
-
-static uint8_t token_char_lit(Token *token) {
-    assert(token->id == TokenIdCharLiteral);
-    return token->data.char_lit.c;
+    if (token->id == TokenIdSymbol && token_is_plain_symbol(pc->buf, token)) {
+        // intern_buf only hashes, compares and copies the bytes, so it can be
+        // given the name where it is in the source
+        Buf name = BUF_INIT;
+        name.list.items = buf_ptr(pc->buf) + token->start_pos;
+        name.list.length = token->end_pos - token->start_pos + 1;
+        return intern_buf(pc->codegen, &name);
+    }
+    Buf *buf = buf_alloc();
+    token_decode_str(pc->buf, token, buf);
+    if (token->id == TokenIdSymbol)
+        return intern_buf(pc->codegen, buf);
+    return buf;
 }
 
 static void ast_buf_from_token(ParseContext *pc, Token *token, Buf *buf) {
     if (token->id == TokenIdSymbol) {
-        buf_init_from_buf(buf, token_buf(token));
+        buf_init_from_buf(buf, token_buf(pc, token));
     } else {
         buf_init_from_mem(buf, buf_ptr(pc->buf) + token->start_pos, token->end_pos - token->start_pos);
     }
@@ -278,7 +400,7 @@ static AstNode *ast_parse_param_decl(ParseContext *pc, size_t *token_index) {
     if (token->id == TokenIdSymbol) {
         Token *next_token = &pc->tokens->at(*token_index + 1);
         if (next_token->id == TokenIdColon) {
-            node->data.param_decl.name = token_buf(token);
+            node->data.param_decl.name = token_buf(pc, token);
             *token_index += 2;
         }
     }
@@ -424,8 +546,8 @@ static void ast_parse_asm_input_item(ParseContext *pc, size_t *token_index, AstN
     ast_eat_token(pc, token_index, TokenIdRParen);
 
     AsmInput *asm_input = allocate<AsmInput>(1);
-    asm_input->asm_symbolic_name = token_buf(alias);
-    asm_input->constraint = token_buf(constraint);
+    asm_input->asm_symbolic_name = token_buf(pc, alias);
+    asm_input->constraint = token_buf(pc, constraint);
     asm_input->expr = expr_node;
     node->data.asm_expr.input_list.append(asm_input);
 }
@@ -447,7 +569,7 @@ static void ast_parse_asm_output_item(ParseContext *pc, size_t *token_index, Ast
     Token *token = &pc->tokens->at(*token_index);
     *token_index += 1;
     if (token->id == TokenIdSymbol) {
-        asm_output->variable_name = token_buf(token);
+        asm_output->variable_name = token_buf(pc, token);
     } else if (token->id == TokenIdArrow) {
         asm_output->return_type = ast_parse_type_expr(pc, token_index, true);
     } else {
@@ -456,8 +578,8 @@ static void ast_parse_asm_output_item(ParseContext *pc, size_t *token_index, Ast
 
     ast_eat_token(pc, token_index, TokenIdRParen);
 
-    asm_output->asm_symbolic_name = token_buf(alias);
-    asm_output->constraint = token_buf(constraint);
+    asm_output->asm_symbolic_name = token_buf(pc, alias);
+    asm_output->constraint = token_buf(pc, constraint);
     node->data.asm_expr.output_list.append(asm_output);
 }
 
@@ -477,7 +599,7 @@ static void ast_parse_asm_clobbers(ParseContext *pc, size_t *token_index, AstNod
         ast_expect_token(pc, string_tok, TokenIdStringLiteral);
         *token_index += 1;
 
-        Buf *clobber_buf = token_buf(string_tok);
+        Buf *clobber_buf = token_buf(pc, string_tok);
         node->data.asm_expr.clobber_list.append(clobber_buf);
 
         Token *comma = &pc->tokens->at(*token_index);
@@ -606,7 +728,7 @@ static AstNode *ast_parse_asm_expr(ParseContext *pc, size_t *token_index, bool m
 
     Token *template_tok = ast_eat_token(pc, token_index, TokenIdStringLiteral);
 
-    node->data.asm_expr.asm_template = token_buf(template_tok);
+    node->data.asm_expr.asm_template = token_buf(pc, template_tok);
     parse_asm_template(pc, node);
 
     ast_parse_asm_output(pc, token_index, node);
@@ -633,7 +755,7 @@ static AstNode *ast_parse_goto_expr(ParseContext *pc, size_t *token_index, bool
     AstNode *node = ast_create_node(pc, NodeTypeGoto, goto_token);
 
     Token *dest_symbol = ast_eat_token(pc, token_index, TokenIdSymbol);
-    node->data.goto_expr.name = token_buf(dest_symbol);
+    node->data.goto_expr.name = token_buf(pc, dest_symbol);
     return node;
 }
 
@@ -668,19 +790,19 @@ static AstNode *ast_parse_primary_expr(ParseContext *pc, size_t *token_index, bo
 
     if (token->id == TokenIdNumberLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeNumberLiteral, token);
-        node->data.number_literal.bignum = token_bignum(token);
-        node->data.number_literal.overflow = token->data.num_lit.overflow;
+        node->data.number_literal.bignum = arena_allocate<BigNum>(pc->node_arena, 1);
+        node->data.number_literal.overflow = token_decode_number(pc->buf, token, node->data.number_literal.bignum);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdStringLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeStringLiteral, token);
-        node->data.string_literal.buf = token_buf(token);
-        node->data.string_literal.c = token->data.str_lit.is_c_str;
+        node->data.string_literal.buf = token_buf(pc, token);
+        node->data.string_literal.c = token_is_c_str(pc->buf, token);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdCharLiteral) {
         AstNode *node = ast_create_node(pc, NodeTypeCharLiteral, token);
-        node->data.char_literal.value = token_char_lit(token);
+        node->data.char_literal.value = token_decode_char(pc->buf, token);
         *token_index += 1;
         return node;
     } else if (token->id == TokenIdKeywordTrue) {
@@ -721,7 +843,7 @@ static AstNode *ast_parse_primary_expr(ParseContext *pc, size_t *token_index, bo
         *token_index += 1;
         Token *name_tok = ast_eat_token(pc, token_index, TokenIdSymbol);
         AstNode *name_node = ast_create_node(pc, NodeTypeSymbol, name_tok);
-        name_node->data.symbol_expr.symbol = token_buf(name_tok);
+        name_node->data.symbol_expr.symbol = token_buf(pc, name_tok);
 
         AstNode *node = ast_create_node(pc, NodeTypeFnCallExpr, token);
         node->data.fn_call_expr.fn_ref_expr = name_node;
@@ -733,7 +855,7 @@ static AstNode *ast_parse_primary_expr(ParseContext *pc, size_t *token_index, bo
     } else if (token->id == TokenIdSymbol) {
         *token_index += 1;
         AstNode *node = ast_create_node(pc, NodeTypeSymbol, token);
-        node->data.symbol_expr.symbol = token_buf(token);
+        node->data.symbol_expr.symbol = token_buf(pc, token);
         return node;
     }
 
@@ -813,7 +935,7 @@ static AstNode *ast_parse_curly_suffix_expr(ParseContext *pc, size_t *token_inde
 
                         AstNode *field_node = ast_create_node(pc, NodeTypeStructValueField, token);
 
-                        field_node->data.struct_val_field.name = token_buf(field_name_tok);
+                        field_node->data.struct_val_field.name = token_buf(pc, field_name_tok);
                         field_node->data.struct_val_field.expr = ast_parse_expression(pc, token_index, true);
 
                         node->data.container_init_expr.entries.append(field_node);
@@ -928,7 +1050,7 @@ static AstNode *ast_parse_suffix_op_expr(ParseContext *pc, size_t *token_index,
 
             AstNode *node = ast_create_node(pc, NodeTypeFieldAccessExpr, first_token);
             node->data.field_access_expr.struct_expr = primary_expr;
-            node->data.field_access_expr.field_name = token_buf(name_token);
+            node->data.field_access_expr.field_name = token_buf(pc, name_token);
 
             primary_expr = node;
         } else {
@@ -1382,17 +1504,17 @@ static AstNode *ast_parse_if_try_test_expr(ParseContext *pc, size_t *token_index
         node->data.try_expr.target_node = condition;
         node->data.try_expr.var_is_ptr = var_is_ptr;
         if (var_name_tok != nullptr) {
-            node->data.try_expr.var_symbol = token_buf(var_name_tok);
+            node->data.try_expr.var_symbol = token_buf(pc, var_name_tok);
         }
         node->data.try_expr.then_node = body_node;
-        node->data.try_expr.err_symbol = token_buf(err_name_tok);
+        node->data.try_expr.err_symbol = token_buf(pc, err_name_tok);
         node->data.try_expr.else_node = else_node;
         return node;
     } else if (var_name_tok != nullptr) {
         AstNode *node = ast_create_node(pc, NodeTypeTestExpr, if_token);
         node->data.test_expr.target_node = condition;
         node->data.test_expr.var_is_ptr = var_is_ptr;
-        node->data.test_expr.var_symbol = token_buf(var_name_tok);
+        node->data.test_expr.var_symbol = token_buf(pc, var_name_tok);
         node->data.test_expr.then_node = body_node;
         node->data.test_expr.else_node = else_node;
         return node;
@@ -1538,7 +1660,7 @@ static AstNode *ast_parse_variable_declaration_expr(ParseContext *pc, size_t *to
     node->data.variable_declaration.visib_mod = visib_mod;
 
     Token *name_token = ast_eat_token(pc, token_index, TokenIdSymbol);
-    node->data.variable_declaration.symbol = token_buf(name_token);
+    node->data.variable_declaration.symbol = token_buf(pc, name_token);
 
     Token *eq_or_colon = &pc->tokens->at(*token_index);
     *token_index += 1;
@@ -1635,7 +1757,7 @@ static AstNode *ast_parse_while_expr(ParseContext *pc, size_t *token_index, bool
         }
 
         Token *var_name_tok = ast_eat_token(pc, token_index, TokenIdSymbol);
-        node->data.while_expr.var_symbol = token_buf(var_name_tok);
+        node->data.while_expr.var_symbol = token_buf(pc, var_name_tok);
         ast_eat_token(pc, token_index, TokenIdBinOr);
     }
 
@@ -1658,7 +1780,7 @@ static AstNode *ast_parse_while_expr(ParseContext *pc, size_t *token_index, bool
             *token_index += 1;
 
             Token *err_name_tok = ast_eat_token(pc, token_index, TokenIdSymbol);
-            node->data.while_expr.err_symbol = token_buf(err_name_tok);
+            node->data.while_expr.err_symbol = token_buf(pc, err_name_tok);
 
             ast_eat_token(pc, token_index, TokenIdBinOr);
         }
@@ -1672,7 +1794,7 @@ static AstNode *ast_parse_while_expr(ParseContext *pc, size_t *token_index, bool
 static AstNode *ast_parse_symbol(ParseContext *pc, size_t *token_index) {
     Token *token = ast_eat_token(pc, token_index, TokenIdSymbol);
     AstNode *node = ast_create_node(pc, NodeTypeSymbol, token);
-    node->data.symbol_expr.symbol = token_buf(token);
+    node->data.symbol_expr.symbol = token_buf(pc, token);
     return node;
 }
 
@@ -2059,7 +2181,7 @@ static AstNode *ast_parse_label(ParseContext *pc, size_t *token_index, bool mand
     *token_index += 2;
 
     AstNode *node = ast_create_node(pc, NodeTypeLabel, symbol_token);
-    node->data.label.name = token_buf(symbol_token);
+    node->data.label.name = token_buf(pc, symbol_token);
     return node;
 }
 
@@ -2194,7 +2316,7 @@ static AstNode *ast_parse_fn_proto(ParseContext *pc, size_t *token_index, bool m
     Token *fn_name = &pc->tokens->at(*token_index);
     if (fn_name->id == TokenIdSymbol) {
         *token_index += 1;
-        node->data.fn_proto.name = token_buf(fn_name);
+        node->data.fn_proto.name = token_buf(pc, fn_name);
     } else {
         node->data.fn_proto.name = pc->empty_buf;
     }
@@ -2273,7 +2395,7 @@ static AstNode *ast_parse_extern_decl(ParseContext *pc, size_t *token_index, boo
     Token *lib_name_tok = &pc->tokens->at(*token_index);
     Buf *lib_name = nullptr;
     if (lib_name_tok->id == TokenIdStringLiteral) {
-        lib_name = token_buf(lib_name_tok);
+        lib_name = token_buf(pc, lib_name_tok);
         *token_index += 1;
     }
 
@@ -2396,7 +2518,7 @@ static AstNode *ast_parse_container_decl(ParseContext *pc, size_t *token_index,
             *token_index += 1;
 
             field_node->data.struct_field.visib_mod = visib_mod;
-            field_node->data.struct_field.name = token_buf(token);
+            field_node->data.struct_field.name = token_buf(pc, token);
 
             Token *token = &pc->tokens->at(*token_index);
             if (token->id == TokenIdComma || token->id == TokenIdRBrace) {
@@ -2443,7 +2565,7 @@ static AstNode *ast_parse_error_value_decl(ParseContext *pc, size_t *token_index
     ast_eat_token(pc, token_index, TokenIdSemicolon);
 
     AstNode *node = ast_create_node(pc, NodeTypeErrorValueDecl, first_token);
-    node->data.error_value_decl.name = token_buf(name_tok);
+    node->data.error_value_decl.name = token_buf(pc, name_tok);
 
     return node;
 }
@@ -2462,7 +2584,7 @@ static AstNode *ast_parse_test_decl_node(ParseContext *pc, size_t *token_index)
     Token *name_tok = ast_eat_token(pc, token_index, TokenIdStringLiteral);
 
     AstNode *node = ast_create_node(pc, NodeTypeTestDecl, first_token);
-    node->data.test_decl.name = token_buf(name_tok);
+    node->data.test_decl.name = token_buf(pc, name_tok);
     node->data.test_decl.body = ast_parse_block(pc, token_index, true);
 
     return node;
@@ -2550,21 +2672,49 @@ static AstNode *ast_parse_root(ParseContext *pc, size_t *token_index) {
 }
 
 AstNode *ast_parse(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner,
-        ErrColor err_color, uint32_t *next_node_index)
+        ErrColor err_color, uint32_t *next_node_index, Arena *node_arena, CodeGen *g)
 {
     ParseContext pc = {0};
-    pc.void_buf = buf_create_from_str("void");
+    pc.void_buf = intern_buf(g, buf_create_from_str("void"));
     pc.empty_buf = buf_create_from_str("");
     pc.err_color = err_color;
     pc.owner = owner;
     pc.buf = buf;
     pc.tokens = tokens;
     pc.next_node_index = next_node_index;
+    pc.node_arena = node_arena;
+    pc.codegen = g;
     size_t token_index = 0;
     pc.root = ast_parse_root(&pc, &token_index);
     return pc.root;
 }
 
+// The parser keeps nothing on the stack that needs cleaning up, so a syntax
+// error can unwind it with longjmp. What was allocated stays in node_arena.
+AstNode *ast_parse_detached(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner,
+        Arena *node_arena, ZigList<AstNode *> *out_nodes, CodeGen *g)
+{
+    uint32_t next_node_index = 0;
+    jmp_buf error_jmp;
+
+    ParseContext pc = {0};
+    pc.void_buf = intern_buf(g, buf_create_from_str("void"));
+    pc.empty_buf = buf_create_from_str("");
+    pc.err_color = ErrColorOff;
+    pc.owner = owner;
+    pc.buf = buf;
+    pc.tokens = tokens;
+    pc.next_node_index = &next_node_index;
+    pc.node_arena = node_arena;
+    pc.codegen = g;
+    pc.created_nodes = out_nodes;
+    pc.error_jmp = &error_jmp;
+    if (setjmp(error_jmp) != 0)
+        return nullptr;
+    size_t token_index = 0;
+    return ast_parse_root(&pc, &token_index);
+}
+
 static void visit_field(AstNode **node, void (*visit)(AstNode **, void *context), void *context) {
     if (*node) {
         visit(node, context);
@@ -18,7 +18,14 @@ void ast_token_error(Token *token, const char *format, ...);
 
 // This function is provided by generated code, generated by parsergen.cpp
 AstNode * ast_parse(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner, ErrColor err_color,
-        uint32_t *next_node_index);
+        uint32_t *next_node_index, Arena *node_arena, CodeGen *g);
+
+// Parses on a thread other than the one doing semantic analysis. The nodes
+// are numbered from 0 and appended to out_nodes in creation order. Returns
+// nullptr on a syntax error instead of reporting it; ast_parse reports it
+// if the file is needed after all.
+AstNode *ast_parse_detached(Buf *buf, ZigList<Token> *tokens, ImportTableEntry *owner,
+        Arena *node_arena, ZigList<AstNode *> *out_nodes, CodeGen *g);
 
 void ast_print(AstNode *node, int indent);
 
@@ -293,6 +293,48 @@ void get_target_triple(Buf *triple, const ZigTarget *target) {
             ZigLLVMGetEnvironmentTypeName(target->env_type));
 }
 
+static LLVMTargetRef get_llvm_target(const ZigTarget *target, Buf *triple) {
+    get_target_triple(triple, target);
+    LLVMTargetRef target_ref;
+    char *err_msg = nullptr;
+    if (LLVMGetTargetFromTriple(buf_ptr(triple), &target_ref, &err_msg)) {
+        zig_panic("unable to create target based on: %s", buf_ptr(triple));
+    }
+    return target_ref;
+}
+
+bool target_has_cpu(const ZigTarget *target, const char *cpu) {
+    Buf triple = BUF_INIT;
+    LLVMTargetRef target_ref = get_llvm_target(target, &triple);
+    return ZigLLVMTargetHasCPU(target_ref, buf_ptr(&triple), cpu);
+}
+
+// features is a comma separated list of +feature and -feature flags, in the
+// form that LLVM takes them. Like LLVM, empty items are skipped, so the list
+// may be empty or have a trailing comma. On error, out_bad_flag is the flag
+// which has no sign or names no feature of the target.
+int parse_target_features(const ZigTarget *target, const char *features, Buf *out_bad_flag) {
+    Buf triple = BUF_INIT;
+    LLVMTargetRef target_ref = get_llvm_target(target, &triple);
+    const char *flag = features;
+    while (*flag != 0) {
+        const char *end = strchr(flag, ',');
+        size_t flag_len = (end == nullptr) ? strlen(flag) : (size_t)(end - flag);
+        if (flag_len != 0) {
+            buf_init_from_mem(out_bad_flag, flag, flag_len);
+            if (flag_len < 2 || (flag[0] != '+' && flag[0] != '-'))
+                return ErrorInvalidFormat;
+            if (!ZigLLVMTargetHasFeature(target_ref, buf_ptr(&triple), buf_ptr(out_bad_flag) + 1))
+                return ErrorInvalidFormat;
+        }
+        if (end == nullptr)
+            break;
+        flag = end + 1;
+    }
+    buf_resize(out_bad_flag, 0);
+    return ErrorNone;
+}
+
 static bool is_os_darwin(ZigTarget *target) {
     switch (target->os) {
         case ZigLLVM_Darwin:
@@ -68,6 +68,9 @@ void init_all_targets(void);
 
 void get_target_triple(Buf *triple, const ZigTarget *target);
 
+bool target_has_cpu(const ZigTarget *target, const char *cpu);
+int parse_target_features(const ZigTarget *target, const char *features, Buf *out_bad_flag);
+
 void resolve_target_object_format(ZigTarget *target);
 
 uint32_t target_c_type_size_in_bits(const ZigTarget *target, CIntType id);
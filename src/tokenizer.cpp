@@ -148,22 +148,103 @@ static const struct ZigKeyword zig_keywords[] = {
     {"while", TokenIdKeywordWhile},
 };
 
-bool is_zig_keyword(Buf *buf) {
-    for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
-        if (buf_eql_str(buf, zig_keywords[i].text)) {
-            return true;
+// Keywords are looked up with a perfect hash of their first two bytes, last
+// two bytes and length, which tells all of them apart. The slots are filled in
+// from zig_keywords when the program starts. If a new keyword collides with
+// another one that panics, and keyword_hash_multiplier needs to be changed.
+static const uint32_t keyword_hash_multiplier = 0xad26c051;
+static const uint32_t keyword_slot_bits = 7;
+
+static uint32_t keyword_hash(const char *mem, size_t len) {
+    assert(len >= 2);
+    uint32_t key = (uint32_t)(uint8_t)mem[0] | ((uint32_t)(uint8_t)mem[1] << 8) |
+        ((uint32_t)(uint8_t)mem[len - 2] << 16) | ((uint32_t)(uint8_t)mem[len - 1] << 24);
+    return ((key + (uint32_t)len) * keyword_hash_multiplier) >> (32 - keyword_slot_bits);
+}
+
+struct KeywordTable {
+    // 1 + the index into zig_keywords, or 0 for no keyword
+    uint8_t slots[1 << keyword_slot_bits];
+
+    KeywordTable() {
+        memset(slots, 0, sizeof(slots));
+        for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
+            const char *text = zig_keywords[i].text;
+            uint32_t slot = keyword_hash(text, strlen(text));
+            if (slots[slot] != 0) {
+                zig_panic("keywords '%s' and '%s' have the same hash", text, zig_keywords[slots[slot] - 1].text);
+            }
+            slots[slot] = (uint8_t)(i + 1);
         }
     }
-    return false;
+};
+
+static const KeywordTable keyword_table;
+
+static const ZigKeyword *find_keyword(const char *mem, size_t len) {
+    if (len < 2)
+        return nullptr;
+    uint8_t slot = keyword_table.slots[keyword_hash(mem, len)];
+    if (slot == 0)
+        return nullptr;
+    const ZigKeyword *keyword = &zig_keywords[slot - 1];
+    if (!mem_eql_str(mem, len, keyword->text))
+        return nullptr;
+    return keyword;
+}
+
+bool is_zig_keyword(Buf *buf) {
+    return find_keyword(buf_ptr(buf), buf_len(buf)) != nullptr;
+}
+
+enum CharClass {
+    CharClassSymbol = 0x1, // SYMBOL_CHAR
+    CharClassStringText = 0x2, // anything that a "" string may contain unescaped
+};
+
+static const uint8_t char_classes[256] = {
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2, 2,
+    2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 0, 2, 2, 3,
+    2, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+};
+
+// Returns the index of the first byte at or after pos that is not in the
+// class, or len. This is how the tokenizer gets over identifiers, string
+// contents and runs of spaces without going around its main loop per byte.
+static size_t skip_char_class(const char *src, size_t pos, size_t len, uint8_t char_class) {
+    while (pos < len && (char_classes[(uint8_t)src[pos]] & char_class))
+        pos += 1;
+    return pos;
+}
+
+static size_t skip_spaces(const char *src, size_t pos, size_t len) {
+    while (pos < len && src[pos] == ' ')
+        pos += 1;
+    return pos;
+}
+
+// memchr is vectorized by the C library, which makes this the fast way over
+// comments and \\ lines.
+static size_t find_newline(const char *src, size_t pos, size_t len) {
+    const char *newline = (const char *)memchr(src + pos, '\n', len - pos);
+    return (newline == nullptr) ? len : (size_t)(newline - src);
 }
 
 static bool is_symbol_char(uint8_t c) {
-    switch (c) {
-        case SYMBOL_CHAR:
-            return true;
-        default:
-            return false;
-    }
+    return char_classes[c] & CharClassSymbol;
 }
 
 enum TokenizeState {
@@ -223,15 +304,10 @@ struct Tokenize {
     Token *cur_tok;
     Tokenization *out;
     uint32_t radix;
-    int32_t exp_add_amt;
-    bool is_exp_negative;
-    bool is_num_lit_float;
     size_t char_code_index;
     size_t char_code_end;
     bool unicode;
     uint32_t char_code;
-    int exponent_in_bin_or_dec;
-    BigNum specified_exponent;
 };
 
 __attribute__ ((format (printf, 2, 3)))
@@ -254,23 +330,15 @@ static void tokenize_error(Tokenize *t, const char *format, ...) {
 
 static void set_token_id(Tokenize *t, Token *token, TokenId id) {
     token->id = id;
-
-    if (id == TokenIdNumberLiteral) {
-        token->data.num_lit.overflow = false;
-    } else if (id == TokenIdStringLiteral || id == TokenIdSymbol) {
-        memset(&token->data.str_lit.str, 0, sizeof(Buf));
-        buf_resize(&token->data.str_lit.str, 0);
-        token->data.str_lit.is_c_str = false;
-    }
 }
 
 static void begin_token(Tokenize *t, TokenId id) {
     assert(!t->cur_tok);
     t->tokens->add_one();
     Token *token = &t->tokens->last();
-    token->start_line = t->line;
-    token->start_column = t->column;
-    token->start_pos = t->pos;
+    token->start_line = (uint32_t)t->line;
+    token->start_column = (uint32_t)t->column;
+    token->start_pos = (uint32_t)t->pos;
 
     set_token_id(t, token, id);
 
@@ -282,83 +350,16 @@ static void cancel_token(Tokenize *t) {
     t->cur_tok = nullptr;
 }
 
-static void end_float_token(Tokenize *t) {
-    t->cur_tok->data.num_lit.bignum.kind = BigNumKindFloat;
-
-    if (t->radix == 10) {
-        char *str_begin = buf_ptr(t->buf) + t->cur_tok->start_pos;
-        char *str_end;
-        errno = 0;
-        t->cur_tok->data.num_lit.bignum.data.x_float = strtod(str_begin, &str_end);
-        if (errno) {
-            t->cur_tok->data.num_lit.overflow = true;
-            return;
-        }
-        assert(str_end <= buf_ptr(t->buf) + t->cur_tok->end_pos);
-        return;
-    }
-
-
-    if (t->specified_exponent.data.x_uint >= INT_MAX) {
-        t->cur_tok->data.num_lit.overflow = true;
-        return;
-    }
-
-    int64_t specified_exponent = t->specified_exponent.data.x_uint;
-    if (t->is_exp_negative) {
-        specified_exponent = -specified_exponent;
-    }
-    t->exponent_in_bin_or_dec = (int)(t->exponent_in_bin_or_dec + specified_exponent);
-
-    uint64_t significand = t->cur_tok->data.num_lit.bignum.data.x_uint;
-    uint64_t significand_bits;
-    uint64_t exponent_bits;
-    if (significand == 0) {
-        // 0 is all 0's
-        significand_bits = 0;
-        exponent_bits = 0;
-    } else {
-        // normalize the significand
-        if (t->radix == 10) {
-            zig_panic("TODO: decimal floats");
-        } else {
-            int significand_magnitude_in_bin = __builtin_clzll(1) - __builtin_clzll(significand);
-            t->exponent_in_bin_or_dec += significand_magnitude_in_bin;
-            if (!(-1023 <= t->exponent_in_bin_or_dec && t->exponent_in_bin_or_dec < 1023)) {
-                t->cur_tok->data.num_lit.overflow = true;
-                return;
-            } else {
-                // this should chop off exactly one 1 bit from the top.
-                significand_bits = ((uint64_t)significand << (52 - significand_magnitude_in_bin)) & 0xfffffffffffffULL;
-                exponent_bits = t->exponent_in_bin_or_dec + 1023;
-            }
-        }
-    }
-    uint64_t double_bits = (exponent_bits << 52) | significand_bits;
-    safe_memcpy(&t->cur_tok->data.num_lit.bignum.data.x_float, (double *)&double_bits, 1);
-}
-
 static void end_token(Tokenize *t) {
     assert(t->cur_tok);
-    t->cur_tok->end_pos = t->pos + 1;
-
-    if (t->cur_tok->id == TokenIdNumberLiteral) {
-        if (t->cur_tok->data.num_lit.overflow) {
-            return;
-        }
-        if (t->is_num_lit_float) {
-            end_float_token(t);
-        }
-    } else if (t->cur_tok->id == TokenIdSymbol) {
-        char *token_mem = buf_ptr(t->buf) + t->cur_tok->start_pos;
-        int token_len = (int)(t->cur_tok->end_pos - t->cur_tok->start_pos);
+    // tokens that run into the end of the file end with it
+    t->cur_tok->end_pos = (uint32_t)min(t->pos + 1, buf_len(t->buf));
 
-        for (size_t i = 0; i < array_length(zig_keywords); i += 1) {
-            if (mem_eql_str(token_mem, token_len, zig_keywords[i].text)) {
-                t->cur_tok->id = zig_keywords[i].token_id;
-                break;
-            }
-        }
+    if (t->cur_tok->id == TokenIdSymbol) {
+        const ZigKeyword *keyword = find_keyword(buf_ptr(t->buf) + t->cur_tok->start_pos,
+                t->cur_tok->end_pos - t->cur_tok->start_pos);
+        if (keyword != nullptr)
+            t->cur_tok->id = keyword->token_id;
     }
 
     t->cur_tok = nullptr;
@@ -385,18 +386,37 @@ static uint32_t get_digit_value(uint8_t c) {
     return UINT32_MAX;
 }
 
-static void handle_string_escape(Tokenize *t, uint8_t c) {
+static void end_string_escape(Tokenize *t) {
     if (t->cur_tok->id == TokenIdCharLiteral) {
-        t->cur_tok->data.char_lit.c = c;
         t->state = TokenizeStateCharLiteralEnd;
     } else if (t->cur_tok->id == TokenIdStringLiteral || t->cur_tok->id == TokenIdSymbol) {
-        buf_append_char(&t->cur_tok->data.str_lit.str, c);
         t->state = TokenizeStateString;
     } else {
         zig_unreachable();
     }
 }
 
+static bool is_c_str_token(Tokenize *t) {
+    return buf_ptr(t->buf)[t->cur_tok->start_pos] == 'c';
+}
+
+// Moves onto the byte before end as if the tokenizer had gone through the
+// bytes one at a time. They must not contain a newline.
+static void skip_until(Tokenize *t, size_t end) {
+    assert(end > t->pos);
+    t->column += (int)(end - 1 - t->pos);
+    t->pos = end - 1;
+}
+
+static void find_line_offsets(Buf *buf, ZigList<size_t> *line_offsets) {
+    const char *src = buf_ptr(buf);
+    size_t len = buf_len(buf);
+    line_offsets->append(0);
+    for (size_t pos = find_newline(src, 0, len); pos < len; pos = find_newline(src, pos + 1, len)) {
+        line_offsets->append(pos + 1);
+    }
+}
+
 void tokenize(Buf *buf, Tokenization *out) {
     Tokenize t = {0};
     t.out = out;
@@ -404,47 +424,44 @@ void tokenize(Buf *buf, Tokenization *out) {
     t.buf = buf;
 
     out->line_offsets = allocate<ZigList<size_t>>(1);
+    find_line_offsets(buf, out->line_offsets);
 
-    out->line_offsets->append(0);
-    for (t.pos = 0; t.pos < buf_len(t.buf); t.pos += 1) {
-        uint8_t c = buf_ptr(t.buf)[t.pos];
+    if (buf_len(t.buf) >= UINT32_MAX) {
+        tokenize_error(&t, "source file too large");
+        return;
+    }
+    const char *src = buf_ptr(t.buf);
+    size_t len = buf_len(t.buf);
+    for (t.pos = 0; t.pos < len; t.pos += 1) {
+        uint8_t c = src[t.pos];
         switch (t.state) {
             case TokenizeStateError:
                 break;
             case TokenizeStateStart:
                 switch (c) {
-                    case WHITESPACE:
+                    case ' ':
+                        skip_until(&t, skip_spaces(src, t.pos + 1, len));
+                        break;
+                    case '\n':
                         break;
                     case 'c':
                         t.state = TokenizeStateSymbolFirstC;
                         begin_token(&t, TokenIdSymbol);
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     case ALPHA_EXCEPT_C:
                     case '_':
                         t.state = TokenizeStateSymbol;
                         begin_token(&t, TokenIdSymbol);
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     case '0':
                         t.state = TokenizeStateZero;
                         begin_token(&t, TokenIdNumberLiteral);
                         t.radix = 10;
-                        t.exp_add_amt = 1;
-                        t.exponent_in_bin_or_dec = 0;
-                        t.is_num_lit_float = false;
-                        bignum_init_unsigned(&t.cur_tok->data.num_lit.bignum, 0);
-                        bignum_init_unsigned(&t.specified_exponent, 0);
                         break;
                     case DIGIT_NON_ZERO:
                         t.state = TokenizeStateNumber;
                         begin_token(&t, TokenIdNumberLiteral);
                         t.radix = 10;
-                        t.exp_add_amt = 1;
-                        t.exponent_in_bin_or_dec = 0;
-                        t.is_num_lit_float = false;
-                        bignum_init_unsigned(&t.cur_tok->data.num_lit.bignum, get_digit_value(c));
-                        bignum_init_unsigned(&t.specified_exponent, 0);
                         break;
                     case '"':
                         begin_token(&t, TokenIdStringLiteral);
@@ -901,7 +918,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateLineStringEnd;
                         break;
                     default:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_until(&t, find_newline(src, t.pos + 1, len));
                         break;
                 }
                 break;
@@ -910,7 +927,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                     case WHITESPACE:
                         break;
                     case 'c':
-                        if (!t.cur_tok->data.str_lit.is_c_str) {
+                        if (!is_c_str_token(&t)) {
                             t.pos -= 1;
                             end_token(&t);
                             t.state = TokenizeStateStart;
@@ -919,7 +936,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateLineStringContinueC;
                         break;
                     case '\\':
-                        if (t.cur_tok->data.str_lit.is_c_str) {
+                        if (is_c_str_token(&t)) {
                             tokenize_error(&t, "invalid character: '%c'", c);
                         }
                         t.state = TokenizeStateLineStringContinue;
@@ -947,7 +964,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                 switch (c) {
                     case '\\':
                         t.state = TokenizeStateLineString;
-                        buf_append_char(&t.cur_tok->data.str_lit.str, '\n');
                         break;
                     default:
                         tokenize_error(&t, "invalid character: '%c'", c);
@@ -960,7 +976,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         break;
                     default:
-                        // do nothing
+                        skip_until(&t, find_newline(src, t.pos + 1, len));
                         break;
                 }
                 break;
@@ -968,17 +984,14 @@ void tokenize(Buf *buf, Tokenization *out) {
                 switch (c) {
                     case '"':
                         set_token_id(&t, t.cur_tok, TokenIdStringLiteral);
-                        t.cur_tok->data.str_lit.is_c_str = true;
                         t.state = TokenizeStateString;
                         break;
                     case '\\':
                         set_token_id(&t, t.cur_tok, TokenIdStringLiteral);
-                        t.cur_tok->data.str_lit.is_c_str = true;
                         t.state = TokenizeStateSawBackslash;
                         break;
                     case SYMBOL_CHAR:
                         t.state = TokenizeStateSymbol;
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
                         break;
                     default:
                         t.pos -= 1;
@@ -1003,7 +1016,7 @@ void tokenize(Buf *buf, Tokenization *out) {
             case TokenizeStateSymbol:
                 switch (c) {
                     case SYMBOL_CHAR:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_until(&t, skip_char_class(src, t.pos + 1, len, CharClassSymbol));
                         break;
                     default:
                         t.pos -= 1;
@@ -1025,7 +1038,7 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStringEscape;
                         break;
                     default:
-                        buf_append_char(&t.cur_tok->data.str_lit.str, c);
+                        skip_until(&t, skip_char_class(src, t.pos + 1, len, CharClassStringText));
                         break;
                 }
                 break;
@@ -1056,22 +1069,22 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.unicode = true;
                         break;
                     case 'n':
-                        handle_string_escape(&t, '\n');
+                        end_string_escape(&t);
                         break;
                     case 'r':
-                        handle_string_escape(&t, '\r');
+                        end_string_escape(&t);
                         break;
                     case '\\':
-                        handle_string_escape(&t, '\\');
+                        end_string_escape(&t);
                         break;
                     case 't':
-                        handle_string_escape(&t, '\t');
+                        end_string_escape(&t);
                         break;
                     case '\'':
-                        handle_string_escape(&t, '\'');
+                        end_string_escape(&t);
                         break;
                     case '"':
-                        handle_string_escape(&t, '\"');
+                        end_string_escape(&t);
                         break;
                     default:
                         tokenize_error(&t, "invalid character: '%c'", c);
@@ -1088,33 +1101,15 @@ void tokenize(Buf *buf, Tokenization *out) {
                     t.char_code_index += 1;
 
                     if (t.char_code_index >= t.char_code_end) {
+                        // the bytes are only produced by token_decode_str, this
+                        // checks that there will be some
                         if (t.unicode) {
                             if (t.char_code <= 0x7f) {
-                                // 00000000 00000000 00000000 0xxxxxxx
-                                handle_string_escape(&t, (uint8_t)t.char_code);
+                                end_string_escape(&t);
                             } else if (t.cur_tok->id == TokenIdCharLiteral) {
                                 tokenize_error(&t, "unicode value too large for character literal: %x", t.char_code);
-                            } else if (t.char_code <= 0x7ff) {
-                                // 00000000 00000000 00000xxx xx000000
-                                handle_string_escape(&t, (uint8_t)(0xc0 | (t.char_code >> 6)));
-                                // 00000000 00000000 00000000 00xxxxxx
-                                handle_string_escape(&t, (uint8_t)(0x80 | (t.char_code & 0x3f)));
-                            } else if (t.char_code <= 0xffff) {
-                                // 00000000 00000000 xxxx0000 00000000
-                                handle_string_escape(&t, (uint8_t)(0xe0 | (t.char_code >> 12)));
-                                // 00000000 00000000 0000xxxx xx000000
-                                handle_string_escape(&t, (uint8_t)(0x80 | ((t.char_code >> 6) & 0x3f)));
-                                // 00000000 00000000 00000000 00xxxxxx
-                                handle_string_escape(&t, (uint8_t)(0x80 | (t.char_code & 0x3f)));
                             } else if (t.char_code <= 0x10ffff) {
-                                // 00000000 000xxx00 00000000 00000000
-                                handle_string_escape(&t, (uint8_t)(0xf0 | (t.char_code >> 18)));
-                                // 00000000 000000xx xxxx0000 00000000
-                                handle_string_escape(&t, (uint8_t)(0x80 | ((t.char_code >> 12) & 0x3f)));
-                                // 00000000 00000000 0000xxxx xx000000
-                                handle_string_escape(&t, (uint8_t)(0x80 | ((t.char_code >> 6) & 0x3f)));
-                                // 00000000 00000000 00000000 00xxxxxx
-                                handle_string_escape(&t, (uint8_t)(0x80 | (t.char_code & 0x3f)));
+                                end_string_escape(&t);
                             } else {
                                 tokenize_error(&t, "unicode value out of range: %x", t.char_code);
                             }
@@ -1122,8 +1117,9 @@ void tokenize(Buf *buf, Tokenization *out) {
                             if (t.cur_tok->id == TokenIdCharLiteral && t.char_code > UINT8_MAX) {
                                 tokenize_error(&t, "value too large for character literal: '%x'",
                                         t.char_code);
+                            } else {
+                                end_string_escape(&t);
                             }
-                            handle_string_escape(&t, (uint8_t)t.char_code);
                         }
                     }
                 }
@@ -1136,7 +1132,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStringEscape;
                         break;
                     default:
-                        t.cur_tok->data.char_lit.c = c;
                         t.state = TokenizeStateCharLiteralEnd;
                         break;
                 }
@@ -1159,12 +1154,10 @@ void tokenize(Buf *buf, Tokenization *out) {
                         break;
                     case 'o':
                         t.radix = 8;
-                        t.exp_add_amt = 3;
                         t.state = TokenizeStateNumber;
                         break;
                     case 'x':
                         t.radix = 16;
-                        t.exp_add_amt = 4;
                         t.state = TokenizeStateNumber;
                         break;
                     default:
@@ -1182,7 +1175,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                     }
                     if (is_exponent_signifier(c, t.radix)) {
                         t.state = TokenizeStateFloatExponentUnsigned;
-                        t.is_num_lit_float = true;
                         break;
                     }
                     uint32_t digit_value = get_digit_value(c);
@@ -1196,10 +1188,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         continue;
                     }
-                    t.cur_tok->data.num_lit.overflow = t.cur_tok->data.num_lit.overflow ||
-                        bignum_multiply_by_scalar(&t.cur_tok->data.num_lit.bignum, t.radix);
-                    t.cur_tok->data.num_lit.overflow = t.cur_tok->data.num_lit.overflow ||
-                        bignum_increment_by_scalar(&t.cur_tok->data.num_lit.bignum, digit_value);
                     break;
                 }
             case TokenizeStateNumberDot:
@@ -1211,7 +1199,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                 }
                 t.pos -= 1;
                 t.state = TokenizeStateFloatFraction;
-                t.is_num_lit_float = true;
                 continue;
             case TokenizeStateFloatFraction:
                 {
@@ -1230,32 +1217,19 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         continue;
                     }
-                    t.exponent_in_bin_or_dec -= t.exp_add_amt;
-                    if (t.radix == 10) {
-                        // For now we use strtod to parse decimal floats, so we just have to get to the
-                        // end of the token.
-                        break;
-                    }
-                    t.cur_tok->data.num_lit.overflow = t.cur_tok->data.num_lit.overflow ||
-                        bignum_multiply_by_scalar(&t.cur_tok->data.num_lit.bignum, t.radix);
-                    t.cur_tok->data.num_lit.overflow = t.cur_tok->data.num_lit.overflow ||
-                        bignum_increment_by_scalar(&t.cur_tok->data.num_lit.bignum, digit_value);
                     break;
                 }
             case TokenizeStateFloatExponentUnsigned:
                 switch (c) {
                     case '+':
-                        t.is_exp_negative = false;
                         t.state = TokenizeStateFloatExponentNumber;
                         break;
                     case '-':
-                        t.is_exp_negative = true;
                         t.state = TokenizeStateFloatExponentNumber;
                         break;
                     default:
                         // reinterpret as normal exponent number
                         t.pos -= 1;
-                        t.is_exp_negative = false;
                         t.state = TokenizeStateFloatExponentNumber;
                         continue;
                 }
@@ -1273,15 +1247,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                         t.state = TokenizeStateStart;
                         continue;
                     }
-                    if (t.radix == 10) {
-                        // For now we use strtod to parse decimal floats, so we just have to get to the
-                        // end of the token.
-                        break;
-                    }
-                    t.cur_tok->data.num_lit.overflow = t.cur_tok->data.num_lit.overflow ||
-                        bignum_multiply_by_scalar(&t.specified_exponent, 10);
-                    t.cur_tok->data.num_lit.overflow = t.cur_tok->data.num_lit.overflow ||
-                        bignum_increment_by_scalar(&t.specified_exponent, digit_value);
                 }
                 break;
             case TokenizeStateSawDash:
@@ -1323,7 +1288,6 @@ void tokenize(Buf *buf, Tokenization *out) {
                 break;
         }
         if (c == '\n') {
-            out->line_offsets->append(t.pos + 1);
             t.line += 1;
             t.column = 0;
         } else {
@@ -1525,13 +1489,296 @@ void print_tokens(Buf *buf, ZigList<Token> *tokens) {
     for (size_t i = 0; i < tokens->length; i += 1) {
         Token *token = &tokens->at(i);
         fprintf(stderr, "%s ", token_name(token->id));
-        if (token->start_pos != SIZE_MAX) {
-            fwrite(buf_ptr(buf) + token->start_pos, 1, token->end_pos - token->start_pos, stderr);
-        }
+        fwrite(buf_ptr(buf) + token->start_pos, 1, token->end_pos - token->start_pos, stderr);
         fprintf(stderr, "\n");
     }
 }
 
+// Decodes the escape sequence that starts just past the backslash at *p into
+// out_bytes, which must have room for 4, and returns how many bytes it is.
+static size_t decode_escape(const char **p, uint8_t *out_bytes) {
+    char c = **p;
+    *p += 1;
+    size_t digit_count;
+    bool unicode;
+    switch (c) {
+        case 'n':
+            out_bytes[0] = '\n';
+            return 1;
+        case 'r':
+            out_bytes[0] = '\r';
+            return 1;
+        case 't':
+            out_bytes[0] = '\t';
+            return 1;
+        case 'x':
+            digit_count = 2;
+            unicode = false;
+            break;
+        case 'u':
+            digit_count = 4;
+            unicode = true;
+            break;
+        case 'U':
+            digit_count = 6;
+            unicode = true;
+            break;
+        default:
+            // '\\', '\'' and '"'
+            out_bytes[0] = (uint8_t)c;
+            return 1;
+    }
+
+    uint32_t char_code = 0;
+    for (size_t i = 0; i < digit_count; i += 1) {
+        char_code = char_code * 16 + get_digit_value((uint8_t)**p);
+        *p += 1;
+    }
+
+    if (!unicode || char_code <= 0x7f) {
+        // 00000000 00000000 00000000 0xxxxxxx
+        out_bytes[0] = (uint8_t)char_code;
+        return 1;
+    } else if (char_code <= 0x7ff) {
+        // 00000000 00000000 00000xxx xx000000
+        out_bytes[0] = (uint8_t)(0xc0 | (char_code >> 6));
+        // 00000000 00000000 00000000 00xxxxxx
+        out_bytes[1] = (uint8_t)(0x80 | (char_code & 0x3f));
+        return 2;
+    } else if (char_code <= 0xffff) {
+        // 00000000 00000000 xxxx0000 00000000
+        out_bytes[0] = (uint8_t)(0xe0 | (char_code >> 12));
+        // 00000000 00000000 0000xxxx xx000000
+        out_bytes[1] = (uint8_t)(0x80 | ((char_code >> 6) & 0x3f));
+        // 00000000 00000000 00000000 00xxxxxx
+        out_bytes[2] = (uint8_t)(0x80 | (char_code & 0x3f));
+        return 3;
+    } else {
+        assert(char_code <= 0x10ffff);
+        // 00000000 000xxx00 00000000 00000000
+        out_bytes[0] = (uint8_t)(0xf0 | (char_code >> 18));
+        // 00000000 000000xx xxxx0000 00000000
+        out_bytes[1] = (uint8_t)(0x80 | ((char_code >> 12) & 0x3f));
+        // 00000000 00000000 0000xxxx xx000000
+        out_bytes[2] = (uint8_t)(0x80 | ((char_code >> 6) & 0x3f));
+        // 00000000 00000000 00000000 00xxxxxx
+        out_bytes[3] = (uint8_t)(0x80 | (char_code & 0x3f));
+        return 4;
+    }
+}
+
+// the text between the quotes of "..." or @"..."
+static void decode_quoted(const char *p, const char *end, Buf *out) {
+    for (;;) {
+        const char *backslash = (const char *)memchr(p, '\\', end - p);
+        if (backslash == nullptr) {
+            buf_append_mem(out, p, end - p);
+            return;
+        }
+        buf_append_mem(out, p, backslash - p);
+        p = backslash + 1;
+        uint8_t bytes[4];
+        size_t byte_count = decode_escape(&p, bytes);
+        buf_append_mem(out, (const char *)bytes, byte_count);
+    }
+}
+
+// \\ lines, starting at the first backslash. Each line of a c string after
+// the first one starts with c\\ instead.
+static void decode_line_string(const char *p, const char *end, bool is_c_str, Buf *out) {
+    for (;;) {
+        assert(p[0] == '\\' && p[1] == '\\');
+        p += 2;
+        const char *line_end = (const char *)memchr(p, '\n', end - p);
+        if (line_end == nullptr) {
+            buf_append_mem(out, p, end - p);
+            return;
+        }
+        buf_append_mem(out, p, line_end - p);
+
+        p = line_end + 1;
+        while (p < end && (*p == ' ' || *p == '\n'))
+            p += 1;
+        if (is_c_str) {
+            if (p == end || *p != 'c')
+                return;
+            p += 1;
+        }
+        if (p == end || *p != '\\')
+            return;
+        buf_append_char(out, '\n');
+    }
+}
+
+void token_decode_str(Buf *source, Token *token, Buf *out) {
+    assert(token->id == TokenIdStringLiteral || token->id == TokenIdSymbol);
+    const char *p = buf_ptr(source) + token->start_pos;
+    const char *end = buf_ptr(source) + token->end_pos;
+    buf_resize(out, 0);
+
+    if (token->id == TokenIdSymbol) {
+        if (*p == '@') {
+            decode_quoted(p + 2, end - 1, out);
+        } else {
+            buf_append_mem(out, p, end - p);
+        }
+        return;
+    }
+
+    bool is_c_str = (*p == 'c');
+    if (is_c_str)
+        p += 1;
+    if (*p == '"') {
+        decode_quoted(p + 1, end - 1, out);
+    } else {
+        decode_line_string(p, end, is_c_str, out);
+    }
+}
+
+bool token_is_c_str(Buf *source, Token *token) {
+    assert(token->id == TokenIdStringLiteral);
+    return buf_ptr(source)[token->start_pos] == 'c';
+}
+
+// A symbol that is spelled the same as its name, unlike @"...".
+bool token_is_plain_symbol(Buf *source, Token *token) {
+    assert(token->id == TokenIdSymbol);
+    return buf_ptr(source)[token->start_pos] != '@';
+}
+
+uint8_t token_decode_char(Buf *source, Token *token) {
+    assert(token->id == TokenIdCharLiteral);
+    const char *p = buf_ptr(source) + token->start_pos + 1;
+    if (*p != '\\')
+        return (uint8_t)*p;
+    p += 1;
+    uint8_t bytes[4];
+    size_t byte_count = decode_escape(&p, bytes);
+    assert(byte_count == 1);
+    return bytes[0];
+}
+
+static bool decode_float(const char *str_begin, const char *str_end, uint32_t radix, int exponent_in_bin_or_dec,
+        BigNum *specified_exponent, bool is_exp_negative, BigNum *out)
+{
+    out->kind = BigNumKindFloat;
+
+    if (radix == 10) {
+        char *strtod_end;
+        errno = 0;
+        out->data.x_float = strtod(str_begin, &strtod_end);
+        if (errno)
+            return true;
+        assert(strtod_end <= str_end);
+        return false;
+    }
+
+    if (specified_exponent->data.x_uint >= INT_MAX)
+        return true;
+
+    int64_t specified_exponent_value = specified_exponent->data.x_uint;
+    if (is_exp_negative) {
+        specified_exponent_value = -specified_exponent_value;
+    }
+    exponent_in_bin_or_dec = (int)(exponent_in_bin_or_dec + specified_exponent_value);
+
+    uint64_t significand = out->data.x_uint;
+    uint64_t significand_bits;
+    uint64_t exponent_bits;
+    if (significand == 0) {
+        // 0 is all 0's
+        significand_bits = 0;
+        exponent_bits = 0;
+    } else {
+        // normalize the significand
+        int significand_magnitude_in_bin = __builtin_clzll(1) - __builtin_clzll(significand);
+        exponent_in_bin_or_dec += significand_magnitude_in_bin;
+        if (!(-1023 <= exponent_in_bin_or_dec && exponent_in_bin_or_dec < 1023))
+            return true;
+        // this should chop off exactly one 1 bit from the top.
+        significand_bits = ((uint64_t)significand << (52 - significand_magnitude_in_bin)) & 0xfffffffffffffULL;
+        exponent_bits = exponent_in_bin_or_dec + 1023;
+    }
+    uint64_t double_bits = (exponent_bits << 52) | significand_bits;
+    safe_memcpy(&out->data.x_float, (double *)&double_bits, 1);
+    return false;
+}
+
+// Returns true if the literal does not fit in a uint64_t or double without
+// losing data.
+bool token_decode_number(Buf *source, Token *token, BigNum *out) {
+    assert(token->id == TokenIdNumberLiteral);
+    const char *str_begin = buf_ptr(source) + token->start_pos;
+    const char *end = buf_ptr(source) + token->end_pos;
+    const char *p = str_begin;
+
+    uint32_t radix = 10;
+    int exp_add_amt = 1;
+    if (end - p >= 2 && p[0] == '0') {
+        switch (p[1]) {
+            case 'b':
+                radix = 2;
+                p += 2;
+                break;
+            case 'o':
+                radix = 8;
+                exp_add_amt = 3;
+                p += 2;
+                break;
+            case 'x':
+                radix = 16;
+                exp_add_amt = 4;
+                p += 2;
+                break;
+        }
+    }
+
+    bool overflow = false;
+    bignum_init_unsigned(out, 0);
+    for (; p < end && *p != '.' && !is_exponent_signifier(*p, radix); p += 1) {
+        overflow = overflow || bignum_multiply_by_scalar(out, radix);
+        overflow = overflow || bignum_increment_by_scalar(out, get_digit_value(*p));
+    }
+
+    bool is_float = false;
+    int exponent_in_bin_or_dec = 0;
+    if (p < end && *p == '.') {
+        is_float = true;
+        for (p += 1; p < end && !is_exponent_signifier(*p, radix); p += 1) {
+            exponent_in_bin_or_dec -= exp_add_amt;
+            // For now we use strtod to parse decimal floats, so we just have
+            // to get to the end of the token.
+            if (radix == 10)
+                continue;
+            overflow = overflow || bignum_multiply_by_scalar(out, radix);
+            overflow = overflow || bignum_increment_by_scalar(out, get_digit_value(*p));
+        }
+    }
+
+    BigNum specified_exponent;
+    bignum_init_unsigned(&specified_exponent, 0);
+    bool is_exp_negative = false;
+    if (p < end) {
+        assert(is_exponent_signifier(*p, radix));
+        is_float = true;
+        p += 1;
+        if (p < end && (*p == '+' || *p == '-')) {
+            is_exp_negative = (*p == '-');
+            p += 1;
+        }
+        for (; p < end; p += 1) {
+            if (radix == 10)
+                continue;
+            overflow = overflow || bignum_multiply_by_scalar(&specified_exponent, 10);
+            overflow = overflow || bignum_increment_by_scalar(&specified_exponent, get_digit_value(*p));
+        }
+    }
+
+    if (overflow || !is_float)
+        return overflow;
+    return decode_float(str_begin, end, radix, exponent_in_bin_or_dec, &specified_exponent, is_exp_negative, out);
+}
+
 bool valid_symbol_starter(uint8_t c) {
     switch (c) {
         case SYMBOL_START:
@@ -118,39 +118,15 @@ enum TokenId {
     TokenIdTimesPercentEq,
 };
 
-struct TokenNumLit {
-    BigNum bignum;
-    // overflow is true if when parsing the number, we discovered it would not
-    // fit without losing data in a uint64_t or double
-    bool overflow;
-};
-
-struct TokenStrLit {
-    Buf str;
-    bool is_c_str;
-};
-
-struct TokenCharLit {
-    uint8_t c;
-};
-
+// A token is only its kind and where it is in the source. The value of a
+// symbol, string, character or number literal is decoded from the source with
+// the token_* functions below when the parser needs it.
 struct Token {
     TokenId id;
-    size_t start_pos;
-    size_t end_pos;
-    size_t start_line;
-    size_t start_column;
-
-    union {
-        // TokenIdNumberLiteral
-        TokenNumLit num_lit;
-
-        // TokenIdStringLiteral or TokenIdSymbol
-        TokenStrLit str_lit;
-
-        // TokenIdCharLiteral
-        TokenCharLit char_lit;
-    } data;
+    uint32_t start_pos;
+    uint32_t end_pos;
+    uint32_t start_line;
+    uint32_t start_column;
 };
 
 struct Tokenization {
@@ -169,6 +145,13 @@ void print_tokens(Buf *buf, ZigList<Token> *tokens);
 
 const char * token_name(TokenId id);
 
+// These may only be used on tokens that tokenize accepted from source.
+void token_decode_str(Buf *source, Token *token, Buf *out);
+bool token_is_c_str(Buf *source, Token *token);
+bool token_is_plain_symbol(Buf *source, Token *token);
+uint8_t token_decode_char(Buf *source, Token *token);
+bool token_decode_number(Buf *source, Token *token, BigNum *out);
+
 bool valid_symbol_starter(uint8_t c);
 bool is_zig_keyword(Buf *buf);
 
@@ -24,6 +24,8 @@
 
 #include <llvm/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Bitcode/BitcodeWriterPass.h>
+#include <llvm/CodeGen/ParallelCG.h>
 #include <llvm/IR/DIBuilder.h>
 #include <llvm/IR/DiagnosticInfo.h>
 #include <llvm/IR/IRBuilder.h>
@@ -33,10 +35,12 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/InitializePasses.h>
+#include <llvm/MC/MCSubtargetInfo.h>
 #include <llvm/MC/SubtargetFeature.h>
 #include <llvm/PassRegistry.h>
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/TargetParser.h>
+#include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Support/COFF.h>
 #include <llvm/Target/TargetMachine.h>
@@ -44,6 +48,7 @@
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 
 #include <lld/Driver/Driver.h>
 
@@ -74,6 +79,39 @@ char *ZigLLVMGetNativeFeatures(void) {
     return strdup(features.getString().c_str());
 }
 
+bool ZigLLVMTargetHasCPU(LLVMTargetRef target_ref, const char *triple, const char *cpu) {
+    const Target *target = reinterpret_cast<const Target *>(target_ref);
+    std::unique_ptr<MCSubtargetInfo> sti(target->createMCSubtargetInfo(triple, "", ""));
+    return sti != nullptr && sti->isCPUStringValid(cpu);
+}
+
+// LLVM warns about and ignores features it does not know, so a feature is
+// known if enabling it and disabling it give different feature bits.
+bool ZigLLVMTargetHasFeature(LLVMTargetRef target_ref, const char *triple, const char *feature) {
+    const Target *target = reinterpret_cast<const Target *>(target_ref);
+    std::unique_ptr<MCSubtargetInfo> sti(target->createMCSubtargetInfo(triple, "", ""));
+    if (sti == nullptr)
+        return false;
+    FeatureBitset enabled = sti->ApplyFeatureFlag(std::string("+") + feature);
+    FeatureBitset disabled = sti->ApplyFeatureFlag(std::string("-") + feature);
+    return enabled != disabled;
+}
+
+// Whether the code generated by the target machine may use feature, which
+// is the case if enabling it changes nothing and disabling it does.
+bool ZigLLVMTargetMachineHasFeature(LLVMTargetMachineRef targ_machine_ref, const char *feature) {
+    TargetMachine *target_machine = reinterpret_cast<TargetMachine*>(targ_machine_ref);
+    std::unique_ptr<MCSubtargetInfo> sti(target_machine->getTarget().createMCSubtargetInfo(
+                target_machine->getTargetTriple().str(), target_machine->getTargetCPU(),
+                target_machine->getTargetFeatureString()));
+    if (sti == nullptr)
+        return false;
+    FeatureBitset bits = sti->getFeatureBits();
+    if (sti->ApplyFeatureFlag(std::string("+") + feature) != bits)
+        return false;
+    return sti->ApplyFeatureFlag(std::string("-") + feature) != bits;
+}
+
 static void addDiscriminatorsPass(const PassManagerBuilder &Builder, legacy::PassManagerBase &PM) {
   PM.add(createAddDiscriminatorsPass());
 }
@@ -87,27 +125,46 @@ static const bool assertions_on = false;
 bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
         const char *filename, LLVMCodeGenFileType file_type, char **error_message, bool is_debug)
 {
-    std::error_code EC;
-    raw_fd_ostream dest(filename, EC, sys::fs::F_None);
-    if (EC) {
-        *error_message = strdup(EC.message().c_str());
-        return true;
+    return ZigLLVMTargetMachineEmitToFiles(targ_machine_ref, module_ref, &filename, 1, file_type,
+            error_message, is_debug, false, false, nullptr, nullptr);
+}
+
+bool ZigLLVMTargetMachineEmitToFiles(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
+        const char **filenames, size_t filename_count, LLVMCodeGenFileType file_type, char **error_message,
+        bool is_debug, bool is_small, bool thin_lto, const char *profile_generate_path,
+        const char *profile_use_path)
+{
+    assert(filename_count >= 1);
+    assert(!thin_lto || filename_count == 1);
+    std::vector<std::unique_ptr<raw_fd_ostream>> dests;
+    for (size_t i = 0; i < filename_count; i += 1) {
+        std::error_code EC;
+        dests.emplace_back(new raw_fd_ostream(filenames[i], EC, sys::fs::F_None));
+        if (EC) {
+            *error_message = strdup(EC.message().c_str());
+            return true;
+        }
     }
     TargetMachine* target_machine = reinterpret_cast<TargetMachine*>(targ_machine_ref);
     target_machine->setO0WantsFastISel(true);
+    // one section per function and global, so that the linker can drop the
+    // unused ones
+    target_machine->Options.FunctionSections = is_small;
+    target_machine->Options.DataSections = is_small;
 
     Module* module = unwrap(module_ref);
 
     PassManagerBuilder *PMBuilder = new PassManagerBuilder();
     PMBuilder->OptLevel = target_machine->getOptLevel();
-    PMBuilder->SizeLevel = 0;
+    // like -Oz, and without the passes that trade size for speed
+    PMBuilder->SizeLevel = is_small ? 2 : 0;
 
     PMBuilder->DisableTailCalls = is_debug;
     PMBuilder->DisableUnitAtATime = is_debug;
-    PMBuilder->DisableUnrollLoops = is_debug;
-    PMBuilder->BBVectorize = !is_debug;
-    PMBuilder->SLPVectorize = !is_debug;
-    PMBuilder->LoopVectorize = !is_debug;
+    PMBuilder->DisableUnrollLoops = is_debug || is_small;
+    PMBuilder->BBVectorize = !is_debug && !is_small;
+    PMBuilder->SLPVectorize = !is_debug && !is_small;
+    PMBuilder->LoopVectorize = !is_debug && !is_small;
     PMBuilder->RerollLoops = !is_debug;
     PMBuilder->LoadCombine = !is_debug;
     PMBuilder->NewGVN = !is_debug;
@@ -116,8 +173,15 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
     PMBuilder->VerifyOutput = assertions_on;
     PMBuilder->MergeFunctions = !is_debug;
     PMBuilder->PrepareForLTO = false;
-    PMBuilder->PrepareForThinLTO = false;
+    PMBuilder->PrepareForThinLTO = thin_lto;
     PMBuilder->PerformThinLTO = false;
+    // the instrumentation counts how often each block runs and the profile
+    // runtime in std/special/profile.zig writes the counts out. the merged
+    // counts of such runs then guide block placement and inlining.
+    if (profile_generate_path != nullptr)
+        PMBuilder->PGOInstrGen = profile_generate_path;
+    if (profile_use_path != nullptr)
+        PMBuilder->PGOInstrUse = profile_use_path;
 
     TargetLibraryInfoImpl tlii(Triple(module->getTargetTriple()));
     PMBuilder->LibraryInfo = &tlii;
@@ -157,7 +221,13 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
             ft = TargetMachine::CGFT_ObjectFile;
             break;
     }
-    if (target_machine->addPassesToEmitFile(MPM, dest, ft)) {
+    // With more than one output, the module pipeline only optimizes and the
+    // machine code is emitted afterwards by splitCodeGen.
+    if (thin_lto) {
+        // the linker does the rest of the optimization and all of the codegen,
+        // using the summary to import functions across modules
+        MPM.add(createBitcodeWriterPass(*dests[0], false, true, true));
+    } else if (filename_count == 1 && target_machine->addPassesToEmitFile(MPM, *dests[0], ft)) {
         *error_message = strdup("TargetMachine can't emit a file of this type");
         return true;
     }
@@ -171,7 +241,32 @@ bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMM
 
     MPM.run(*module);
 
-    dest.flush();
+    if (filename_count > 1) {
+        // Split the optimized module into one partition per output and run
+        // instruction selection and emission for each on its own thread,
+        // with its own TargetMachine. The caller keeps using the original
+        // module, so the partitions are made from a copy of it. Locals stay
+        // local so that the partitions cannot clash with other objects.
+        const Target &target = target_machine->getTarget();
+        std::string triple = target_machine->getTargetTriple().str();
+        auto target_machine_factory = [&]() {
+            std::unique_ptr<TargetMachine> partition_machine(target.createTargetMachine(triple,
+                    target_machine->getTargetCPU(), target_machine->getTargetFeatureString(),
+                    target_machine->Options, target_machine->getRelocationModel(),
+                    target_machine->getCodeModel(), target_machine->getOptLevel()));
+            partition_machine->setO0WantsFastISel(true);
+            return partition_machine;
+        };
+        std::vector<raw_pwrite_stream *> streams;
+        for (size_t i = 0; i < filename_count; i += 1) {
+            streams.push_back(dests[i].get());
+        }
+        splitCodeGen(CloneModule(module), streams, {}, target_machine_factory, ft, true);
+    }
+
+    for (size_t i = 0; i < filename_count; i += 1) {
+        dests[i]->flush();
+    }
     return false;
 }
 
@@ -33,9 +33,20 @@ void ZigLLVMInitializeLowerIntrinsicsPass(LLVMPassRegistryRef R);
 
 char *ZigLLVMGetHostCPUName(void);
 char *ZigLLVMGetNativeFeatures(void);
+bool ZigLLVMTargetHasCPU(LLVMTargetRef target_ref, const char *triple, const char *cpu);
+bool ZigLLVMTargetHasFeature(LLVMTargetRef target_ref, const char *triple, const char *feature);
+bool ZigLLVMTargetMachineHasFeature(LLVMTargetMachineRef targ_machine_ref, const char *feature);
 
 bool ZigLLVMTargetMachineEmitToFile(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
         const char *filename, LLVMCodeGenFileType file_type, char **error_message, bool is_debug);
+// Emits filename_count objects that together make up the module, in parallel.
+// With thin_lto there is exactly one output, which is ThinLTO bitcode.
+// is_small optimizes for size instead of speed. profile_generate_path and
+// profile_use_path may be null; see CodeGen.
+bool ZigLLVMTargetMachineEmitToFiles(LLVMTargetMachineRef targ_machine_ref, LLVMModuleRef module_ref,
+        const char **filenames, size_t filename_count, LLVMCodeGenFileType file_type, char **error_message,
+        bool is_debug, bool is_small, bool thin_lto, const char *profile_generate_path,
+        const char *profile_use_path);
 
 LLVMValueRef ZigLLVMBuildCall(LLVMBuilderRef B, LLVMValueRef Fn, LLVMValueRef *Args,
         unsigned NumArgs, unsigned CC, bool always_inline, const char *Name);
@@ -413,15 +413,18 @@ pub const Builder = struct {
 
         const release_safe = self.option(bool, "release-safe", "optimizations on and safety on") ?? false;
         const release_fast = self.option(bool, "release-fast", "optimizations on and safety off") ?? false;
+        const release_small = self.option(bool, "release-small", "size optimizations on and safety off") ?? false;
 
-        const mode = if (release_safe and !release_fast) {
+        const mode = if (release_safe and !release_fast and !release_small) {
             builtin.Mode.ReleaseSafe
-        } else if (release_fast and !release_safe) {
+        } else if (release_fast and !release_safe and !release_small) {
             builtin.Mode.ReleaseFast
-        } else if (!release_fast and !release_safe) {
+        } else if (release_small and !release_safe and !release_fast) {
+            builtin.Mode.ReleaseSmall
+        } else if (!release_fast and !release_safe and !release_small) {
             builtin.Mode.Debug
         } else {
-            %%io.stderr.printf("Both -Drelease-safe and -Drelease-fast specified");
+            %%io.stderr.printf("More than one of -Drelease-safe, -Drelease-fast and -Drelease-small specified");
             self.markInvalidUserInput();
             builtin.Mode.Debug
         };
@@ -913,6 +916,7 @@ pub const LibExeObjStep = struct {
             builtin.Mode.Debug => {},
             builtin.Mode.ReleaseSafe => %%zig_args.append("--release-safe"),
             builtin.Mode.ReleaseFast => %%zig_args.append("--release-fast"),
+            builtin.Mode.ReleaseSmall => %%zig_args.append("--release-small"),
         }
 
         %%zig_args.append("--cache-dir");
@@ -1063,6 +1067,7 @@ pub const TestStep = struct {
             builtin.Mode.Debug => {},
             builtin.Mode.ReleaseSafe => %%zig_args.append("--release-safe"),
             builtin.Mode.ReleaseFast => %%zig_args.append("--release-fast"),
+            builtin.Mode.ReleaseSmall => %%zig_args.append("--release-small"),
         }
 
         if (self.filter) |filter| {
@@ -1289,6 +1294,9 @@ pub const CLibExeObjStep = struct {
             builtin.Mode.ReleaseFast => {
                 %%args.append("-O2");
             },
+            builtin.Mode.ReleaseSmall => {
+                %%args.append("-Oz");
+            },
         }
 
         for (self.include_dirs.toSliceConst()) |dir| {
@@ -36,7 +36,7 @@ export nakedcc fn _start() -> noreturn {
 
 fn windowsCallMainAndExit() -> noreturn {
     std.debug.user_main_fn = root.main;
-    root.main() %% std.os.windows.ExitProcess(1);
+    callRootMain() %% std.os.windows.ExitProcess(1);
     std.os.windows.ExitProcess(0);
 }
 
@@ -57,7 +57,18 @@ fn callMain(argc: usize, argv: &&u8, envp: &?&u8) -> %void {
 
     std.debug.user_main_fn = root.main;
 
-    return root.main();
+    return callRootMain();
+}
+
+fn callRootMain() -> %void {
+    const result = root.main();
+    if (builtin.profile_generate) {
+        @import("profile.zig").writeFile(builtin.profile_generate_path) %% |err| {
+            %%std.io.stderr.printf("unable to write profile {}: {}\n",
+                builtin.profile_generate_path, @errorName(err));
+        };
+    }
+    return result;
 }
 
 export fn main(c_argc: i32, c_argv: &&u8, c_envp: &?&u8) -> i32 {
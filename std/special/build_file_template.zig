@@ -4,11 +4,14 @@ const Mode = @import("builtin").Mode;
 pub fn build(b: &Builder) {
     const release_safe = b.option(bool, "--release-safe", "optimizations on and safety on") ?? false;
     const release_fast = b.option(bool, "--release-fast", "optimizations on and safety off") ?? false;
+    const release_small = b.option(bool, "--release-small", "size optimizations on and safety off") ?? false;
 
     const build_mode = if (release_safe) {
         Mode.ReleaseSafe
     } else if (release_fast) {
         Mode.ReleaseFast
+    } else if (release_small) {
+        Mode.ReleaseSmall
     } else {
         Mode.Debug
     };
@@ -0,0 +1,109 @@
+// The part of LLVM's profile runtime that builds with --profile-generate
+// need. bootstrap.zig calls writeFile when main returns, which writes the
+// counters in LLVM's raw profile format (version 4), for llvm-profdata to
+// merge into the file that --profile-use takes.
+//
+// The instrumentation is found through the __start_ and __stop_ symbols
+// that ELF linkers define for its sections, so only ELF targets are
+// supported.
+
+const std = @import("std");
+const io = std.io;
+const os = std.os;
+
+extern var __start___llvm_prf_data: u8;
+extern var __stop___llvm_prf_data: u8;
+extern var __start___llvm_prf_cnts: u8;
+extern var __stop___llvm_prf_cnts: u8;
+extern var __start___llvm_prf_names: u8;
+extern var __stop___llvm_prf_names: u8;
+
+// The instrumented module refers to this to pull the runtime in.
+export var __llvm_profile_runtime: i32 = 0;
+
+// The instrumentation passes the file name here from a global constructor,
+// which nothing runs without libc. writeFile is given the name instead.
+export fn __llvm_profile_override_default_filename(name: ?&const u8) {}
+
+// Value profiling is not supported; the calls which would record the
+// targets of indirect calls do nothing, so no values are written out.
+export fn __llvm_profile_instrument_target(target_value: u64, data: ?&u8, counter_index: u32) {}
+
+// __llvm_profile_data, one for each instrumented function
+const ProfileData = extern struct {
+    name_ref: u64,
+    func_hash: u64,
+    counter_ptr: usize,
+    function_pointer: usize,
+    values: usize,
+    num_counters: u32,
+    // for the one kind of value that LLVM 4.0 profiles, indirect call targets
+    num_value_sites: [1]u16,
+};
+
+const raw_magic = if (@sizeOf(usize) == 8) u64(0xff6c70726f667281) else u64(0xff6c70726f665281);
+// version 4, marked as coming from IR level instrumentation
+const raw_version = u64(4) | (u64(1) << 56);
+
+fn sectionBytes(start: &u8, stop: &u8) -> []const u8 {
+    return start[0..usize(stop) - usize(start)];
+}
+
+pub fn writeFile(path: []const u8) -> %void {
+    const data = sectionBytes(&__start___llvm_prf_data, &__stop___llvm_prf_data);
+    const counters = sectionBytes(&__start___llvm_prf_cnts, &__stop___llvm_prf_cnts);
+    const names = sectionBytes(&__start___llvm_prf_names, &__stop___llvm_prf_names);
+    const records = @ptrCast(&const ProfileData, data.ptr)[0..data.len / @sizeOf(ProfileData)];
+
+    const header = []u64 {
+        raw_magic,
+        raw_version,
+        records.len,
+        counters.len / @sizeOf(u64),
+        names.len,
+        usize(counters.ptr),
+        usize(names.ptr),
+        // the last kind of value, indirect call targets
+        0,
+    };
+    const zeroes = []u8{0} ** 8;
+
+    // the --profile-generate dir
+    const dir = os.path.dirname(path);
+    if (dir.len != 0)
+        %return os.makePath(&std.debug.global_allocator, dir);
+
+    var out = %return io.OutStream.open(path, null);
+    defer out.close();
+
+    %return out.write(@ptrCast(&const u8, &header[0])[0..@sizeOf(@typeOf(header))]);
+    %return out.write(data);
+    %return out.write(counters);
+    %return out.write(names);
+    %return out.write(zeroes[0..(8 - names.len % 8) % 8]);
+
+    // Every function with value sites gets a record of how many values each
+    // site has, which is none.
+    for (records) |record| {
+        const site_count = usize(record.num_value_sites[0]);
+        if (site_count == 0)
+            continue;
+        const record_size = (2 * @sizeOf(u32) + site_count + 7) / 8 * 8;
+        const value_header = []u32 {
+            u32(2 * @sizeOf(u32) + record_size),
+            // the number of kinds of value
+            1,
+            // the kind, indirect call targets
+            0,
+            u32(site_count),
+        };
+        %return out.write(@ptrCast(&const u8, &value_header[0])[0..@sizeOf(@typeOf(value_header))]);
+        var left = record_size - 2 * @sizeOf(u32);
+        while (left != 0) {
+            const amt = if (left < zeroes.len) left else zeroes.len;
+            %return out.write(zeroes[0..amt]);
+            left -= amt;
+        }
+    }
+    %return out.flush();
+}
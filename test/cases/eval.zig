@@ -1,4 +1,5 @@
 const assert = @import("std").debug.assert;
+const mem = @import("std").mem;
 const builtin = @import("builtin");
 
 test "compile time recursion" {
@@ -342,3 +343,99 @@ test "const global shares pointer with other same one" {
 fn assertEqualPtrs(ptr1: &const u8, ptr2: &const u8) {
     assert(ptr1 == ptr2);
 }
+
+test "modify copy of string literal at compile time" {
+    comptime {
+        var s = "hello";
+        s[0] = 'j';
+        assert(mem.eql(u8, s, "jello"));
+        assert(mem.eql(u8, "hello", "hel" ++ "lo"));
+        assert(mem.eql(u8, "ab" ** 3, "ababab"));
+    }
+}
+
+test "compile time tables of floats and bools" {
+    assert(global_float_table[3] == 1.5);
+    assert(global_bool_table[4]);
+    assert(!global_bool_table[5]);
+}
+
+const global_float_table = {
+    var result: [8]f64 = undefined;
+    for (result) |*item, index| {
+        *item = f64(index) * 0.5;
+    }
+    result
+};
+
+const global_bool_table = {
+    var result: [8]bool = undefined;
+    for (result) |*item, index| {
+        *item = index % 2 == 0;
+    }
+    result
+};
+
+test "repeated comptime calls with different arguments" {
+    comptime {
+        var sum: usize = 0;
+        var i: usize = 0;
+        while (i < 10) : (i += 1) {
+            sum += squareWithLocal(i);
+        }
+        assert(sum == 285);
+        assert(fibonacci(6) == 13);
+        assert(sizeOfEither(u8, u32, false) == 4);
+        assert(sizeOfEither(u8, u32, true) == 1);
+    }
+}
+
+fn squareWithLocal(x: usize) -> usize {
+    var result = x;
+    result *= x;
+    return result;
+}
+
+fn sizeOfEither(comptime A: type, comptime B: type, first: bool) -> usize {
+    const T = if (first) A else B;
+    return @sizeOf(T);
+}
+
+test "comptime calls of functions with runtime loops and recursion" {
+    comptime {
+        assert(countCollatzSteps(27) == 111);
+        assert(gcd(1071, 462) == 21);
+    }
+    assert(countCollatzSteps(27) == 111);
+    assert(gcd(1071, 462) == 21);
+}
+
+fn countCollatzSteps(start: u32) -> u32 {
+    var n = start;
+    var steps: u32 = 0;
+    while (n != 1) : (steps += 1) {
+        if (n % 2 == 0) {
+            n /= 2;
+        } else {
+            n = 3 * n + 1;
+        }
+    }
+    return steps;
+}
+
+fn gcd(a: u32, b: u32) -> u32 {
+    if (b == 0) return a;
+    return gcd(b, a % b);
+}
+
+test "@setEvalBranchQuota" {
+    comptime {
+        @setEvalBranchQuota(2000);
+        var i = 0;
+        var sum = 0;
+        while (i < 1001) : (i += 1) {
+            sum += i;
+        }
+        assert(sum == 500500);
+    }
+}
@@ -135,3 +135,65 @@ test "array of generic fns" {
     assert(foos[0](true));
     assert(!foos[1](true));
 }
+
+
+test "generic fn keyed by aggregate comptime values" {
+    assert(ConfigType(Config { .a = 1, .b = true }) == ConfigType(Config { .a = 1, .b = true }));
+    assert(ConfigType(Config { .a = 1, .b = true }) != ConfigType(Config { .a = 2, .b = true }));
+    assert(ArrayKeyedType([]u8 {1, 2, 3}) == ArrayKeyedType([]u8 {1, 2, 3}));
+    assert(ArrayKeyedType([]u8 {1, 2, 3}) != ArrayKeyedType([]u8 {1, 2, 4}));
+    assert(ArrayKeyedType([]u8 {1, 2, 3}).sum == 6);
+}
+const Config = struct {
+    a: i32,
+    b: bool,
+};
+fn ConfigType(comptime config: Config) -> type {
+    struct {
+        const a = config.a;
+    }
+}
+fn ArrayKeyedType(comptime array: [3]u8) -> type {
+    struct {
+        const sum = array[0] + array[1] + array[2];
+    }
+}
+
+test "memoized comptime calls keyed by aggregates, including undefined ones" {
+    assert(ArrayLen([3]u8(undefined)) == ArrayLen([]u8 {undefined, undefined, undefined}));
+    assert(ArrayLen([3]u8(undefined)) != ArrayLen([]u8 {1, 2, 3}));
+    assert(ArrayLen([]u8 {1, 2, undefined}) == ArrayLen([]u8 {1, 2, undefined}));
+    assert(ArrayLen([]u8 {1, 2, undefined}) != ArrayLen([]u8 {1, 2, 3}));
+    assert(ArrayLen([3]u8(undefined)).len == 3);
+    assert(PointType(Point { .x = 1, .y = undefined }) == PointType(Point { .x = 1, .y = undefined }));
+    assert(PointType(Point { .x = 1, .y = undefined }) != PointType(Point { .x = 1, .y = 2 }));
+}
+fn ArrayLen(array: [3]u8) -> type {
+    struct {
+        const len = array.len;
+    }
+}
+const Point = struct {
+    x: i32,
+    y: i32,
+};
+fn PointType(point: Point) -> type {
+    struct {
+        const x = point.x;
+    }
+}
+
+test "many memoized comptime calls keyed by arrays" {
+    comptime {
+        var i: usize = 0;
+        while (i < 200) : (i += 1) {
+            assert(ArraySum([]usize {i, i * 2, i * 3}) == ArraySum([]usize {i, i * 2, i * 3}));
+            assert(ArraySum([]usize {i, i * 2, i * 3}).sum == i * 6);
+        }
+    }
+}
+fn ArraySum(array: [3]usize) -> type {
+    struct {
+        const sum = array[0] + array[1] + array[2];
+    }
+}
@@ -168,6 +168,14 @@ test "builtin static eval" {
     assert(x == comptime 6);
 }
 
+test "builtin cpu features" {
+    comptime {
+        for (builtin.cpu_features) |feature| {
+            assert(feature.len != 0 and feature[0] != '+' and feature[0] != '-');
+        }
+    }
+}
+
 test "slicing" {
     var array : [20]i32 = undefined;
 
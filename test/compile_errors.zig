@@ -885,6 +885,16 @@ pub fn addCases(cases: &tests.CompileErrorContext) {
             ".tmp_source.zig:3:21: error: evaluation exceeded 1000 backwards branches",
             ".tmp_source.zig:3:21: note: called from here");
 
+    cases.add("@setEvalBranchQuota in non-root comptime execution context",
+        \\comptime {
+        \\    foo();
+        \\}
+        \\fn foo() {
+        \\    @setEvalBranchQuota(1001);
+        \\}
+    ,
+            ".tmp_source.zig:5:5: error: @setEvalBranchQuota must be called from the top of the comptime stack");
+
     cases.add("@embedFile with bogus file",
         \\const resource = @embedFile("bogus.txt");
         \\
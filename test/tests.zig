@@ -108,7 +108,7 @@ pub fn addPkgTests(b: &build.Builder, test_filter: ?[]const u8, root_src: []cons
     name:[] const u8, desc: []const u8) -> &build.Step
 {
     const step = b.step(b.fmt("test-{}", name), desc);
-    for ([]Mode{Mode.Debug, Mode.ReleaseFast}) |mode| {
+    for ([]Mode{Mode.Debug, Mode.ReleaseFast, Mode.ReleaseSmall}) |mode| {
         for ([]bool{false, true}) |link_libc| {
             const these_tests = b.addTest(root_src);
             these_tests.setNamePrefix(b.fmt("{}-{}-{} ", name, @enumTagName(mode),
@@ -124,6 +124,142 @@ pub fn addPkgTests(b: &build.Builder, test_filter: ?[]const u8, root_src: []cons
     return step;
 }
 
+pub fn addAnalysisThreadsTests(b: &build.Builder, test_filter: ?[]const u8, root_src: []const u8,
+    name: []const u8) -> &build.Step
+{
+    const step = b.step(b.fmt("test-{}-analysis-threads", name),
+        b.fmt("Run the {} tests with --analysis-threads 4 and --free-ir", name));
+    for ([]Mode{Mode.Debug, Mode.ReleaseFast}) |mode| {
+        const threaded = AnalysisThreadsStep.create(b, test_filter, root_src, name, mode);
+        step.dependOn(&threaded.step);
+    }
+    return step;
+}
+
+// Builds and runs the tests once on one thread, then again on four threads
+// with import prefetching and --free-ir, and checks that both builds
+// produce the same executable.
+const AnalysisThreadsStep = struct {
+    step: build.Step,
+    b: &build.Builder,
+    test_filter: ?[]const u8,
+    root_src: []const u8,
+    name: []const u8,
+    build_mode: Mode,
+
+    pub fn create(b: &build.Builder, test_filter: ?[]const u8, root_src: []const u8,
+        name: []const u8, build_mode: Mode) -> &AnalysisThreadsStep
+    {
+        const ptr = %%b.allocator.create(AnalysisThreadsStep);
+        *ptr = AnalysisThreadsStep {
+            .step = build.Step.init("AnalysisThreads", b.allocator, make),
+            .b = b,
+            .test_filter = test_filter,
+            .root_src = root_src,
+            .name = name,
+            .build_mode = build_mode,
+        };
+        return ptr;
+    }
+
+    fn make(step: &build.Step) -> %void {
+        const self = @fieldParentPtr(AnalysisThreadsStep, "step", step);
+        const b = self.b;
+
+        var single_exe = Buffer.initNull(b.allocator);
+        defer single_exe.deinit();
+        var threaded_exe = Buffer.initNull(b.allocator);
+        defer threaded_exe.deinit();
+
+        %return self.runTests(false, &single_exe);
+        %return self.runTests(true, &threaded_exe);
+
+        if (!mem.eql(u8, single_exe.toSliceConst(), threaded_exe.toSliceConst())) {
+            %%io.stderr.printf("{} tests in {} mode: --analysis-threads 4 changed the output\n",
+                self.name, @enumTagName(self.build_mode));
+            return error.TestFailed;
+        }
+    }
+
+    fn runTests(self: &AnalysisThreadsStep, threaded: bool, exe_contents: &Buffer) -> %void {
+        const b = self.b;
+
+        // Both builds use the same cache dir so that the paths in their
+        // debug info match. analysis_threads is not part of the cache key,
+        // so the dir is emptied first to keep the second build from being
+        // restored from the first.
+        const cache_dir = %%os.path.join(b.allocator, b.cache_root, "analysis-threads");
+        %return os.deleteTree(b.allocator, cache_dir);
+
+        var zig_args = ArrayList([]const u8).init(b.allocator);
+        defer zig_args.deinit();
+
+        %%zig_args.append("test");
+        %%zig_args.append(b.pathFromRoot(self.root_src));
+
+        %%zig_args.append("--cache-dir");
+        %%zig_args.append(cache_dir);
+
+        if (threaded) {
+            %%zig_args.append("--analysis-threads");
+            %%zig_args.append("4");
+            %%zig_args.append("--free-ir");
+        }
+
+        switch (self.build_mode) {
+            Mode.Debug => {},
+            Mode.ReleaseSafe => %%zig_args.append("--release-safe"),
+            Mode.ReleaseFast => %%zig_args.append("--release-fast"),
+            Mode.ReleaseSmall => %%zig_args.append("--release-small"),
+        }
+
+        // the prefix ends up in the executable, so it must not depend on
+        // the thread count
+        %%zig_args.append("--test-name-prefix");
+        %%zig_args.append(b.fmt("{}-{}-threads ", self.name, @enumTagName(self.build_mode)));
+
+        if (self.test_filter) |filter| {
+            %%zig_args.append("--test-filter");
+            %%zig_args.append(filter);
+        }
+
+        if (b.verbose) {
+            %%io.stderr.printf("{}", b.zig_exe);
+            for (zig_args.toSliceConst()) |arg| {
+                %%io.stderr.printf(" {}", arg);
+            }
+            %%io.stderr.printf("\n");
+        }
+
+        var child = os.ChildProcess.spawn(b.zig_exe, zig_args.toSliceConst(), null, &b.env_map,
+            StdIo.Ignore, StdIo.Inherit, StdIo.Inherit, b.allocator) %% |err|
+        {
+            debug.panic("Unable to spawn {}: {}\n", b.zig_exe, @errorName(err));
+        };
+
+        const term = child.wait() %% |err| {
+            debug.panic("Unable to spawn {}: {}\n", b.zig_exe, @errorName(err));
+        };
+        switch (term) {
+            Term.Clean => |code| {
+                if (code != 0) {
+                    %%io.stderr.printf("Process {} exited with error code {}\n", b.zig_exe, code);
+                    return error.TestFailed;
+                }
+            },
+            else => {
+                %%io.stderr.printf("Process {} terminated unexpectedly\n", b.zig_exe);
+                return error.TestFailed;
+            },
+        };
+
+        // zig test leaves the executable it ran at ./test
+        var in_stream = %return io.InStream.open("./test", b.allocator);
+        defer in_stream.close();
+        %return in_stream.readAll(exe_contents);
+    }
+};
+
 pub const CompareOutputContext = struct {
     b: &build.Builder,
     step: &build.Step,
@@ -500,6 +636,7 @@ pub const CompileErrorContext = struct {
                 Mode.Debug => {},
                 Mode.ReleaseSafe => %%zig_args.append("--release-safe"),
                 Mode.ReleaseFast => %%zig_args.append("--release-fast"),
+                Mode.ReleaseSmall => %%zig_args.append("--release-small"),
             }
 
             %%io.stderr.printf("Test {}/{} {}...", self.test_index+1, self.context.test_index, self.name);